@@ -0,0 +1,86 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#ifndef GEKKOFS_CLIENT_DISTRIBUTOR_SWITCH_HPP
+#define GEKKOFS_CLIENT_DISTRIBUTOR_SWITCH_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace gkfs {
+namespace rpc {
+class Distributor;
+}
+
+namespace preload {
+
+/**
+ * Holds the distributor of the client, which is replaced when the forwarding map changes. Data operations acquire the
+ * distributor and use it until they release it. A switch waits until no operation uses the current distributor and
+ * holds back new operations meanwhile.
+ */
+class DistributorSwitch {
+private:
+    std::shared_ptr<gkfs::rpc::Distributor> distributor_;
+    // data operations using the distributor and a pending distributor switch that waits for them
+    std::atomic<unsigned int> data_ops_in_flight_;
+    std::atomic<bool> switch_pending_;
+    std::mutex switch_mutex_;
+    std::condition_variable switch_cv_;
+
+public:
+    DistributorSwitch();
+
+    /**
+     * Sets the distributor without waiting for data operations, e.g., before the first one
+     * @param distributor
+     */
+    void distributor(std::shared_ptr<gkfs::rpc::Distributor> distributor);
+
+    std::shared_ptr<gkfs::rpc::Distributor> distributor() const;
+
+    std::shared_ptr<gkfs::rpc::Distributor> acquire();
+
+    void release();
+
+    void switch_distributor(std::shared_ptr<gkfs::rpc::Distributor> distributor);
+};
+
+/**
+ * Pins the distributor for the lifetime of a data operation so that all its RPCs go to the same hosts.
+ * DistributorSwitch::switch_distributor() waits until no operation holds a pin.
+ */
+class DistributorGuard {
+private:
+    DistributorSwitch& switch_;
+    std::shared_ptr<gkfs::rpc::Distributor> distributor_;
+public:
+    explicit DistributorGuard(DistributorSwitch& distributors);
+
+    ~DistributorGuard();
+
+    DistributorGuard(const DistributorGuard&) = delete;
+
+    DistributorGuard& operator=(const DistributorGuard&) = delete;
+
+    const gkfs::rpc::Distributor& operator*() const;
+
+    const gkfs::rpc::Distributor* operator->() const;
+};
+
+} // namespace preload
+} // namespace gkfs
+
+#endif //GEKKOFS_CLIENT_DISTRIBUTOR_SWITCH_HPP
@@ -33,8 +33,16 @@ static constexpr auto LOG_OUTPUT          = ADD_PREFIX("LOG_OUTPUT");
 static constexpr auto LOG_OUTPUT_TRUNC    = ADD_PREFIX("LOG_OUTPUT_TRUNC");
 static constexpr auto CWD                 = ADD_PREFIX("CWD");
 static constexpr auto HOSTS_FILE          = ADD_PREFIX("HOSTS_FILE");
+static constexpr auto RPC_TIMEOUT         = ADD_PREFIX("RPC_TIMEOUT");
+static constexpr auto RPC_RETRIES         = ADD_PREFIX("RPC_RETRIES");
+static constexpr auto RPC_HEDGE           = ADD_PREFIX("RPC_HEDGE");
+static constexpr auto REGISTRATION_CACHE_SIZE = ADD_PREFIX("REGISTRATION_CACHE_SIZE");
+static constexpr auto SHM_SIZE            = ADD_PREFIX("SHM_SIZE");
+static constexpr auto STATFS_INTERVAL     = ADD_PREFIX("STATFS_INTERVAL");
+static constexpr auto TRACE_FILE          = ADD_PREFIX("TRACE_FILE");
 #ifdef GKFS_ENABLE_FORWARDING
 static constexpr auto FORWARDING_MAP_FILE = ADD_PREFIX("FORWARDING_MAP_FILE");
+static constexpr auto FORWARDING_MODE     = ADD_PREFIX("FORWARDING_MODE");
 #endif
 
 } // namespace env
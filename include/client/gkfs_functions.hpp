@@ -29,6 +29,8 @@ int gkfs_open(const std::string& path, mode_t mode, int flags);
 
 int gkfs_create(const std::string& path, mode_t mode);
 
+int gkfs_create(const std::string& path, mode_t mode, int& data_host, gkfs::metadata::Layout& layout);
+
 int gkfs_remove(const std::string& path);
 
 // Implementation of access,
@@ -55,12 +57,17 @@ off64_t gkfs_lseek(std::shared_ptr<gkfs::filemap::OpenFile> gkfs_fd, off64_t off
 
 int gkfs_truncate(const std::string& path, off_t offset);
 
-int gkfs_truncate(const std::string& path, off_t old_size, off_t new_size);
+int gkfs_truncate(const std::string& path, off_t old_size, off_t new_size, int data_host,
+                  const gkfs::metadata::Layout& layout, bool stored_inline);
 
 int gkfs_dup(int oldfd);
 
 int gkfs_dup2(int oldfd, int newfd);
 
+int gkfs_setxattr(const std::string& path, const std::string& name, const void* value, size_t size, int flags);
+
+ssize_t gkfs_getxattr(const std::string& path, const std::string& name, void* value, size_t size);
+
 #ifdef HAS_SYMLINKS
 
 int gkfs_mk_symlink(const std::string& path, const std::string& target_path);
@@ -70,12 +77,15 @@ int gkfs_readlink(const std::string& path, char* buf, int bufsize);
 #endif
 
 ssize_t gkfs_pwrite(std::shared_ptr<gkfs::filemap::OpenFile> file,
-                    const char* buf, size_t count, off64_t offset);
+                    const char* buf, size_t count, off64_t offset, off64_t& write_offset);
 
 ssize_t gkfs_pwrite_ws(int fd, const void* buf, size_t count, off64_t offset);
 
 ssize_t gkfs_write(int fd, const void* buf, size_t count);
 
+ssize_t gkfs_pwritev(std::shared_ptr<gkfs::filemap::OpenFile> file, const struct iovec* iov, int iovcnt,
+                     off64_t offset, off64_t& write_offset);
+
 ssize_t gkfs_pwritev(int fd, const struct iovec* iov, int iovcnt, off_t offset);
 
 ssize_t gkfs_writev(int fd, const struct iovec* iov, int iovcnt);
@@ -105,6 +105,11 @@ int hook_statfs(const char* path, struct statfs* buf);
 
 int hook_fstatfs(unsigned int fd, struct statfs* buf);
 
+int hook_setxattr(const char* path, const char* name, const void* value, size_t size, int flags,
+                  bool follow_links);
+
+int hook_getxattr(const char* path, const char* name, void* value, size_t size, bool follow_links);
+
 } // namespace hook
 } // namespace gkfs
 
@@ -15,6 +15,10 @@
 #ifndef GEKKOFS_OPEN_FILE_MAP_HPP
 #define GEKKOFS_OPEN_FILE_MAP_HPP
 
+#include <global/metadata.hpp>
+#include <global/rpc/distributor.hpp>
+
+#include <array>
 #include <map>
 #include <mutex>
 #include <memory>
@@ -49,15 +53,21 @@ protected:
     std::string path_;
     std::array<bool, static_cast<int>(OpenFile_flags::flag_count)> flags_ = {{false}};
     unsigned long pos_;
+    int data_host_; // host holding all chunks, taken from the file's metadata on open
+    gkfs::metadata::Layout layout_; // of the chunks, taken from the file's metadata on open
+    // content is in the metadentry. Taken from the file's metadata on open, cleared once it is moved to chunks
+    std::atomic<bool> stored_inline_;
     std::mutex pos_mutex_;
     std::mutex flag_mutex_;
+    // keeps the data host chosen for a regular file fixed while it is open, if the distributor chooses one per file
+    std::shared_ptr<gkfs::rpc::Distributor> pinned_distributor_;
 
 public:
     // multiple threads may want to update the file position if fd has been duplicated by dup()
 
     OpenFile(const std::string& path, int flags, FileType type = FileType::regular);
 
-    ~OpenFile() = default;
+    ~OpenFile();
 
     // getter/setter
     std::string path() const;
@@ -73,6 +83,18 @@ public:
     void set_flag(OpenFile_flags flag, bool value);
 
     FileType type() const;
+
+    int data_host() const;
+
+    void data_host(int data_host);
+
+    const gkfs::metadata::Layout& layout() const;
+
+    void layout(const gkfs::metadata::Layout& layout);
+
+    bool stored_inline() const;
+
+    void stored_inline(bool stored_inline);
 };
 
 
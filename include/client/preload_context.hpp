@@ -14,6 +14,8 @@
 #ifndef GEKKOFS_PRELOAD_CTX_HPP
 #define GEKKOFS_PRELOAD_CTX_HPP
 
+#include <client/distributor_switch.hpp>
+
 #include <hermes.hpp>
 #include <map>
 #include <mercury.h>
@@ -22,6 +24,8 @@
 #include <string>
 
 #include <bitset>
+#include <atomic>
+#include <mutex>
 
 /* Forward declarations */
 namespace gkfs {
@@ -30,6 +34,7 @@ class OpenFileMap;
 }
 namespace rpc {
 class Distributor;
+enum class DistributorType : unsigned int;
 }
 namespace log {
 struct logger;
@@ -52,6 +57,12 @@ struct FsConfig {
 
     std::string rootdir;
 
+    // placement used by the daemons
+    gkfs::rpc::DistributorType distributor;
+
+    // files of up to this size are stored in their metadentry, 0 if disabled
+    uint64_t inline_data_size;
+
 };
 
 enum class RelativizeStatus {
@@ -73,7 +84,7 @@ private:
     PreloadContext();
 
     std::shared_ptr<gkfs::filemap::OpenFileMap> ofm_;
-    std::shared_ptr<gkfs::rpc::Distributor> distributor_;
+    DistributorSwitch distributors_;
     std::shared_ptr<FsConfig> fs_conf_;
 
     std::string cwd_;
@@ -141,6 +152,8 @@ public:
 
     std::shared_ptr<gkfs::rpc::Distributor> distributor() const;
 
+    DistributorSwitch& distributors();
+
     const std::shared_ptr<FsConfig>& fs_conf() const;
 
     void enable_interception();
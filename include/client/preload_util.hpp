@@ -21,6 +21,7 @@
 #include <string>
 #include <iostream>
 #include <map>
+#include <vector>
 #include <type_traits>
 
 namespace gkfs {
@@ -37,6 +38,7 @@ struct MetadentryUpdateFlags {
     bool size = false;
     bool blocks = false;
     bool path = false;
+    bool layout = false;
 };
 
 } // namespace metadata
@@ -62,7 +64,8 @@ int metadata_to_stat(const std::string& path, const gkfs::metadata::Metadata& md
 std::vector<std::pair<std::string, std::string>> load_hostfile(const std::string& lfpath);
 
 void load_hosts();
-void load_forwarding_map();
+
+std::vector<uint64_t> read_forwarding_hosts();
 
 } // namespace util
 } // namespace gkfs
@@ -16,6 +16,12 @@
 #define GEKKOFS_CLIENT_FORWARD_DATA_HPP
 
 namespace gkfs {
+
+/* Forward declaration */
+namespace metadata {
+struct Layout;
+}
+
 namespace rpc {
 
 struct ChunkStat {
@@ -25,14 +31,36 @@ struct ChunkStat {
 };
 
 ssize_t forward_write(const std::string& path, const void* buf, bool append_flag, off64_t in_offset,
-                      size_t write_size, int64_t updated_metadentry_size);
+                      size_t write_size, int64_t updated_metadentry_size, int data_host,
+                      const gkfs::metadata::Layout& layout);
+
+ssize_t forward_read(const std::string& path, void* buf, off64_t offset, size_t read_size, int data_host,
+                     const gkfs::metadata::Layout& layout);
+
+ssize_t forward_write_inline(const std::string& path, const void* buf, off64_t offset, size_t write_size,
+                             bool append_flag, bool& stored_inline, off64_t& write_offset);
+
+ssize_t forward_read_inline(const std::string& path, void* buf, off64_t offset, size_t read_size,
+                            bool& stored_inline);
 
-ssize_t forward_read(const std::string& path, void* buf, off64_t offset, size_t read_size);
+int forward_promote_inline(const std::string& path);
 
-int forward_truncate(const std::string& path, size_t current_size, size_t new_size);
+off64_t forward_seek_data(const std::string& path, off64_t offset, size_t file_size, int whence, int data_host,
+                          const gkfs::metadata::Layout& layout);
+
+int forward_truncate(const std::string& path, size_t current_size, size_t new_size, int data_host,
+                     const gkfs::metadata::Layout& layout);
 
 ChunkStat forward_get_chunk_stat();
 
+ChunkStat forward_get_chunk_stat(unsigned int host);
+
+void init_chunk_stat_cache();
+
+void destroy_chunk_stat_cache();
+
+ChunkStat cached_chunk_stat();
+
 } // namespace rpc
 } // namespace gkfs
 
@@ -15,11 +15,24 @@
 #ifndef GEKKOFS_CLIENT_FORWARD_MNGMNT_HPP
 #define GEKKOFS_CLIENT_FORWARD_MNGMNT_HPP
 
+#include <cstdint>
+#include <vector>
+
 namespace gkfs {
 namespace rpc {
 
+struct ForwarderLoad {
+    uint64_t io_queue_depth;
+    uint64_t bytes_in_flight;
+    uint64_t agios_backlog;
+};
+
 bool forward_get_fs_config();
 
+std::vector<ForwarderLoad> forward_get_load(const std::vector<unsigned int>& hosts);
+
+unsigned int choose_forwarder(const std::vector<unsigned int>& candidates);
+
 } // namespace rpc
 } // namespace gkfs
 
@@ -15,6 +15,7 @@
 #ifndef GEKKOFS_CLIENT_FORWARD_METADATA_HPP
 #define GEKKOFS_CLIENT_FORWARD_METADATA_HPP
 
+#include <functional>
 #include <string>
 
 /* Forward declaration */
@@ -25,23 +26,29 @@ class OpenDir;
 namespace metadata {
 struct MetadentryUpdateFlags;
 class Metadata;
+struct Layout;
 }
 
 namespace rpc {
 
-int forward_create(const std::string& path, mode_t mode);
+int forward_create(const std::string& path, mode_t mode, int data_host, const gkfs::metadata::Layout& layout);
 
 int forward_stat(const std::string& path, std::string& attr);
 
-int forward_remove(const std::string& path, bool remove_metadentry_only, ssize_t size);
+int forward_remove(const std::string& path, bool remove_metadentry_only, ssize_t size, int data_host,
+                   const gkfs::metadata::Layout& layout);
 
 int forward_decr_size(const std::string& path, size_t length);
 
 int forward_update_metadentry(const std::string& path, const gkfs::metadata::Metadata& md,
                               const gkfs::metadata::MetadentryUpdateFlags& md_flags);
 
+/**
+ * Updates the size of a file after a write. overlap, e.g., the data transfer of the write, runs while the request is
+ * in flight and before its reply is awaited
+ */
 int forward_update_metadentry_size(const std::string& path, size_t size, off64_t offset, bool append_flag,
-                                   off64_t& ret_size);
+                                   off64_t& ret_size, const std::function<void()>& overlap = nullptr);
 
 int forward_get_metadentry_size(const std::string& path, off64_t& ret_size);
 
@@ -0,0 +1,106 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#ifndef GEKKOFS_CLIENT_REGISTRATION_CACHE_HPP
+#define GEKKOFS_CLIENT_REGISTRATION_CACHE_HPP
+
+#include <hermes.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace gkfs {
+namespace rpc {
+
+/**
+ * Keeps user buffers exposed for RDMA across I/O calls, since most applications reuse the same buffers and
+ * registering memory is expensive with verbs or psm2. A cached registration is reused for a buffer with the same start
+ * address, size and access mode. Registrations are dropped in LRU order when the pinned memory would exceed the
+ * budget, and when their memory is unmapped. A registration in use by a request stays valid until the request
+ * releases it.
+ */
+class RegistrationCache {
+public:
+    using expose_function = std::function<std::shared_ptr<hermes::exposed_memory>(void*, std::size_t,
+                                                                                  hermes::access_mode)>;
+
+private:
+    struct Entry;
+    // by start address of the region
+    using entry_map = std::multimap<uintptr_t, Entry>;
+
+    struct Entry {
+        std::size_t size;
+        hermes::access_mode mode;
+        std::shared_ptr<hermes::exposed_memory> memory;
+        std::list<entry_map::iterator>::iterator lru_pos;
+    };
+
+    std::size_t budget_;
+    // registers a buffer with the RPC engine
+    expose_function expose_;
+    std::size_t pinned_;
+    // largest cached region, bounds the search for regions overlapping an unmapped range
+    std::size_t max_entry_size_;
+    entry_map entries_;
+    // most recently used first
+    std::list<entry_map::iterator> lru_;
+    std::atomic<bool> empty_;
+    mutable std::mutex mutex_;
+
+    entry_map::iterator find(uintptr_t addr, hermes::access_mode mode);
+
+    void erase(entry_map::iterator it);
+
+public:
+    RegistrationCache(std::size_t budget, expose_function expose);
+
+    /**
+     * Returns exposed memory for the buffer, registering it only if it is not cached yet
+     * @param buf
+     * @param size
+     * @param mode
+     * @return
+     * @throws std::exception if the buffer cannot be exposed
+     */
+    std::shared_ptr<hermes::exposed_memory> expose(void* buf, std::size_t size, hermes::access_mode mode);
+
+    /**
+     * Drops all registrations overlapping the given address range, e.g., before it is unmapped
+     * @param addr
+     * @param size
+     */
+    void invalidate(const void* addr, std::size_t size);
+
+    void clear();
+
+    std::size_t pinned() const;
+};
+
+void init_registration_cache();
+
+void destroy_registration_cache();
+
+std::shared_ptr<hermes::exposed_memory> expose_user_buffer(void* buf, std::size_t size, hermes::access_mode mode);
+
+void invalidate_registrations(const void* addr, std::size_t size);
+
+} // namespace rpc
+} // namespace gkfs
+
+#endif //GEKKOFS_CLIENT_REGISTRATION_CACHE_HPP
@@ -133,7 +133,9 @@ struct fs_config {
                 m_link_cnt_state(),
                 m_blocks_state(),
                 m_uid(),
-                m_gid() {}
+                m_gid(),
+                m_distributor(),
+                m_inline_data_size() {}
 
         output(const std::string& mountdir,
                const std::string& rootdir,
@@ -143,7 +145,9 @@ struct fs_config {
                bool link_cnt_state,
                bool blocks_state,
                uint32_t uid,
-               uint32_t gid) :
+               uint32_t gid,
+               uint32_t distributor,
+               uint64_t inline_data_size) :
                 m_mountdir(mountdir),
                 m_rootdir(rootdir),
                 m_atime_state(atime_state),
@@ -152,7 +156,9 @@ struct fs_config {
                 m_link_cnt_state(link_cnt_state),
                 m_blocks_state(blocks_state),
                 m_uid(uid),
-                m_gid(gid) {}
+                m_gid(gid),
+                m_distributor(distributor),
+                m_inline_data_size(inline_data_size) {}
 
         output(output&& rhs) = default;
 
@@ -180,6 +186,8 @@ struct fs_config {
             m_blocks_state = out.blocks_state;
             m_uid = out.uid;
             m_gid = out.gid;
+            m_distributor = out.distributor;
+            m_inline_data_size = out.inline_data_size;
         }
 
         std::string
@@ -227,6 +235,16 @@ struct fs_config {
             return m_gid;
         }
 
+        uint32_t
+        distributor() const {
+            return m_distributor;
+        }
+
+        uint64_t
+        inline_data_size() const {
+            return m_inline_data_size;
+        }
+
     private:
         std::string m_mountdir;
         std::string m_rootdir;
@@ -237,6 +255,8 @@ struct fs_config {
         bool m_blocks_state;
         uint32_t m_uid;
         uint32_t m_gid;
+        uint32_t m_distributor;
+        uint64_t m_inline_data_size;
     };
 };
 
@@ -287,9 +307,15 @@ struct create {
 
     public:
         input(const std::string& path,
-              uint32_t mode) :
+              uint32_t mode,
+              int32_t data_host,
+              uint64_t chunk_size,
+              uint32_t stripe_width) :
                 m_path(path),
-                m_mode(mode) {}
+                m_mode(mode),
+                m_data_host(data_host),
+                m_chunk_size(chunk_size),
+                m_stripe_width(stripe_width) {}
 
         input(input&& rhs) = default;
 
@@ -309,19 +335,40 @@ struct create {
             return m_mode;
         }
 
+        int32_t
+        data_host() const {
+            return m_data_host;
+        }
+
+        uint64_t
+        chunk_size() const {
+            return m_chunk_size;
+        }
+
+        uint32_t
+        stripe_width() const {
+            return m_stripe_width;
+        }
+
         explicit
         input(const rpc_mk_node_in_t& other) :
                 m_path(other.path),
-                m_mode(other.mode) {}
+                m_mode(other.mode),
+                m_data_host(other.data_host),
+                m_chunk_size(other.chunk_size),
+                m_stripe_width(other.stripe_width) {}
 
         explicit
         operator rpc_mk_node_in_t() {
-            return {m_path.c_str(), m_mode};
+            return {m_path.c_str(), m_mode, m_data_host, m_chunk_size, m_stripe_width};
         }
 
     private:
         std::string m_path;
         uint32_t m_mode;
+        int32_t m_data_host;
+        uint64_t m_chunk_size;
+        uint32_t m_stripe_width;
     };
 
     class output {
@@ -589,6 +636,115 @@ struct remove {
     };
 };
 
+//==============================================================================
+// definitions for reclaim_chunks
+struct reclaim_chunks {
+
+    // forward declarations of public input/output types for this RPC
+    class input;
+
+    class output;
+
+    // traits used so that the engine knows what to do with the RPC
+    using self_type = reclaim_chunks;
+    using handle_type = hermes::rpc_handle<self_type>;
+    using input_type = input;
+    using output_type = output;
+    using mercury_input_type = rpc_rm_node_in_t;
+    using mercury_output_type = rpc_err_out_t;
+
+    // RPC public identifier
+    // (N.B: we reuse the same IDs assigned by Margo so that the daemon
+    // understands Hermes RPCs)
+    constexpr static const uint64_t public_id = 3855417344;
+
+    // RPC internal Mercury identifier
+    constexpr static const hg_id_t mercury_id = public_id;
+
+    // RPC name
+    constexpr static const auto name = gkfs::rpc::tag::reclaim_chunks;
+
+    // requires response?
+    constexpr static const auto requires_response = true;
+
+    // Mercury callback to serialize input arguments
+    constexpr static const auto mercury_in_proc_cb =
+            HG_GEN_PROC_NAME(rpc_rm_node_in_t);
+
+    // Mercury callback to serialize output arguments
+    constexpr static const auto mercury_out_proc_cb =
+            HG_GEN_PROC_NAME(rpc_err_out_t);
+
+    class input {
+
+        template<typename ExecutionContext>
+        friend hg_return_t hermes::detail::post_to_mercury(ExecutionContext*);
+
+    public:
+        input(const std::string& path) :
+                m_path(path) {}
+
+        input(input&& rhs) = default;
+
+        input(const input& other) = default;
+
+        input& operator=(input&& rhs) = default;
+
+        input& operator=(const input& other) = default;
+
+        std::string
+        path() const {
+            return m_path;
+        }
+
+        explicit
+        input(const rpc_rm_node_in_t& other) :
+                m_path(other.path) {}
+
+        explicit
+        operator rpc_rm_node_in_t() {
+            return {m_path.c_str()};
+        }
+
+    private:
+        std::string m_path;
+    };
+
+    class output {
+
+        template<typename ExecutionContext>
+        friend hg_return_t hermes::detail::post_to_mercury(ExecutionContext*);
+
+    public:
+        output() :
+                m_err() {}
+
+        output(int32_t err) :
+                m_err(err) {}
+
+        output(output&& rhs) = default;
+
+        output(const output& other) = default;
+
+        output& operator=(output&& rhs) = default;
+
+        output& operator=(const output& other) = default;
+
+        explicit
+        output(const rpc_err_out_t& out) {
+            m_err = out.err;
+        }
+
+        int32_t
+        err() const {
+            return m_err;
+        }
+
+    private:
+        int32_t m_err;
+    };
+};
+
 //==============================================================================
 // definitions for decr_size
 struct decr_size {
@@ -761,13 +917,16 @@ struct update_metadentry {
               int64_t atime,
               int64_t mtime,
               int64_t ctime,
+              uint64_t chunk_size,
+              uint32_t stripe_width,
               bool nlink_flag,
               bool mode_flag,
               bool size_flag,
               bool block_flag,
               bool atime_flag,
               bool mtime_flag,
-              bool ctime_flag) :
+              bool ctime_flag,
+              bool layout_flag) :
                 m_path(path),
                 m_nlink(nlink),
                 m_mode(mode),
@@ -778,13 +937,16 @@ struct update_metadentry {
                 m_atime(atime),
                 m_mtime(mtime),
                 m_ctime(ctime),
+                m_chunk_size(chunk_size),
+                m_stripe_width(stripe_width),
                 m_nlink_flag(nlink_flag),
                 m_mode_flag(mode_flag),
                 m_size_flag(size_flag),
                 m_block_flag(block_flag),
                 m_atime_flag(atime_flag),
                 m_mtime_flag(mtime_flag),
-                m_ctime_flag(ctime_flag) {}
+                m_ctime_flag(ctime_flag),
+                m_layout_flag(layout_flag) {}
 
         input(input&& rhs) = default;
 
@@ -844,6 +1006,16 @@ struct update_metadentry {
             return m_ctime;
         }
 
+        uint64_t
+        chunk_size() const {
+            return m_chunk_size;
+        }
+
+        uint32_t
+        stripe_width() const {
+            return m_stripe_width;
+        }
+
         bool
         nlink_flag() const {
             return m_nlink_flag;
@@ -879,6 +1051,11 @@ struct update_metadentry {
             return m_ctime_flag;
         }
 
+        bool
+        layout_flag() const {
+            return m_layout_flag;
+        }
+
         explicit
         input(const rpc_update_metadentry_in_t& other) :
                 m_path(other.path),
@@ -891,13 +1068,16 @@ struct update_metadentry {
                 m_atime(other.atime),
                 m_mtime(other.mtime),
                 m_ctime(other.ctime),
+                m_chunk_size(other.chunk_size),
+                m_stripe_width(other.stripe_width),
                 m_nlink_flag(other.nlink_flag),
                 m_mode_flag(other.mode_flag),
                 m_size_flag(other.size_flag),
                 m_block_flag(other.block_flag),
                 m_atime_flag(other.atime_flag),
                 m_mtime_flag(other.mtime_flag),
-                m_ctime_flag(other.ctime_flag) {}
+                m_ctime_flag(other.ctime_flag),
+                m_layout_flag(other.layout_flag) {}
 
         explicit
         operator rpc_update_metadentry_in_t() {
@@ -911,13 +1091,16 @@ struct update_metadentry {
                     m_atime,
                     m_mtime,
                     m_ctime,
+                    m_chunk_size,
+                    m_stripe_width,
                     m_nlink_flag,
                     m_mode_flag,
                     m_size_flag,
                     m_block_flag,
                     m_atime_flag,
                     m_mtime_flag,
-                    m_ctime_flag};
+                    m_ctime_flag,
+                    m_layout_flag};
         }
 
     private:
@@ -931,6 +1114,8 @@ struct update_metadentry {
         int64_t m_atime;
         int64_t m_mtime;
         int64_t m_ctime;
+        uint64_t m_chunk_size;
+        uint32_t m_stripe_width;
         bool m_nlink_flag;
         bool m_mode_flag;
         bool m_size_flag;
@@ -938,6 +1123,7 @@ struct update_metadentry {
         bool m_atime_flag;
         bool m_mtime_flag;
         bool m_ctime_flag;
+        bool m_layout_flag;
     };
 
     class output {
@@ -1409,20 +1595,32 @@ struct write_data {
               int64_t offset,
               uint64_t host_id,
               uint64_t host_size,
+              uint64_t chunk_size,
+              uint32_t stripe_width,
               uint64_t chunk_n,
               uint64_t chunk_start,
               uint64_t chunk_end,
               uint64_t total_chunk_size,
-              const hermes::exposed_memory& buffers) :
+              const hermes::exposed_memory& buffers,
+              uint64_t shm_id,
+              uint32_t shm_pid,
+              int32_t shm_fd,
+              int64_t shm_offset) :
                 m_path(path),
                 m_offset(offset),
                 m_host_id(host_id),
                 m_host_size(host_size),
+                m_chunk_size(chunk_size),
+                m_stripe_width(stripe_width),
                 m_chunk_n(chunk_n),
                 m_chunk_start(chunk_start),
                 m_chunk_end(chunk_end),
                 m_total_chunk_size(total_chunk_size),
-                m_buffers(buffers) {}
+                m_buffers(buffers),
+                m_shm_id(shm_id),
+                m_shm_pid(shm_pid),
+                m_shm_fd(shm_fd),
+                m_shm_offset(shm_offset) {}
 
         input(input&& rhs) = default;
 
@@ -1452,6 +1650,16 @@ struct write_data {
             return m_host_size;
         }
 
+        uint64_t
+        chunk_size() const {
+            return m_chunk_size;
+        }
+
+        uint32_t
+        stripe_width() const {
+            return m_stripe_width;
+        }
+
         uint64_t
         chunk_n() const {
             return m_chunk_n;
@@ -1477,17 +1685,43 @@ struct write_data {
             return m_buffers;
         }
 
+        uint64_t
+        shm_id() const {
+            return m_shm_id;
+        }
+
+        uint32_t
+        shm_pid() const {
+            return m_shm_pid;
+        }
+
+        int32_t
+        shm_fd() const {
+            return m_shm_fd;
+        }
+
+        int64_t
+        shm_offset() const {
+            return m_shm_offset;
+        }
+
         explicit
         input(const rpc_write_data_in_t& other) :
                 m_path(other.path),
                 m_offset(other.offset),
                 m_host_id(other.host_id),
                 m_host_size(other.host_size),
+                m_chunk_size(other.chunk_size),
+                m_stripe_width(other.stripe_width),
                 m_chunk_n(other.chunk_n),
                 m_chunk_start(other.chunk_start),
                 m_chunk_end(other.chunk_end),
                 m_total_chunk_size(other.total_chunk_size),
-                m_buffers(other.bulk_handle) {}
+                m_buffers(other.bulk_handle),
+                m_shm_id(other.shm_id),
+                m_shm_pid(other.shm_pid),
+                m_shm_fd(other.shm_fd),
+                m_shm_offset(other.shm_offset) {}
 
         explicit
         operator rpc_write_data_in_t() {
@@ -1496,11 +1730,17 @@ struct write_data {
                     m_offset,
                     m_host_id,
                     m_host_size,
+                    m_chunk_size,
+                    m_stripe_width,
                     m_chunk_n,
                     m_chunk_start,
                     m_chunk_end,
                     m_total_chunk_size,
-                    hg_bulk_t(m_buffers)
+                    hg_bulk_t(m_buffers),
+                    m_shm_id,
+                    m_shm_pid,
+                    m_shm_fd,
+                    m_shm_offset
             };
         }
 
@@ -1509,11 +1749,17 @@ struct write_data {
         int64_t m_offset;
         uint64_t m_host_id;
         uint64_t m_host_size;
+        uint64_t m_chunk_size;
+        uint32_t m_stripe_width;
         uint64_t m_chunk_n;
         uint64_t m_chunk_start;
         uint64_t m_chunk_end;
         uint64_t m_total_chunk_size;
         hermes::exposed_memory m_buffers;
+        uint64_t m_shm_id;
+        uint32_t m_shm_pid;
+        int32_t m_shm_fd;
+        int64_t m_shm_offset;
     };
 
     class output {
@@ -1575,7 +1821,7 @@ struct read_data {
     using input_type = input;
     using output_type = output;
     using mercury_input_type = rpc_read_data_in_t;
-    using mercury_output_type = rpc_data_out_t;
+    using mercury_output_type = rpc_read_data_out_t;
 
     // RPC public identifier
     // (N.B: we reuse the same IDs assigned by Margo so that the daemon
@@ -1597,7 +1843,7 @@ struct read_data {
 
     // Mercury callback to serialize output arguments
     constexpr static const auto mercury_out_proc_cb =
-            HG_GEN_PROC_NAME(rpc_data_out_t);
+            HG_GEN_PROC_NAME(rpc_read_data_out_t);
 
     class input {
 
@@ -1609,20 +1855,32 @@ struct read_data {
               int64_t offset,
               uint64_t host_id,
               uint64_t host_size,
+              uint64_t chunk_size,
+              uint32_t stripe_width,
               uint64_t chunk_n,
               uint64_t chunk_start,
               uint64_t chunk_end,
               uint64_t total_chunk_size,
-              const hermes::exposed_memory& buffers) :
+              const hermes::exposed_memory& buffers,
+              uint64_t shm_id,
+              uint32_t shm_pid,
+              int32_t shm_fd,
+              int64_t shm_offset) :
                 m_path(path),
                 m_offset(offset),
                 m_host_id(host_id),
                 m_host_size(host_size),
+                m_chunk_size(chunk_size),
+                m_stripe_width(stripe_width),
                 m_chunk_n(chunk_n),
                 m_chunk_start(chunk_start),
                 m_chunk_end(chunk_end),
                 m_total_chunk_size(total_chunk_size),
-                m_buffers(buffers) {}
+                m_buffers(buffers),
+                m_shm_id(shm_id),
+                m_shm_pid(shm_pid),
+                m_shm_fd(shm_fd),
+                m_shm_offset(shm_offset) {}
 
         input(input&& rhs) = default;
 
@@ -1652,6 +1910,16 @@ struct read_data {
             return m_host_size;
         }
 
+        uint64_t
+        chunk_size() const {
+            return m_chunk_size;
+        }
+
+        uint32_t
+        stripe_width() const {
+            return m_stripe_width;
+        }
+
         uint64_t
         chunk_n() const {
             return m_chunk_n;
@@ -1677,17 +1945,43 @@ struct read_data {
             return m_buffers;
         }
 
+        uint64_t
+        shm_id() const {
+            return m_shm_id;
+        }
+
+        uint32_t
+        shm_pid() const {
+            return m_shm_pid;
+        }
+
+        int32_t
+        shm_fd() const {
+            return m_shm_fd;
+        }
+
+        int64_t
+        shm_offset() const {
+            return m_shm_offset;
+        }
+
         explicit
         input(const rpc_read_data_in_t& other) :
                 m_path(other.path),
                 m_offset(other.offset),
                 m_host_id(other.host_id),
                 m_host_size(other.host_size),
+                m_chunk_size(other.chunk_size),
+                m_stripe_width(other.stripe_width),
                 m_chunk_n(other.chunk_n),
                 m_chunk_start(other.chunk_start),
                 m_chunk_end(other.chunk_end),
                 m_total_chunk_size(other.total_chunk_size),
-                m_buffers(other.bulk_handle) {}
+                m_buffers(other.bulk_handle),
+                m_shm_id(other.shm_id),
+                m_shm_pid(other.shm_pid),
+                m_shm_fd(other.shm_fd),
+                m_shm_offset(other.shm_offset) {}
 
         explicit
         operator rpc_read_data_in_t() {
@@ -1696,11 +1990,17 @@ struct read_data {
                     m_offset,
                     m_host_id,
                     m_host_size,
+                    m_chunk_size,
+                    m_stripe_width,
                     m_chunk_n,
                     m_chunk_start,
                     m_chunk_end,
                     m_total_chunk_size,
-                    hg_bulk_t(m_buffers)
+                    hg_bulk_t(m_buffers),
+                    m_shm_id,
+                    m_shm_pid,
+                    m_shm_fd,
+                    m_shm_offset
             };
         }
 
@@ -1709,11 +2009,17 @@ struct read_data {
         int64_t m_offset;
         uint64_t m_host_id;
         uint64_t m_host_size;
+        uint64_t m_chunk_size;
+        uint32_t m_stripe_width;
         uint64_t m_chunk_n;
         uint64_t m_chunk_start;
         uint64_t m_chunk_end;
         uint64_t m_total_chunk_size;
         hermes::exposed_memory m_buffers;
+        uint64_t m_shm_id;
+        uint32_t m_shm_pid;
+        int32_t m_shm_fd;
+        int64_t m_shm_offset;
     };
 
     class output {
@@ -1724,11 +2030,13 @@ struct read_data {
     public:
         output() :
                 m_err(),
-                m_io_size() {}
+                m_io_size(),
+                m_data_end() {}
 
-        output(int32_t err, size_t io_size) :
+        output(int32_t err, size_t io_size, uint64_t data_end) :
                 m_err(err),
-                m_io_size(io_size) {}
+                m_io_size(io_size),
+                m_data_end(data_end) {}
 
         output(output&& rhs) = default;
 
@@ -1739,9 +2047,10 @@ struct read_data {
         output& operator=(const output& other) = default;
 
         explicit
-        output(const rpc_data_out_t& out) {
+        output(const rpc_read_data_out_t& out) {
             m_err = out.err;
             m_io_size = out.io_size;
+            m_data_end = out.data_end;
         }
 
         int32_t
@@ -1754,9 +2063,15 @@ struct read_data {
             return m_io_size;
         }
 
+        uint64_t
+        data_end() const {
+            return m_data_end;
+        }
+
     private:
         int32_t m_err;
         size_t m_io_size;
+        uint64_t m_data_end;
     };
 };
 
@@ -1806,9 +2121,11 @@ struct trunc_data {
 
     public:
         input(const std::string& path,
-              uint64_t length) :
+              uint64_t length,
+              uint64_t chunk_size) :
                 m_path(path),
-                m_length(length) {}
+                m_length(length),
+                m_chunk_size(chunk_size) {}
 
         input(input&& rhs) = default;
 
@@ -1828,22 +2145,30 @@ struct trunc_data {
             return m_length;
         }
 
+        uint64_t
+        chunk_size() const {
+            return m_chunk_size;
+        }
+
         explicit
         input(const rpc_trunc_in_t& other) :
                 m_path(other.path),
-                m_length(other.length) {}
+                m_length(other.length),
+                m_chunk_size(other.chunk_size) {}
 
         explicit
         operator rpc_trunc_in_t() {
             return {
                     m_path.c_str(),
                     m_length,
+                    m_chunk_size,
             };
         }
 
     private:
         std::string m_path;
         uint64_t m_length;
+        uint64_t m_chunk_size;
     };
 
     class output {
@@ -2138,6 +2463,852 @@ struct chunk_stat {
     };
 };
 
+//==============================================================================
+// definitions for get_load
+struct get_load {
+
+    // forward declarations of public input/output types for this RPC
+    class input;
+
+    class output;
+
+    // traits used so that the engine knows what to do with the RPC
+    using self_type = get_load;
+    using handle_type = hermes::rpc_handle<self_type>;
+    using input_type = input;
+    using output_type = output;
+    using mercury_input_type = hermes::detail::hg_void_t;
+    using mercury_output_type = rpc_load_out_t;
+
+    // RPC public identifier
+    // (N.B: we reuse the same IDs assigned by Margo so that the daemon
+    // understands Hermes RPCs)
+    constexpr static const uint64_t public_id = 1520238592;
+
+    // RPC internal Mercury identifier
+    constexpr static const hg_id_t mercury_id = public_id;
+
+    // RPC name
+    constexpr static const auto name = gkfs::rpc::tag::get_load;
+
+    // requires response?
+    constexpr static const auto requires_response = true;
+
+    // Mercury callback to serialize input arguments
+    constexpr static const auto mercury_in_proc_cb =
+            hermes::detail::hg_proc_void_t;
+
+    // Mercury callback to serialize output arguments
+    constexpr static const auto mercury_out_proc_cb =
+            HG_GEN_PROC_NAME(rpc_load_out_t);
+
+    class input {
+
+        template<typename ExecutionContext>
+        friend hg_return_t hermes::detail::post_to_mercury(ExecutionContext*);
+
+    public:
+        input() {}
+
+        input(input&& rhs) = default;
+
+        input(const input& other) = default;
+
+        input& operator=(input&& rhs) = default;
+
+        input& operator=(const input& other) = default;
+
+        explicit
+        input(const hermes::detail::hg_void_t& other) {}
+
+        explicit
+        operator hermes::detail::hg_void_t() {
+            return {};
+        }
+    };
+
+    class output {
+
+        template<typename ExecutionContext>
+        friend hg_return_t hermes::detail::post_to_mercury(ExecutionContext*);
+
+    public:
+        output() :
+                m_io_queue_depth(),
+                m_bytes_in_flight(),
+                m_agios_backlog() {}
+
+        output(uint64_t io_queue_depth, uint64_t bytes_in_flight, uint64_t agios_backlog) :
+                m_io_queue_depth(io_queue_depth),
+                m_bytes_in_flight(bytes_in_flight),
+                m_agios_backlog(agios_backlog) {}
+
+        output(output&& rhs) = default;
+
+        output(const output& other) = default;
+
+        output& operator=(output&& rhs) = default;
+
+        output& operator=(const output& other) = default;
+
+        explicit
+        output(const rpc_load_out_t& out) {
+            m_io_queue_depth = out.io_queue_depth;
+            m_bytes_in_flight = out.bytes_in_flight;
+            m_agios_backlog = out.agios_backlog;
+        }
+
+        uint64_t
+        io_queue_depth() const {
+            return m_io_queue_depth;
+        }
+
+        uint64_t
+        bytes_in_flight() const {
+            return m_bytes_in_flight;
+        }
+
+        uint64_t
+        agios_backlog() const {
+            return m_agios_backlog;
+        }
+
+    private:
+        uint64_t m_io_queue_depth;
+        uint64_t m_bytes_in_flight;
+        uint64_t m_agios_backlog;
+    };
+};
+
+//==============================================================================
+// definitions for write_inline
+struct write_inline {
+
+    // forward declarations of public input/output types for this RPC
+    class input;
+
+    class output;
+
+    // traits used so that the engine knows what to do with the RPC
+    using self_type = write_inline;
+    using handle_type = hermes::rpc_handle<self_type>;
+    using input_type = input;
+    using output_type = output;
+    using mercury_input_type = rpc_inline_data_in_t;
+    using mercury_output_type = rpc_inline_data_out_t;
+
+    // RPC public identifier
+    // (N.B: we reuse the same IDs assigned by Margo so that the daemon
+    // understands Hermes RPCs)
+    constexpr static const uint64_t public_id = 1609891840;
+
+    // RPC internal Mercury identifier
+    constexpr static const hg_id_t mercury_id = public_id;
+
+    // RPC name
+    constexpr static const auto name = gkfs::rpc::tag::write_inline;
+
+    // requires response?
+    constexpr static const auto requires_response = true;
+
+    // Mercury callback to serialize input arguments
+    constexpr static const auto mercury_in_proc_cb =
+            HG_GEN_PROC_NAME(rpc_inline_data_in_t);
+
+    // Mercury callback to serialize output arguments
+    constexpr static const auto mercury_out_proc_cb =
+            HG_GEN_PROC_NAME(rpc_inline_data_out_t);
+
+    class input {
+
+        template<typename ExecutionContext>
+        friend hg_return_t hermes::detail::post_to_mercury(ExecutionContext*);
+
+    public:
+        input(const std::string& path,
+              int64_t offset,
+              uint64_t size,
+              bool append,
+              const hermes::exposed_memory& buffers) :
+                m_path(path),
+                m_offset(offset),
+                m_size(size),
+                m_append(append),
+                m_buffers(buffers) {}
+
+        input(input&& rhs) = default;
+
+        input(const input& other) = default;
+
+        input& operator=(input&& rhs) = default;
+
+        input& operator=(const input& other) = default;
+
+        std::string
+        path() const {
+            return m_path;
+        }
+
+        int64_t
+        offset() const {
+            return m_offset;
+        }
+
+        uint64_t
+        size() const {
+            return m_size;
+        }
+
+        bool
+        append() const {
+            return m_append;
+        }
+
+        hermes::exposed_memory
+        buffers() const {
+            return m_buffers;
+        }
+
+        explicit
+        input(const rpc_inline_data_in_t& other) :
+                m_path(other.path),
+                m_offset(other.offset),
+                m_size(other.size),
+                m_append(other.append),
+                m_buffers(other.bulk_handle) {}
+
+        explicit
+        operator rpc_inline_data_in_t() {
+            return {
+                    m_path.c_str(),
+                    m_offset,
+                    m_size,
+                    m_append,
+                    hg_bulk_t(m_buffers)
+            };
+        }
+
+    private:
+        std::string m_path;
+        int64_t m_offset;
+        uint64_t m_size;
+        bool m_append;
+        hermes::exposed_memory m_buffers;
+    };
+
+    class output {
+
+        template<typename ExecutionContext>
+        friend hg_return_t hermes::detail::post_to_mercury(ExecutionContext*);
+
+    public:
+        output() :
+                m_err(),
+                m_stored_inline(),
+                m_offset(),
+                m_io_size(),
+                m_file_size() {}
+
+        output(int32_t err, bool stored_inline, int64_t offset, uint64_t io_size, uint64_t file_size) :
+                m_err(err),
+                m_stored_inline(stored_inline),
+                m_offset(offset),
+                m_io_size(io_size),
+                m_file_size(file_size) {}
+
+        output(output&& rhs) = default;
+
+        output(const output& other) = default;
+
+        output& operator=(output&& rhs) = default;
+
+        output& operator=(const output& other) = default;
+
+        explicit
+        output(const rpc_inline_data_out_t& out) {
+            m_err = out.err;
+            m_stored_inline = out.stored_inline;
+            m_offset = out.offset;
+            m_io_size = out.io_size;
+            m_file_size = out.file_size;
+        }
+
+        int32_t
+        err() const {
+            return m_err;
+        }
+
+        bool
+        stored_inline() const {
+            return m_stored_inline;
+        }
+
+        int64_t
+        offset() const {
+            return m_offset;
+        }
+
+        uint64_t
+        io_size() const {
+            return m_io_size;
+        }
+
+        uint64_t
+        file_size() const {
+            return m_file_size;
+        }
+
+    private:
+        int32_t m_err;
+        bool m_stored_inline;
+        int64_t m_offset;
+        uint64_t m_io_size;
+        uint64_t m_file_size;
+    };
+};
+
+//==============================================================================
+// definitions for read_inline
+struct read_inline {
+
+    // forward declarations of public input/output types for this RPC
+    class input;
+
+    class output;
+
+    // traits used so that the engine knows what to do with the RPC
+    using self_type = read_inline;
+    using handle_type = hermes::rpc_handle<self_type>;
+    using input_type = input;
+    using output_type = output;
+    using mercury_input_type = rpc_inline_data_in_t;
+    using mercury_output_type = rpc_inline_data_out_t;
+
+    // RPC public identifier
+    // (N.B: we reuse the same IDs assigned by Margo so that the daemon
+    // understands Hermes RPCs)
+    constexpr static const uint64_t public_id = 1917386752;
+
+    // RPC internal Mercury identifier
+    constexpr static const hg_id_t mercury_id = public_id;
+
+    // RPC name
+    constexpr static const auto name = gkfs::rpc::tag::read_inline;
+
+    // requires response?
+    constexpr static const auto requires_response = true;
+
+    // Mercury callback to serialize input arguments
+    constexpr static const auto mercury_in_proc_cb =
+            HG_GEN_PROC_NAME(rpc_inline_data_in_t);
+
+    // Mercury callback to serialize output arguments
+    constexpr static const auto mercury_out_proc_cb =
+            HG_GEN_PROC_NAME(rpc_inline_data_out_t);
+
+    class input {
+
+        template<typename ExecutionContext>
+        friend hg_return_t hermes::detail::post_to_mercury(ExecutionContext*);
+
+    public:
+        input(const std::string& path,
+              int64_t offset,
+              uint64_t size,
+              bool append,
+              const hermes::exposed_memory& buffers) :
+                m_path(path),
+                m_offset(offset),
+                m_size(size),
+                m_append(append),
+                m_buffers(buffers) {}
+
+        input(input&& rhs) = default;
+
+        input(const input& other) = default;
+
+        input& operator=(input&& rhs) = default;
+
+        input& operator=(const input& other) = default;
+
+        std::string
+        path() const {
+            return m_path;
+        }
+
+        int64_t
+        offset() const {
+            return m_offset;
+        }
+
+        uint64_t
+        size() const {
+            return m_size;
+        }
+
+        bool
+        append() const {
+            return m_append;
+        }
+
+        hermes::exposed_memory
+        buffers() const {
+            return m_buffers;
+        }
+
+        explicit
+        input(const rpc_inline_data_in_t& other) :
+                m_path(other.path),
+                m_offset(other.offset),
+                m_size(other.size),
+                m_append(other.append),
+                m_buffers(other.bulk_handle) {}
+
+        explicit
+        operator rpc_inline_data_in_t() {
+            return {
+                    m_path.c_str(),
+                    m_offset,
+                    m_size,
+                    m_append,
+                    hg_bulk_t(m_buffers)
+            };
+        }
+
+    private:
+        std::string m_path;
+        int64_t m_offset;
+        uint64_t m_size;
+        bool m_append;
+        hermes::exposed_memory m_buffers;
+    };
+
+    class output {
+
+        template<typename ExecutionContext>
+        friend hg_return_t hermes::detail::post_to_mercury(ExecutionContext*);
+
+    public:
+        output() :
+                m_err(),
+                m_stored_inline(),
+                m_offset(),
+                m_io_size(),
+                m_file_size() {}
+
+        output(int32_t err, bool stored_inline, int64_t offset, uint64_t io_size, uint64_t file_size) :
+                m_err(err),
+                m_stored_inline(stored_inline),
+                m_offset(offset),
+                m_io_size(io_size),
+                m_file_size(file_size) {}
+
+        output(output&& rhs) = default;
+
+        output(const output& other) = default;
+
+        output& operator=(output&& rhs) = default;
+
+        output& operator=(const output& other) = default;
+
+        explicit
+        output(const rpc_inline_data_out_t& out) {
+            m_err = out.err;
+            m_stored_inline = out.stored_inline;
+            m_offset = out.offset;
+            m_io_size = out.io_size;
+            m_file_size = out.file_size;
+        }
+
+        int32_t
+        err() const {
+            return m_err;
+        }
+
+        bool
+        stored_inline() const {
+            return m_stored_inline;
+        }
+
+        int64_t
+        offset() const {
+            return m_offset;
+        }
+
+        uint64_t
+        io_size() const {
+            return m_io_size;
+        }
+
+        uint64_t
+        file_size() const {
+            return m_file_size;
+        }
+
+    private:
+        int32_t m_err;
+        bool m_stored_inline;
+        int64_t m_offset;
+        uint64_t m_io_size;
+        uint64_t m_file_size;
+    };
+};
+
+//==============================================================================
+// definitions for promote_inline
+struct promote_inline {
+
+    // forward declarations of public input/output types for this RPC
+    class input;
+
+    class output;
+
+    // traits used so that the engine knows what to do with the RPC
+    using self_type = promote_inline;
+    using handle_type = hermes::rpc_handle<self_type>;
+    using input_type = input;
+    using output_type = output;
+    using mercury_input_type = rpc_path_only_in_t;
+    using mercury_output_type = rpc_inline_data_out_t;
+
+    // RPC public identifier
+    // (N.B: we reuse the same IDs assigned by Margo so that the daemon
+    // understands Hermes RPCs)
+    constexpr static const uint64_t public_id = 1329594368;
+
+    // RPC internal Mercury identifier
+    constexpr static const hg_id_t mercury_id = public_id;
+
+    // RPC name
+    constexpr static const auto name = gkfs::rpc::tag::promote_inline;
+
+    // requires response?
+    constexpr static const auto requires_response = true;
+
+    // Mercury callback to serialize input arguments
+    constexpr static const auto mercury_in_proc_cb =
+            HG_GEN_PROC_NAME(rpc_path_only_in_t);
+
+    // Mercury callback to serialize output arguments
+    constexpr static const auto mercury_out_proc_cb =
+            HG_GEN_PROC_NAME(rpc_inline_data_out_t);
+
+    class input {
+
+        template<typename ExecutionContext>
+        friend hg_return_t hermes::detail::post_to_mercury(ExecutionContext*);
+
+    public:
+        input(const std::string& path) :
+                m_path(path) {}
+
+        input(input&& rhs) = default;
+
+        input(const input& other) = default;
+
+        input& operator=(input&& rhs) = default;
+
+        input& operator=(const input& other) = default;
+
+        std::string
+        path() const {
+            return m_path;
+        }
+
+        explicit
+        input(const rpc_path_only_in_t& other) :
+                m_path(other.path) {}
+
+        explicit
+        operator rpc_path_only_in_t() {
+            return {m_path.c_str()};
+        }
+
+    private:
+        std::string m_path;
+    };
+
+    class output {
+
+        template<typename ExecutionContext>
+        friend hg_return_t hermes::detail::post_to_mercury(ExecutionContext*);
+
+    public:
+        output() :
+                m_err(),
+                m_stored_inline(),
+                m_offset(),
+                m_io_size(),
+                m_file_size() {}
+
+        output(int32_t err, bool stored_inline, int64_t offset, uint64_t io_size, uint64_t file_size) :
+                m_err(err),
+                m_stored_inline(stored_inline),
+                m_offset(offset),
+                m_io_size(io_size),
+                m_file_size(file_size) {}
+
+        output(output&& rhs) = default;
+
+        output(const output& other) = default;
+
+        output& operator=(output&& rhs) = default;
+
+        output& operator=(const output& other) = default;
+
+        explicit
+        output(const rpc_inline_data_out_t& out) {
+            m_err = out.err;
+            m_stored_inline = out.stored_inline;
+            m_offset = out.offset;
+            m_io_size = out.io_size;
+            m_file_size = out.file_size;
+        }
+
+        int32_t
+        err() const {
+            return m_err;
+        }
+
+        bool
+        stored_inline() const {
+            return m_stored_inline;
+        }
+
+        int64_t
+        offset() const {
+            return m_offset;
+        }
+
+        uint64_t
+        io_size() const {
+            return m_io_size;
+        }
+
+        uint64_t
+        file_size() const {
+            return m_file_size;
+        }
+
+    private:
+        int32_t m_err;
+        bool m_stored_inline;
+        int64_t m_offset;
+        uint64_t m_io_size;
+        uint64_t m_file_size;
+    };
+};
+
+//==============================================================================
+// definitions for seek_data
+struct seek_data {
+
+    // forward declarations of public input/output types for this RPC
+    class input;
+
+    class output;
+
+    // traits used so that the engine knows what to do with the RPC
+    using self_type = seek_data;
+    using handle_type = hermes::rpc_handle<self_type>;
+    using input_type = input;
+    using output_type = output;
+    using mercury_input_type = rpc_seek_data_in_t;
+    using mercury_output_type = rpc_seek_data_out_t;
+
+    // RPC public identifier
+    // (N.B: we reuse the same IDs assigned by Margo so that the daemon
+    // understands Hermes RPCs)
+    constexpr static const uint64_t public_id = 437518336;
+
+    // RPC internal Mercury identifier
+    constexpr static const hg_id_t mercury_id = public_id;
+
+    // RPC name
+    constexpr static const auto name = gkfs::rpc::tag::seek_data;
+
+    // requires response?
+    constexpr static const auto requires_response = true;
+
+    // Mercury callback to serialize input arguments
+    constexpr static const auto mercury_in_proc_cb =
+            HG_GEN_PROC_NAME(rpc_seek_data_in_t);
+
+    // Mercury callback to serialize output arguments
+    constexpr static const auto mercury_out_proc_cb =
+            HG_GEN_PROC_NAME(rpc_seek_data_out_t);
+
+    class input {
+
+        template<typename ExecutionContext>
+        friend hg_return_t hermes::detail::post_to_mercury(ExecutionContext*);
+
+    public:
+        input(const std::string& path,
+              int64_t offset,
+              int32_t whence,
+              uint64_t host_id,
+              uint64_t host_size,
+              uint64_t chunk_size,
+              uint32_t stripe_width,
+              uint64_t chunk_start,
+              uint64_t chunk_end,
+              bool all_chunks) :
+                m_path(path),
+                m_offset(offset),
+                m_whence(whence),
+                m_host_id(host_id),
+                m_host_size(host_size),
+                m_chunk_size(chunk_size),
+                m_stripe_width(stripe_width),
+                m_chunk_start(chunk_start),
+                m_chunk_end(chunk_end),
+                m_all_chunks(all_chunks) {}
+
+        input(input&& rhs) = default;
+
+        input(const input& other) = default;
+
+        input& operator=(input&& rhs) = default;
+
+        input& operator=(const input& other) = default;
+
+        std::string
+        path() const {
+            return m_path;
+        }
+
+        int64_t
+        offset() const {
+            return m_offset;
+        }
+
+        int32_t
+        whence() const {
+            return m_whence;
+        }
+
+        uint64_t
+        host_id() const {
+            return m_host_id;
+        }
+
+        uint64_t
+        host_size() const {
+            return m_host_size;
+        }
+
+        uint64_t
+        chunk_size() const {
+            return m_chunk_size;
+        }
+
+        uint32_t
+        stripe_width() const {
+            return m_stripe_width;
+        }
+
+        uint64_t
+        chunk_start() const {
+            return m_chunk_start;
+        }
+
+        uint64_t
+        chunk_end() const {
+            return m_chunk_end;
+        }
+
+        bool
+        all_chunks() const {
+            return m_all_chunks;
+        }
+
+        explicit
+        input(const rpc_seek_data_in_t& other) :
+                m_path(other.path),
+                m_offset(other.offset),
+                m_whence(other.whence),
+                m_host_id(other.host_id),
+                m_host_size(other.host_size),
+                m_chunk_size(other.chunk_size),
+                m_stripe_width(other.stripe_width),
+                m_chunk_start(other.chunk_start),
+                m_chunk_end(other.chunk_end),
+                m_all_chunks(other.all_chunks) {}
+
+        explicit
+        operator rpc_seek_data_in_t() {
+            return {
+                    m_path.c_str(),
+                    m_offset,
+                    m_whence,
+                    m_host_id,
+                    m_host_size,
+                    m_chunk_size,
+                    m_stripe_width,
+                    m_chunk_start,
+                    m_chunk_end,
+                    m_all_chunks
+            };
+        }
+
+    private:
+        std::string m_path;
+        int64_t m_offset;
+        int32_t m_whence;
+        uint64_t m_host_id;
+        uint64_t m_host_size;
+        uint64_t m_chunk_size;
+        uint32_t m_stripe_width;
+        uint64_t m_chunk_start;
+        uint64_t m_chunk_end;
+        bool m_all_chunks;
+    };
+
+    class output {
+
+        template<typename ExecutionContext>
+        friend hg_return_t hermes::detail::post_to_mercury(ExecutionContext*);
+
+    public:
+        output() :
+                m_err(),
+                m_offset() {}
+
+        output(int32_t err, int64_t offset) :
+                m_err(err),
+                m_offset(offset) {}
+
+        output(output&& rhs) = default;
+
+        output(const output& other) = default;
+
+        output& operator=(output&& rhs) = default;
+
+        output& operator=(const output& other) = default;
+
+        explicit
+        output(const rpc_seek_data_out_t& out) {
+            m_err = out.err;
+            m_offset = out.offset;
+        }
+
+        int32_t
+        err() const {
+            return m_err;
+        }
+
+        int64_t
+        offset() const {
+            return m_offset;
+        }
+
+    private:
+        int32_t m_err;
+        int64_t m_offset;
+    };
+};
+
 } // namespace rpc
 } // namespace gkfs
 
@@ -0,0 +1,313 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#ifndef GEKKOFS_CLIENT_RPC_WAIT_HPP
+#define GEKKOFS_CLIENT_RPC_WAIT_HPP
+
+#include <global/histogram.hpp>
+
+#include <hermes.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace gkfs {
+namespace rpc {
+
+/**
+ * A daemon did not answer within the RPC deadline, including all retries
+ */
+class rpc_timeout_error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * How a request may be repeated when its daemon is slow
+ */
+enum class RpcRetry {
+    // never sent twice, e.g., requests that modify files. A late copy could undo what followed it
+    none,
+    // re-sent after a timeout, e.g., requests that only read
+    idempotent,
+    // re-sent after a timeout and duplicated after the daemon's p99 latency, e.g., reads and stats
+    hedged
+};
+
+void init_rpc_wait(unsigned int hosts_size);
+
+std::chrono::milliseconds rpc_timeout();
+
+unsigned int rpc_retries();
+
+bool rpc_hedging();
+
+/**
+ * Whether requests with the given retry policy are awaited with a deadline. A copy of such a request may still run
+ * after get() has returned
+ * @param retry
+ * @return
+ */
+bool waits_with_deadline(RpcRetry retry);
+
+gkfs::util::LatencyHistogram& host_latency(unsigned int host);
+
+std::chrono::microseconds hedge_delay(unsigned int host);
+
+void log_host_latencies();
+
+namespace detail {
+
+/**
+ * Output of the first of possibly several copies of a request to answer
+ */
+template <typename Output>
+struct RpcCompletion {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+    std::unique_ptr<Output> output;
+    std::exception_ptr error;
+
+    void set_output(Output&& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!done) {
+            output = std::make_unique<Output>(std::move(out));
+            done = true;
+            cv.notify_all();
+        }
+    }
+
+    void set_error(std::exception_ptr e) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!done) {
+            error = e;
+            done = true;
+            cv.notify_all();
+        }
+    }
+};
+
+/**
+ * Reserves one of the threads that wait for the copies of requests with a deadline. The threads are shared by all
+ * requests and reused, a new one is only started while all of them are busy. A copy sent to a daemon that is gone
+ * keeps its thread forever, so there are at most gkfs::config::rpc::max_waiters of them
+ * @param until how long to wait for a thread if all of them are busy
+ * @return false if no thread became free in time
+ */
+bool reserve_waiter(std::chrono::steady_clock::time_point until);
+
+// returns a reserved thread that was not used
+void release_waiter();
+
+/**
+ * Runs wait on a thread reserved with reserve_waiter()
+ * @param wait must not throw
+ */
+void wait_in_background(std::function<void()> wait);
+
+} // namespace detail
+
+/**
+ * A request posted to a daemon whose output is awaited with the client's RPC deadline. The request is posted on
+ * construction. Without a timeout and hedging, get() simply blocks on the hermes handle. Otherwise each copy of the
+ * request is awaited by a shared waiter thread so that get() can give up on it. Requests fail with rpc_timeout_error
+if all waiter threads stay busy until their deadline. Copies that answer late are
+ * discarded. Such a copy may still transfer data after get() has returned, so it keeps the memory it transfers
+ * (see TransferBuffer) alive until it has finished.
+ */
+template <typename Request>
+class OutstandingRpc {
+public:
+    using handle_type = typename Request::handle_type;
+    using output_type = typename Request::output_type;
+    using post_type = std::function<handle_type()>;
+    using clock = std::chrono::steady_clock;
+
+private:
+    unsigned int host_;
+    post_type post_;
+    RpcRetry retry_;
+    // memory the transfers of the request use, kept alive by every copy
+    std::shared_ptr<void> transfer_;
+    // where a duplicate of a slow request goes, host_ unless hedge_to() is called
+    unsigned int hedge_host_;
+    post_type hedge_post_;
+    clock::time_point posted_;
+    // only set when the output is awaited synchronously
+    std::unique_ptr<handle_type> handle_;
+    std::shared_ptr<detail::RpcCompletion<output_type>> completion_;
+
+    /**
+     * Posts a copy of the request to host
+     * @return false if no waiter thread became free until the given time. Nothing is posted then
+     */
+    bool send(unsigned int host, const post_type& post, clock::time_point until) {
+        // reserved before posting, a posted copy may not be left without a waiter
+        if (!detail::reserve_waiter(until)) {
+            return false;
+        }
+        auto posted = clock::now();
+        std::shared_ptr<handle_type> handle;
+        try {
+            handle = std::make_shared<handle_type>(post());
+        } catch (...) {
+            detail::release_waiter();
+            throw;
+        }
+        auto completion = completion_;
+        auto transfer = transfer_;
+        detail::wait_in_background([handle, completion, transfer, host, posted]() {
+            try {
+                auto out = handle->get().at(0);
+                host_latency(host).record(static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - posted).count()));
+                completion->set_output(std::move(out));
+            } catch (...) {
+                completion->set_error(std::current_exception());
+            }
+        });
+        return true;
+    }
+
+    [[noreturn]] void throw_no_waiter(unsigned int attempts) const {
+        throw rpc_timeout_error("too many requests are waiting for daemons, daemon " + std::to_string(host_) +
+                                " not asked after " + std::to_string(attempts) + " attempt(s)");
+    }
+
+public:
+    OutstandingRpc(unsigned int host, post_type post, RpcRetry retry = RpcRetry::none,
+                   std::shared_ptr<void> transfer = nullptr) :
+            host_(host), post_(std::move(post)), retry_(retry), transfer_(std::move(transfer)), hedge_host_(host),
+            posted_(clock::now()) {
+        if (waits_with_deadline(retry_)) {
+            completion_ = std::make_shared<detail::RpcCompletion<output_type>>();
+            auto timeout = rpc_timeout();
+            if (send(host_, post_, posted_ + timeout)) {
+                return;
+            }
+            if (timeout.count() > 0) {
+                throw_no_waiter(0);
+            }
+            // without a deadline, a request that cannot be hedged is simply awaited
+            completion_.reset();
+            handle_ = std::make_unique<handle_type>(post_());
+        } else {
+            handle_ = std::make_unique<handle_type>(post_());
+        }
+    }
+
+    OutstandingRpc(OutstandingRpc&&) = default;
+
+    OutstandingRpc& operator=(OutstandingRpc&&) = default;
+
+    unsigned int host() const {
+        return host_;
+    }
+
+    /**
+     * Sends the duplicate of a slow request to another host that can serve it, e.g., another forwarder in front of
+     * the same storage
+     * @param host
+     * @param post posts one copy of the request to host
+     */
+    void hedge_to(unsigned int host, post_type post) {
+        hedge_host_ = host;
+        hedge_post_ = std::move(post);
+    }
+
+    /**
+     * Waits for the output of the request
+     * @return
+     * @throws rpc_timeout_error if the daemon did not answer in time, or any error of hermes
+     */
+    output_type get() {
+        if (handle_) {
+            auto out = handle_->get().at(0);
+            host_latency(host_).record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - posted_).count()));
+            return out;
+        }
+        auto timeout = rpc_timeout();
+        auto attempt_start = posted_;
+        unsigned int retries = 0;
+        bool hedged = (retry_ != RpcRetry::hedged) || !rpc_hedging();
+        auto is_done = [this]() { return completion_->done; };
+
+        std::unique_lock<std::mutex> lock(completion_->mutex);
+        while (!completion_->done) {
+            if (!hedged) {
+                hedged = true;
+                auto delay = hedge_delay(host_);
+                // a hedge after the deadline would be a retry
+                if (timeout.count() > 0 && delay >= timeout) {
+                    continue;
+                }
+                if (delay.count() > 0 && !completion_->cv.wait_until(lock, posted_ + delay, is_done)) {
+                    lock.unlock();
+                    // skipped if no waiter is free right away
+                    send(hedge_host_, hedge_post_ ? hedge_post_ : post_, clock::now());
+                    lock.lock();
+                }
+                continue;
+            }
+            if (timeout.count() == 0) {
+                completion_->cv.wait(lock, is_done);
+                break;
+            }
+            if (completion_->cv.wait_until(lock, attempt_start + timeout, is_done)) {
+                break;
+            }
+            if (retry_ == RpcRetry::none || retries >= rpc_retries()) {
+                throw rpc_timeout_error("no response from daemon " + std::to_string(host_) + " after " +
+                                        std::to_string(retries + 1) + " attempt(s)");
+            }
+            retries++;
+            lock.unlock();
+            attempt_start = clock::now();
+            if (!send(host_, post_, attempt_start + timeout)) {
+                throw_no_waiter(retries);
+            }
+            lock.lock();
+        }
+        if (completion_->error) {
+            std::rethrow_exception(completion_->error);
+        }
+        return *completion_->output;
+    }
+};
+
+/**
+ * Posts a request and waits for its output
+ * @param host
+ * @param post posts one copy of the request to host
+ * @param retry
+ * @param transfer memory the transfers of the request use, see TransferBuffer
+ * @return
+ */
+template <typename Request>
+typename Request::output_type
+forward_and_wait(unsigned int host, typename OutstandingRpc<Request>::post_type post,
+                 RpcRetry retry = RpcRetry::none, std::shared_ptr<void> transfer = nullptr) {
+    return OutstandingRpc<Request>(host, std::move(post), retry, std::move(transfer)).get();
+}
+
+} // namespace rpc
+} // namespace gkfs
+
+#endif //GEKKOFS_CLIENT_RPC_WAIT_HPP
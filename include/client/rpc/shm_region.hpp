@@ -0,0 +1,117 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#ifndef GEKKOFS_CLIENT_SHM_REGION_HPP
+#define GEKKOFS_CLIENT_SHM_REGION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+extern "C" {
+#include <sys/types.h>
+}
+
+namespace gkfs {
+namespace rpc {
+
+/**
+ * Memory region this process shares with the daemon on its node: a memfd that the daemon maps through
+ * /proc/<pid>/fd/<fd>. Data RPCs to that daemon carry offsets into the region instead of a buffer for bulk transfers,
+ * and the daemon reads chunks into and writes them from the region in place. The region starts with a random id
+ * that the daemon checks before it maps it.
+ */
+class ShmRegion {
+private:
+    uint64_t id_;
+    int fd_;
+    char* base_;
+    std::size_t size_;
+    pid_t pid_;
+
+public:
+    /**
+     * Creates and maps a region of size bytes, including the header
+     * @param size
+     * @throws std::system_error
+     */
+    explicit ShmRegion(std::size_t size);
+
+    ~ShmRegion();
+
+    ShmRegion(const ShmRegion&) = delete;
+
+    ShmRegion& operator=(const ShmRegion&) = delete;
+
+    uint64_t id() const;
+
+    int fd() const;
+
+    // process that created the region. A forked child creates its own
+    pid_t pid() const;
+
+    // the data behind the header
+    char* data() const;
+
+    std::size_t capacity() const;
+};
+
+/**
+ * Exclusive use of the region of this process by one data operation. Empty if the region is disabled, used by
+ * another thread or smaller than the operation
+ */
+class ShmLease {
+private:
+    std::unique_lock<std::mutex> lock_;
+    ShmRegion* region_;
+
+public:
+    ShmLease();
+
+    ShmLease(std::unique_lock<std::mutex> lock, ShmRegion* region);
+
+    ShmLease(ShmLease&&) = default;
+
+    ShmLease& operator=(ShmLease&&) = default;
+
+    explicit operator bool() const;
+
+    ShmRegion* operator->() const;
+
+    /**
+     * Drops the region so that later operations use a new one, e.g., after a request timed out whose daemon may still
+     * access it
+     */
+    void discard();
+};
+
+void init_shm_region();
+
+void destroy_shm_region();
+
+/**
+ * Whether data RPCs to the given daemon may use shared memory
+ * @param host
+ * @return
+ */
+bool shm_host(uint64_t host);
+
+ShmLease lease_shm_region(std::size_t size);
+
+// stops using shared memory, e.g., because the daemon cannot map the region
+void disable_shm_region();
+
+} // namespace rpc
+} // namespace gkfs
+
+#endif //GEKKOFS_CLIENT_SHM_REGION_HPP
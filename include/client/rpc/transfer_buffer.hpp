@@ -0,0 +1,87 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#ifndef GEKKOFS_CLIENT_TRANSFER_BUFFER_HPP
+#define GEKKOFS_CLIENT_TRANSFER_BUFFER_HPP
+
+#include <client/rpc/rpc_wait.hpp>
+
+#include <hermes.hpp>
+
+#include <cstddef>
+#include <memory>
+
+namespace gkfs {
+namespace rpc {
+
+/**
+ * Memory that the RDMA transfers of a request use. Without an RPC deadline, get() returns only once the request is
+ * done, and transfers use the caller's buffer, whose registration is cached. With a deadline, a copy of the request
+ * may still transfer after get() has returned or given up. Transfers then use memory of their own, which every copy
+ * keeps alive until it has finished, so that a late copy never touches the caller's buffer. Data to write is copied
+ * into it, read data is copied out of it with copy_out().
+ */
+class TransferBuffer {
+private:
+    struct Memory {
+        std::unique_ptr<char[]> data;
+        // released before the data
+        std::unique_ptr<hermes::exposed_memory> exposed;
+    };
+
+    char* buf_;
+    std::shared_ptr<hermes::exposed_memory> cached_;
+    std::shared_ptr<Memory> own_;
+
+public:
+    /**
+     * Transfers of requests with the given retry policy to or from buf
+     * @param buf
+     * @param size
+     * @param mode read_only for writes, write_only for reads
+     * @param retry
+     * @throws std::exception if the memory cannot be exposed
+     */
+    TransferBuffer(void* buf, std::size_t size, hermes::access_mode mode, RpcRetry retry);
+
+    /**
+     * Memory of its own, e.g., for the replies of daemons
+     * @param size
+     * @param mode
+     * @throws std::exception if the memory cannot be exposed
+     */
+    TransferBuffer(std::size_t size, hermes::access_mode mode);
+
+    const hermes::exposed_memory& exposed() const;
+
+    // the memory the transfers use
+    char* data() const;
+
+    /**
+     * What a copy of the request has to keep alive until it has finished. Empty if the caller's buffer is used
+     */
+    std::shared_ptr<void> transfer() const;
+
+    /**
+     * Copies what daemons have transferred to [pos, pos + size) into the caller's buffer. Nothing is copied if the
+     * transfers used it directly
+     * @param pos
+     * @param size
+     */
+    void copy_out(std::size_t pos, std::size_t size) const;
+};
+
+} // namespace rpc
+} // namespace gkfs
+
+#endif //GEKKOFS_CLIENT_TRANSFER_BUFFER_HPP
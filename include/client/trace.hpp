@@ -0,0 +1,139 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#ifndef GKFS_CLIENT_TRACE_HPP
+#define GKFS_CLIENT_TRACE_HPP
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <ctime>
+#endif
+
+/*
+ * Binary tracing of the intercepted system calls. Each thread appends fixed-size records to its own buffer without
+ * locking or formatting. Full buffers are appended to the trace file as a block, the remaining records at exit.
+ * scripts/decode_gkfs_trace.py turns trace files into text, Chrome trace JSON or latency histograms.
+ *
+ * File format (little endian): a sequence of blocks, each a BlockHeader followed by `count` entries. The first block
+ * holds the syscall names (SyscallName), all others records (Record) or the paths (PathHeader followed by the path,
+ * padded to 8 bytes) that records of the same thread refer to by hash. A path block precedes the first record block
+ * that refers to its paths. The (tsc, ns) pairs of the block headers convert timestamps to nanoseconds. gkfs_replay
+ * re-issues the recorded syscalls.
+ */
+namespace gkfs {
+namespace trace {
+
+constexpr uint32_t BLOCK_MAGIC = 0x42544b47; // "GKTB" on little endian
+constexpr uint16_t VERSION = 2;
+
+enum class BlockType : uint16_t {
+    names = 1,
+    records = 2,
+    paths = 3
+};
+
+struct BlockHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t type;
+    uint32_t count;
+    uint32_t pid;
+    uint32_t tid;
+    uint32_t reserved;
+    // timestamp counter and CLOCK_MONOTONIC nanoseconds when the block was written
+    uint64_t tsc;
+    uint64_t ns;
+};
+
+static_assert(sizeof(BlockHeader) == 40, "Block header is part of the trace file format");
+
+struct SyscallName {
+    uint16_t syscall;
+    char name[30];
+};
+
+static_assert(sizeof(SyscallName) == 32, "Syscall names are part of the trace file format");
+
+struct Record {
+    // timestamp counter at entry and exit of the hook
+    uint64_t start;
+    uint64_t end;
+    // FNV-1a hash of the path argument, 0 if there is none
+    uint64_t path_hash;
+    // -1 if the syscall has no offset argument
+    int64_t offset;
+    // bytes requested, 0 if the syscall does not transfer data
+    uint64_t size;
+    int64_t result;
+    // -1 if the syscall has no fd argument
+    int32_t fd;
+    uint16_t syscall;
+    uint16_t reserved;
+    // flags of open, openat and the *at syscalls, whence of lseek, 0 otherwise
+    uint32_t flags;
+    // mode of open, creat, mkdir and chmod, 0 otherwise
+    uint32_t mode;
+};
+
+static_assert(sizeof(Record) == 64, "Records are part of the trace file format");
+
+struct PathHeader {
+    uint64_t hash;
+    // without the terminating null byte and the padding
+    uint32_t length;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(PathHeader) == 16, "Paths are part of the trace file format");
+
+// bytes of a path entry in the file
+inline size_t path_entry_size(uint32_t length) {
+    return sizeof(PathHeader) + ((length + 7) & ~size_t(7));
+}
+
+extern std::atomic<bool> tracing;
+
+inline bool enabled() {
+    return tracing.load(std::memory_order_relaxed);
+}
+
+inline uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ul + ts.tv_nsec;
+#endif
+}
+
+/**
+ * Starts tracing to the file in LIBGKFS_TRACE_FILE, suffixed with the pid. Does nothing if it is not set
+ */
+void init();
+
+/**
+ * Stops tracing and writes the records of all threads to the trace file
+ */
+void finalize();
+
+void record(long syscall_number, const long args[6], long result, uint64_t start, uint64_t end);
+
+} // namespace trace
+} // namespace gkfs
+
+#endif //GKFS_CLIENT_TRACE_HPP
@@ -25,13 +25,42 @@ namespace config {
 
 constexpr auto hostfile_path = "./gkfs_hosts.txt";
 constexpr auto forwarding_file_path = "./gkfs_forwarding.map";
+// seconds between two checks of the forwarding map file for changes
+constexpr auto forwarding_map_check_interval = 10;
 
 namespace io {
 /*
- * Zero buffer before read. This is relevant if sparse files are used.
- * If buffer is not zeroed, sparse regions contain invalid data.
+ * Chunk compression in the daemon, set per daemon with --compression and --compression-level (0 uses the
+ * algorithm's default). A chunk is only stored compressed if that saves at least `compression_min_saving_percent`.
+ * Larger chunks are first probed with `compression_sample_count` LZ4 compressed samples of `compression_sample_size`
+ * bytes so that incompressible data is detected without compressing the whole chunk
  */
-constexpr auto zero_buffer_before_read = false;
+constexpr auto compression = "none";
+constexpr auto compression_level = 0;
+constexpr auto compression_min_saving_percent = 10;
+constexpr auto compression_sample_size = 4096;
+constexpr auto compression_sample_count = 4;
+/*
+ * Blocks of zeros in the data written to uncompressed chunks are punched out of the chunk files instead of being
+ * written. Zeros are detected per `zero_block_size` bytes of the chunk
+ */
+constexpr auto punch_zero_blocks = true;
+constexpr auto zero_block_size = 4096;
+/*
+ * Chunk files are opened with O_DIRECT if the daemon runs with --direct-io, bypassing the page cache. Transfers must
+ * be multiples of `direct_io_alignment`, at least the logical block size of the device. Unaligned parts of a request
+ * are merged with their blocks on disk and copied through buffers of at most `direct_io_bounce_size` bytes. Zero blocks
+ * are not punched out of chunks written with direct I/O
+ */
+constexpr auto direct_io = false;
+constexpr auto direct_io_alignment = 4096;
+constexpr auto direct_io_bounce_size = 1024 * 1024;
+/*
+ * Chunks of removed files are deleted in the background, `reclaim_batch_size` chunk files at a time with a pause of
+ * `reclaim_batch_interval_ms` between batches
+ */
+constexpr auto reclaim_batch_size = 256;
+constexpr auto reclaim_batch_interval_ms = 10;
 } // namespace io
 
 namespace log {
@@ -40,6 +69,8 @@ constexpr auto daemon_log_path = "/tmp/gkfs_daemon.log";
 
 constexpr auto client_log_level = "info,errors,critical,hermes";
 constexpr auto daemon_log_level = 4; //info
+// records per thread of the binary syscall trace (LIBGKFS_TRACE_FILE) that are written to the file at once
+constexpr auto trace_buffer_records = 4096;
 } // namespace logging
 
 namespace metadata {
@@ -49,21 +80,91 @@ constexpr auto use_ctime = false;
 constexpr auto use_mtime = false;
 constexpr auto use_link_cnt = false;
 constexpr auto use_blocks = false;
+/*
+ * Files of up to this many bytes keep their content in their metadentry instead of chunks until they grow larger.
+ * Set per daemon with --inline-data-size. 0 disables inline data
+ */
+constexpr auto inline_data_size = 0;
+// extended attribute that gets and sets the layout of a directory, e.g., "chunk_size=4M,stripe_width=8"
+constexpr auto layout_xattr = "user.gkfs.layout";
 } // namespace metadata
 
 namespace rpc {
 constexpr auto chunksize = 524288; // in bytes (e.g., 524288 == 512KB)
+/*
+ * Bounds of the chunk size that a directory layout may set for the files created in it, see
+ * gkfs::metadata::Layout. Chunk sizes are powers of two. Files without a layout use `chunksize`
+ */
+constexpr auto min_chunksize = 4096;
+constexpr auto max_chunksize = 64 * 1024 * 1024;
 //size of preallocated buffer to hold directory entries in rpc call
 constexpr auto dirents_buff_size = (8 * 1024 * 1024); // 8 mega
 /*
  * Indicates the number of concurrent progress to drive I/O operations of chunk files to and from local file systems
- * The value is directly mapped to created Argobots xstreams, controlled in a single pool with ABT_snoozer scheduler
+ * The value is directly mapped to created Argobots xstreams. Set per daemon with --io-xstreams
  */
 constexpr auto daemon_io_xstreams = 8;
-// Number of threads used for RPC handlers at the daemon
+/*
+ * Pools the I/O xstreams take chunk tasks from: "shared" (a single pool), "numa" (one per NUMA node) or "xstream"
+ * (one per xstream). Set per daemon with --io-pools
+ */
+constexpr auto daemon_io_pools = "shared";
+// microseconds an idle I/O xstream waits on its own pool before it tries to steal tasks from the other pools again
+constexpr auto daemon_io_steal_interval_us = 1000;
+// Number of threads used for data RPC handlers at the daemon. Set per daemon with --handler-xstreams
 constexpr auto daemon_handler_xstreams = 8;
+/*
+ * Number of threads used for metadata RPC handlers so that they do not queue behind data RPCs blocked on bulk
+ * transfers. 0 runs them on the data handler threads. Set per daemon with --metadata-handler-xstreams
+ */
+constexpr auto daemon_metadata_handler_xstreams = 4;
+// nice value of the metadata handler threads, e.g., negative to prioritize them. Needs CAP_SYS_NICE if negative
+constexpr auto daemon_metadata_handler_nice = 0;
+/*
+ * Client RPC deadlines. A timeout of 0 waits forever. Requests that only read (reads, stats, directory listings)
+ * are re-sent up to `retries` times after a timeout. Others, e.g., writes and truncations, fail with ETIMEDOUT, as a
+ * copy that was given up on cannot be cancelled and could still modify the file after a later request
+ */
+constexpr auto timeout_ms = 0;
+constexpr auto retries = 2;
+/*
+ * threads waiting for requests with a deadline. A request sent to a daemon that is gone keeps its thread. Requests
+ * wait for a free one until their deadline and then fail with ETIMEDOUT
+ */
+constexpr unsigned int max_waiters = 256;
+/*
+ * Hedged reads and stats: if a request to a daemon takes longer than that daemon's p99 latency, a duplicate is sent
+ * and the first answer is taken. Only used once `hedge_min_samples` latencies of that daemon were recorded
+ */
+constexpr auto hedge_percentile = 0.99;
+constexpr auto hedge_min_samples = 100;
+// bytes of user buffers the client keeps registered for RDMA between I/O calls. 0 registers every buffer per call
+constexpr auto registration_cache_size = 64 * 1024 * 1024;
+/*
+ * milliseconds a client answers statfs() from the chunk statistics it last collected from all daemons. Older
+ * statistics are still returned but refreshed in the background. 0 asks all daemons on every call
+ */
+constexpr auto chunk_stat_interval_ms = 1000;
+/*
+ * Bytes of the memory region a client process shares with the daemon on its node. Data RPCs to that daemon pass
+ * offsets into it instead of buffers for bulk transfers. Requests larger than the region use bulk transfers. 0
+ * disables it. Set per client with LIBGKFS_SHM_SIZE
+ */
+constexpr auto shm_region_size = 16 * 1024 * 1024;
+// bytes of client regions a daemon keeps mapped. Those of exited processes are dropped whenever a region is mapped
+constexpr auto daemon_max_shm_size = 1024UL * 1024 * 1024;
 } // namespace rpc
 
+namespace distributor {
+/*
+ * Locality distributor: new files are only placed on the local daemon while more than this percentage of its
+ * chunk space is free. Otherwise their chunks are hashed across all daemons.
+ */
+constexpr auto locality_min_free_percent = 10;
+// seconds a client reuses the free space reported by its local daemon before asking again
+constexpr auto locality_stat_interval = 5;
+} // namespace distributor
+
 namespace rocksdb {
 // Write-ahead logging of rocksdb
 constexpr auto use_write_ahead_log = false;
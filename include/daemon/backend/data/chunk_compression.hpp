@@ -0,0 +1,87 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#ifndef GEKKOFS_CHUNK_COMPRESSION_HPP
+#define GEKKOFS_CHUNK_COMPRESSION_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace gkfs {
+namespace data {
+
+enum class CompressionType : uint8_t {
+    none = 0,
+    lz4 = 1,
+    zstd = 2,
+    snappy = 3
+};
+
+CompressionType compression_type_from_string(const std::string& name);
+
+std::string to_string(CompressionType type);
+
+/*
+ * Header in front of every chunk file if compression is enabled. `type` tells how the payload is encoded:
+ * chunks that do not compress well are stored with type none, i.e., raw.
+ */
+struct ChunkHeader {
+    static constexpr uint32_t MAGIC = 0x43534b47; // "GKSC" on little endian
+
+    uint32_t magic;
+    uint8_t type;
+    uint8_t reserved[3];
+    // bytes of chunk data after decompression
+    uint32_t data_size;
+    // bytes of payload following the header
+    uint32_t stored_size;
+};
+
+static_assert(sizeof(ChunkHeader) == 16, "Chunk header is part of the on-disk format");
+
+/**
+ * Compresses and decompresses whole chunks with the algorithm and level chosen for the deployment
+ */
+class ChunkCompressor {
+private:
+    CompressionType type_;
+    int level_;
+
+    bool sample_compressible(const char* data, size_t size) const;
+
+public:
+    ChunkCompressor(CompressionType type, int level);
+
+    CompressionType type() const;
+
+    int level() const;
+
+    /**
+     * Compresses `size` bytes. Returns false if the data does not compress well, in which case it should be stored
+     * raw and `out` is undefined.
+     */
+    bool compress(const char* data, size_t size, std::vector<char>& out) const;
+
+    /**
+     * Decompresses a payload written with `type` into exactly `out_size` bytes. Throws std::runtime_error if the
+     * payload is corrupt.
+     */
+    static void decompress(CompressionType type, const char* in, size_t in_size, char* out, size_t out_size);
+};
+
+} // namespace data
+} // namespace gkfs
+
+#endif //GEKKOFS_CHUNK_COMPRESSION_HPP
@@ -0,0 +1,91 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#ifndef GEKKOFS_CHUNK_RECLAIMER_HPP
+#define GEKKOFS_CHUNK_RECLAIMER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+/* Forward declarations */
+namespace spdlog {
+    class logger;
+}
+
+namespace gkfs {
+namespace data {
+
+class ChunkStorage;
+
+/**
+ * Deletes the chunks of removed files in the background. Removing a file only moves its chunk directory into the
+ * reclaim directory, which is a single rename. A thread then unlinks the chunk files of the queued directories in
+ * batches with a pause in between so that reclamation does not compete with the I/O of the daemon. Directories left
+ * over from a previous run are reclaimed as well.
+ */
+class ChunkReclaimer {
+private:
+    static constexpr const char* LOGGER_NAME = "ChunkReclaimer";
+
+    std::shared_ptr<spdlog::logger> log;
+
+    std::shared_ptr<ChunkStorage> storage_;
+    std::string reclaim_path_;
+    size_t batch_size_;
+    std::chrono::milliseconds batch_interval_;
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<std::string> queue_;
+    std::mt19937_64 rng_;
+    bool shutdown_{false};
+    std::thread worker_;
+
+    void run();
+
+    bool reclaim_batch(const std::string& dir);
+
+public:
+    ChunkReclaimer(std::shared_ptr<ChunkStorage> storage, const std::string& reclaim_path, size_t batch_size,
+                   std::chrono::milliseconds batch_interval);
+
+    ~ChunkReclaimer();
+
+    ChunkReclaimer(const ChunkReclaimer&) = delete;
+
+    ChunkReclaimer& operator=(const ChunkReclaimer&) = delete;
+
+    /**
+     * Detaches the chunks of a file from the storage and queues them for deletion. New chunks of a file with the
+     * same path are not affected.
+     * @param file_path
+     * @throws system_error
+     */
+    void reclaim(const std::string& file_path);
+
+    /**
+     * @return number of chunk directories waiting for deletion
+     */
+    size_t pending() const;
+};
+
+} // namespace data
+} // namespace gkfs
+
+#endif //GEKKOFS_CHUNK_RECLAIMER_HPP
@@ -14,13 +14,18 @@
 #ifndef GEKKOFS_CHUNK_STORAGE_HPP
 #define GEKKOFS_CHUNK_STORAGE_HPP
 
+#include <daemon/backend/data/chunk_compression.hpp>
+
 extern "C" {
 #include <abt.h>
 }
 
+#include <array>
 #include <limits>
+#include <mutex>
 #include <string>
 #include <memory>
+#include <vector>
 
 /* Forward declarations */
 namespace spdlog {
@@ -43,21 +48,43 @@ private:
     std::shared_ptr<spdlog::logger> log;
 
     std::string root_path;
+    // unit of the chunk space statistics. Chunks themselves are as large as the chunk size of their file
     size_t chunksize;
 
+    // compressed chunks are rewritten as a whole, so writers to the same chunk must be serialized
+    ChunkCompressor compressor;
+    static constexpr size_t chunk_lock_count = 64;
+    mutable std::array<std::mutex, chunk_lock_count> chunk_locks;
+    // chunk files are opened with O_DIRECT. Writers to the same chunk are serialized by the chunk locks
+    bool direct_io_;
+
     inline std::string absolute(const std::string& internal_path) const;
 
-    static inline std::string get_chunks_dir(const std::string& file_path);
+    inline std::string get_chunks_dir(const std::string& file_path) const;
 
-    static inline std::string get_chunk_path(const std::string& file_path, unsigned int chunk_id);
+    inline std::string get_chunk_path(const std::string& file_path, unsigned int chunk_id) const;
 
     void init_chunk_space(const std::string& file_path) const;
 
+    std::mutex& chunk_lock(const std::string& file_path, unsigned int chunk_id) const;
+
+    std::vector<char> load_chunk(const std::string& chunk_path, bool must_exist) const;
+
+    void store_chunk(const std::string& chunk_path, const std::vector<char>& data) const;
+
 public:
-    ChunkStorage(const std::string& path, size_t chunksize);
+    /**
+     * @throws std::invalid_argument if direct I/O is combined with compression
+     * @throws std::system_error if direct I/O is not supported by the file system of path
+     */
+    ChunkStorage(const std::string& path, size_t chunksize,
+                 CompressionType compression = CompressionType::none, int compression_level = 0,
+                 bool direct_io = false);
+
+    bool direct_io() const;
 
     void write_chunk(const std::string& file_path, unsigned int chunk_id,
-                     const char* buff, size_t size, off64_t offset,
+                     const char* buff, size_t size, off64_t offset, size_t chunk_size,
                      ABT_eventual& eventual) const;
 
     void read_chunk(const std::string& file_path, unsigned int chunk_id,
@@ -71,9 +98,21 @@ public:
 
     void truncate_chunk(const std::string& file_path, unsigned int chunk_id, off_t length);
 
+    off64_t seek_chunk(const std::string& file_path, unsigned int chunk_id, off64_t offset, int whence) const;
+
+    std::vector<unsigned int> chunk_ids(const std::string& file_path) const;
+
     void destroy_chunk_space(const std::string& file_path) const;
 
+    bool detach_chunk_space(const std::string& file_path, const std::string& target) const;
+
     ChunkStat chunk_stat() const;
+
+    std::vector<std::pair<std::string, unsigned int>> chunk_list() const;
+
+    static std::string encode_chunks_dir(const std::string& file_path);
+
+    static std::string get_file_path(const std::string& chunks_dir);
 };
 
 } // namespace data
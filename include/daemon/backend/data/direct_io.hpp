@@ -0,0 +1,76 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#ifndef GEKKOFS_DIRECT_IO_HPP
+#define GEKKOFS_DIRECT_IO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+extern "C" {
+#include <sys/types.h>
+}
+
+namespace gkfs {
+namespace data {
+
+struct FreeDeleter {
+    void operator()(void* ptr) const;
+};
+
+using AlignedBuffer = std::unique_ptr<char, FreeDeleter>;
+
+/**
+ * Allocates a buffer whose address is a multiple of alignment, a power of two
+ * @throws std::bad_alloc
+ */
+AlignedBuffer make_aligned_buffer(size_t size, size_t alignment);
+
+inline bool is_aligned(const void* ptr, size_t alignment) {
+    return (reinterpret_cast<uintptr_t>(ptr) & (alignment - 1)) == 0;
+}
+
+/**
+ * Writes like pwrite() to a file opened with O_DIRECT, whose transfers must start and end at multiples of alignment
+ * in the file and in memory. The aligned middle of the range is written straight from buf if buf is aligned there,
+ * and through a bounce buffer of at most bounce_size bytes otherwise. Unaligned head and tail fragments are merged
+ * with the current content of their blocks (read-modify-write). The file does not grow beyond offset + size.
+ * Writers to the same file must be serialized by the caller.
+ * @param fd
+ * @param buf
+ * @param size
+ * @param offset
+ * @param alignment power of two, e.g., the logical block size of the device
+ * @param bounce_size multiple of alignment
+ * @return size or -1 with errno set
+ */
+ssize_t pwrite_direct(int fd, const char* buf, size_t size, off64_t offset, size_t alignment, size_t bounce_size);
+
+/**
+ * Reads like pread() from a file opened with O_DIRECT. Aligned blocks are read straight into buf if buf is aligned at
+ * them, all others through a bounce buffer of at most bounce_size bytes.
+ * @param fd
+ * @param buf
+ * @param size
+ * @param offset
+ * @param alignment power of two
+ * @param bounce_size multiple of alignment
+ * @return bytes read, less than size at the end of the file, or -1 with errno set
+ */
+ssize_t pread_direct(int fd, char* buf, size_t size, off64_t offset, size_t alignment, size_t bounce_size);
+
+} // namespace data
+} // namespace gkfs
+
+#endif //GEKKOFS_DIRECT_IO_HPP
@@ -0,0 +1,49 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#ifndef GEKKOFS_ZERO_BLOCKS_HPP
+#define GEKKOFS_ZERO_BLOCKS_HPP
+
+#include <cstddef>
+
+extern "C" {
+#include <sys/types.h>
+}
+
+namespace gkfs {
+namespace data {
+
+/**
+ * Checks whether a buffer contains only zero bytes. Uses SIMD loads where available and stops at the first non-zero
+ * vector, so data that is not zero is usually rejected after its first bytes.
+ */
+bool is_zero(const char* buf, size_t size);
+
+/**
+ * Writes like pwrite() but does not write blocks of zeros. Zero blocks within the current file are punched out
+ * (FALLOC_FL_PUNCH_HOLE), zero blocks behind its end are skipped. The file has the same size and content afterwards
+ * as if all bytes had been written.
+ * @param fd
+ * @param buf
+ * @param size
+ * @param offset
+ * @param block_size granularity of the zero detection, aligned to the file offset
+ * @param written bytes that were actually written to the file
+ * @return size or -1 with errno set
+ */
+ssize_t pwrite_sparse(int fd, const char* buf, size_t size, off64_t offset, size_t block_size, size_t& written);
+
+} // namespace data
+} // namespace gkfs
+
+#endif //GEKKOFS_ZERO_BLOCKS_HPP
@@ -15,6 +15,7 @@
 #define GEKKOFS_METADATA_DB_HPP
 
 #include <memory>
+#include <functional>
 #include <rocksdb/db.h>
 #include <daemon/backend/exceptions.hpp>
 
@@ -51,9 +52,13 @@ public:
 
     void decrease_size(const std::string& key, size_t size);
 
+    void write_inline(const std::string& key, size_t offset, const std::string& data);
+
+    void promote_inline(const std::string& key);
+
     std::vector<std::pair<std::string, bool>> get_dirents(const std::string& dir) const;
 
-    void iterate_all();
+    void iterate_all(const std::function<void(const std::string&, const std::string&)>& fn) const;
 };
 
 } // namespace metadata
@@ -26,7 +26,9 @@ namespace metadata {
 enum class OperandID : char {
     increase_size = 'i',
     decrease_size = 'd',
-    create = 'c'
+    create = 'c',
+    write_inline = 'w',
+    promote_inline = 'p'
 };
 
 class MergeOperand {
@@ -89,6 +91,37 @@ public:
     std::string serialize_params() const override;
 };
 
+/**
+ * Writes data into the metadentry of a file whose content is stored inline
+ */
+class WriteInlineOperand : public MergeOperand {
+public:
+    constexpr const static char separator = ',';
+
+    size_t offset;
+    std::string data;
+
+    WriteInlineOperand(size_t offset, const std::string& data);
+
+    explicit WriteInlineOperand(const rdb::Slice& serialized_op);
+
+    OperandID id() const override;
+
+    std::string serialize_params() const override;
+};
+
+/**
+ * Moves a file out of its metadentry. The inline data is dropped, the size is kept
+ */
+class PromoteInlineOperand : public MergeOperand {
+public:
+    PromoteInlineOperand() = default;
+
+    OperandID id() const override;
+
+    std::string serialize_params() const override;
+};
+
 class MetadataMergeOperator : public rocksdb::MergeOperator {
 public:
     ~MetadataMergeOperator() override = default;
@@ -0,0 +1,78 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#ifndef GEKKOFS_DAEMON_CLIENT_RPC_GATE_HPP
+#define GEKKOFS_DAEMON_CLIENT_RPC_GATE_HPP
+
+#include <abt.h>
+
+#include <cstdint>
+#include <mutex>
+
+namespace gkfs {
+namespace daemon {
+
+/**
+ * Holds back the RPCs of clients that access data or modify metadata while this daemon rebalances, as their clients
+ * placed them under the previous hosts file. Handlers wait until the rebalancing is done instead of failing, and
+ * rebalancing waits for the handlers in flight. Argobots primitives, as handlers are ULTs that must let others run
+ * while they wait. RPCs of peers are never held back, a peer may rebalance at the same time
+ */
+class ClientRpcGate {
+private:
+    std::once_flag init_flag_;
+    // created on first use, Argobots is initialized by then. Never freed, the gate lives as long as the daemon
+    ABT_mutex mutex_ = ABT_MUTEX_NULL;
+    ABT_cond cond_ = ABT_COND_NULL;
+    bool closed_ = false;
+    uint64_t active_ = 0;
+
+    void init();
+
+public:
+    // waits while the gate is closed
+    void enter();
+
+    void leave();
+
+    // holds back new RPCs and waits for those in flight
+    void close();
+
+    void open();
+};
+
+/**
+ * A client RPC that passes the gate for as long as it is served
+ */
+class ClientRpc {
+private:
+    ClientRpcGate* gate_;
+
+public:
+    /**
+     * @param gate
+     * @param counted false for RPCs of peers, which are not held back
+     */
+    explicit ClientRpc(ClientRpcGate& gate, bool counted = true);
+
+    ~ClientRpc();
+
+    ClientRpc(const ClientRpc&) = delete;
+
+    ClientRpc& operator=(const ClientRpc&) = delete;
+};
+
+} // namespace daemon
+} // namespace gkfs
+
+#endif //GEKKOFS_DAEMON_CLIENT_RPC_GATE_HPP
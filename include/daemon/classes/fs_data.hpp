@@ -16,6 +16,9 @@
 #define LFS_FS_DATA_H
 
 #include <daemon/daemon.hpp>
+#include <global/rpc/distributor.hpp>
+#include <daemon/backend/data/chunk_compression.hpp>
+#include <daemon/classes/io_pools.hpp>
 
 #include <unordered_map>
 #include <map>
@@ -29,6 +32,7 @@ class MetadataDB;
 
 namespace data {
 class ChunkStorage;
+class ChunkReclaimer;
 }
 
 namespace daemon {
@@ -49,10 +53,31 @@ private:
     std::string bind_addr_;
     std::string hosts_file_;
 
+    // data and metadata placement shared with the clients
+    gkfs::rpc::DistributorType distributor_type_{gkfs::rpc::DistributorType::simple_hash};
+    // size limit of files stored in their metadentry, 0 if disabled
+    size_t inline_data_size_{0};
+
+    gkfs::data::CompressionType compression_type_{gkfs::data::CompressionType::none};
+    int compression_level_{0};
+    // chunk files are read and written with O_DIRECT
+    bool direct_io_{false};
+
+    // chunk I/O xstreams and their pools
+    unsigned int io_xstreams_{0};
+    IOPoolLayout io_pool_layout_{IOPoolLayout::shared};
+    bool io_pin_{false};
+    // RPC handler xstreams of data and metadata RPCs
+    unsigned int handler_xstreams_{0};
+    unsigned int metadata_handler_xstreams_{0};
+    int metadata_handler_nice_{0};
+
     // Database
     std::shared_ptr<gkfs::metadata::MetadataDB> mdb_;
     // Storage backend
     std::shared_ptr<gkfs::data::ChunkStorage> storage_;
+    // background deletion of the chunks of removed files
+    std::shared_ptr<gkfs::data::ChunkReclaimer> reclaimer_;
 
     // configurable metadata
     bool atime_state_;
@@ -99,6 +124,12 @@ public:
 
     void storage(const std::shared_ptr<gkfs::data::ChunkStorage>& storage);
 
+    const std::shared_ptr<gkfs::data::ChunkReclaimer>& reclaimer() const;
+
+    void reclaimer(const std::shared_ptr<gkfs::data::ChunkReclaimer>& reclaimer);
+
+    void close_reclaimer();
+
     const std::string& bind_addr() const;
 
     void bind_addr(const std::string& addr);
@@ -107,6 +138,50 @@ public:
 
     void hosts_file(const std::string& lookup_file);
 
+    gkfs::rpc::DistributorType distributor_type() const;
+
+    void distributor_type(gkfs::rpc::DistributorType distributor_type);
+
+    size_t inline_data_size() const;
+
+    void inline_data_size(size_t inline_data_size);
+
+    gkfs::data::CompressionType compression_type() const;
+
+    void compression_type(gkfs::data::CompressionType compression_type);
+
+    int compression_level() const;
+
+    void compression_level(int compression_level);
+
+    bool direct_io() const;
+
+    void direct_io(bool direct_io);
+
+    unsigned int io_xstreams() const;
+
+    void io_xstreams(unsigned int io_xstreams);
+
+    IOPoolLayout io_pool_layout() const;
+
+    void io_pool_layout(IOPoolLayout io_pool_layout);
+
+    bool io_pin() const;
+
+    void io_pin(bool io_pin);
+
+    unsigned int handler_xstreams() const;
+
+    void handler_xstreams(unsigned int handler_xstreams);
+
+    unsigned int metadata_handler_xstreams() const;
+
+    void metadata_handler_xstreams(unsigned int metadata_handler_xstreams);
+
+    int metadata_handler_nice() const;
+
+    void metadata_handler_nice(int metadata_handler_nice);
+
     bool atime_state() const;
 
     void atime_state(bool atime_state);
@@ -0,0 +1,116 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#ifndef GEKKOFS_DAEMON_IO_POOLS_HPP
+#define GEKKOFS_DAEMON_IO_POOLS_HPP
+
+extern "C" {
+#include <abt.h>
+}
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gkfs {
+namespace daemon {
+
+/*
+ * How chunk I/O tasks are queued:
+ * shared:  a single pool that all I/O xstreams pop from
+ * numa:    one pool per NUMA node, served by the xstreams of that node
+ * xstream: one pool per xstream
+ * With numa and xstream, xstreams whose pool is empty steal tasks from the other pools, those of their own NUMA node
+ * first.
+ */
+enum class IOPoolLayout {
+    shared,
+    numa,
+    xstream
+};
+
+IOPoolLayout io_pool_layout_from_string(const std::string& name);
+
+std::string to_string(IOPoolLayout layout);
+
+/**
+ * CPUs of each NUMA node that this process may run on, read from sysfs. A single node with all online CPUs if the
+ * topology is unknown
+ */
+std::vector<std::vector<int>> numa_cpus();
+
+/**
+ * Argobots pools and execution streams that run the chunk I/O tasks of the daemon. Also used for the xstreams that
+ * run the metadata RPC handlers
+ */
+class IOPools {
+private:
+    IOPoolLayout layout_;
+    std::vector<ABT_pool> pools_;
+    std::vector<ABT_sched> scheds_;
+    std::vector<ABT_xstream> xstreams_;
+    unsigned int pinned_{0};
+    int nice_;
+    // xstreams whose nice value was set, and those that have tried to
+    std::atomic<unsigned int> reniced_{0};
+    std::atomic<unsigned int> renice_attempts_{0};
+
+    void stop();
+
+    static void run_sched(ABT_sched sched);
+
+public:
+    /**
+     * Creates the pools and starts the xstreams. Throws std::runtime_error if Argobots fails
+     * @param layout
+     * @param xstreams number of I/O xstreams, at least 1
+     * @param pin binds each xstream to a CPU, spread over the NUMA nodes. Needs Argobots with affinity support
+     * @param nice nice value of the threads running the xstreams if not 0. Values below the current one need
+     * CAP_SYS_NICE
+     */
+    IOPools(IOPoolLayout layout, unsigned int xstreams, bool pin, int nice = 0);
+
+    // joins and frees the xstreams after they have run all queued tasks
+    ~IOPools();
+
+    IOPools(const IOPools&) = delete;
+
+    IOPools& operator=(const IOPools&) = delete;
+
+    IOPoolLayout layout() const;
+
+    size_t partitions() const;
+
+    size_t xstreams() const;
+
+    // number of xstreams that were bound to a CPU
+    unsigned int pinned() const;
+
+    // number of xstreams whose nice value was set
+    unsigned int reniced() const;
+
+    /**
+     * Pool for a task. Tasks with the same key always go to the same pool, e.g., all I/O of a chunk
+     */
+    ABT_pool pool(uint64_t key) const;
+
+    // tasks waiting in all pools
+    size_t queue_depth() const;
+};
+
+} // namespace daemon
+} // namespace gkfs
+
+#endif //GEKKOFS_DAEMON_IO_POOLS_HPP
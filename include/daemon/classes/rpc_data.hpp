@@ -16,6 +16,13 @@
 #define LFS_RPC_DATA_HPP
 
 #include <daemon/daemon.hpp>
+#include <daemon/classes/io_pools.hpp>
+#include <daemon/classes/client_rpc_gate.hpp>
+#include <daemon/classes/shm_regions.hpp>
+#include <global/stage_stats.hpp>
+
+#include <atomic>
+#include <memory>
 
 namespace gkfs {
 namespace daemon {
@@ -29,10 +36,21 @@ private:
     margo_instance_id server_rpc_mid_;
 
     // Argobots I/O pools and execution streams
-    ABT_pool io_pool_;
-    std::vector<ABT_xstream> io_streams_;
+    std::unique_ptr<IOPools> io_pools_;
+    // pool and execution streams of the metadata RPC handlers, if they do not share those of the data RPCs
+    std::unique_ptr<IOPools> metadata_handler_pools_;
     std::string self_addr_str_;
 
+    // load reported to clients choosing a forwarder
+    std::atomic<uint64_t> bytes_in_flight_{0};
+    std::atomic<uint64_t> agios_backlog_{0};
+    // closed while this daemon rebalances
+    ClientRpcGate client_rpc_gate_;
+    // latencies of the stages of RPC handlers reported by the stage stats RPC
+    gkfs::util::StageStats stage_stats_;
+    // memory regions shared by the client processes on this node
+    ShmRegions shm_regions_{gkfs::config::rpc::daemon_max_shm_size};
+
 public:
 
     static RPCData* getInstance() {
@@ -50,18 +68,34 @@ public:
 
     void server_rpc_mid(margo_instance* server_rpc_mid);
 
-    ABT_pool io_pool() const;
+    IOPools& io_pools();
+
+    void io_pools(std::unique_ptr<IOPools> io_pools);
 
-    void io_pool(ABT_pool io_pool);
+    // waits for queued I/O tasks and stops the I/O xstreams
+    void close_io_pools();
 
-    std::vector<ABT_xstream>& io_streams();
+    // pool to register metadata RPCs on, ABT_POOL_NULL for the handler pool of Margo
+    ABT_pool metadata_handler_pool() const;
 
-    void io_streams(const std::vector<ABT_xstream>& io_streams);
+    void metadata_handler_pools(std::unique_ptr<IOPools> metadata_handler_pools);
+
+    void close_metadata_handler_pools();
 
     const std::string& self_addr_str() const;
 
     void self_addr_str(const std::string& addr_str);
 
+    std::atomic<uint64_t>& bytes_in_flight();
+
+    std::atomic<uint64_t>& agios_backlog();
+
+    ClientRpcGate& client_rpc_gate();
+
+    gkfs::util::StageStats& stage_stats();
+
+    ShmRegions& shm_regions();
+
 };
 
 } // namespace daemon
@@ -0,0 +1,101 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#ifndef GEKKOFS_DAEMON_SHM_REGIONS_HPP
+#define GEKKOFS_DAEMON_SHM_REGIONS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+extern "C" {
+#include <sys/types.h>
+}
+
+namespace gkfs {
+namespace daemon {
+
+/**
+ * Memory region of a client process on this node, mapped by the daemon. Unmapped once no request uses it anymore
+ */
+class ShmRegion {
+private:
+    char* base_;
+    std::size_t size_;
+    pid_t pid_;
+
+public:
+    ShmRegion(char* base, std::size_t size, pid_t pid);
+
+    ~ShmRegion();
+
+    ShmRegion(const ShmRegion&) = delete;
+
+    ShmRegion& operator=(const ShmRegion&) = delete;
+
+    pid_t pid() const;
+
+    std::size_t size() const;
+
+    /**
+     * Returns the memory at [pos, pos + size) of the region, or nullptr if that range is not within its data. The
+     * header is never returned, so that a request cannot change the id of the region
+     * @param pos
+     * @param size
+     * @return
+     */
+    char* span(int64_t pos, std::size_t size) const;
+};
+
+/**
+ * Client regions the daemon has mapped, by region id. A region is mapped when the first request names it and stays
+ * mapped for the following ones. Whenever a region is mapped, those of exited processes are dropped. Regions of at
+ * most max_size bytes in total are kept, beyond that arbitrary ones are dropped and mapped again when they are used
+ * next.
+ */
+class ShmRegions {
+private:
+    std::size_t max_size_;
+    std::size_t mapped_size_;
+    std::unordered_map<uint64_t, std::shared_ptr<ShmRegion>> regions_;
+    mutable std::mutex mutex_;
+
+    void evict(std::size_t needed);
+
+public:
+    explicit ShmRegions(std::size_t max_size);
+
+    /**
+     * Returns the region with the given id, mapping it on first use. A region is only mapped if fd of process pid is
+     * a GekkoFS memfd, the process belongs to the daemon's user (unless the daemon runs as root) and the region's
+     * header holds id
+     * @param id
+     * @param pid
+     * @param fd
+     * @return
+     * @throws std::system_error if the region cannot be mapped
+     */
+    std::shared_ptr<ShmRegion> get(uint64_t id, pid_t pid, int fd);
+
+    std::size_t size() const;
+
+    // bytes of the kept regions
+    std::size_t mapped_size() const;
+};
+
+} // namespace daemon
+} // namespace gkfs
+
+#endif //GEKKOFS_DAEMON_SHM_REGIONS_HPP
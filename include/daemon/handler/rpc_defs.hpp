@@ -23,6 +23,10 @@ extern "C" {
 
 DECLARE_MARGO_RPC_HANDLER(rpc_srv_get_fs_config)
 
+DECLARE_MARGO_RPC_HANDLER(rpc_srv_get_load)
+
+DECLARE_MARGO_RPC_HANDLER(rpc_srv_get_stage_stats)
+
 DECLARE_MARGO_RPC_HANDLER(rpc_srv_create)
 
 DECLARE_MARGO_RPC_HANDLER(rpc_srv_stat)
@@ -39,6 +43,16 @@ DECLARE_MARGO_RPC_HANDLER(rpc_srv_update_metadentry_size)
 
 DECLARE_MARGO_RPC_HANDLER(rpc_srv_get_dirents)
 
+DECLARE_MARGO_RPC_HANDLER(rpc_srv_migrate_metadentry)
+
+DECLARE_MARGO_RPC_HANDLER(rpc_srv_write_inline)
+
+DECLARE_MARGO_RPC_HANDLER(rpc_srv_migrate_inline)
+
+DECLARE_MARGO_RPC_HANDLER(rpc_srv_read_inline)
+
+DECLARE_MARGO_RPC_HANDLER(rpc_srv_promote_inline)
+
 #ifdef HAS_SYMLINKS
 
 DECLARE_MARGO_RPC_HANDLER(rpc_srv_mk_symlink)
@@ -51,8 +65,14 @@ DECLARE_MARGO_RPC_HANDLER(rpc_srv_read)
 
 DECLARE_MARGO_RPC_HANDLER(rpc_srv_write)
 
+DECLARE_MARGO_RPC_HANDLER(rpc_srv_migrate_chunk)
+
 DECLARE_MARGO_RPC_HANDLER(rpc_srv_truncate)
 
 DECLARE_MARGO_RPC_HANDLER(rpc_srv_get_chunk_stat)
 
+DECLARE_MARGO_RPC_HANDLER(rpc_srv_seek_data)
+
+DECLARE_MARGO_RPC_HANDLER(rpc_srv_reclaim_chunks)
+
 #endif //GKFS_DAEMON_RPC_DEFS_HPP
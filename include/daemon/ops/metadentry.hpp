@@ -33,7 +33,12 @@ void create(const std::string& path, Metadata& md);
 
 void update(const std::string& path, Metadata& md);
 
-void update_size(const std::string& path, size_t io_size, off_t offset, bool append);
+off64_t update_size(const std::string& path, size_t io_size, off64_t offset, bool append);
+
+bool write_inline(const std::string& path, const std::string& data, off64_t offset, bool append,
+                  off64_t& write_offset, size_t& file_size);
+
+bool promote_inline(const std::string& path, size_t& io_size, size_t& file_size);
 
 void remove_node(const std::string& path);
 
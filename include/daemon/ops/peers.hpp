@@ -0,0 +1,82 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#ifndef GEKKOFS_DAEMON_PEERS_HPP
+#define GEKKOFS_DAEMON_PEERS_HPP
+
+#include <daemon/daemon.hpp>
+#include <global/metadata.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gkfs {
+namespace daemon {
+
+/**
+ * Reads the hosts file in the same way clients do: the line number is the host id
+ * @param hosts_file
+ * @return vector of pair <hostname, uri>
+ */
+std::vector<std::pair<std::string, std::string>> read_hosts_file(const std::string& hosts_file);
+
+/**
+ * Id of this daemon in the hosts, or hosts.size() if it is not listed
+ */
+unsigned int self_host_id(const std::vector<std::pair<std::string, std::string>>& hosts);
+
+hg_id_t registered_id(margo_instance_id mid, const char* name);
+
+/**
+ * Sends an RPC to another daemon and waits for its output. The caller frees the output with margo_free_output.
+ * Must be called from an Argobots ULT
+ */
+template<typename I, typename O>
+hg_handle_t forward_to_peer(margo_instance_id mid, hg_addr_t addr, hg_id_t rpc_id, I* in, O* out) {
+    hg_handle_t handle;
+    auto ret = margo_create(mid, addr, rpc_id, &handle);
+    if (ret != HG_SUCCESS) {
+        throw std::runtime_error("Failed to create RPC handle");
+    }
+    ret = margo_forward(handle, in);
+    if (ret == HG_SUCCESS) {
+        ret = margo_get_output(handle, out);
+    }
+    if (ret != HG_SUCCESS) {
+        margo_destroy(handle);
+        throw std::runtime_error(fmt::format("Failed to forward RPC to peer: {}", HG_Error_to_string(ret)));
+    }
+    return handle;
+}
+
+/**
+ * Writes a whole chunk to the daemon at addr with the given write RPC, e.g., migrate_chunk
+ */
+void push_chunk(margo_instance_id mid, hg_addr_t addr, const char* rpc_name, const std::string& path,
+                unsigned int chunk_id, unsigned int owner, unsigned int hosts_size, char* buf, hg_size_t size);
+
+/**
+ * Writes the data at the start of a file to its chunks, on this daemon or on the ones that hold them under the
+ * file's data host and layout. Must be called from an Argobots ULT
+ * @param path
+ * @param md
+ * @param data
+ */
+void write_file_chunks(const std::string& path, const gkfs::metadata::Metadata& md, const std::string& data);
+
+} // namespace daemon
+} // namespace gkfs
+
+#endif //GEKKOFS_DAEMON_PEERS_HPP
@@ -0,0 +1,25 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#ifndef GEKKOFS_DAEMON_REBALANCE_HPP
+#define GEKKOFS_DAEMON_REBALANCE_HPP
+
+namespace gkfs {
+namespace daemon {
+
+void rebalance();
+
+} // namespace daemon
+} // namespace gkfs
+
+#endif //GEKKOFS_DAEMON_REBALANCE_HPP
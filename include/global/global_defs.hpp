@@ -36,6 +36,16 @@ constexpr auto write = "rpc_srv_write_data";
 constexpr auto read = "rpc_srv_read_data";
 constexpr auto truncate = "rpc_srv_trunc_data";
 constexpr auto get_chunk_stat = "rpc_srv_chunk_stat";
+constexpr auto migrate_metadentry = "rpc_srv_migrate_metadentry";
+constexpr auto migrate_chunk = "rpc_srv_migrate_chunk";
+constexpr auto get_load = "rpc_srv_get_load";
+constexpr auto write_inline = "rpc_srv_write_inline";
+constexpr auto migrate_inline = "rpc_srv_migrate_inline";
+constexpr auto read_inline = "rpc_srv_read_inline";
+constexpr auto promote_inline = "rpc_srv_promote_inline";
+constexpr auto seek_data = "rpc_srv_seek_data";
+constexpr auto reclaim_chunks = "rpc_srv_reclaim_chunks";
+constexpr auto get_stage_stats = "rpc_srv_get_stage_stats";
 } // namespace tag
 
 namespace protocol {
@@ -0,0 +1,65 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#ifndef GKFS_COMMON_HISTOGRAM_HPP
+#define GKFS_COMMON_HISTOGRAM_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace gkfs {
+namespace util {
+
+/**
+ * Lock-free latency histogram with power-of-two buckets of microseconds. Bucket 0 counts latencies below 1 us,
+ * bucket i > 0 those in [2^(i-1), 2^i) us. The last bucket also takes everything above its range.
+ */
+class LatencyHistogram {
+public:
+    static constexpr unsigned int bucket_count = 40;
+
+    LatencyHistogram();
+
+    void record(uint64_t usec);
+
+    uint64_t count() const;
+
+    /**
+     * Upper bound in microseconds of the bucket in which the given quantile falls, e.g., 0.99 for the p99
+     * @param q in (0, 1]
+     * @return 0 if nothing was recorded
+     */
+    uint64_t quantile(double q) const;
+
+    std::array<uint64_t, bucket_count> snapshot() const;
+
+    /**
+     * Quantile of bucket counts taken from snapshot(), e.g., summed up over several histograms
+     */
+    static uint64_t quantile(const std::array<uint64_t, bucket_count>& counts, double q);
+
+    void reset();
+
+    static unsigned int bucket_of(uint64_t usec);
+
+    static uint64_t bucket_upper_bound(unsigned int bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, bucket_count> buckets_;
+};
+
+} // namespace util
+} // namespace gkfs
+
+#endif // GKFS_COMMON_HISTOGRAM_HPP
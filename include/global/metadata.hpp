@@ -25,6 +25,32 @@ namespace gkfs {
 namespace metadata {
 
 constexpr mode_t LINK_MODE = ((S_IRWXU | S_IRWXG | S_IRWXO) | S_IFLNK);
+// data_host value of files whose chunks are spread by the hash distributor
+constexpr int NO_DATA_HOST = -1;
+
+/*
+ * How the chunks of a file are laid out. The layout of a directory is inherited by the files and directories created
+ * in it. 0 selects the default of a field
+ */
+struct Layout {
+    size_t chunk_size{0};          // power of two within config::rpc::min_chunksize and max_chunksize
+    unsigned int stripe_width{0};  // number of daemons holding the chunks of a file, all of them if 0
+};
+
+// chunk size of a file with the given layout
+size_t chunk_size(const Layout& layout);
+
+/**
+ * Throws std::invalid_argument if the chunk size of a layout is not a power of two within the configured bounds
+ */
+void check_layout(const Layout& layout);
+
+/**
+ * Parses a layout like "chunk_size=4M,stripe_width=8". Fields that are left out are 0. Throws std::invalid_argument
+ */
+Layout layout_from_string(const std::string& value);
+
+std::string to_string(const Layout& layout);
 
 class Metadata {
 private:
@@ -35,6 +61,10 @@ private:
     nlink_t link_count_;   // number of names for this inode (hardlinks)
     size_t size_;          // size_ in bytes, might be computed instead of stored
     blkcnt_t blocks_;      // allocated file system blocks_
+    int data_host_;        // host holding all chunks of the file or NO_DATA_HOST if chunks are hashed
+    bool stored_inline_;   // file content is kept in inline_data_ instead of chunks
+    Layout layout_;        // of the chunks of a file, for directories the one passed on to new entries
+    std::string inline_data_;  // content of small files. May be shorter than size_, the rest reads as zeros
 #ifdef HAS_SYMLINKS
     std::string target_path_;  // For links this is the path of the target file
 #endif
@@ -89,6 +119,22 @@ public:
 
     void blocks(blkcnt_t blocks_);
 
+    int data_host() const;
+
+    void data_host(int data_host_);
+
+    bool stored_inline() const;
+
+    void stored_inline(bool stored_inline);
+
+    const std::string& inline_data() const;
+
+    void inline_data(const std::string& inline_data);
+
+    const Layout& layout() const;
+
+    void layout(const Layout& layout);
+
 #ifdef HAS_SYMLINKS
 
     std::string target_path() const;
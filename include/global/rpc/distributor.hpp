@@ -17,6 +17,13 @@
 #include <vector>
 #include <string>
 #include <numeric>
+#include <memory>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
 
 namespace gkfs {
 namespace rpc {
@@ -24,6 +31,19 @@ namespace rpc {
 using chunkid_t = unsigned int;
 using host_t = unsigned int;
 
+/**
+ * Hash-based placement functions the daemons can be started with. Clients
+ * learn the active one from their local daemon so that both sides agree.
+ * With `locality` a file's chunks are all written to the daemon on the node
+ * that created it (recorded in the file's metadata). Files created while that
+ * daemon was short on space and all metadata fall back to simple hashing.
+ */
+enum class DistributorType : unsigned int {
+    simple_hash = 0,
+    jump_hash = 1,
+    locality = 2
+};
+
 class Distributor {
 public:
     virtual host_t localhost() const = 0;
@@ -33,6 +53,32 @@ public:
     virtual host_t locate_file_metadata(const std::string& path) const = 0;
 
     virtual std::vector<host_t> locate_directory_metadata(const std::string& path) const = 0;
+
+    /**
+     * Host id and number of hosts sent with a data request to `host`. The daemon re-hashes the chunk ids of the
+     * request with them to find the chunks meant for it. Distributors using a subset of the hosts for data return
+     * the position of `host` in that subset and its size.
+     */
+    virtual std::pair<host_t, unsigned int> data_request_host(host_t host, unsigned int hosts_size) const;
+
+    /**
+     * Keeps the host that holds all data of a file fixed until unpin_file(), for distributors that choose one per
+     * file at runtime. Clients pin a file while it is open and for each data request, and locate the request's
+     * chunks with the returned host. Distributors that place chunks by hash return false and keep nothing
+     * @param path
+     * @param host (return val) the host holding all data of the file
+     * @return whether the file is pinned and has to be unpinned
+     */
+    virtual bool pin_file(const std::string& path, host_t& host) const;
+
+    virtual void unpin_file(const std::string& path) const;
+
+    /**
+     * Another host that can serve the data requests sent to `host`, e.g., another forwarder in front of the same
+     * shared backend. Requests keep the host id and number of hosts of data_request_host(host), so that the other
+     * host finds the same chunks. Returns `host` if there is none
+     */
+    virtual host_t alternative_data_host(host_t host) const;
 };
 
 
@@ -87,6 +133,132 @@ public:
     std::vector<host_t> locate_directory_metadata(const std::string& path) const override;
 };
 
+/**
+ * Sends all chunks of a file to one forwarder out of a candidate set. The forwarder is picked by a
+ * selection function (e.g., load-aware) when a file is first seen and then kept, so that the requests
+ * of a file are ordered by a single forwarder. Metadata is placed like in ForwarderDistributor.
+ * The choice is kept while a file is pinned. Of the other files, the least recently used ones are forgotten
+ * beyond max_sticky_files.
+ */
+class DynamicForwarderDistributor : public Distributor {
+public:
+    using selector_t = std::function<host_t(const std::vector<host_t>& candidates)>;
+
+    // files remembered, unless more of them are pinned
+    static constexpr std::size_t max_sticky_files = 4096;
+private:
+    struct StickyFile {
+        host_t host;
+        unsigned int pins;
+        // position in unpinned_ while pins is 0
+        std::list<std::string>::iterator unpinned_pos;
+    };
+
+    std::vector<host_t> candidates_;
+    unsigned int hosts_size_;
+    std::vector<host_t> all_hosts_;
+    std::hash<std::string> str_hash;
+    selector_t selector_;
+    mutable std::mutex sticky_mutex_;
+    mutable std::unordered_map<std::string, StickyFile> sticky_;
+    // files that are not pinned, least recently used first
+    mutable std::list<std::string> unpinned_;
+
+    StickyFile& remember(const std::string& path, host_t host) const;
+
+public:
+    DynamicForwarderDistributor(std::vector<host_t> candidates, unsigned int hosts_size, selector_t selector);
+
+    host_t localhost() const override;
+
+    host_t locate_data(const std::string& path, const chunkid_t& chnk_id) const override;
+
+    host_t locate_file_metadata(const std::string& path) const override;
+
+    std::vector<host_t> locate_directory_metadata(const std::string& path) const override;
+
+    bool pin_file(const std::string& path, host_t& host) const override;
+
+    void unpin_file(const std::string& path) const override;
+
+    host_t alternative_data_host(host_t host) const override;
+
+    const std::vector<host_t>& candidates() const;
+
+    // number of files whose forwarder is remembered
+    std::size_t sticky_files() const;
+};
+
+/**
+ * Stripes the chunks of every file across a client's forwarders by hashing the chunk id within that set, so that a
+ * client node is not limited to the bandwidth of one forwarder. Metadata is placed like in ForwarderDistributor.
+ */
+class StripedForwarderDistributor : public Distributor {
+private:
+    std::vector<host_t> forwarders_;
+    unsigned int hosts_size_;
+    std::vector<host_t> all_hosts_;
+    std::hash<std::string> str_hash;
+public:
+    StripedForwarderDistributor(std::vector<host_t> forwarders, unsigned int hosts_size);
+
+    host_t localhost() const override;
+
+    host_t locate_data(const std::string& path, const chunkid_t& chnk_id) const override;
+
+    host_t locate_file_metadata(const std::string& path) const override;
+
+    std::vector<host_t> locate_directory_metadata(const std::string& path) const override;
+
+    std::pair<host_t, unsigned int> data_request_host(host_t host, unsigned int hosts_size) const override;
+
+    host_t alternative_data_host(host_t host) const override;
+};
+
+/**
+ * Places data and metadata with jump consistent hashing (Lamping and Veach).
+ * Growing the cluster from n to n + 1 hosts only moves ~1/(n + 1) of all
+ * chunks and metadentries, all of them to the new host.
+ */
+class JumpHashDistributor : public Distributor {
+private:
+    host_t localhost_;
+    unsigned int hosts_size_;
+    std::vector<host_t> all_hosts_;
+    std::hash<std::string> str_hash;
+public:
+    JumpHashDistributor(host_t localhost, unsigned int hosts_size);
+
+    host_t localhost() const override;
+
+    host_t locate_data(const std::string& path, const chunkid_t& chnk_id) const override;
+
+    host_t locate_file_metadata(const std::string& path) const override;
+
+    std::vector<host_t> locate_directory_metadata(const std::string& path) const override;
+
+    static host_t jump_hash(uint64_t key, unsigned int num_buckets);
+};
+
+/**
+ * Places the chunks of a file whose layout limits it to `stripe_width` of the `hosts_size` hosts. The chunks go
+ * round-robin to consecutive hosts, starting at the host that the path hashes to. Used instead of the distributor if
+ * is_striped() holds
+ */
+host_t locate_striped_data(const std::string& path, chunkid_t chnk_id, unsigned int stripe_width,
+                           unsigned int hosts_size);
+
+inline bool is_striped(unsigned int stripe_width, unsigned int hosts_size) {
+    return stripe_width != 0 && stripe_width < hosts_size;
+}
+
+DistributorType distributor_type_from_string(const std::string& name);
+
+std::string to_string(DistributorType type);
+
+std::shared_ptr<Distributor>
+make_hash_distributor(DistributorType type, host_t localhost, unsigned int hosts_size);
+
 } // namespace rpc
 } // namespace gkfs
 
@@ -26,9 +26,13 @@ extern "C" {
 MERCURY_GEN_PROC(rpc_err_out_t, ((hg_int32_t) (err)))
 
 // Metadentry
+// chunk_size and stripe_width are the layout the new entry inherits from its parent directory
 MERCURY_GEN_PROC(rpc_mk_node_in_t,
                  ((hg_const_string_t) (path))\
-((uint32_t) (mode)))
+((uint32_t) (mode))\
+((hg_int32_t) (data_host))\
+((hg_uint64_t) (chunk_size))\
+((hg_uint32_t) (stripe_width)))
 
 MERCURY_GEN_PROC(rpc_path_only_in_t, ((hg_const_string_t) (path)))
 
@@ -39,7 +43,8 @@ MERCURY_GEN_PROC(rpc_rm_node_in_t, ((hg_const_string_t) (path)))
 
 MERCURY_GEN_PROC(rpc_trunc_in_t,
                  ((hg_const_string_t) (path)) \
-((hg_uint64_t) (length)))
+((hg_uint64_t) (length)) \
+((hg_uint64_t) (chunk_size)))
 
 MERCURY_GEN_PROC(rpc_update_metadentry_in_t,
                  ((hg_const_string_t) (path))\
@@ -52,13 +57,16 @@ MERCURY_GEN_PROC(rpc_update_metadentry_in_t,
 ((hg_int64_t) (atime))\
 ((hg_int64_t) (mtime))\
 ((hg_int64_t) (ctime))\
+((hg_uint64_t) (chunk_size))\
+((hg_uint32_t) (stripe_width))\
 ((hg_bool_t) (nlink_flag))\
 ((hg_bool_t) (mode_flag))\
 ((hg_bool_t) (size_flag))\
 ((hg_bool_t) (block_flag))\
 ((hg_bool_t) (atime_flag))\
 ((hg_bool_t) (mtime_flag))\
-((hg_bool_t) (ctime_flag)))
+((hg_bool_t) (ctime_flag))\
+((hg_bool_t) (layout_flag)))
 
 MERCURY_GEN_PROC(rpc_update_metadentry_size_in_t, ((hg_const_string_t) (path))
         ((hg_uint64_t) (size))
@@ -71,6 +79,21 @@ MERCURY_GEN_PROC(rpc_update_metadentry_size_out_t, ((hg_int32_t) (err))
 MERCURY_GEN_PROC(rpc_get_metadentry_size_out_t, ((hg_int32_t) (err))
         ((hg_int64_t) (ret_size)))
 
+// content of small files stored in their metadentry. Used for inline writes, reads and promotions
+MERCURY_GEN_PROC(rpc_inline_data_in_t,
+                 ((hg_const_string_t) (path))\
+((hg_int64_t) (offset))\
+((hg_uint64_t) (size))\
+((hg_bool_t) (append))\
+((hg_bulk_t) (bulk_handle)))
+
+MERCURY_GEN_PROC(rpc_inline_data_out_t,
+                 ((hg_int32_t) (err))\
+((hg_bool_t) (stored_inline))\
+((hg_int64_t) (offset))\
+((hg_uint64_t) (io_size))\
+((hg_uint64_t) (file_size)))
+
 #ifdef HAS_SYMLINKS
 MERCURY_GEN_PROC(rpc_mk_symlink_in_t,
                  ((hg_const_string_t) (path))\
@@ -79,32 +102,70 @@ MERCURY_GEN_PROC(rpc_mk_symlink_in_t,
 
 #endif
 
-// data
+/*
+ * data. chunk_size and stripe_width are the layout of the file. A shm_id other than 0 replaces the bulk handle by the
+ * shared-memory region of client process shm_pid, its memfd shm_fd. The request's first byte is at shm_offset in it
+ */
 MERCURY_GEN_PROC(rpc_read_data_in_t,
                  ((hg_const_string_t) (path))\
 ((int64_t) (offset))\
 ((hg_uint64_t) (host_id))\
 ((hg_uint64_t) (host_size))\
+((hg_uint64_t) (chunk_size))\
+((hg_uint32_t) (stripe_width))\
 ((hg_uint64_t) (chunk_n))\
 ((hg_uint64_t) (chunk_start))\
 ((hg_uint64_t) (chunk_end))\
 ((hg_uint64_t) (total_chunk_size))\
-((hg_bulk_t) (bulk_handle)))
+((hg_bulk_t) (bulk_handle))\
+((hg_uint64_t) (shm_id))\
+((hg_uint32_t) (shm_pid))\
+((int32_t) (shm_fd))\
+((int64_t) (shm_offset)))
 
 MERCURY_GEN_PROC(rpc_data_out_t,
                  ((int32_t) (err))\
 ((hg_size_t) (io_size)))
 
+// data_end is the file offset behind the last byte of data the daemon found in the requested chunks, 0 if none
+MERCURY_GEN_PROC(rpc_read_data_out_t,
+                 ((int32_t) (err))\
+((hg_size_t) (io_size))\
+((hg_uint64_t) (data_end)))
+
+// whence is SEEK_DATA or SEEK_HOLE. offset in the output is -1 if the daemon's chunks hold no such position
+MERCURY_GEN_PROC(rpc_seek_data_in_t,
+                 ((hg_const_string_t) (path))\
+((int64_t) (offset))\
+((int32_t) (whence))\
+((hg_uint64_t) (host_id))\
+((hg_uint64_t) (host_size))\
+((hg_uint64_t) (chunk_size))\
+((hg_uint32_t) (stripe_width))\
+((hg_uint64_t) (chunk_start))\
+((hg_uint64_t) (chunk_end))\
+((hg_bool_t) (all_chunks)))
+
+MERCURY_GEN_PROC(rpc_seek_data_out_t,
+                 ((int32_t) (err))\
+((int64_t) (offset)))
+
 MERCURY_GEN_PROC(rpc_write_data_in_t,
                  ((hg_const_string_t) (path))\
 ((int64_t) (offset))\
 ((hg_uint64_t) (host_id))\
 ((hg_uint64_t) (host_size))\
+((hg_uint64_t) (chunk_size))\
+((hg_uint32_t) (stripe_width))\
 ((hg_uint64_t) (chunk_n))\
 ((hg_uint64_t) (chunk_start))\
 ((hg_uint64_t) (chunk_end))\
 ((hg_uint64_t) (total_chunk_size))\
-((hg_bulk_t) (bulk_handle)))
+((hg_bulk_t) (bulk_handle))\
+((hg_uint64_t) (shm_id))\
+((hg_uint32_t) (shm_pid))\
+((int32_t) (shm_fd))\
+((int64_t) (shm_offset)))
 
 MERCURY_GEN_PROC(rpc_get_dirents_in_t,
                  ((hg_const_string_t) (path))
@@ -126,6 +187,8 @@ MERCURY_GEN_PROC(rpc_config_out_t, ((hg_const_string_t) (mountdir))
 ((hg_bool_t) (blocks_state)) \
 ((hg_uint32_t) (uid)) \
 ((hg_uint32_t) (gid)) \
+((hg_uint32_t) (distributor)) \
+((hg_uint64_t) (inline_data_size)) \
 )
 
 
@@ -139,4 +202,29 @@ MERCURY_GEN_PROC(rpc_chunk_stat_out_t,
                          ((hg_uint64_t) (chunk_free))
 )
 
+// management
+MERCURY_GEN_PROC(rpc_migrate_metadentry_in_t,
+                 ((hg_const_string_t) (path))
+                         ((hg_const_string_t) (db_val))
+)
+
+MERCURY_GEN_PROC(rpc_load_out_t,
+                 ((hg_uint64_t) (io_queue_depth))
+                         ((hg_uint64_t) (bytes_in_flight))
+                         ((hg_uint64_t) (agios_backlog))
+)
+
+// the daemon pushes the bucket counts of its stage latency histograms into bulk_handle as uint64_t
+MERCURY_GEN_PROC(rpc_stage_stats_in_t,
+                 ((hg_bool_t) (reset))
+                         ((hg_bulk_t) (bulk_handle))
+)
+
+MERCURY_GEN_PROC(rpc_stage_stats_out_t,
+                 ((hg_int32_t) (err))
+                         ((hg_uint32_t) (op_count))
+                         ((hg_uint32_t) (stage_count))
+                         ((hg_uint32_t) (bucket_count))
+)
+
 #endif //LFS_RPC_TYPES_HPP
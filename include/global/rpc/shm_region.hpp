@@ -0,0 +1,64 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#ifndef GEKKOFS_GLOBAL_SHM_REGION_HPP
+#define GEKKOFS_GLOBAL_SHM_REGION_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+#include <fcntl.h>
+}
+
+// glibc < 2.27 does not define them
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS 1033
+#define F_GET_SEALS 1034
+#endif
+#ifndef F_SEAL_SHRINK
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#endif
+
+namespace gkfs {
+namespace rpc {
+namespace shm {
+
+/*
+ * Layout of the memory region a client process shares with the daemon on its node. The client creates it as a memfd
+ * with this name, which the daemon opens through /proc/<pid>/fd/<fd>
+ */
+constexpr auto memfd_name = "gkfs-shm";
+
+// starts the region. The daemon only maps a region whose header holds the id the client sent along
+struct Header {
+    uint64_t id;
+};
+
+// data follows the header page, so that it is page-aligned
+constexpr std::size_t data_offset = 4096;
+
+/*
+ * Seals the client adds to the memfd. A region whose size could change would raise SIGBUS in the daemon when it is
+ * accessed behind a shrunk end, so the daemon refuses regions without them
+ */
+constexpr int required_seals = F_SEAL_SHRINK | F_SEAL_GROW;
+
+static_assert(sizeof(Header) <= data_offset, "shared memory header does not fit before the data");
+
+} // namespace shm
+} // namespace rpc
+} // namespace gkfs
+
+#endif //GEKKOFS_GLOBAL_SHM_REGION_HPP
@@ -0,0 +1,123 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#ifndef GKFS_COMMON_STAGE_STATS_HPP
+#define GKFS_COMMON_STAGE_STATS_HPP
+
+#include <global/histogram.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace gkfs {
+namespace util {
+
+// RPC handlers of the daemon whose stages are timed. Values are part of the stage stats RPC
+enum class RpcOp : unsigned int {
+    write = 0,
+    read,
+    create,
+    stat,
+    remove,
+    update_size,
+    get_size,
+    get_dirents
+};
+
+constexpr unsigned int rpc_op_count = 8;
+
+/*
+ * Stages of an RPC handler. Not every handler goes through every stage:
+ * decode:    decoding the RPC input
+ * schedule:  waiting for AGIOS to schedule the request
+ * transfer:  bulk transfers from or to the client, summed up over all chunks of a request
+ * queue:     time a chunk task waits in the I/O pool until it runs, per chunk
+ * storage:   chunk file I/O per chunk, or the metadata backend operation
+ * respond:   sending the response
+ * total:     the whole handler
+ */
+enum class RpcStage : unsigned int {
+    decode = 0,
+    schedule,
+    transfer,
+    queue,
+    storage,
+    respond,
+    total
+};
+
+constexpr unsigned int rpc_stage_count = 7;
+
+const char* to_string(RpcOp op);
+
+const char* to_string(RpcStage stage);
+
+/**
+ * Lock-free latency histograms per RPC handler and stage
+ */
+class StageStats {
+public:
+    // number of bucket counts in snapshot(), laid out as [op][stage][bucket]
+    static constexpr size_t counts_size = rpc_op_count * rpc_stage_count * LatencyHistogram::bucket_count;
+
+    void record(RpcOp op, RpcStage stage, uint64_t usec);
+
+    std::vector<uint64_t> snapshot() const;
+
+    void reset();
+
+    // position of the first bucket count of a histogram in snapshot()
+    static size_t offset(RpcOp op, RpcStage stage);
+
+private:
+    std::array<LatencyHistogram, rpc_op_count * rpc_stage_count> histograms_;
+};
+
+/**
+ * Times the stages of a single RPC handler invocation. stage() records the time since the previous stage ended and
+ * the destructor records the total time of the handler
+ */
+class StageTimer {
+public:
+    using clock = std::chrono::steady_clock;
+
+    StageTimer(StageStats& stats, RpcOp op);
+
+    ~StageTimer();
+
+    StageTimer(const StageTimer&) = delete;
+
+    StageTimer& operator=(const StageTimer&) = delete;
+
+    // records the time since the previous stage ended or the handler started
+    void stage(RpcStage stage);
+
+    // records a duration measured by the caller, e.g., summed up over several calls. Leaves the stage mark alone
+    void record(RpcStage stage, clock::duration duration);
+
+    // starts the next stage now without recording the time since the previous one
+    void mark();
+
+private:
+    StageStats& stats_;
+    RpcOp op_;
+    clock::time_point start_;
+    clock::time_point last_;
+};
+
+} // namespace util
+} // namespace gkfs
+
+#endif // GKFS_COMMON_STAGE_STATS_HPP
@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+################################################################################
+#  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain           #
+#  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany         #
+#                                                                              #
+#  This software was partially supported by the                                #
+#  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).   #
+#                                                                              #
+#  This software was partially supported by the                                #
+#  ADA-FS project under the SPPEXA project funded by the DFG.                  #
+#                                                                              #
+#  SPDX-License-Identifier: MIT                                                #
+################################################################################
+
+"""Decodes the binary syscall traces written by the client with LIBGKFS_TRACE_FILE.
+
+The format is described in include/client/trace.hpp.
+"""
+
+import argparse
+import json
+import struct
+import sys
+from collections import defaultdict, namedtuple
+
+BLOCK_MAGIC = 0x42544b47
+BLOCK_NAMES = 1
+BLOCK_RECORDS = 2
+BLOCK_PATHS = 3
+
+BLOCK_HEADER = struct.Struct('<IHHIIIIQQ')
+SYSCALL_NAME = struct.Struct('<H30s')
+# records of version 1 lack flags and mode
+RECORDS = {1: struct.Struct('<QQQqQqiHH'), 2: struct.Struct('<QQQqQqiHHII')}
+PATH_HEADER = struct.Struct('<QII')
+
+Record = namedtuple('Record', ['pid', 'tid', 'start', 'end', 'path_hash', 'offset', 'size', 'result', 'fd',
+                               'syscall', 'flags', 'mode'])
+
+
+class Trace(object):
+    """Records of one or more trace files with their timestamps converted to nanoseconds"""
+
+    def __init__(self):
+        self.names = {}
+        self.paths = {}
+        self.records = []
+        # (tsc, ns) pairs of the block headers per process
+        self._clock = defaultdict(list)
+
+    def load(self, path):
+        with open(path, 'rb') as f:
+            data = f.read()
+        pos = 0
+        while pos + BLOCK_HEADER.size <= len(data):
+            magic, version, btype, count, pid, tid, _, tsc, ns = BLOCK_HEADER.unpack_from(data, pos)
+            if magic != BLOCK_MAGIC or version not in RECORDS:
+                raise ValueError('{}: invalid block at offset {}'.format(path, pos))
+            pos += BLOCK_HEADER.size
+            self._clock[pid].append((tsc, ns))
+            if btype == BLOCK_NAMES:
+                for _ in range(count):
+                    nr, name = SYSCALL_NAME.unpack_from(data, pos)
+                    self.names[nr] = name.split(b'\0', 1)[0].decode()
+                    pos += SYSCALL_NAME.size
+            elif btype == BLOCK_RECORDS:
+                record = RECORDS[version]
+                for _ in range(count):
+                    fields = record.unpack_from(data, pos)
+                    flags, mode = fields[9:] if version >= 2 else (0, 0)
+                    self.records.append(Record(pid, tid, *fields[:8], flags=flags, mode=mode))
+                    pos += record.size
+            elif btype == BLOCK_PATHS:
+                for _ in range(count):
+                    path_hash, length, _ = PATH_HEADER.unpack_from(data, pos)
+                    pos += PATH_HEADER.size
+                    self.paths[path_hash] = data[pos:pos + length].decode(errors='replace')
+                    pos += (length + 7) & ~7
+            else:
+                raise ValueError('{}: unknown block type {}'.format(path, btype))
+
+    def finish(self):
+        """Converts timestamps to nanoseconds since the start of each process and sorts the records"""
+        conversion = {}
+        for pid, points in self._clock.items():
+            first = min(points)
+            last = max(points)
+            # without two distinct points assume that the timestamp counter runs at 1 GHz
+            rate = (last[0] - first[0]) / (last[1] - first[1]) if last[1] > first[1] else 1.0
+            conversion[pid] = (first[0], rate)
+        converted = []
+        for r in self.records:
+            base, rate = conversion[r.pid]
+            converted.append(r._replace(start=(r.start - base) / rate, end=(r.end - base) / rate))
+        self.records = sorted(converted, key=lambda r: r.start)
+
+    def name(self, record):
+        return self.names.get(record.syscall, 'syscall_{}'.format(record.syscall))
+
+
+def arguments(trace, record):
+    args = []
+    if record.fd != -1:
+        args.append('fd={}'.format(record.fd))
+    if record.path_hash != 0:
+        args.append('path={}'.format(trace.paths.get(record.path_hash, '#{:016x}'.format(record.path_hash))))
+    if record.offset != -1:
+        args.append('offset={}'.format(record.offset))
+    if record.size != 0:
+        args.append('size={}'.format(record.size))
+    if record.flags != 0:
+        args.append('flags={:#o}'.format(record.flags))
+    if record.mode != 0:
+        args.append('mode={:#o}'.format(record.mode))
+    return args
+
+
+def print_text(trace, out):
+    for r in trace.records:
+        out.write('{:16.3f} {}/{} {}({}) = {} <{:.3f} us>\n'.format(
+            r.start / 1000.0, r.pid, r.tid, trace.name(r), ', '.join(arguments(trace, r)), r.result,
+            (r.end - r.start) / 1000.0))
+
+
+def print_chrome(trace, out):
+    events = []
+    for r in trace.records:
+        args = {'result': r.result}
+        for arg in arguments(trace, r):
+            key, value = arg.split('=', 1)
+            args[key] = value
+        events.append({'name': trace.name(r), 'cat': 'syscall', 'ph': 'X', 'pid': r.pid, 'tid': r.tid,
+                       'ts': r.start / 1000.0, 'dur': (r.end - r.start) / 1000.0, 'args': args})
+    json.dump({'traceEvents': events, 'displayTimeUnit': 'ns'}, out)
+    out.write('\n')
+
+
+def percentile(sorted_values, p):
+    return sorted_values[min(len(sorted_values) - 1, int(p * len(sorted_values)))]
+
+
+def print_histogram(trace, out):
+    latencies = defaultdict(list)
+    for r in trace.records:
+        latencies[trace.name(r)].append((r.end - r.start) / 1000.0)
+    for name in sorted(latencies, key=lambda n: -sum(latencies[n])):
+        values = sorted(latencies[name])
+        out.write('{}: count {}, total {:.1f} us, mean {:.3f} us, p50 {:.3f} us, p90 {:.3f} us, p99 {:.3f} us, '
+                  'max {:.3f} us\n'.format(name, len(values), sum(values), sum(values) / len(values),
+                                            percentile(values, 0.5), percentile(values, 0.9),
+                                            percentile(values, 0.99), values[-1]))
+        # log2 buckets in microseconds
+        buckets = defaultdict(int)
+        for v in values:
+            bucket = 0
+            while (1 << bucket) < v:
+                bucket += 1
+            buckets[bucket] += 1
+        peak = max(buckets.values())
+        for bucket in range(min(buckets), max(buckets) + 1):
+            count = buckets.get(bucket, 0)
+            out.write('  <= {:>8} us {:>10} {}\n'.format(1 << bucket, count, '#' * (40 * count // peak)))
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description='Decodes GekkoFS client syscall traces (LIBGKFS_TRACE_FILE)')
+    parser.add_argument('traces', nargs='+', help='trace files, e.g., one per process')
+    parser.add_argument('-f', '--format', choices=['text', 'chrome', 'histogram'], default='text',
+                        help='text: one line per syscall, chrome: Chrome trace event JSON for chrome://tracing or '
+                             'Perfetto, histogram: latency histogram per syscall')
+    parser.add_argument('-o', '--output', help='output file, default stdout')
+    return parser.parse_args()
+
+
+if __name__ == '__main__':
+    args = parse_args()
+    trace = Trace()
+    for path in args.traces:
+        trace.load(path)
+    trace.finish()
+    out = open(args.output, 'w') if args.output else sys.stdout
+    {'text': print_text, 'chrome': print_chrome, 'histogram': print_histogram}[args.format](trace, out)
+    if out is not sys.stdout:
+        out.close()
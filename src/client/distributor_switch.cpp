@@ -0,0 +1,87 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <client/distributor_switch.hpp>
+
+namespace gkfs {
+namespace preload {
+
+DistributorSwitch::DistributorSwitch() :
+        data_ops_in_flight_(0),
+        switch_pending_(false) {}
+
+void DistributorSwitch::distributor(std::shared_ptr<gkfs::rpc::Distributor> d) {
+    std::atomic_store(&distributor_, d);
+}
+
+std::shared_ptr<gkfs::rpc::Distributor> DistributorSwitch::distributor() const {
+    return std::atomic_load(&distributor_);
+}
+
+/**
+ * Registers a data operation and returns the distributor it must use until release().
+ * Blocks while a distributor switch is draining operations.
+ * @return
+ */
+std::shared_ptr<gkfs::rpc::Distributor> DistributorSwitch::acquire() {
+    while (true) {
+        // register first, then check: a switch that starts concurrently either sees us or we see it
+        data_ops_in_flight_++;
+        if (!switch_pending_) {
+            return std::atomic_load(&distributor_);
+        }
+        release();
+        std::unique_lock<std::mutex> lock(switch_mutex_);
+        switch_cv_.wait(lock, [this] { return !switch_pending_; });
+    }
+}
+
+void DistributorSwitch::release() {
+    if (--data_ops_in_flight_ == 0 && switch_pending_) {
+        std::lock_guard<std::mutex> lock(switch_mutex_);
+        switch_cv_.notify_all();
+    }
+}
+
+/**
+ * Replaces the distributor once all data operations using the current one have finished.
+ * New data operations are held back until the switch is done.
+ * @param d
+ */
+void DistributorSwitch::switch_distributor(std::shared_ptr<gkfs::rpc::Distributor> d) {
+    std::unique_lock<std::mutex> lock(switch_mutex_);
+    switch_pending_ = true;
+    switch_cv_.wait(lock, [this] { return data_ops_in_flight_ == 0; });
+    std::atomic_store(&distributor_, d);
+    switch_pending_ = false;
+    switch_cv_.notify_all();
+}
+
+DistributorGuard::DistributorGuard(DistributorSwitch& distributors) :
+        switch_(distributors),
+        distributor_(distributors.acquire()) {}
+
+DistributorGuard::~DistributorGuard() {
+    switch_.release();
+}
+
+const gkfs::rpc::Distributor& DistributorGuard::operator*() const {
+    return *distributor_;
+}
+
+const gkfs::rpc::Distributor* DistributorGuard::operator->() const {
+    return distributor_.get();
+}
+
+} // namespace preload
+} // namespace gkfs
@@ -22,14 +22,21 @@
 #include <client/open_dir.hpp>
 
 #include <global/path_util.hpp>
+#include <global/rpc/distributor.hpp>
 
 extern "C" {
 #include <dirent.h> // used for file types in the getdents{,64}() functions
 #include <linux/kernel.h> // used for definition of alignment macros
 #include <sys/statfs.h>
 #include <sys/statvfs.h>
+#include <sys/xattr.h>
 }
 
+#include <atomic>
+#include <ctime>
+#include <stdexcept>
+#include <vector>
+
 using namespace std;
 
 /*
@@ -61,7 +68,12 @@ struct linux_dirent64 {
 
 namespace {
 
-int check_parent_dir(const std::string& path) {
+/**
+ * @param path
+ * @param layout set to the layout of the parent directory, which new entries inherit
+ * @return 0 on success, -1 on error with errno set
+ */
+int check_parent_dir(const std::string& path, gkfs::metadata::Layout& layout) {
 #if CREATE_CHECK_PARENTS
     auto p_comp = gkfs::path::dirname(path);
     auto md = gkfs::util::get_metadata(p_comp);
@@ -78,9 +90,59 @@ int check_parent_dir(const std::string& path) {
         errno = ENOTDIR;
         return -1;
     }
+    layout = md->layout();
 #endif // CREATE_CHECK_PARENTS
     return 0;
 }
+
+/**
+ * Chooses where the chunks of a new regular file go. With the locality distributor this is the local daemon
+ * unless its chunk space is running low, in which case the file falls back to hashed placement.
+ * The local daemon's free space is reused for config::distributor::locality_stat_interval seconds.
+ * @return host id or NO_DATA_HOST
+ */
+int choose_data_host() {
+#ifdef GKFS_ENABLE_FORWARDING
+    return gkfs::metadata::NO_DATA_HOST;
+#else
+    if (CTX->fs_conf()->distributor != gkfs::rpc::DistributorType::locality) {
+        return gkfs::metadata::NO_DATA_HOST;
+    }
+    static std::atomic<time_t> next_check{0};
+    static std::atomic<bool> local_space_left{false};
+    auto now = ::time(nullptr);
+    if (now >= next_check) {
+        next_check = now + gkfs::config::distributor::locality_stat_interval;
+        try {
+            auto stat = gkfs::rpc::forward_get_chunk_stat(CTX->local_host_id());
+            local_space_left = stat.chunk_free * 100 >
+                               stat.chunk_total * gkfs::config::distributor::locality_min_free_percent;
+        } catch (const std::exception& e) {
+            LOG(WARNING, "Failed to get chunk stat of local host: {}", e.what());
+            local_space_left = false;
+        }
+        if (!local_space_left) {
+            LOG(INFO, "Local daemon is short on space. New files are placed by hashing");
+        }
+    }
+    return local_space_left ? static_cast<int>(CTX->local_host_id()) : gkfs::metadata::NO_DATA_HOST;
+#endif
+}
+/**
+ * Moves the content of an inline file into its chunks once a write would grow it beyond the inline data size. The
+ * metadata host writes the chunks before it marks the file as stored in chunks
+ * @param path
+ * @return 0 on success, -1 on error with errno set
+ */
+int promote_inline(const string& path) {
+    if (gkfs::rpc::forward_promote_inline(path) < 0) {
+        LOG(ERROR, "{}() Failed to promote file '{}' from its metadentry: {}", __func__, path, strerror(errno));
+        return -1;
+    }
+    LOG(DEBUG, "{}() Moved file '{}' to chunks", __func__, path);
+    return 0;
+}
+
 } // namespace
 
 namespace gkfs {
@@ -94,13 +156,10 @@ int gkfs_open(const std::string& path, mode_t mode, int flags) {
         return -1;
     }
 
-    if (flags & O_APPEND) {
-        LOG(ERROR, "`O_APPEND` flag is not supported");
-        errno = ENOTSUP;
-        return -1;
-    }
-
     bool exists = true;
+    int data_host = gkfs::metadata::NO_DATA_HOST;
+    gkfs::metadata::Layout layout{};
+    bool stored_inline = false;
     auto md = gkfs::util::get_metadata(path);
     if (!md) {
         if (errno == ENOENT) {
@@ -128,10 +187,12 @@ int gkfs_open(const std::string& path, mode_t mode, int flags) {
         }
 
         // no access check required here. If one is using our FS they have the permissions.
-        if (gkfs_create(path, mode | S_IFREG)) {
+        if (gkfs_create(path, mode | S_IFREG, data_host, layout)) {
             LOG(ERROR, "Error creating non-existent file: '{}'", strerror(errno));
             return -1;
         }
+        // the daemon stores new files inline if enabled
+        stored_inline = CTX->fs_conf()->inline_data_size > 0;
     } else {
         /* File already exists */
 
@@ -159,19 +220,40 @@ int gkfs_open(const std::string& path, mode_t mode, int flags) {
 
         /*** Regular file exists ***/
         assert(S_ISREG(md->mode()));
+        data_host = md->data_host();
+        layout = md->layout();
+        stored_inline = md->stored_inline();
 
         if ((flags & O_TRUNC) && ((flags & O_RDWR) || (flags & O_WRONLY))) {
-            if (gkfs_truncate(path, md->size(), 0)) {
+            if (gkfs_truncate(path, md->size(), 0, data_host, layout, stored_inline)) {
                 LOG(ERROR, "Error truncating file");
                 return -1;
             }
         }
     }
 
-    return CTX->file_map()->add(std::make_shared<gkfs::filemap::OpenFile>(path, flags));
+    auto file = std::make_shared<gkfs::filemap::OpenFile>(path, flags);
+    file->data_host(data_host);
+    file->layout(layout);
+    file->stored_inline(stored_inline);
+    return CTX->file_map()->add(file);
 }
 
 int gkfs_create(const std::string& path, mode_t mode) {
+    int data_host;
+    gkfs::metadata::Layout layout{};
+    return gkfs_create(path, mode, data_host, layout);
+}
+
+/**
+ * Creates a file system node
+ * @param path
+ * @param mode
+ * @param data_host set to the host that will hold all chunks of a new regular file or NO_DATA_HOST
+ * @param layout set to the chunk layout of the new node, inherited from its parent directory
+ * @return 0 on success, -1 on error with errno set
+ */
+int gkfs_create(const std::string& path, mode_t mode, int& data_host, gkfs::metadata::Layout& layout) {
 
     //file type must be set
     switch (mode & S_IFMT) {
@@ -194,10 +276,12 @@ int gkfs_create(const std::string& path, mode_t mode) {
             return -1;
     }
 
-    if (check_parent_dir(path)) {
+    layout = {};
+    if (check_parent_dir(path, layout)) {
         return -1;
     }
-    return gkfs::rpc::forward_create(path, mode);
+    data_host = S_ISREG(mode) ? choose_data_host() : gkfs::metadata::NO_DATA_HOST;
+    return gkfs::rpc::forward_create(path, mode, data_host, layout);
 }
 
 /**
@@ -210,8 +294,9 @@ int gkfs_remove(const std::string& path) {
     if (!md) {
         return -1;
     }
-    bool has_data = S_ISREG(md->mode()) && (md->size() != 0);
-    return gkfs::rpc::forward_remove(path, !has_data, md->size());
+    // the content of inline files is removed with their metadentry
+    bool has_data = S_ISREG(md->mode()) && (md->size() != 0) && !md->stored_inline();
+    return gkfs::rpc::forward_remove(path, !has_data, md->size(), md->data_host(), md->layout());
 }
 
 int gkfs_access(const std::string& path, const int mask, bool follow_links) {
@@ -271,7 +356,7 @@ int gkfs_statx(int dirfs, const std::string& path, int flags, unsigned int mask,
 #endif
 
 int gkfs_statfs(struct statfs* buf) {
-    auto blk_stat = gkfs::rpc::forward_get_chunk_stat();
+    auto blk_stat = gkfs::rpc::cached_chunk_stat();
     buf->f_type = 0;
     buf->f_bsize = blk_stat.chunk_size;
     buf->f_blocks = blk_stat.chunk_total;
@@ -289,7 +374,7 @@ int gkfs_statfs(struct statfs* buf) {
 
 int gkfs_statvfs(struct statvfs* buf) {
     gkfs::preload::init_ld_env_if_needed();
-    auto blk_stat = gkfs::rpc::forward_get_chunk_stat();
+    auto blk_stat = gkfs::rpc::cached_chunk_stat();
     buf->f_bsize = blk_stat.chunk_size;
     buf->f_blocks = blk_stat.chunk_total;
     buf->f_bfree = blk_stat.chunk_free;
@@ -320,9 +405,8 @@ off_t gkfs_lseek(shared_ptr<gkfs::filemap::OpenFile> gkfs_fd, off_t offset, unsi
         case SEEK_END: {
             off64_t file_size;
             auto err = gkfs::rpc::forward_get_metadentry_size(gkfs_fd->path(), file_size);
-          
             if (err < 0) {
-                errno = err; // Negative numbers are explicitly for error codes
+                // errno is set
                 return -1;
             }
             
@@ -333,16 +417,35 @@ off_t gkfs_lseek(shared_ptr<gkfs::filemap::OpenFile> gkfs_fd, off_t offset, unsi
             gkfs_fd->pos(file_size + offset);
             break;
         }
-        case SEEK_DATA:
-            LOG(WARNING, "SEEK_DATA whence is not supported");
-            // We do not support this whence yet
-            errno = EINVAL;
-            return -1;
-        case SEEK_HOLE:
-            LOG(WARNING, "SEEK_HOLE whence is not supported");
-            // We do not support this whence yet
-            errno = EINVAL;
-            return -1;
+        case SEEK_DATA: // intentionally fall-through
+        case SEEK_HOLE: {
+            if (offset < 0) {
+                errno = EINVAL;
+                return -1;
+            }
+            off64_t file_size;
+            auto err = gkfs::rpc::forward_get_metadentry_size(gkfs_fd->path(), file_size);
+            if (err < 0) {
+                return -1;
+            }
+            if (offset >= file_size) {
+                errno = ENXIO;
+                return -1;
+            }
+            off64_t pos;
+            if (gkfs_fd->stored_inline()) {
+                // inline files have no holes
+                pos = (whence == SEEK_DATA) ? offset : file_size;
+            } else {
+                pos = gkfs::rpc::forward_seek_data(gkfs_fd->path(), offset, file_size, whence,
+                                                   gkfs_fd->data_host(), gkfs_fd->layout());
+                if (pos < 0) {
+                    return -1;
+                }
+            }
+            gkfs_fd->pos(pos);
+            break;
+        }
         default:
             LOG(WARNING, "Unknown whence value {:#x}", whence);
             errno = EINVAL;
@@ -351,7 +454,8 @@ off_t gkfs_lseek(shared_ptr<gkfs::filemap::OpenFile> gkfs_fd, off_t offset, unsi
     return gkfs_fd->pos();
 }
 
-int gkfs_truncate(const std::string& path, off_t old_size, off_t new_size) {
+int gkfs_truncate(const std::string& path, off_t old_size, off_t new_size, int data_host,
+                  const gkfs::metadata::Layout& layout, bool stored_inline) {
     assert(new_size >= 0);
     assert(new_size <= old_size);
 
@@ -364,7 +468,8 @@ int gkfs_truncate(const std::string& path, off_t old_size, off_t new_size) {
         return -1;
     }
 
-    if (gkfs::rpc::forward_truncate(path, old_size, new_size)) {
+    // decreasing the size already cut the inline data
+    if (!stored_inline && gkfs::rpc::forward_truncate(path, old_size, new_size, data_host, layout)) {
         LOG(DEBUG, "Failed to truncate data");
         return -1;
     }
@@ -396,7 +501,7 @@ int gkfs_truncate(const std::string& path, off_t length) {
         errno = EINVAL;
         return -1;
     }
-    return gkfs_truncate(path, size, length);
+    return gkfs_truncate(path, size, length, md->data_host(), md->layout(), md->stored_inline());
 }
 
 int gkfs_dup(const int oldfd) {
@@ -407,7 +512,18 @@ int gkfs_dup2(const int oldfd, const int newfd) {
     return CTX->file_map()->dup2(oldfd, newfd);
 }
 
-ssize_t gkfs_pwrite(std::shared_ptr<gkfs::filemap::OpenFile> file, const char* buf, size_t count, off64_t offset) {
+/**
+ * Writes count bytes at offset, or at the end of the file if it was opened with O_APPEND. Like on Linux, the offset
+ * is then ignored also by pwrite(). Concurrent appends get disjoint ranges, which the metadata daemon reserves
+ * @param file
+ * @param buf
+ * @param count
+ * @param offset
+ * @param write_offset (return val) offset the data was written at
+ * @return written size or -1 as error
+ */
+ssize_t gkfs_pwrite(std::shared_ptr<gkfs::filemap::OpenFile> file, const char* buf, size_t count, off64_t offset,
+                    off64_t& write_offset) {
     if (file->type() != gkfs::filemap::FileType::regular) {
         assert(file->type() == gkfs::filemap::FileType::directory);
         LOG(WARNING, "Cannot read from directory");
@@ -418,22 +534,68 @@ ssize_t gkfs_pwrite(std::shared_ptr<gkfs::filemap::OpenFile> file, const char* b
     auto append_flag = file->get_flag(gkfs::filemap::OpenFile_flags::append);
     ssize_t ret = 0;
     long updated_size = 0;
+    write_offset = offset;
 
-    ret = gkfs::rpc::forward_update_metadentry_size(*path, count, offset, append_flag, updated_size);
+    if (file->stored_inline() && count > 0) {
+        bool stored_inline = true;
+        ret = gkfs::rpc::forward_write_inline(*path, buf, offset, count, append_flag, stored_inline, write_offset);
+        if (ret >= 0 && stored_inline) {
+            return ret;
+        }
+        if (ret < 0 && errno != EFBIG) {
+            LOG(WARNING, "gkfs::rpc::forward_write_inline() failed with ret {}", ret);
+            return ret;
+        }
+        if (ret < 0 && promote_inline(*path)) {
+            return -1;
+        }
+        // the file is stored in chunks from now on
+        file->stored_inline(false);
+    }
+
+    if (append_flag) {
+        if (count == 0) {
+            return 0;
+        }
+        // the offset of an append is only known from the size update's reply, which holds the end of the range
+        // reserved for it
+        ret = gkfs::rpc::forward_update_metadentry_size(*path, count, offset, append_flag, updated_size);
+        if (ret != 0) {
+            LOG(ERROR, "update_metadentry_size() failed with ret {}", ret);
+            return ret; // ERR
+        }
+        write_offset = updated_size - count;
+        ret = gkfs::rpc::forward_write(*path, buf, append_flag, offset, count, updated_size, file->data_host(),
+                                        file->layout());
+        if (ret < 0) {
+            LOG(WARNING, "gkfs::rpc::forward_write() failed with ret {}", ret);
+        }
+        return ret; // return written size or -1 as error
+    }
+
+    // otherwise the size update is in flight while the data is transferred, saving a round trip on small writes
+    ssize_t written = 0;
+    int write_errno = 0;
+    ret = gkfs::rpc::forward_update_metadentry_size(*path, count, offset, append_flag, updated_size, [&]() {
+        written = gkfs::rpc::forward_write(*path, buf, append_flag, offset, count, offset + count,
+                                           file->data_host(), file->layout());
+        write_errno = errno;
+    });
     if (ret != 0) {
         LOG(ERROR, "update_metadentry_size() failed with ret {}", ret);
         return ret; // ERR
     }
-    ret = gkfs::rpc::forward_write(*path, buf, append_flag, offset, count, updated_size);
-    if (ret < 0) {
-        LOG(WARNING, "gkfs::rpc::forward_write() failed with ret {}", ret);
+    if (written < 0) {
+        LOG(WARNING, "gkfs::rpc::forward_write() failed with ret {}", written);
+        errno = write_errno;
     }
-    return ret; // return written size or -1 as error
+    return written; // return written size or -1 as error
 }
 
 ssize_t gkfs_pwrite_ws(int fd, const void* buf, size_t count, off64_t offset) {
     auto file = CTX->file_map()->get(fd);
-    return gkfs_pwrite(file, reinterpret_cast<const char*>(buf), count, offset);
+    off64_t write_offset;
+    return gkfs_pwrite(file, reinterpret_cast<const char*>(buf), count, offset, write_offset);
 }
 
 /* Write counts bytes starting from current file position
@@ -444,29 +606,50 @@ ssize_t gkfs_pwrite_ws(int fd, const void* buf, size_t count, off64_t offset) {
 ssize_t gkfs_write(int fd, const void* buf, size_t count) {
     auto gkfs_fd = CTX->file_map()->get(fd);
     auto pos = gkfs_fd->pos(); //retrieve the current offset
-    if (gkfs_fd->get_flag(gkfs::filemap::OpenFile_flags::append))
-        gkfs_lseek(gkfs_fd, 0, SEEK_END);
-    auto ret = gkfs_pwrite(gkfs_fd, reinterpret_cast<const char*>(buf), count, pos);
-    // Update offset in file descriptor in the file map
+    off64_t write_offset;
+    auto ret = gkfs_pwrite(gkfs_fd, reinterpret_cast<const char*>(buf), count, pos, write_offset);
+    // Update offset in file descriptor in the file map. An append moves it behind the appended data
     if (ret > 0) {
-        gkfs_fd->pos(pos + count);
+        gkfs_fd->pos(write_offset + ret);
     }
     return ret;
 }
 
-ssize_t gkfs_pwritev(int fd, const struct iovec* iov, int iovcnt, off_t offset) {
+/**
+ * Writes the buffers of iov one after another at offset. With O_APPEND, they are gathered and appended at once, so
+ * that the data of concurrent appenders does not interleave
+ * @param file
+ * @param iov
+ * @param iovcnt
+ * @param offset
+ * @param write_offset (return val) offset the data was written at
+ * @return written size or -1 as error
+ */
+ssize_t gkfs_pwritev(std::shared_ptr<gkfs::filemap::OpenFile> file, const struct iovec* iov, int iovcnt,
+                     off64_t offset, off64_t& write_offset) {
+
+    write_offset = offset;
+    if (file->get_flag(gkfs::filemap::OpenFile_flags::append)) {
+        string data;
+        for (int i = 0; i < iovcnt; ++i) {
+            data.append(reinterpret_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+        }
+        if (!data.empty()) {
+            return gkfs_pwrite(file, data.data(), data.size(), offset, write_offset);
+        }
+    }
 
-    auto file = CTX->file_map()->get(fd);
     auto pos = offset; // keep track of current position
     ssize_t written = 0;
     ssize_t ret;
+    off64_t iov_offset;
     for (int i = 0; i < iovcnt; ++i) {
         auto count = (iov + i)->iov_len;
         if (count == 0) {
             continue;
         }
         auto buf = (iov + i)->iov_base;
-        ret = gkfs_pwrite(file, reinterpret_cast<char*>(buf), count, pos);
+        ret = gkfs_pwrite(file, reinterpret_cast<char*>(buf), count, pos, iov_offset);
         if (ret == -1) {
             break;
         }
@@ -484,16 +667,22 @@ ssize_t gkfs_pwritev(int fd, const struct iovec* iov, int iovcnt, off_t offset)
     return written;
 }
 
+ssize_t gkfs_pwritev(int fd, const struct iovec* iov, int iovcnt, off_t offset) {
+    off64_t write_offset;
+    return gkfs_pwritev(CTX->file_map()->get(fd), iov, iovcnt, offset, write_offset);
+}
+
 ssize_t gkfs_writev(int fd, const struct iovec* iov, int iovcnt) {
 
     auto gkfs_fd = CTX->file_map()->get(fd);
     auto pos = gkfs_fd->pos(); // retrieve the current offset
-    auto ret = gkfs_pwritev(fd, iov, iovcnt, pos);
+    off64_t write_offset;
+    auto ret = gkfs_pwritev(gkfs_fd, iov, iovcnt, pos, write_offset);
     assert(ret != 0);
     if (ret < 0) {
         return -1;
     }
-    gkfs_fd->pos(pos + ret);
+    gkfs_fd->pos(write_offset + ret);
     return ret;
 }
 
@@ -505,15 +694,24 @@ ssize_t gkfs_pread(std::shared_ptr<gkfs::filemap::OpenFile> file, char* buf, siz
         return -1;
     }
 
-    // Zeroing buffer before read is only relevant for sparse files. Otherwise sparse regions contain invalid data.
-    if (gkfs::config::io::zero_buffer_before_read) {
-        memset(buf, 0, sizeof(char) * count);
+    if (file->stored_inline() && count > 0) {
+        bool stored_inline = true;
+        auto ret = gkfs::rpc::forward_read_inline(file->path(), buf, offset, count, stored_inline);
+        if (ret < 0) {
+            LOG(WARNING, "gkfs::rpc::forward_read_inline() failed with ret {}", ret);
+        }
+        if (ret < 0 || stored_inline) {
+            return ret;
+        }
+        // another process moved the file to chunks
+        file->stored_inline(false);
     }
-    auto ret = gkfs::rpc::forward_read(file->path(), buf, offset, count);
+
+    // holes are returned as zeros and the read stops at the end of the file
+    auto ret = gkfs::rpc::forward_read(file->path(), buf, offset, count, file->data_host(), file->layout());
     if (ret < 0) {
         LOG(WARNING, "gkfs::rpc::forward_read() failed with ret {}", ret);
     }
-    // XXX check that we don't try to read past end of the file
     return ret; // return read size or -1 as error
 }
 
@@ -612,7 +810,7 @@ int gkfs_rmdir(const std::string& path) {
         errno = ENOTEMPTY;
         return -1;
     }
-    return gkfs::rpc::forward_remove(path, true, 0);
+    return gkfs::rpc::forward_remove(path, true, 0, gkfs::metadata::NO_DATA_HOST, md->layout());
 }
 
 int gkfs_getdents(unsigned int fd,
@@ -735,6 +933,67 @@ int gkfs_getdents64(unsigned int fd,
     return written;
 }
 
+/**
+ * Sets the chunk layout of a directory or an empty regular file through config::metadata::layout_xattr, e.g.,
+ * "chunk_size=4M,stripe_width=8". Files and directories created in a directory inherit its layout. Other extended
+ * attributes are not supported
+ * @return 0 on success, -1 on error with errno set
+ */
+int gkfs_setxattr(const std::string& path, const std::string& name, const void* value, size_t size, int flags) {
+    if (name != gkfs::config::metadata::layout_xattr) {
+        LOG(DEBUG, "{}() Unsupported extended attribute '{}'", __func__, name);
+        errno = ENOTSUP;
+        return -1;
+    }
+    auto md = gkfs::util::get_metadata(path);
+    if (!md) {
+        return -1;
+    }
+    if (flags & XATTR_CREATE) {
+        // every entry has a layout, the default one if it was never set
+        errno = EEXIST;
+        return -1;
+    }
+    gkfs::metadata::Layout layout{};
+    try {
+        layout = gkfs::metadata::layout_from_string(std::string(static_cast<const char*>(value), size));
+        gkfs::metadata::check_layout(layout);
+    } catch (const std::invalid_argument& e) {
+        LOG(DEBUG, "{}() Invalid layout for '{}': {}", __func__, path, e.what());
+        errno = EINVAL;
+        return -1;
+    }
+    md->layout(layout);
+    gkfs::metadata::MetadentryUpdateFlags md_flags{};
+    md_flags.layout = true;
+    return gkfs::rpc::forward_update_metadentry(path, *md, md_flags);
+}
+
+/**
+ * Reads the chunk layout of an entry through config::metadata::layout_xattr
+ * @return length of the value, or -1 on error with errno set
+ */
+ssize_t gkfs_getxattr(const std::string& path, const std::string& name, void* value, size_t size) {
+    if (name != gkfs::config::metadata::layout_xattr) {
+        LOG(DEBUG, "{}() Unsupported extended attribute '{}'", __func__, name);
+        errno = ENODATA;
+        return -1;
+    }
+    auto md = gkfs::util::get_metadata(path);
+    if (!md) {
+        return -1;
+    }
+    auto layout = gkfs::metadata::to_string(md->layout());
+    if (size == 0) {
+        return layout.size();
+    }
+    if (size < layout.size()) {
+        errno = ERANGE;
+        return -1;
+    }
+    layout.copy(static_cast<char*>(value), layout.size());
+    return layout.size();
+}
 
 #ifdef HAS_SYMLINKS
 
@@ -756,7 +1015,9 @@ int gkfs_mk_symlink(const std::string& path, const std::string& target_path) {
         }
     }
 
-    if (check_parent_dir(path)) {
+    // symlinks have no chunks
+    gkfs::metadata::Layout layout{};
+    if (check_parent_dir(path, layout)) {
         return -1;
     }
 
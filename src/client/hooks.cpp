@@ -814,5 +814,31 @@ int hook_fstatfs(unsigned int fd, struct statfs* buf) {
     return syscall_no_intercept(SYS_fstatfs, fd, buf);
 }
 
+int hook_setxattr(const char* path, const char* name, const void* value, size_t size, int flags,
+                  bool follow_links) {
+
+    LOG(DEBUG, "{}() called with path: \"{}\", name: \"{}\", value: {}, size: {}, flags: {}, follow_links: {}",
+        __func__, path, name, fmt::ptr(value), size, flags, follow_links);
+
+    std::string rel_path;
+    if (CTX->relativize_path(path, rel_path, follow_links)) {
+        return with_errno(gkfs::syscall::gkfs_setxattr(rel_path, name, value, size, flags));
+    }
+    return syscall_no_intercept(follow_links ? SYS_setxattr : SYS_lsetxattr, rel_path.c_str(), name, value, size,
+                                flags);
+}
+
+int hook_getxattr(const char* path, const char* name, void* value, size_t size, bool follow_links) {
+
+    LOG(DEBUG, "{}() called with path: \"{}\", name: \"{}\", value: {}, size: {}, follow_links: {}",
+        __func__, path, name, fmt::ptr(value), size, follow_links);
+
+    std::string rel_path;
+    if (CTX->relativize_path(path, rel_path, follow_links)) {
+        return with_errno(gkfs::syscall::gkfs_getxattr(rel_path, name, value, size));
+    }
+    return syscall_no_intercept(follow_links ? SYS_getxattr : SYS_lgetxattr, rel_path.c_str(), name, value, size);
+}
+
 } // namespace hook
 } // namespace gkfs
@@ -15,6 +15,8 @@
 #include <client/preload.hpp>
 #include <client/hooks.hpp>
 #include <client/logging.hpp>
+#include <client/trace.hpp>
+#include <client/rpc/registration_cache.hpp>
 
 #include <boost/optional.hpp>
 #include <fmt/format.h>
@@ -26,6 +28,7 @@ extern "C" {
 #include <libsyscall_intercept_hook_point.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/mman.h>
 #include <printf.h>
 }
 
@@ -726,7 +729,63 @@ int hook(long syscall_number,
                                               reinterpret_cast<struct statfs*>(arg1));
             break;
 
+        // only the chunk layout is supported as extended attribute
+        case SYS_setxattr:
+        case SYS_lsetxattr:
+            *result = gkfs::hook::hook_setxattr(reinterpret_cast<const char*>(arg0),
+                                                reinterpret_cast<const char*>(arg1),
+                                                reinterpret_cast<const void*>(arg2),
+                                                static_cast<size_t>(arg3),
+                                                static_cast<int>(arg4),
+                                                syscall_number == SYS_setxattr);
+            break;
+
+        case SYS_getxattr:
+        case SYS_lgetxattr:
+            *result = gkfs::hook::hook_getxattr(reinterpret_cast<const char*>(arg0),
+                                                reinterpret_cast<const char*>(arg1),
+                                                reinterpret_cast<void*>(arg2),
+                                                static_cast<size_t>(arg3),
+                                                syscall_number == SYS_getxattr);
+            break;
+
+        // memory that is unmapped must not stay registered for RDMA. These
+        // syscalls are still executed by the kernel
+        case SYS_munmap:
+        case SYS_mremap:
+            gkfs::rpc::invalidate_registrations(reinterpret_cast<const void*>(arg0),
+                                                static_cast<size_t>(arg1));
+            goto forward;
+
+        case SYS_brk:
+            if (arg0 != 0) {
+                auto cur_brk = syscall_no_intercept(SYS_brk, 0);
+                if (arg0 < cur_brk) {
+                    gkfs::rpc::invalidate_registrations(reinterpret_cast<const void*>(arg0),
+                                                        static_cast<size_t>(cur_brk - arg0));
+                }
+            }
+            goto forward;
+
+        // these advices drop the pages of the range, registrations of it
+        // would keep pinning the old ones
+        case SYS_madvise:
+            switch (static_cast<int>(arg2)) {
+                case MADV_DONTNEED:
+#ifdef MADV_FREE
+                case MADV_FREE:
+#endif
+                case MADV_REMOVE:
+                    gkfs::rpc::invalidate_registrations(reinterpret_cast<const void*>(arg0),
+                                                        static_cast<size_t>(arg1));
+                    break;
+                default:
+                    break;
+            }
+            goto forward;
+
         default:
+        forward:
             // ignore any other syscalls, i.e.: pass them on to the kernel
             // (syscalls forwarded to the kernel that return are logged in 
             // hook_forwarded_syscall())
@@ -893,9 +952,16 @@ hook_guard_wrapper(long syscall_number,
 
     reentrance_guard_flag = true;
     int oerrno = errno;
+    const auto trace_start = gkfs::trace::enabled() ? gkfs::trace::now() : 0;
     was_hooked = ::hook(syscall_number,
                         arg0, arg1, arg2, arg3, arg4, arg5,
                         syscall_return_value);
+    if (trace_start != 0 && was_hooked == gkfs::syscall::hooked) {
+        const long args[gkfs::syscall::MAX_ARGS] = {
+                arg0, arg1, arg2, arg3, arg4, arg5
+        };
+        gkfs::trace::record(syscall_number, args, *syscall_return_value, trace_start, gkfs::trace::now());
+    }
     errno = oerrno;
     reentrance_guard_flag = false;
 
@@ -45,6 +45,20 @@ OpenFile::OpenFile(const string& path, const int flags, FileType type) :
         flags_[gkfs::util::to_underlying(OpenFile_flags::rdwr)] = true;
 
     pos_ = 0; // If O_APPEND flag is used, it will be used before each write.
+    data_host_ = gkfs::metadata::NO_DATA_HOST;
+    stored_inline_ = false;
+
+    auto distributor = CTX->distributor();
+    gkfs::rpc::host_t host;
+    if (type_ == FileType::regular && distributor && distributor->pin_file(path_, host)) {
+        pinned_distributor_ = distributor;
+    }
+}
+
+OpenFile::~OpenFile() {
+    if (pinned_distributor_) {
+        pinned_distributor_->unpin_file(path_);
+    }
 }
 
 OpenFileMap::OpenFileMap() :
@@ -83,6 +97,30 @@ FileType OpenFile::type() const {
     return type_;
 }
 
+int OpenFile::data_host() const {
+    return data_host_;
+}
+
+void OpenFile::data_host(int data_host) {
+    OpenFile::data_host_ = data_host;
+}
+
+const gkfs::metadata::Layout& OpenFile::layout() const {
+    return layout_;
+}
+
+void OpenFile::layout(const gkfs::metadata::Layout& layout) {
+    OpenFile::layout_ = layout;
+}
+
+bool OpenFile::stored_inline() const {
+    return stored_inline_;
+}
+
+void OpenFile::stored_inline(bool stored_inline) {
+    OpenFile::stored_inline_ = stored_inline;
+}
+
 // OpenFileMap starts here
 
 shared_ptr<OpenFile> OpenFileMap::get(int fd) {
@@ -14,18 +14,27 @@
 #include <client/preload.hpp>
 #include <client/path.hpp>
 #include <client/logging.hpp>
+#include <client/trace.hpp>
 #include <client/rpc/forward_management.hpp>
+#include <client/rpc/forward_data.hpp>
+#include <client/rpc/rpc_wait.hpp>
+#include <client/rpc/registration_cache.hpp>
+#include <client/rpc/shm_region.hpp>
 #include <client/preload_util.hpp>
 #include <client/intercept.hpp>
+#include <client/env.hpp>
 
+#include <global/env_util.hpp>
 #include <global/rpc/distributor.hpp>
 
 #include <fstream>
+#include <chrono>
 
 #include <hermes.hpp>
 
 extern "C" {
 #include <sys/types.h>
+#include <sys/stat.h>
 }
 
 using namespace std;
@@ -36,14 +45,27 @@ namespace {
 // make sure that things are only initialized once
 pthread_once_t init_env_thread = PTHREAD_ONCE_INIT;
 
+// cached RDMA registrations of user buffers, unset if disabled
+unique_ptr<gkfs::rpc::RegistrationCache> registration_cache;
+
 #ifdef GKFS_ENABLE_FORWARDING
 pthread_t mapper;
 bool forwarding_running;
 
-pthread_mutex_t remap_mutex;
-pthread_cond_t remap_signal;
+pthread_mutex_t remap_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t remap_signal = PTHREAD_COND_INITIALIZER;
+
+// forwarders of this node as listed in the forwarding map
+std::vector<uint64_t> fwd_hosts;
 #endif
 
+shared_ptr<hermes::exposed_memory> expose_memory(void* buf, size_t size, hermes::access_mode mode) {
+    vector<hermes::mutable_buffer> bufseq{
+            hermes::mutable_buffer{buf, size},
+    };
+    return make_shared<hermes::exposed_memory>(ld_network_service->expose(bufseq, mode));
+}
+
 inline void exit_error_msg(int errcode, const string& msg) {
 
     LOG_ERROR("{}", msg);
@@ -84,6 +106,31 @@ bool init_hermes_client(const std::string& transport_prefix) {
     return true;
 }
 
+#ifdef GKFS_ENABLE_FORWARDING
+/**
+ * Creates the distributor for the given forwarders. With more than one forwarder each file is
+ * assigned to the less loaded of two randomly chosen forwarders or, with LIBGKFS_FORWARDING_MODE=stripe,
+ * the chunks of each file are striped across all of them
+ * @param forwarders
+ * @return
+ */
+std::shared_ptr<gkfs::rpc::Distributor> make_forwarder_distributor(const std::vector<uint64_t>& forwarders) {
+    if (forwarders.size() == 1) {
+        return std::make_shared<gkfs::rpc::ForwarderDistributor>(forwarders.front(), CTX->hosts().size());
+    }
+    std::vector<gkfs::rpc::host_t> candidates(forwarders.begin(), forwarders.end());
+    auto mode = gkfs::env::get_var(gkfs::env::FORWARDING_MODE, "load");
+    if (mode == "stripe") {
+        return std::make_shared<gkfs::rpc::StripedForwarderDistributor>(candidates, CTX->hosts().size());
+    }
+    if (mode != "load") {
+        LOG(WARNING, "{}() Unknown forwarding mode '{}'. Using 'load'", __func__, mode);
+    }
+    return std::make_shared<gkfs::rpc::DynamicForwarderDistributor>(candidates, CTX->hosts().size(),
+                                                                    gkfs::rpc::choose_forwarder);
+}
+#endif
+
 /**
  * This function is only called in the preload constructor and initializes 
  * the file system client
@@ -104,58 +151,114 @@ void init_ld_environment_() {
         exit_error_msg(EXIT_FAILURE, "Failed to load hosts addresses: "s + e.what());
     }
 
-    /* Setup distributor */
+    gkfs::rpc::init_rpc_wait(CTX->hosts().size());
+    gkfs::rpc::init_registration_cache();
+    gkfs::rpc::init_shm_region();
+    gkfs::rpc::init_chunk_stat_cache();
+
+    LOG(INFO, "Retrieving file system configuration...");
+
+    if (!gkfs::rpc::forward_get_fs_config()) {
+        exit_error_msg(EXIT_FAILURE, "Unable to fetch file system configurations from daemon process through RPC.");
+    }
+
+    /* Setup distributor. The placement function must match the daemons' */
     #ifdef GKFS_ENABLE_FORWARDING
     try {
-        gkfs::util::load_forwarding_map();
+        fwd_hosts = gkfs::util::read_forwarding_hosts();
+        CTX->fwd_host_id(fwd_hosts.front());
 
-        LOG(INFO, "{}() Forward to {}", __func__, CTX->fwd_host_id());
+        LOG(INFO, "{}() Forward to {} ({} forwarder(s))", __func__, CTX->fwd_host_id(), fwd_hosts.size());
     } catch (std::exception& e){
         exit_error_msg(EXIT_FAILURE, fmt::format("Unable set the forwarding host '{}'", e.what()));
     }
     
-    auto forwarder_dist = std::make_shared<gkfs::rpc::ForwarderDistributor>(CTX->fwd_host_id(), CTX->hosts().size());
-    CTX->distributor(forwarder_dist);
+    CTX->distributor(make_forwarder_distributor(fwd_hosts));
     #else
-    auto simple_hash_dist = std::make_shared<gkfs::rpc::SimpleHashDistributor>(CTX->local_host_id(),
-                                                                               CTX->hosts().size());
-    CTX->distributor(simple_hash_dist);
+    auto hash_dist = gkfs::rpc::make_hash_distributor(CTX->fs_conf()->distributor, CTX->local_host_id(),
+                                                      CTX->hosts().size());
+    CTX->distributor(hash_dist);
     #endif
 
-    LOG(INFO, "Retrieving file system configuration...");
+    LOG(INFO, "Environment initialization successful.");
+}
 
-    if (!gkfs::rpc::forward_get_fs_config()) {
-        exit_error_msg(EXIT_FAILURE, "Unable to fetch file system configurations from daemon process through RPC.");
+#ifdef GKFS_ENABLE_FORWARDING
+/**
+ * Checks whether the forwarding map file was modified or replaced since the last call
+ * without reading its content
+ * @param path
+ * @param last file status of the last call, updated
+ * @return
+ */
+bool forwarding_map_changed(const string& path, struct stat& last) {
+    struct stat st{};
+    if (stat(path.c_str(), &st) != 0) {
+        // the file may be in the middle of being replaced. Keep the current mapping
+        return false;
     }
+    bool changed = st.st_ino != last.st_ino || st.st_size != last.st_size ||
+                   st.st_mtim.tv_sec != last.st_mtim.tv_sec || st.st_mtim.tv_nsec != last.st_mtim.tv_nsec;
+    last = st;
+    return changed;
+}
 
-    LOG(INFO, "Environment initialization successful.");
+/**
+ * Re-reads the forwarding map and switches to the new forwarder once all data operations
+ * in flight to the old one have finished
+ */
+void remap_forwarder() {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uint64_t> new_fwd_hosts;
+    try {
+        new_fwd_hosts = gkfs::util::read_forwarding_hosts();
+    } catch (const std::exception& e) {
+        LOG(ERROR, "{}() Keeping forwarder {}: {}", __func__, CTX->fwd_host_id(), e.what());
+        return;
+    }
+    auto parsed = std::chrono::steady_clock::now();
+
+    auto old_host = CTX->fwd_host_id();
+    if (new_fwd_hosts != fwd_hosts) {
+        CTX->distributors().switch_distributor(make_forwarder_distributor(new_fwd_hosts));
+        CTX->fwd_host_id(new_fwd_hosts.front());
+        fwd_hosts = new_fwd_hosts;
+    }
+    auto switched = std::chrono::steady_clock::now();
+
+    LOG(INFO, "{}() Forward to {} (was {}). Parsing took {} us, draining and switching {} us", __func__,
+        CTX->fwd_host_id(), old_host,
+        std::chrono::duration_cast<std::chrono::microseconds>(parsed - start).count(),
+        std::chrono::duration_cast<std::chrono::microseconds>(switched - parsed).count());
 }
 
-#ifdef GKFS_ENABLE_FORWARDING
 void *forwarding_mapper(void* p) {
-    struct timespec timeout;
-    clock_gettime(CLOCK_REALTIME, &timeout);
-    timeout.tv_sec += 10; // 10 seconds
-
-    int previous = -1;
+    auto map_file = gkfs::env::get_var(gkfs::env::FORWARDING_MAP_FILE, gkfs::config::forwarding_file_path);
+    struct stat last{};
+    // the map was loaded during initialization
+    forwarding_map_changed(map_file, last);
 
+    pthread_mutex_lock(&remap_mutex);
     while (forwarding_running) {
-        try {
-            gkfs::util::load_forwarding_map();
-
-            if (previous != CTX->fwd_host_id()) {
-                LOG(INFO, "{}() Forward to {}", __func__, CTX->fwd_host_id());
+        struct timespec timeout;
+        clock_gettime(CLOCK_REALTIME, &timeout);
+        timeout.tv_sec += gkfs::config::forwarding_map_check_interval;
+
+        // only shutdown wakes us up early
+        while (forwarding_running &&
+               pthread_cond_timedwait(&remap_signal, &remap_mutex, &timeout) != ETIMEDOUT);
+        if (!forwarding_running) {
+            break;
+        }
+        pthread_mutex_unlock(&remap_mutex);
 
-                previous = CTX->fwd_host_id();
-            }
-        } catch (std::exception& e) {
-            exit_error_msg(EXIT_FAILURE, fmt::format("Unable set the forwarding host '{}'", e.what()));
+        if (forwarding_map_changed(map_file, last)) {
+            remap_forwarder();
         }
 
         pthread_mutex_lock(&remap_mutex);
-        pthread_cond_timedwait(&remap_signal, &remap_mutex, &timeout);
-        pthread_mutex_unlock(&remap_mutex);
     }
+    pthread_mutex_unlock(&remap_mutex);
 
     return nullptr;
 }
@@ -171,9 +274,10 @@ void init_forwarding_mapper() {
 
 #ifdef GKFS_ENABLE_FORWARDING
 void destroy_forwarding_mapper() {
+    pthread_mutex_lock(&remap_mutex);
     forwarding_running = false;
-
     pthread_cond_signal(&remap_signal);
+    pthread_mutex_unlock(&remap_mutex);
 
     pthread_join(mapper, NULL);
 }
@@ -205,6 +309,52 @@ void init_ld_env_if_needed() {
 }
 
 } // namespace preload
+
+namespace rpc {
+
+/**
+ * Sets up the registration cache with the budget from LIBGKFS_REGISTRATION_CACHE_SIZE. A budget of 0 disables it
+ */
+void init_registration_cache() {
+    auto budget_str = gkfs::env::get_var(gkfs::env::REGISTRATION_CACHE_SIZE,
+                                         std::to_string(gkfs::config::rpc::registration_cache_size));
+    size_t budget;
+    try {
+        budget = stoull(budget_str);
+    } catch (const exception& e) {
+        LOG(WARNING, "Ignoring invalid registration cache size '{}'", budget_str);
+        budget = gkfs::config::rpc::registration_cache_size;
+    }
+    if (budget > 0) {
+        registration_cache = make_unique<RegistrationCache>(budget, expose_memory);
+    }
+    LOG(INFO, "Registration cache budget: {} bytes", budget);
+}
+
+/**
+ * Drops all cached registrations. Must be called before the RPC engine is shut down
+ */
+void destroy_registration_cache() {
+    // keep the object, other threads may still unmap memory
+    if (registration_cache) {
+        registration_cache->clear();
+    }
+}
+
+shared_ptr<hermes::exposed_memory> expose_user_buffer(void* buf, size_t size, hermes::access_mode mode) {
+    if (registration_cache) {
+        return registration_cache->expose(buf, size, mode);
+    }
+    return expose_memory(buf, size, mode);
+}
+
+void invalidate_registrations(const void* addr, size_t size) {
+    if (registration_cache) {
+        registration_cache->invalidate(addr, size);
+    }
+}
+
+} // namespace rpc
 } // namespace gkfs
 
 /**
@@ -218,6 +368,7 @@ void init_preload() {
     CTX->init_logging();
     // from here ownwards it is safe to print messages
     LOG(DEBUG, "Logging subsystem initialized");
+    gkfs::trace::init();
 
     // Kernel modules such as ib_uverbs may create fds in kernel space and pass
     // them to user-space processes using ioctl()-like interfaces. if this 
@@ -249,13 +400,20 @@ void init_preload() {
  * Called last when preload library is used with the LD_PRELOAD environment variable
  */
 void destroy_preload() {
+    gkfs::trace::finalize();
+
     #ifdef GKFS_ENABLE_FORWARDING
     destroy_forwarding_mapper();
     #endif
 
+    gkfs::rpc::log_host_latencies();
+    gkfs::rpc::destroy_chunk_stat_cache();
+
     CTX->clear_hosts();
     LOG(DEBUG, "Peer information deleted");
 
+    gkfs::rpc::destroy_registration_cache();
+    gkfs::rpc::destroy_shm_region();
     ld_network_service.reset();
     LOG(DEBUG, "RPC subsystem shut down");
 
@@ -19,6 +19,7 @@
 
 #include <global/env_util.hpp>
 #include <global/path_util.hpp>
+#include <global/rpc/distributor.hpp>
 #include <config.hpp>
 
 #include <hermes.hpp>
@@ -199,11 +200,15 @@ const std::shared_ptr<gkfs::filemap::OpenFileMap>& PreloadContext::file_map() co
 }
 
 void PreloadContext::distributor(std::shared_ptr<gkfs::rpc::Distributor> d) {
-    distributor_ = d;
+    distributors_.distributor(d);
 }
 
 std::shared_ptr<gkfs::rpc::Distributor> PreloadContext::distributor() const {
-    return distributor_;
+    return distributors_.distributor();
+}
+
+DistributorSwitch& PreloadContext::distributors() {
+    return distributors_;
 }
 
 const std::shared_ptr<FsConfig>& PreloadContext::fs_conf() const {
@@ -110,7 +110,8 @@ int metadata_to_stat(const std::string& path, const gkfs::metadata::Metadata& md
     attr.st_uid = CTX->fs_conf()->uid;
     attr.st_gid = CTX->fs_conf()->gid;
     attr.st_rdev = 0;
-    attr.st_blksize = gkfs::config::rpc::chunksize;
+    // the preferred I/O size is a chunk of the file
+    attr.st_blksize = gkfs::metadata::chunk_size(md.layout());
     attr.st_blocks = 0;
 
     memset(&attr.st_atim, 0, sizeof(timespec));
@@ -177,7 +178,12 @@ vector<pair<string, string>> load_hostfile(const std::string& lfpath) {
 }
 
 #ifdef GKFS_ENABLE_FORWARDING
-map<string, uint64_t> load_forwarding_map_file(const std::string& lfpath) {
+/**
+ * Parses the forwarding map file. Each line holds a host name followed by one or more forwarder ids.
+ * @param lfpath
+ * @return map of host name to forwarder ids
+ */
+map<string, vector<uint64_t>> load_forwarding_map_file(const std::string& lfpath) {
 
     LOG(DEBUG, "Loading forwarding map file file: \"{}\"", lfpath);
 
@@ -186,12 +192,11 @@ map<string, uint64_t> load_forwarding_map_file(const std::string& lfpath) {
         throw runtime_error(fmt::format("Failed to open forwarding map file '{}': {}",
                             lfpath, strerror(errno)));
     }
-    map<string, uint64_t> forwarding_map;
-    const regex line_re("^(\\S+)\\s+(\\S+)$",
+    map<string, vector<uint64_t>> forwarding_map;
+    const regex line_re("^(\\S+)((\\s+\\d+)+)\\s*$",
                         regex::ECMAScript | regex::optimize);
     string line;
     string host;
-    uint64_t forwarder;
     std::smatch match;
     while (getline(lf, line)) {
         if (!regex_match(line, match, line_re)) {
@@ -203,42 +208,50 @@ map<string, uint64_t> load_forwarding_map_file(const std::string& lfpath) {
                     fmt::format("unrecognized line format: '{}'", line));
         }
         host = match[1];
-        forwarder = std::stoi(match[2].str());
-        forwarding_map[host] = forwarder;
+        istringstream forwarders(match[2].str());
+        vector<uint64_t> fwd_hosts;
+        uint64_t forwarder;
+        while (forwarders >> forwarder) {
+            fwd_hosts.push_back(forwarder);
+        }
+        forwarding_map[host] = fwd_hosts;
     }
     return forwarding_map;
 }
 #endif
 
 #ifdef GKFS_ENABLE_FORWARDING
-void load_forwarding_map() {
+/**
+ * Reads the forwarding map file and returns the forwarders of this node
+ * @return forwarder host ids, the first one is the default forwarder
+ */
+vector<uint64_t> read_forwarding_hosts() {
     string forwarding_map_file;
-    
+
     forwarding_map_file = gkfs::env::get_var(gkfs::env::FORWARDING_MAP_FILE, gkfs::config::forwarding_file_path);
 
-    map<string, uint64_t> forwarding_map;
+    map<string, vector<uint64_t>> forwarding_map;
 
-    while (forwarding_map.size() == 0) {
-        try {
-            forwarding_map = load_forwarding_map_file(forwarding_map_file);
-        } catch (const exception& e) {
-            auto emsg = fmt::format("Failed to load forwarding map file: {}", e.what());
-            throw runtime_error(emsg);
-        }
+    try {
+        forwarding_map = load_forwarding_map_file(forwarding_map_file);
+    } catch (const exception& e) {
+        auto emsg = fmt::format("Failed to load forwarding map file: {}", e.what());
+        throw runtime_error(emsg);
     }
 
-    //if (forwarding_map.size() == 0) {
-    //    throw runtime_error(fmt::format("Forwarding map file is empty: '{}'", forwarding_map_file));
-    //}
+    if (forwarding_map.size() == 0) {
+        throw runtime_error(fmt::format("Forwarding map file is empty: '{}'", forwarding_map_file));
+    }
 
     auto local_hostname = get_my_hostname(true);
 
     if (forwarding_map.find(local_hostname) == forwarding_map.end()) {
         throw runtime_error(fmt::format("Unable to determine the forwarder for host: '{}'", local_hostname));   
     }
-    LOG(INFO, "Forwarding map loaded for '{}' as '{}'", local_hostname, forwarding_map[local_hostname]);
+    LOG(INFO, "Forwarding map loaded for '{}' with {} forwarder(s)", local_hostname,
+        forwarding_map[local_hostname].size());
 
-    CTX->fwd_host_id(forwarding_map[local_hostname]);
+    return forwarding_map[local_hostname];
 }
 #endif
 
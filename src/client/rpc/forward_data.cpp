@@ -14,11 +14,26 @@
 #include <client/preload_util.hpp>
 #include <client/rpc/forward_data.hpp>
 #include <client/rpc/rpc_types.hpp>
+#include <client/rpc/rpc_wait.hpp>
+#include <client/rpc/transfer_buffer.hpp>
+#include <client/rpc/shm_region.hpp>
 #include <client/logging.hpp>
 
 #include <global/rpc/distributor.hpp>
 #include <global/chunk_calc_util.hpp>
+#include <global/metadata.hpp>
+#include <global/rpc/shm_region.hpp>
 
+#include <client/env.hpp>
+
+#include <global/env_util.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <numeric>
+#include <thread>
 #include <unordered_set>
 
 using namespace std;
@@ -26,6 +41,102 @@ using namespace std;
 namespace gkfs {
 namespace rpc {
 
+namespace {
+
+/**
+ * Pins the host a distributor chose for all data of a file while a request on it is in flight, so that the choice is
+ * neither forgotten nor made again until the request's chunks have been served. Resolved once per request
+ */
+class FilePin {
+private:
+    const Distributor& distributor_;
+    const string& path_;
+    host_t host_;
+    bool pinned_;
+
+public:
+    FilePin(const Distributor& distributor, const string& path) : distributor_(distributor), path_(path), host_(0) {
+        pinned_ = distributor_.pin_file(path_, host_);
+    }
+
+    ~FilePin() {
+        if (pinned_) {
+            distributor_.unpin_file(path_);
+        }
+    }
+
+    FilePin(const FilePin&) = delete;
+
+    FilePin& operator=(const FilePin&) = delete;
+
+    bool pinned() const {
+        return pinned_;
+    }
+
+    host_t host() const {
+        return host_;
+    }
+};
+
+/**
+ * Files with a data host (locality distributor) keep all their chunks on it,
+ * files whose layout has a stripe width spread them over that many hosts,
+ * files pinned to a host by the distributor have all their chunks there,
+ * all others are placed by the distributor.
+ * @param distributor
+ * @param pin
+ * @param path
+ * @param chnk_id
+ * @param data_host
+ * @param layout
+ * @return
+ */
+inline host_t locate_chunk(const Distributor& distributor, const FilePin& pin, const string& path, chunkid_t chnk_id,
+                           int data_host, const gkfs::metadata::Layout& layout) {
+    if (data_host != gkfs::metadata::NO_DATA_HOST)
+        return static_cast<host_t>(data_host);
+#ifndef GKFS_ENABLE_FORWARDING
+    // forwarders do not stripe by layout, they hash the chunks of all files
+    if (is_striped(layout.stripe_width, CTX->hosts().size()))
+        return locate_striped_data(path, chnk_id, layout.stripe_width, CTX->hosts().size());
+#endif
+    if (pin.pinned())
+        return pin.host();
+    return distributor.locate_data(path, chnk_id);
+}
+
+/**
+ * Part [begin, end) of the user buffer of a request at offset of size that holds the given chunks
+ */
+inline pair<uint64_t, uint64_t> chunk_span(const vector<uint64_t>& chnks, const off64_t offset, const size_t size,
+                                           const uint64_t chunksize) {
+    auto begin = max<uint64_t>(offset, chnks.front() * chunksize) - offset;
+    auto end = min<uint64_t>(offset + size, (chnks.back() + 1) * chunksize) - offset;
+    return {begin, end};
+}
+
+/**
+ * Copies the given chunks of a request between the user buffer and the shared memory, which holds them as laid out in
+ * the buffer from span_begin on. Only the part of the buffer before buf_end is copied
+ */
+void copy_shm_chunks(const vector<uint64_t>& chnks, const off64_t offset, const uint64_t buf_end,
+                     const uint64_t chunksize, char* buf, char* shm, const uint64_t span_begin, const bool to_shm) {
+    for (auto chnk_id : chnks) {
+        auto begin = max<uint64_t>(offset, chnk_id * chunksize) - offset;
+        auto end = min<uint64_t>(buf_end, (chnk_id + 1) * chunksize - offset);
+        if (begin >= end) {
+            continue;
+        }
+        if (to_shm) {
+            memcpy(shm + (begin - span_begin), buf + begin, end - begin);
+        } else {
+            memcpy(buf + begin, shm + (begin - span_begin), end - begin);
+        }
+    }
+}
+
+} // namespace
+
 // TODO If we decide to keep this functionality with one segment, the function can be merged mostly.
 // Code is mostly redundant
 
@@ -34,16 +145,23 @@ namespace rpc {
  */
 ssize_t forward_write(const string& path, const void* buf, const bool append_flag,
                       const off64_t in_offset, const size_t write_size,
-                      const int64_t updated_metadentry_size) {
+                      const int64_t updated_metadentry_size, const int data_host,
+                      const gkfs::metadata::Layout& layout) {
 
     assert(write_size > 0);
 
     // Calculate chunkid boundaries and numbers so that daemons know in
     // which interval to look for chunks
-    off64_t offset = append_flag ? in_offset : (updated_metadentry_size - write_size);
+    // an append is written at the end of the range the size update has reserved for it
+    off64_t offset = append_flag ? (updated_metadentry_size - write_size) : in_offset;
+
+    auto chunksize = gkfs::metadata::chunk_size(layout);
+    auto chnk_start = gkfs::util::chnk_id_for_offset(offset, chunksize);
+    auto chnk_end = gkfs::util::chnk_id_for_offset((offset + write_size) - 1, chunksize);
 
-    auto chnk_start = gkfs::util::chnk_id_for_offset(offset, gkfs::config::rpc::chunksize);
-    auto chnk_end = gkfs::util::chnk_id_for_offset((offset + write_size) - 1, gkfs::config::rpc::chunksize);
+    // all RPCs of this operation go through the same distributor, even if the forwarder is switched meanwhile
+    gkfs::preload::DistributorGuard distributor(CTX->distributors());
+    FilePin pin(*distributor, path);
 
     // Collect all chunk ids within count that have the same destination so
     // that those are send in one rpc bulk transfer
@@ -57,7 +175,7 @@ ssize_t forward_write(const string& path, const void* buf, const bool append_fla
     uint64_t chnk_end_target = 0;
 
     for (uint64_t chnk_id = chnk_start; chnk_id <= chnk_end; chnk_id++) {
-        auto target = CTX->distributor()->locate_data(path, chnk_id);
+        auto target = locate_chunk(*distributor, pin, path, chnk_id, data_host, layout);
 
         if (target_chnks.count(target) == 0) {
             target_chnks.insert(std::make_pair(target, std::vector<uint64_t>{chnk_id}));
@@ -76,79 +194,107 @@ ssize_t forward_write(const string& path, const void* buf, const bool append_fla
         }
     }
 
-    // some helper variables for async RPC
-    std::vector<hermes::mutable_buffer> bufseq{
-            hermes::mutable_buffer{const_cast<void*>(buf), write_size},
-    };
-
-    // expose user buffers so that they can serve as RDMA data sources
-    // (these are automatically "unexposed" when the destructor is called)
-    hermes::exposed_memory local_buffers;
-
-    try {
-        local_buffers = ld_network_service->expose(bufseq, hermes::access_mode::read_only);
-
-    } catch (const std::exception& ex) {
-        LOG(ERROR, "Failed to expose buffers for RMA");
-        errno = EBUSY;
-        return -1;
+    // the daemon on this node takes its chunks from shared memory if the region is free and large enough. The other
+    // daemons pull theirs from the user buffer
+    ShmLease shm;
+    uint64_t shm_target = 0;
+    pair<uint64_t, uint64_t> shm_span{};
+    for (const auto& target : targets) {
+        if (shm_host(target)) {
+            shm_span = chunk_span(target_chnks[target], offset, write_size, chunksize);
+            shm = lease_shm_region(shm_span.second - shm_span.first);
+            if (shm) {
+                shm_target = target;
+                copy_shm_chunks(target_chnks[target], offset, write_size, chunksize,
+                                static_cast<char*>(const_cast<void*>(buf)), shm->data(), shm_span.first, true);
+            }
+            break;
+        }
     }
 
-    std::vector<hermes::rpc_handle<gkfs::rpc::write_data>> handles;
+    // expose the user buffer, or a copy of it with RPC deadlines, so that it can serve as RDMA data source
+    std::unique_ptr<TransferBuffer> local_buffers;
+    auto expose_buffers = [&]() {
+        if (!local_buffers) {
+            local_buffers = std::make_unique<TransferBuffer>(const_cast<void*>(buf), write_size,
+                                                             hermes::access_mode::read_only, RpcRetry::none);
+        }
+    };
 
-    // Issue non-blocking RPC requests and wait for the result later
-    //
-    // TODO(amiranda): This could be simplified by adding a vector of inputs
-    // to async_engine::broadcast(). This would allow us to avoid manually
-    // looping over handles as we do below
-    for (const auto& target : targets) {
+    if (!shm || targets.size() > 1) {
+        try {
+            expose_buffers();
+        } catch (const std::exception& ex) {
+            LOG(ERROR, "Failed to expose buffers for RMA");
+            errno = EBUSY;
+            return -1;
+        }
+    }
 
+    auto post_write = [&](uint64_t target, bool use_shm) {
         // total chunk_size for target
-        auto total_chunk_size = target_chnks[target].size() * gkfs::config::rpc::chunksize;
+        auto total_chunk_size = target_chnks[target].size() * chunksize;
 
         // receiver of first chunk must subtract the offset from first chunk
         if (target == chnk_start_target) {
-            total_chunk_size -= gkfs::util::chnk_lpad(offset, gkfs::config::rpc::chunksize);
+            total_chunk_size -= gkfs::util::chnk_lpad(offset, chunksize);
         }
 
         // receiver of last chunk must subtract
         if (target == chnk_end_target) {
-            total_chunk_size -= gkfs::util::chnk_rpad(offset + write_size, gkfs::config::rpc::chunksize);
+            total_chunk_size -= gkfs::util::chnk_rpad(offset + write_size, chunksize);
         }
 
         auto endp = CTX->hosts().at(target);
+        // lets the daemon recognize its chunks, e.g., its stripe of the chunks when striping across forwarders
+        auto request_host = distributor->data_request_host(target, CTX->hosts().size());
+
+        LOG(DEBUG, "Sending RPC ...");
+
+        gkfs::rpc::write_data::input in(
+                path,
+                // first offset in targets is the chunk with
+                // a potential offset
+                gkfs::util::chnk_lpad(offset, chunksize),
+                request_host.first,
+                request_host.second,
+                layout.chunk_size,
+                layout.stripe_width,
+                // number of chunks handled by that destination
+                target_chnks[target].size(),
+                // chunk start id of this write
+                chnk_start,
+                // chunk end id of this write
+                chnk_end,
+                // total size to write
+                total_chunk_size,
+                use_shm ? hermes::exposed_memory{} : local_buffers->exposed(),
+                use_shm ? shm->id() : 0,
+                use_shm ? static_cast<uint32_t>(shm->pid()) : 0,
+                use_shm ? shm->fd() : -1,
+                // the byte at offset x of the user buffer is at shm_offset + x in the region
+                use_shm ? static_cast<int64_t>(gkfs::rpc::shm::data_offset) - static_cast<int64_t>(shm_span.first)
+                        : 0);
+
+        LOG(DEBUG, "host: {}, path: \"{}\", chunks: {}, size: {}, offset: {}, shared memory: {}",
+            target, path, in.chunk_n(), total_chunk_size, in.offset(), use_shm);
+
+        // never repeated: a copy given up on cannot be cancelled and could still overwrite data written after it
+        return OutstandingRpc<gkfs::rpc::write_data>(target, [endp, in]() mutable {
+            return ld_network_service->post<gkfs::rpc::write_data>(endp, in);
+        }, RpcRetry::none, use_shm ? nullptr : local_buffers->transfer());
+    };
 
-        try {
-
-            LOG(DEBUG, "Sending RPC ...");
-
-            gkfs::rpc::write_data::input in(
-                    path,
-                    // first offset in targets is the chunk with
-                    // a potential offset
-                    gkfs::util::chnk_lpad(offset, gkfs::config::rpc::chunksize),
-                    target,
-                    CTX->hosts().size(),
-                    // number of chunks handled by that destination
-                    target_chnks[target].size(),
-                    // chunk start id of this write
-                    chnk_start,
-                    // chunk end id of this write
-                    chnk_end,
-                    // total size to write
-                    total_chunk_size,
-                    local_buffers);
-
-            // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that
-            // we can retry for RPC_TRIES (see old commits with margo)
-            // TODO(amiranda): hermes will eventually provide a post(endpoint)
-            // returning one result and a broadcast(endpoint_set) returning a
-            // result_set. When that happens we can remove the .at(0) :/
-            handles.emplace_back(ld_network_service->post<gkfs::rpc::write_data>(endp, in));
-
-            LOG(DEBUG, "host: {}, path: \"{}\", chunks: {}, size: {}, offset: {}",
-                target, path, in.chunk_n(), total_chunk_size, in.offset());
+    std::vector<OutstandingRpc<gkfs::rpc::write_data>> handles;
 
+    // Issue non-blocking RPC requests and wait for the result later
+    //
+    // TODO(amiranda): This could be simplified by adding a vector of inputs
+    // to async_engine::broadcast(). This would allow us to avoid manually
+    // looping over handles as we do below
+    for (const auto& target : targets) {
+        try {
+            handles.push_back(post_write(target, shm && target == shm_target));
         } catch (const std::exception& ex) {
             LOG(ERROR, "Unable to send non-blocking rpc for "
                        "path \"{}\" [peer: {}]", path, target);
@@ -164,11 +310,16 @@ ssize_t forward_write(const string& path, const void* buf, const bool append_fla
     ssize_t out_size = 0;
     std::size_t idx = 0;
 
-    for (const auto& h : handles) {
+    for (auto& h : handles) {
         try {
-            // XXX We might need a timeout here to not wait forever for an
-            // output that never comes?
-            auto out = h.get().at(0);
+            auto out = h.get();
+
+            if (shm && targets[idx] == shm_target && out.err() == ENOTSUP) {
+                // the daemon cannot map the region, e.g., as it runs as another user. Repeated with a bulk transfer
+                disable_shm_region();
+                expose_buffers();
+                out = post_write(targets[idx], false).get();
+            }
 
             if (out.err() != 0) {
                 LOG(ERROR, "Daemon reported error: {}", out.err());
@@ -178,6 +329,11 @@ ssize_t forward_write(const string& path, const void* buf, const bool append_fla
 
             out_size += static_cast<size_t>(out.io_size());
 
+        } catch (const rpc_timeout_error& ex) {
+            LOG(ERROR, "Timed out waiting for rpc output for path \"{}\" [peer: {}]: {}",
+                path, targets[idx], ex.what());
+            error = true;
+            errno = ETIMEDOUT;
         } catch (const std::exception& ex) {
             LOG(ERROR, "Failed to get rpc output for path \"{}\" [peer: {}]",
                 path, targets[idx]);
@@ -188,18 +344,28 @@ ssize_t forward_write(const string& path, const void* buf, const bool append_fla
         ++idx;
     }
 
+    // a failed request may still be running at its daemon
+    if (error && shm) {
+        shm.discard();
+    }
     return error ? -1 : out_size;
 }
 
 /**
  * Sends an RPC request to a specific node to push all chunks that belong to him
  */
-ssize_t forward_read(const string& path, void* buf, const off64_t offset, const size_t read_size) {
+ssize_t forward_read(const string& path, void* buf, const off64_t offset, const size_t read_size,
+                     const int data_host, const gkfs::metadata::Layout& layout) {
 
     // Calculate chunkid boundaries and numbers so that daemons know in which
     // interval to look for chunks
-    auto chnk_start = gkfs::util::chnk_id_for_offset(offset, gkfs::config::rpc::chunksize);
-    auto chnk_end = gkfs::util::chnk_id_for_offset((offset + read_size - 1), gkfs::config::rpc::chunksize);
+    auto chunksize = gkfs::metadata::chunk_size(layout);
+    auto chnk_start = gkfs::util::chnk_id_for_offset(offset, chunksize);
+    auto chnk_end = gkfs::util::chnk_id_for_offset((offset + read_size - 1), chunksize);
+
+    // all RPCs of this operation go through the same distributor, even if the forwarder is switched meanwhile
+    gkfs::preload::DistributorGuard distributor(CTX->distributors());
+    FilePin pin(*distributor, path);
 
     // Collect all chunk ids within count that have the same destination so
     // that those are send in one rpc bulk transfer
@@ -213,7 +379,7 @@ ssize_t forward_read(const string& path, void* buf, const off64_t offset, const
     uint64_t chnk_end_target = 0;
 
     for (uint64_t chnk_id = chnk_start; chnk_id <= chnk_end; chnk_id++) {
-        auto target = CTX->distributor()->locate_data(path, chnk_id);
+        auto target = locate_chunk(*distributor, pin, path, chnk_id, data_host, layout);
 
         if (target_chnks.count(target) == 0) {
             target_chnks.insert(std::make_pair(target, std::vector<uint64_t>{chnk_id}));
@@ -232,80 +398,115 @@ ssize_t forward_read(const string& path, void* buf, const off64_t offset, const
         }
     }
 
-    // some helper variables for async RPCs
-    std::vector<hermes::mutable_buffer> bufseq{
-            hermes::mutable_buffer{buf, read_size},
-    };
-
-    // expose user buffers so that they can serve as RDMA data targets
-    // (these are automatically "unexposed" when the destructor is called)
-    hermes::exposed_memory local_buffers;
-
-    try {
-        local_buffers = ld_network_service->expose(bufseq, hermes::access_mode::write_only);
-
-    } catch (const std::exception& ex) {
-        LOG(ERROR, "Failed to expose buffers for RMA");
-        errno = EBUSY;
-        return -1;
+    // the daemon on this node reads its chunks into shared memory if the region is free and large enough. The other
+    // daemons push theirs into the user buffer
+    ShmLease shm;
+    uint64_t shm_target = 0;
+    pair<uint64_t, uint64_t> shm_span{};
+    for (const auto& target : targets) {
+        if (shm_host(target)) {
+            shm_span = chunk_span(target_chnks[target], offset, read_size, chunksize);
+            shm = lease_shm_region(shm_span.second - shm_span.first);
+            if (shm) {
+                shm_target = target;
+            }
+            break;
+        }
     }
 
-    std::vector<hermes::rpc_handle<gkfs::rpc::read_data>> handles;
+    // expose the user buffer, or memory of its own with RPC deadlines, so that it can serve as RDMA data target
+    std::unique_ptr<TransferBuffer> local_buffers;
+    auto expose_buffers = [&]() {
+        if (!local_buffers) {
+            local_buffers = std::make_unique<TransferBuffer>(buf, read_size, hermes::access_mode::write_only,
+                                                             RpcRetry::hedged);
+        }
+    };
 
-    // Issue non-blocking RPC requests and wait for the result later
-    //
-    // TODO(amiranda): This could be simplified by adding a vector of inputs
-    // to async_engine::broadcast(). This would allow us to avoid manually
-    // looping over handles as we do below
-    for (const auto& target : targets) {
+    if (!shm || targets.size() > 1) {
+        try {
+            expose_buffers();
+        } catch (const std::exception& ex) {
+            LOG(ERROR, "Failed to expose buffers for RMA");
+            errno = EBUSY;
+            return -1;
+        }
+    }
 
+    auto post_read = [&](uint64_t target, bool use_shm) {
         // total chunk_size for target
-        auto total_chunk_size = target_chnks[target].size() * gkfs::config::rpc::chunksize;
+        auto total_chunk_size = target_chnks[target].size() * chunksize;
 
         // receiver of first chunk must subtract the offset from first chunk
         if (target == chnk_start_target) {
-            total_chunk_size -= gkfs::util::chnk_lpad(offset, gkfs::config::rpc::chunksize);
+            total_chunk_size -= gkfs::util::chnk_lpad(offset, chunksize);
         }
 
         // receiver of last chunk must subtract
         if (target == chnk_end_target) {
-            total_chunk_size -= gkfs::util::chnk_rpad(offset + read_size, gkfs::config::rpc::chunksize);
+            total_chunk_size -= gkfs::util::chnk_rpad(offset + read_size, chunksize);
         }
 
         auto endp = CTX->hosts().at(target);
+        // lets the daemon recognize its chunks, e.g., its stripe of the chunks when striping across forwarders
+        auto request_host = distributor->data_request_host(target, CTX->hosts().size());
+
+        LOG(DEBUG, "Sending RPC ...");
+
+        gkfs::rpc::read_data::input in(
+                path,
+                // first offset in targets is the chunk with
+                // a potential offset
+                gkfs::util::chnk_lpad(offset, chunksize),
+                request_host.first,
+                request_host.second,
+                layout.chunk_size,
+                layout.stripe_width,
+                // number of chunks handled by that destination
+                target_chnks[target].size(),
+                // chunk start id of this write
+                chnk_start,
+                // chunk end id of this write
+                chnk_end,
+                // total size to write
+                total_chunk_size,
+                use_shm ? hermes::exposed_memory{} : local_buffers->exposed(),
+                use_shm ? shm->id() : 0,
+                use_shm ? static_cast<uint32_t>(shm->pid()) : 0,
+                use_shm ? shm->fd() : -1,
+                // the byte at offset x of the user buffer is at shm_offset + x in the region
+                use_shm ? static_cast<int64_t>(gkfs::rpc::shm::data_offset) - static_cast<int64_t>(shm_span.first)
+                        : 0);
+
+        LOG(DEBUG, "host: {}, path: {}, chunks: {}, size: {}, offset: {}, shared memory: {}",
+            target, path, in.chunk_n(), total_chunk_size, in.offset(), use_shm);
+
+        // a slow read is duplicated. Both copies push the same data into the buffer. Not into shared memory, as an
+        // earlier copy could still write to it once the next operation uses it
+        OutstandingRpc<gkfs::rpc::read_data> rpc(target, [endp, in]() mutable {
+            return ld_network_service->post<gkfs::rpc::read_data>(endp, in);
+        }, use_shm ? RpcRetry::none : RpcRetry::hedged, use_shm ? nullptr : local_buffers->transfer());
+        // with the shared data backend of forwarders, the duplicate is served by another forwarder
+        auto hedge_host = distributor->alternative_data_host(target);
+        if (hedge_host != target) {
+            auto hedge_endp = CTX->hosts().at(hedge_host);
+            rpc.hedge_to(hedge_host, [hedge_endp, in]() mutable {
+                return ld_network_service->post<gkfs::rpc::read_data>(hedge_endp, in);
+            });
+        }
+        return rpc;
+    };
 
-        try {
-
-            LOG(DEBUG, "Sending RPC ...");
-
-            gkfs::rpc::read_data::input in(
-                    path,
-                    // first offset in targets is the chunk with
-                    // a potential offset
-                    gkfs::util::chnk_lpad(offset, gkfs::config::rpc::chunksize),
-                    target,
-                    CTX->hosts().size(),
-                    // number of chunks handled by that destination
-                    target_chnks[target].size(),
-                    // chunk start id of this write
-                    chnk_start,
-                    // chunk end id of this write
-                    chnk_end,
-                    // total size to write
-                    total_chunk_size,
-                    local_buffers);
-
-            // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that
-            // we can retry for RPC_TRIES (see old commits with margo)
-            // TODO(amiranda): hermes will eventually provide a post(endpoint)
-            // returning one result and a broadcast(endpoint_set) returning a
-            // result_set. When that happens we can remove the .at(0) :/
-            handles.emplace_back(
-                    ld_network_service->post<gkfs::rpc::read_data>(endp, in));
-
-            LOG(DEBUG, "host: {}, path: {}, chunks: {}, size: {}, offset: {}",
-                target, path, in.chunk_n(), total_chunk_size, in.offset());
+    std::vector<OutstandingRpc<gkfs::rpc::read_data>> handles;
 
+    // Issue non-blocking RPC requests and wait for the result later
+    //
+    // TODO(amiranda): This could be simplified by adding a vector of inputs
+    // to async_engine::broadcast(). This would allow us to avoid manually
+    // looping over handles as we do below
+    for (const auto& target : targets) {
+        try {
+            handles.push_back(post_read(target, shm && target == shm_target));
         } catch (const std::exception& ex) {
             LOG(ERROR, "Unable to send non-blocking rpc for path \"{}\" "
                        "[peer: {}]", path, target);
@@ -314,18 +515,29 @@ ssize_t forward_read(const string& path, void* buf, const off64_t offset, const
         }
     }
 
-    // Wait for RPC responses and then get response and add it to out_size
-    // which is the read size. All potential outputs are served to free
-    // resources regardless of errors, although an errorcode is set.
+    // Wait for RPC responses and collect where the data of each daemon ends. All potential outputs are served to
+    // free resources regardless of errors, although an errorcode is set.
     bool error = false;
-    ssize_t out_size = 0;
+    std::vector<uint64_t> data_ends(handles.size(), 0);
+    // position of the daemon that read into shared memory in targets, if any
+    auto shm_idx = targets.size();
     std::size_t idx = 0;
 
-    for (const auto& h : handles) {
+    for (auto& h : handles) {
         try {
-            // XXX We might need a timeout here to not wait forever for an
-            // output that never comes?
-            auto out = h.get().at(0);
+            auto out = h.get();
+
+            if (shm && targets[idx] == shm_target) {
+                if (out.err() == ENOTSUP) {
+                    // the daemon cannot map the region, e.g., as it runs as another user. Repeated with a bulk
+                    // transfer
+                    disable_shm_region();
+                    expose_buffers();
+                    out = post_read(targets[idx], false).get();
+                } else {
+                    shm_idx = idx;
+                }
+            }
 
             if (out.err() != 0) {
                 LOG(ERROR, "Daemon reported error: {}", out.err());
@@ -333,8 +545,13 @@ ssize_t forward_read(const string& path, void* buf, const off64_t offset, const
                 errno = out.err();
             }
 
-            out_size += static_cast<size_t>(out.io_size());
+            data_ends[idx] = out.data_end();
 
+        } catch (const rpc_timeout_error& ex) {
+            LOG(ERROR, "Timed out waiting for rpc output for path \"{}\" [peer: {}]: {}",
+                path, targets[idx], ex.what());
+            error = true;
+            errno = ETIMEDOUT;
         } catch (const std::exception& ex) {
             LOG(ERROR, "Failed to get rpc output for path \"{}\" [peer: {}]",
                 path, targets[idx]);
@@ -344,27 +561,303 @@ ssize_t forward_read(const string& path, void* buf, const off64_t offset, const
 
         ++idx;
     }
+    if (error) {
+        // a failed request may still be running at its daemon
+        if (shm) {
+            shm.discard();
+        }
+        return -1;
+    }
 
-    return error ? -1 : out_size;
+    // the data of the other daemons is copied out of the transfer buffer if they did not write to the user buffer
+    if (local_buffers) {
+        for (idx = 0; idx < targets.size(); ++idx) {
+            if (idx == shm_idx) {
+                continue;
+            }
+            for (auto chnk_id : target_chnks[targets[idx]]) {
+                auto copy_begin = std::max(static_cast<uint64_t>(offset), chnk_id * chunksize);
+                auto copy_end = std::min(static_cast<uint64_t>(offset + read_size), (chnk_id + 1) * chunksize);
+                local_buffers->copy_out(copy_begin - offset, copy_end - copy_begin);
+            }
+        }
+    }
+
+    // the data of the daemon on this node is copied out of shared memory. What lies behind its data_end is zeroed below
+    if (shm_idx < targets.size() && data_ends[shm_idx] > static_cast<uint64_t>(offset)) {
+        copy_shm_chunks(target_chnks[shm_target], offset, std::min<uint64_t>(read_size, data_ends[shm_idx] - offset),
+                        chunksize, static_cast<char*>(buf), shm->data(), shm_span.first, false);
+    }
+
+    // The file ends with the last data any daemon found. Daemons fill holes up to their own last data, the holes
+    // behind it are zeroed here
+    auto data_end = *std::max_element(data_ends.begin(), data_ends.end());
+    if (data_end <= static_cast<uint64_t>(offset)) {
+        return 0;
+    }
+    auto read_end = std::min(static_cast<uint64_t>(offset + read_size), data_end);
+    for (idx = 0; idx < targets.size(); ++idx) {
+        if (data_ends[idx] >= read_end) {
+            continue;
+        }
+        for (auto chnk_id : target_chnks[targets[idx]]) {
+            auto zero_begin = std::max({static_cast<uint64_t>(offset), chnk_id * chunksize, data_ends[idx]});
+            auto zero_end = std::min(read_end, (chnk_id + 1) * chunksize);
+            if (zero_begin < zero_end) {
+                memset(static_cast<char*>(buf) + (zero_begin - offset), 0, zero_end - zero_begin);
+            }
+        }
+    }
+    return read_end - offset;
+}
+
+/**
+ * Finds the next data or hole position of a file at or behind offset by asking the daemons that store its chunks
+ * @param path
+ * @param offset
+ * @param file_size
+ * @param whence SEEK_DATA or SEEK_HOLE
+ * @param data_host
+ * @param layout
+ * @return the position, file_size if there is no hole before the end of the file, or -1 as error. errno is ENXIO if
+ * there is no data behind offset
+ */
+off64_t forward_seek_data(const string& path, const off64_t offset, const size_t file_size, const int whence,
+                          const int data_host, const gkfs::metadata::Layout& layout) {
+    assert(static_cast<size_t>(offset) < file_size);
+    auto chunksize = gkfs::metadata::chunk_size(layout);
+    auto chnk_start = gkfs::util::chnk_id_for_offset(offset, chunksize);
+    auto chnk_end = gkfs::util::chnk_id_for_offset(file_size - 1, chunksize);
+
+    gkfs::preload::DistributorGuard distributor(CTX->distributors());
+    FilePin pin(*distributor, path);
+    std::vector<uint64_t> targets{};
+    for (uint64_t chnk_id = chnk_start; chnk_id <= chnk_end; chnk_id++) {
+        auto target = locate_chunk(*distributor, pin, path, chnk_id, data_host, layout);
+        if (std::find(targets.begin(), targets.end(), target) == targets.end()) {
+            targets.push_back(target);
+        }
+    }
+
+    std::vector<OutstandingRpc<gkfs::rpc::seek_data>> handles;
+    for (const auto& target : targets) {
+        auto endp = CTX->hosts().at(target);
+        auto request_host = distributor->data_request_host(target, CTX->hosts().size());
+        try {
+            LOG(DEBUG, "Sending RPC to host: {}", target);
+            gkfs::rpc::seek_data::input in(path, offset, whence, request_host.first, request_host.second,
+                                           layout.chunk_size, layout.stripe_width, chnk_start, chnk_end,
+                                           data_host != gkfs::metadata::NO_DATA_HOST);
+            handles.emplace_back(target, [endp, in]() mutable {
+                return ld_network_service->post<gkfs::rpc::seek_data>(endp, in);
+            }, RpcRetry::idempotent);
+        } catch (const std::exception& ex) {
+            LOG(ERROR, "Unable to send non-blocking rpc for path \"{}\" [peer: {}]", path, target);
+            errno = EBUSY;
+            return -1;
+        }
+    }
+
+    bool error = false;
+    auto pos = static_cast<off64_t>(file_size);
+    for (auto& h : handles) {
+        try {
+            auto out = h.get();
+            if (out.err() != 0) {
+                LOG(ERROR, "Daemon reported error: {}", out.err());
+                error = true;
+                errno = out.err();
+            } else if (out.offset() >= 0) {
+                pos = std::min(pos, static_cast<off64_t>(out.offset()));
+            }
+        } catch (const rpc_timeout_error& ex) {
+            LOG(ERROR, "Timed out waiting for rpc output for path \"{}\": {}", path, ex.what());
+            error = true;
+            errno = ETIMEDOUT;
+        } catch (const std::exception& ex) {
+            LOG(ERROR, "Failed to get rpc output for path \"{}\"", path);
+            error = true;
+            errno = EIO;
+        }
+    }
+    if (error) {
+        return -1;
+    }
+    if (whence == SEEK_DATA && pos == static_cast<off64_t>(file_size)) {
+        errno = ENXIO;
+        return -1;
+    }
+    return pos;
+}
+
+/**
+ * Writes to a small file whose content is stored in its metadentry, i.e., sends a single RPC to the metadata host
+ * @param path
+ * @param buf
+ * @param offset ignored for appends
+ * @param write_size
+ * @param append_flag
+ * @param stored_inline (return val) false if the file is stored in chunks. Nothing was written then
+ * @param write_offset (return val) offset the data was written at
+ * @return written size or -1 as error. errno is EFBIG if the file would grow beyond the inline data size
+ */
+ssize_t forward_write_inline(const string& path, const void* buf, const off64_t offset, const size_t write_size,
+                             const bool append_flag, bool& stored_inline, off64_t& write_offset) {
+
+    auto host = CTX->distributor()->locate_file_metadata(path);
+    auto endp = CTX->hosts().at(host);
+
+    // never repeated, see forward_write()
+    std::unique_ptr<TransferBuffer> local_buffers;
+    try {
+        local_buffers = std::make_unique<TransferBuffer>(const_cast<void*>(buf), write_size,
+                                                         hermes::access_mode::read_only, RpcRetry::none);
+    } catch (const std::exception& ex) {
+        LOG(ERROR, "Failed to expose buffers for RMA");
+        errno = EBUSY;
+        return -1;
+    }
+
+    try {
+        LOG(DEBUG, "Sending RPC ...");
+        gkfs::rpc::write_inline::input in(path, offset, write_size, append_flag, local_buffers->exposed());
+        auto out = forward_and_wait<gkfs::rpc::write_inline>(host, [endp, in]() mutable {
+            return ld_network_service->post<gkfs::rpc::write_inline>(endp, in);
+        }, RpcRetry::none, local_buffers->transfer());
+
+        LOG(DEBUG, "Got response err: {}, stored inline: {}, io_size: {}", out.err(), out.stored_inline(),
+            out.io_size());
+
+        stored_inline = out.stored_inline();
+        if (out.err() != 0) {
+            errno = out.err();
+            return -1;
+        }
+        write_offset = out.offset();
+        return static_cast<ssize_t>(out.io_size());
+    } catch (const rpc_timeout_error& ex) {
+        LOG(ERROR, "Timed out waiting for rpc output for path \"{}\": {}", path, ex.what());
+        errno = ETIMEDOUT;
+        return -1;
+    } catch (const std::exception& ex) {
+        LOG(ERROR, "Failed to get rpc output for path \"{}\"", path);
+        errno = EIO;
+        return -1;
+    }
+}
+
+/**
+ * Reads from a small file whose content is stored in its metadentry. The metadata host answers with the data and
+ * the file size, so a read of such a file needs only this RPC
+ * @param path
+ * @param buf
+ * @param offset
+ * @param read_size
+ * @param stored_inline (return val) false if the file is stored in chunks. Nothing was read then
+ * @return read size, which stops at the end of the file, or -1 as error
+ */
+ssize_t forward_read_inline(const string& path, void* buf, const off64_t offset, const size_t read_size,
+                            bool& stored_inline) {
+
+    auto host = CTX->distributor()->locate_file_metadata(path);
+    auto endp = CTX->hosts().at(host);
+
+    std::unique_ptr<TransferBuffer> local_buffers;
+    try {
+        local_buffers = std::make_unique<TransferBuffer>(buf, read_size, hermes::access_mode::write_only,
+                                                         RpcRetry::hedged);
+    } catch (const std::exception& ex) {
+        LOG(ERROR, "Failed to expose buffers for RMA");
+        errno = EBUSY;
+        return -1;
+    }
+
+    try {
+        LOG(DEBUG, "Sending RPC ...");
+        gkfs::rpc::read_inline::input in(path, offset, read_size, false, local_buffers->exposed());
+        auto out = forward_and_wait<gkfs::rpc::read_inline>(host, [endp, in]() mutable {
+            return ld_network_service->post<gkfs::rpc::read_inline>(endp, in);
+        }, RpcRetry::hedged, local_buffers->transfer());
+
+        LOG(DEBUG, "Got response err: {}, stored inline: {}, io_size: {}, file size: {}", out.err(),
+            out.stored_inline(), out.io_size(), out.file_size());
+
+        stored_inline = out.stored_inline();
+        if (out.err() != 0) {
+            errno = out.err();
+            return -1;
+        }
+        local_buffers->copy_out(0, out.io_size());
+        return static_cast<ssize_t>(out.io_size());
+    } catch (const rpc_timeout_error& ex) {
+        LOG(ERROR, "Timed out waiting for rpc output for path \"{}\": {}", path, ex.what());
+        errno = ETIMEDOUT;
+        return -1;
+    } catch (const std::exception& ex) {
+        LOG(ERROR, "Failed to get rpc output for path \"{}\"", path);
+        errno = EIO;
+        return -1;
+    }
+}
+
+/**
+ * Moves a small file out of its metadentry. The metadata host writes the content to the chunks before it marks the
+ * file as stored in chunks
+ * @param path
+ * @return 0 on success, also if the file was already stored in chunks, or -1 as error
+ */
+int forward_promote_inline(const string& path) {
+
+    auto host = CTX->distributor()->locate_file_metadata(path);
+    auto endp = CTX->hosts().at(host);
+
+    try {
+        LOG(DEBUG, "Sending RPC ...");
+        gkfs::rpc::promote_inline::input in(path);
+        // a repeated promotion finds the file in chunks and does nothing
+        auto out = forward_and_wait<gkfs::rpc::promote_inline>(host, [endp, in]() mutable {
+            return ld_network_service->post<gkfs::rpc::promote_inline>(endp, in);
+        }, RpcRetry::idempotent);
+
+        LOG(DEBUG, "Got response err: {}, stored inline: {}, io_size: {}", out.err(), out.stored_inline(),
+            out.io_size());
+
+        if (out.err() != 0) {
+            errno = out.err();
+            return -1;
+        }
+        return 0;
+    } catch (const rpc_timeout_error& ex) {
+        LOG(ERROR, "Timed out waiting for rpc output for path \"{}\": {}", path, ex.what());
+        errno = ETIMEDOUT;
+        return -1;
+    } catch (const std::exception& ex) {
+        LOG(ERROR, "Failed to get rpc output for path \"{}\"", path);
+        errno = EIO;
+        return -1;
+    }
 }
 
-int forward_truncate(const std::string& path, size_t current_size, size_t new_size) {
+int forward_truncate(const std::string& path, size_t current_size, size_t new_size, const int data_host,
+                     const gkfs::metadata::Layout& layout) {
 
     assert(current_size > new_size);
     bool error = false;
 
     // Find out which data servers need to delete data chunks in order to
     // contact only them
-    const unsigned int chunk_start = gkfs::util::chnk_id_for_offset(new_size, gkfs::config::rpc::chunksize);
-    const unsigned int chunk_end = gkfs::util::chnk_id_for_offset(current_size - new_size - 1,
-                                                                  gkfs::config::rpc::chunksize);
+    auto chunksize = gkfs::metadata::chunk_size(layout);
+    const unsigned int chunk_start = gkfs::util::chnk_id_for_offset(new_size, chunksize);
+    const unsigned int chunk_end = gkfs::util::chnk_id_for_offset(current_size - new_size - 1, chunksize);
 
+    gkfs::preload::DistributorGuard distributor(CTX->distributors());
+    FilePin pin(*distributor, path);
     std::unordered_set<unsigned int> hosts;
     for (unsigned int chunk_id = chunk_start; chunk_id <= chunk_end; ++chunk_id) {
-        hosts.insert(CTX->distributor()->locate_data(path, chunk_id));
+        hosts.insert(locate_chunk(*distributor, pin, path, chunk_id, data_host, layout));
     }
 
-    std::vector<hermes::rpc_handle<gkfs::rpc::trunc_data>> handles;
+    std::vector<OutstandingRpc<gkfs::rpc::trunc_data>> handles;
 
     for (const auto& host: hosts) {
 
@@ -373,14 +866,12 @@ int forward_truncate(const std::string& path, size_t current_size, size_t new_si
         try {
             LOG(DEBUG, "Sending RPC ...");
 
-            gkfs::rpc::trunc_data::input in(path, new_size);
+            gkfs::rpc::trunc_data::input in(path, new_size, layout.chunk_size);
 
-            // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that
-            // we can retry for RPC_TRIES (see old commits with margo)
-            // TODO(amiranda): hermes will eventually provide a post(endpoint)
-            // returning one result and a broadcast(endpoint_set) returning a
-            // result_set. When that happens we can remove the .at(0) :/
-            handles.emplace_back(ld_network_service->post<gkfs::rpc::trunc_data>(endp, in));
+            // never repeated: a late copy would remove data written after the truncation
+            handles.emplace_back(host, [endp, in]() mutable {
+                return ld_network_service->post<gkfs::rpc::trunc_data>(endp, in);
+            });
 
         } catch (const std::exception& ex) {
             // TODO(amiranda): we should cancel all previously posted requests
@@ -393,18 +884,20 @@ int forward_truncate(const std::string& path, size_t current_size, size_t new_si
     }
 
     // Wait for RPC responses and then get response
-    for (const auto& h : handles) {
+    for (auto& h : handles) {
 
         try {
-            // XXX We might need a timeout here to not wait forever for an
-            // output that never comes?
-            auto out = h.get().at(0);
+            auto out = h.get();
 
             if (out.err() != 0) {
                 LOG(ERROR, "received error response: {}", out.err());
                 error = true;
                 errno = EIO;
             }
+        } catch (const rpc_timeout_error& ex) {
+            LOG(ERROR, "while getting rpc output: {}", ex.what());
+            error = true;
+            errno = ETIMEDOUT;
         } catch (const std::exception& ex) {
             LOG(ERROR, "while getting rpc output");
             error = true;
@@ -415,22 +908,27 @@ int forward_truncate(const std::string& path, size_t current_size, size_t new_si
     return error ? -1 : 0;
 }
 
-ChunkStat forward_get_chunk_stat() {
+namespace {
+
+/**
+ * Sums up the chunk statistics of the given daemons
+ * @param hosts
+ * @return
+ */
+ChunkStat chunk_stat_of(const std::vector<unsigned int>& hosts) {
 
-    std::vector<hermes::rpc_handle<gkfs::rpc::chunk_stat>> handles;
+    std::vector<OutstandingRpc<gkfs::rpc::chunk_stat>> handles;
 
-    for (const auto& endp : CTX->hosts()) {
+    for (const auto& host : hosts) {
+        auto endp = CTX->hosts().at(host);
         try {
             LOG(DEBUG, "Sending RPC to host: {}", endp.to_string());
 
             gkfs::rpc::chunk_stat::input in(0);
 
-            // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that
-            // we can retry for RPC_TRIES (see old commits with margo)
-            // TODO(amiranda): hermes will eventually provide a post(endpoint)
-            // returning one result and a broadcast(endpoint_set) returning a
-            // result_set. When that happens we can remove the .at(0) :/
-            handles.emplace_back(ld_network_service->post<gkfs::rpc::chunk_stat>(endp, in));
+            handles.emplace_back(host, [endp, in]() mutable {
+                return ld_network_service->post<gkfs::rpc::chunk_stat>(endp, in);
+            }, RpcRetry::idempotent);
 
         } catch (const std::exception& ex) {
             // TODO(amiranda): we should cancel all previously posted requests
@@ -450,9 +948,7 @@ ChunkStat forward_get_chunk_stat() {
         gkfs::rpc::chunk_stat::output out;
 
         try {
-            // XXX We might need a timeout here to not wait forever for an
-            // output that never comes?
-            out = handles[i].get().at(0);
+            out = handles[i].get();
 
             assert(out.chunk_size() == chunk_size);
             chunk_total += out.chunk_total();
@@ -467,5 +963,111 @@ ChunkStat forward_get_chunk_stat() {
     return {chunk_size, chunk_total, chunk_free};
 }
 
+} // namespace
+
+ChunkStat forward_get_chunk_stat() {
+    std::vector<unsigned int> hosts(CTX->hosts().size());
+    std::iota(hosts.begin(), hosts.end(), 0);
+    return chunk_stat_of(hosts);
+}
+
+/**
+ * Returns the chunk statistics of a single daemon
+ * @param host
+ * @return
+ */
+ChunkStat forward_get_chunk_stat(unsigned int host) {
+    return chunk_stat_of({host});
+}
+
+namespace {
+
+// statistics of all daemons for statfs(), see cached_chunk_stat()
+std::chrono::milliseconds chunk_stat_interval{gkfs::config::rpc::chunk_stat_interval_ms};
+std::mutex chunk_stat_mutex;
+ChunkStat chunk_stat_cache{};
+std::chrono::steady_clock::time_point chunk_stat_updated{};
+bool chunk_stat_valid = false;
+bool chunk_stat_refreshing = false;
+std::thread chunk_stat_refresher;
+
+void refresh_chunk_stat() {
+    ChunkStat stat{};
+    bool refreshed = false;
+    try {
+        stat = forward_get_chunk_stat();
+        refreshed = true;
+    } catch (const std::exception& e) {
+        LOG(WARNING, "Failed to refresh chunk statistics: {}", e.what());
+    }
+    std::lock_guard<std::mutex> lock(chunk_stat_mutex);
+    if (refreshed) {
+        chunk_stat_cache = stat;
+        chunk_stat_updated = std::chrono::steady_clock::now();
+    }
+    chunk_stat_refreshing = false;
+}
+
+} // namespace
+
+/**
+ * Reads the refresh interval of the cached chunk statistics from LIBGKFS_STATFS_INTERVAL
+ */
+void init_chunk_stat_cache() {
+    auto interval_str = gkfs::env::get_var(gkfs::env::STATFS_INTERVAL,
+                                           std::to_string(gkfs::config::rpc::chunk_stat_interval_ms));
+    try {
+        chunk_stat_interval = std::chrono::milliseconds(std::stoul(interval_str));
+    } catch (const std::exception& e) {
+        LOG(WARNING, "Ignoring invalid statfs interval '{}'", interval_str);
+    }
+    LOG(INFO, "Chunk statistics are cached for {} ms", chunk_stat_interval.count());
+}
+
+/**
+ * Waits for a background refresh. Must be called before the RPC engine is shut down
+ */
+void destroy_chunk_stat_cache() {
+    std::thread refresher;
+    {
+        std::lock_guard<std::mutex> lock(chunk_stat_mutex);
+        refresher = std::move(chunk_stat_refresher);
+    }
+    if (refresher.joinable()) {
+        refresher.join();
+    }
+}
+
+/**
+ * Returns the summed up chunk statistics of all daemons. Only the first call waits for all daemons. Afterwards the
+ * last statistics are returned and refreshed in the background once they are older than the interval, so that
+ * frequent statfs() calls do not broadcast to every daemon
+ * @return
+ */
+ChunkStat cached_chunk_stat() {
+    if (chunk_stat_interval.count() == 0) {
+        return forward_get_chunk_stat();
+    }
+    std::unique_lock<std::mutex> lock(chunk_stat_mutex);
+    if (!chunk_stat_valid) {
+        lock.unlock();
+        auto stat = forward_get_chunk_stat();
+        lock.lock();
+        chunk_stat_cache = stat;
+        chunk_stat_updated = std::chrono::steady_clock::now();
+        chunk_stat_valid = true;
+        return stat;
+    }
+    if (!chunk_stat_refreshing && std::chrono::steady_clock::now() - chunk_stat_updated >= chunk_stat_interval) {
+        chunk_stat_refreshing = true;
+        // the previous refresher has finished or is about to
+        if (chunk_stat_refresher.joinable()) {
+            chunk_stat_refresher.join();
+        }
+        chunk_stat_refresher = std::thread(refresh_chunk_stat);
+    }
+    return chunk_stat_cache;
+}
+
 } // namespace rpc
 } // namespace gkfs
\ No newline at end of file
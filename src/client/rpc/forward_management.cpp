@@ -15,9 +15,14 @@
 #include <client/logging.hpp>
 #include <client/preload_util.hpp>
 #include <client/rpc/rpc_types.hpp>
+#include <client/rpc/rpc_wait.hpp>
+
+#include <global/rpc/distributor.hpp>
 
 #include <boost/token_functions.hpp>
 
+#include <random>
+
 namespace gkfs {
 namespace rpc {
 
@@ -27,17 +32,15 @@ namespace rpc {
 */
 bool forward_get_fs_config() {
 
-    auto endp = CTX->hosts().at(CTX->local_host_id());
+    auto host = CTX->local_host_id();
+    auto endp = CTX->hosts().at(host);
     gkfs::rpc::fs_config::output out;
 
     try {
         LOG(DEBUG, "Retrieving file system configurations from daemon");
-        // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we can retry
-        // for RPC_TRIES (see old commits with margo)
-        // TODO(amiranda): hermes will eventually provide a post(endpoint)
-        // returning one result and a broadcast(endpoint_set) returning a
-        // result_set. When that happens we can remove the .at(0) :/
-        out = ld_network_service->post<gkfs::rpc::fs_config>(endp).get().at(0);
+        out = forward_and_wait<gkfs::rpc::fs_config>(host, [&]() {
+            return ld_network_service->post<gkfs::rpc::fs_config>(endp);
+        }, RpcRetry::idempotent);
     } catch (const std::exception& ex) {
         LOG(ERROR, "Retrieving fs configurations from daemon");
         return false;
@@ -54,11 +57,84 @@ bool forward_get_fs_config() {
     CTX->fs_conf()->blocks_state = out.blocks_state();
     CTX->fs_conf()->uid = out.uid();
     CTX->fs_conf()->gid = out.gid();
+    CTX->fs_conf()->distributor = static_cast<gkfs::rpc::DistributorType>(out.distributor());
+    CTX->fs_conf()->inline_data_size = out.inline_data_size();
 
-    LOG(DEBUG, "Got response with mountdir {}", out.mountdir());
+    LOG(DEBUG, "Got response with mountdir {}, distributor '{}'", out.mountdir(),
+        gkfs::rpc::to_string(CTX->fs_conf()->distributor));
 
     return true;
 }
 
+/**
+ * Asks the given daemons how busy they are
+ * @param hosts
+ * @return load per host in the same order
+ */
+std::vector<ForwarderLoad> forward_get_load(const std::vector<unsigned int>& hosts) {
+
+    std::vector<OutstandingRpc<gkfs::rpc::get_load>> handles;
+
+    for (const auto& host : hosts) {
+        try {
+            auto endp = CTX->hosts().at(host);
+            // not repeated: a forwarder that is too slow to report its load should not be chosen anyway
+            handles.emplace_back(host, [endp]() {
+                return ld_network_service->post<gkfs::rpc::get_load>(endp);
+            });
+        } catch (const std::exception& ex) {
+            LOG(ERROR, "Failed to send request to host: {}", host);
+            throw std::runtime_error("Failed to forward non-blocking rpc request");
+        }
+    }
+
+    std::vector<ForwarderLoad> loads;
+    for (std::size_t i = 0; i < handles.size(); ++i) {
+        try {
+            auto out = handles[i].get();
+            loads.push_back({out.io_queue_depth(), out.bytes_in_flight(), out.agios_backlog()});
+        } catch (const std::exception& ex) {
+            throw std::runtime_error(fmt::format("Failed to get rpc output for target host: {}", hosts[i]));
+        }
+    }
+    return loads;
+}
+
+/**
+ * Picks a forwarder with the power of two choices: two random candidates are asked for their load and the
+ * less loaded one wins. Queued and AGIOS-scheduled requests count as one chunk each.
+ * @param candidates
+ * @return forwarder host id
+ */
+unsigned int choose_forwarder(const std::vector<unsigned int>& candidates) {
+    assert(!candidates.empty());
+    if (candidates.size() == 1) {
+        return candidates.front();
+    }
+    static thread_local std::mt19937 rng{std::random_device{}()};
+    std::uniform_int_distribution<std::size_t> pick(0, candidates.size() - 1);
+    auto first = pick(rng);
+    auto second = pick(rng);
+    while (second == first) {
+        second = pick(rng);
+    }
+    auto a = candidates[first];
+    auto b = candidates[second];
+
+    try {
+        auto loads = forward_get_load({a, b});
+        auto score = [](const ForwarderLoad& l) {
+            return l.bytes_in_flight + (l.io_queue_depth + l.agios_backlog) * gkfs::config::rpc::chunksize;
+        };
+        auto chosen = score(loads[1]) < score(loads[0]) ? b : a;
+        LOG(DEBUG, "Forwarder load {}: {} bytes, {}: {} bytes. Chose {}", a, score(loads[0]), b, score(loads[1]),
+            chosen);
+        return chosen;
+    } catch (const std::exception& e) {
+        LOG(WARNING, "Failed to get forwarder load. Using forwarder {}: {}", a, e.what());
+        return a;
+    }
+}
+
 } // namespace rpc
 } // namespace gkfs
@@ -17,29 +17,33 @@
 #include <client/preload_util.hpp>
 #include <client/open_dir.hpp>
 #include <client/rpc/rpc_types.hpp>
+#include <client/rpc/rpc_wait.hpp>
+#include <client/rpc/transfer_buffer.hpp>
 
 #include <global/rpc/rpc_util.hpp>
 #include <global/rpc/distributor.hpp>
 #include <global/rpc/rpc_types.hpp>
 
+#include <unordered_set>
+
 using namespace std;
 
 namespace gkfs {
 namespace rpc {
 
-int forward_create(const std::string& path, const mode_t mode) {
+int forward_create(const std::string& path, const mode_t mode, const int data_host,
+                   const gkfs::metadata::Layout& layout) {
 
     int err = EUNKNOWN;
-    auto endp = CTX->hosts().at(CTX->distributor()->locate_file_metadata(path));
+    auto host = CTX->distributor()->locate_file_metadata(path);
+    auto endp = CTX->hosts().at(host);
 
     try {
         LOG(DEBUG, "Sending RPC ...");
-        // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we can
-        // retry for RPC_TRIES (see old commits with margo)
-        // TODO(amiranda): hermes will eventually provide a post(endpoint)
-        // returning one result and a broadcast(endpoint_set) returning a
-        // result_set. When that happens we can remove the .at(0) :/
-        auto out = ld_network_service->post<gkfs::rpc::create>(endp, path, mode).get().at(0);
+        auto out = forward_and_wait<gkfs::rpc::create>(host, [&]() {
+            return ld_network_service->post<gkfs::rpc::create>(endp, path, mode, data_host, layout.chunk_size,
+                                                               layout.stripe_width);
+        });
         err = out.err();
         LOG(DEBUG, "Got response success: {}", err);
 
@@ -48,6 +52,10 @@ int forward_create(const std::string& path, const mode_t mode) {
             return -1;
         }
 
+    } catch (const rpc_timeout_error& ex) {
+        LOG(ERROR, "while getting rpc output: {}", ex.what());
+        errno = ETIMEDOUT;
+        return -1;
     } catch (const std::exception& ex) {
         LOG(ERROR, "while getting rpc output");
         errno = EBUSY;
@@ -59,16 +67,14 @@ int forward_create(const std::string& path, const mode_t mode) {
 
 int forward_stat(const std::string& path, string& attr) {
 
-    auto endp = CTX->hosts().at(CTX->distributor()->locate_file_metadata(path));
+    auto host = CTX->distributor()->locate_file_metadata(path);
+    auto endp = CTX->hosts().at(host);
 
     try {
         LOG(DEBUG, "Sending RPC ...");
-        // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we can
-        // retry for RPC_TRIES (see old commits with margo)
-        // TODO(amiranda): hermes will eventually provide a post(endpoint)
-        // returning one result and a broadcast(endpoint_set) returning a
-        // result_set. When that happens we can remove the .at(0) :/
-        auto out = ld_network_service->post<gkfs::rpc::stat>(endp, path).get().at(0);
+        auto out = forward_and_wait<gkfs::rpc::stat>(host, [&]() {
+            return ld_network_service->post<gkfs::rpc::stat>(endp, path);
+        }, RpcRetry::hedged);
         LOG(DEBUG, "Got response success: {}", out.err());
 
         if (out.err() != 0) {
@@ -79,6 +85,10 @@ int forward_stat(const std::string& path, string& attr) {
         attr = out.db_val();
         return 0;
 
+    } catch (const rpc_timeout_error& ex) {
+        LOG(ERROR, "while getting rpc output: {}", ex.what());
+        errno = ETIMEDOUT;
+        return -1;
     } catch (const std::exception& ex) {
         LOG(ERROR, "while getting rpc output");
         errno = EBUSY;
@@ -88,24 +98,23 @@ int forward_stat(const std::string& path, string& attr) {
     return 0;
 }
 
-int forward_remove(const std::string& path, const bool remove_metadentry_only, const ssize_t size) {
+int forward_remove(const std::string& path, const bool remove_metadentry_only, const ssize_t size,
+                   const int data_host, const gkfs::metadata::Layout& layout) {
 
     // if only the metadentry should be removed, send one rpc to the
     // metadentry's responsible node to remove the metadata
-    // else, send an rpc to all hosts and thus broadcast chunk_removal.
+    // else, additionally ask the hosts holding chunks of the file to reclaim them.
     if (remove_metadentry_only) {
 
-        auto endp = CTX->hosts().at(CTX->distributor()->locate_file_metadata(path));
+        auto host = CTX->distributor()->locate_file_metadata(path);
+        auto endp = CTX->hosts().at(host);
 
         try {
 
             LOG(DEBUG, "Sending RPC ...");
-            // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we can
-            // retry for RPC_TRIES (see old commits with margo)
-            // TODO(amiranda): hermes will eventually provide a post(endpoint)
-            // returning one result and a broadcast(endpoint_set) returning a
-            // result_set. When that happens we can remove the .at(0) :/
-            auto out = ld_network_service->post<gkfs::rpc::remove>(endp, path).get().at(0);
+            auto out = forward_and_wait<gkfs::rpc::remove>(host, [&]() {
+                return ld_network_service->post<gkfs::rpc::remove>(endp, path);
+            });
 
             LOG(DEBUG, "Got response success: {}", out.err());
 
@@ -116,6 +125,10 @@ int forward_remove(const std::string& path, const bool remove_metadentry_only, c
 
             return 0;
 
+        } catch (const rpc_timeout_error& ex) {
+            LOG(ERROR, "while getting rpc output: {}", ex.what());
+            errno = ETIMEDOUT;
+            return -1;
         } catch (const std::exception& ex) {
             LOG(ERROR, "while getting rpc output");
             errno = EBUSY;
@@ -125,81 +138,79 @@ int forward_remove(const std::string& path, const bool remove_metadentry_only, c
         return 0;
     }
 
-    std::vector<hermes::rpc_handle<gkfs::rpc::remove>> handles;
-
-    // Small files
-    if (static_cast<std::size_t>(size / gkfs::config::rpc::chunksize) < CTX->hosts().size()) {
-
-        auto endp = CTX->hosts().at(CTX->distributor()->locate_file_metadata(path));
-
-        try {
-            LOG(DEBUG, "Sending RPC to host: {}", endp.to_string());
-            gkfs::rpc::remove::input in(path);
-            handles.emplace_back(ld_network_service->post<gkfs::rpc::remove>(endp, in));
-
-            uint64_t chnk_start = 0;
-            uint64_t chnk_end = size / gkfs::config::rpc::chunksize;
-
-            for (uint64_t chnk_id = chnk_start; chnk_id <= chnk_end; chnk_id++) {
-                const auto target = CTX->hosts().at(
-                        CTX->distributor()->locate_data(path, chnk_id));
-
-                LOG(DEBUG, "Sending RPC to host: {}", target.to_string());
-
-                handles.emplace_back(ld_network_service->post<gkfs::rpc::remove>(target, in));
-            }
-        } catch (const std::exception& ex) {
-            LOG(ERROR, "Failed to send reduced remove requests");
-            throw std::runtime_error(
-                    "Failed to forward non-blocking rpc request");
+    // The metadata host removes the metadentry and its own chunks. All other hosts holding chunks only receive a
+    // reclaim request. Daemons delete chunks in the background, so none of the requests waits for the deletion.
+    gkfs::preload::DistributorGuard distributor(CTX->distributors());
+    auto metadata_host = distributor->locate_file_metadata(path);
+    std::unordered_set<unsigned int> data_hosts;
+    if (data_host != gkfs::metadata::NO_DATA_HOST) {
+        data_hosts.insert(data_host);
+#ifndef GKFS_ENABLE_FORWARDING
+    } else if (is_striped(layout.stripe_width, CTX->hosts().size())) {
+        const uint64_t chnk_end = size / gkfs::metadata::chunk_size(layout);
+        for (uint64_t chnk_id = 0; chnk_id <= chnk_end && chnk_id < layout.stripe_width; ++chnk_id) {
+            data_hosts.insert(locate_striped_data(path, chnk_id, layout.stripe_width, CTX->hosts().size()));
         }
-    } else {    // "Big" files
-        for (const auto& endp : CTX->hosts()) {
-            try {
-                LOG(DEBUG, "Sending RPC to host: {}", endp.to_string());
-
-                gkfs::rpc::remove::input in(path);
-
-                // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that
-                // we can retry for RPC_TRIES (see old commits with margo)
-                // TODO(amiranda): hermes will eventually provide a post(endpoint)
-                // returning one result and a broadcast(endpoint_set) returning a
-                // result_set. When that happens we can remove the .at(0) :/
-                //
-                //
-
-                handles.emplace_back(ld_network_service->post<gkfs::rpc::remove>(endp, in));
-
-            } catch (const std::exception& ex) {
-                // TODO(amiranda): we should cancel all previously posted requests
-                // here, unfortunately, Hermes does not support it yet :/
-                LOG(ERROR, "Failed to send request to host: {}",
-                    endp.to_string());
-                throw std::runtime_error(
-                        "Failed to forward non-blocking rpc request");
-            }
+#endif
+    } else {
+        // stop early for large files, which usually have chunks on every host
+        const uint64_t chnk_end = size / gkfs::metadata::chunk_size(layout);
+        for (uint64_t chnk_id = 0; chnk_id <= chnk_end && data_hosts.size() < CTX->hosts().size(); ++chnk_id) {
+            data_hosts.insert(distributor->locate_data(path, chnk_id));
+        }
+    }
+    data_hosts.erase(metadata_host);
+
+    std::vector<OutstandingRpc<gkfs::rpc::remove>> handles;
+    std::vector<OutstandingRpc<gkfs::rpc::reclaim_chunks>> reclaim_handles;
+    try {
+        auto metadata_endp = CTX->hosts().at(metadata_host);
+        LOG(DEBUG, "Sending RPC to host: {}", metadata_endp.to_string());
+        handles.emplace_back(metadata_host, [metadata_endp, path]() {
+            return ld_network_service->post<gkfs::rpc::remove>(metadata_endp, path);
+        });
+        for (const auto& host : data_hosts) {
+            auto endp = CTX->hosts().at(host);
+            LOG(DEBUG, "Sending reclaim RPC to host: {}", endp.to_string());
+            // never repeated: a late copy would detach the chunks of a file created again at the same path
+            reclaim_handles.emplace_back(host, [endp, path]() {
+                return ld_network_service->post<gkfs::rpc::reclaim_chunks>(endp, path);
+            });
         }
+    } catch (const std::exception& ex) {
+        // TODO(amiranda): we should cancel all previously posted requests
+        // here, unfortunately, Hermes does not support it yet :/
+        LOG(ERROR, "Failed to send remove requests");
+        throw std::runtime_error(
+                "Failed to forward non-blocking rpc request");
     }
     // wait for RPC responses
     bool got_error = false;
 
-    for (const auto& h : handles) {
-
+    auto wait_for = [&got_error](auto& h) {
         try {
-            // XXX We might need a timeout here to not wait forever for an
-            // output that never comes?
-            auto out = h.get().at(0);
+            auto out = h.get();
 
             if (out.err() != 0) {
                 LOG(ERROR, "received error response: {}", out.err());
                 got_error = true;
                 errno = out.err();
             }
+        } catch (const rpc_timeout_error& ex) {
+            LOG(ERROR, "while getting rpc output: {}", ex.what());
+            got_error = true;
+            errno = ETIMEDOUT;
         } catch (const std::exception& ex) {
             LOG(ERROR, "while getting rpc output");
             got_error = true;
             errno = EBUSY;
         }
+    };
+    for (auto& h : handles) {
+        wait_for(h);
+    }
+    for (auto& h : reclaim_handles) {
+        wait_for(h);
     }
 
     return got_error ? -1 : 0;
@@ -207,17 +218,15 @@ int forward_remove(const std::string& path, const bool remove_metadentry_only, c
 
 int forward_decr_size(const std::string& path, size_t length) {
 
-    auto endp = CTX->hosts().at(CTX->distributor()->locate_file_metadata(path));
+    auto host = CTX->distributor()->locate_file_metadata(path);
+    auto endp = CTX->hosts().at(host);
 
     try {
 
         LOG(DEBUG, "Sending RPC ...");
-        // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we can
-        // retry for RPC_TRIES (see old commits with margo)
-        // TODO(amiranda): hermes will eventually provide a post(endpoint)
-        // returning one result and a broadcast(endpoint_set) returning a
-        // result_set. When that happens we can remove the .at(0) :/
-        auto out = ld_network_service->post<gkfs::rpc::decr_size>(endp, path, length).get().at(0);
+        auto out = forward_and_wait<gkfs::rpc::decr_size>(host, [&]() {
+            return ld_network_service->post<gkfs::rpc::decr_size>(endp, path, length);
+        });
 
         LOG(DEBUG, "Got response success: {}", out.err());
 
@@ -228,6 +237,10 @@ int forward_decr_size(const std::string& path, size_t length) {
 
         return 0;
 
+    } catch (const rpc_timeout_error& ex) {
+        LOG(ERROR, "while getting rpc output: {}", ex.what());
+        errno = ETIMEDOUT;
+        return -1;
     } catch (const std::exception& ex) {
         LOG(ERROR, "while getting rpc output");
         errno = EBUSY;
@@ -238,35 +251,36 @@ int forward_decr_size(const std::string& path, size_t length) {
 int forward_update_metadentry(const string& path, const gkfs::metadata::Metadata& md,
                               const gkfs::metadata::MetadentryUpdateFlags& md_flags) {
 
-    auto endp = CTX->hosts().at(CTX->distributor()->locate_file_metadata(path));
+    auto host = CTX->distributor()->locate_file_metadata(path);
+    auto endp = CTX->hosts().at(host);
 
     try {
 
         LOG(DEBUG, "Sending RPC ...");
-        // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we can
-        // retry for RPC_TRIES (see old commits with margo)
-        // TODO(amiranda): hermes will eventually provide a post(endpoint)
-        // returning one result and a broadcast(endpoint_set) returning a
-        // result_set. When that happens we can remove the .at(0) :/
-        auto out = ld_network_service->post<gkfs::rpc::update_metadentry>(
-                endp,
-                path,
-                (md_flags.link_count ? md.link_count() : 0),
-                /* mode */ 0,
-                /* uid */  0,
-                /* gid */  0,
-                (md_flags.size ? md.size() : 0),
-                (md_flags.blocks ? md.blocks() : 0),
-                (md_flags.atime ? md.atime() : 0),
-                (md_flags.mtime ? md.mtime() : 0),
-                (md_flags.ctime ? md.ctime() : 0),
-                bool_to_merc_bool(md_flags.link_count),
-                /* mode_flag */ false,
-                bool_to_merc_bool(md_flags.size),
-                bool_to_merc_bool(md_flags.blocks),
-                bool_to_merc_bool(md_flags.atime),
-                bool_to_merc_bool(md_flags.mtime),
-                bool_to_merc_bool(md_flags.ctime)).get().at(0);
+        auto out = forward_and_wait<gkfs::rpc::update_metadentry>(host, [&]() {
+            return ld_network_service->post<gkfs::rpc::update_metadentry>(
+                    endp,
+                    path,
+                    (md_flags.link_count ? md.link_count() : 0),
+                    /* mode */ 0,
+                    /* uid */  0,
+                    /* gid */  0,
+                    (md_flags.size ? md.size() : 0),
+                    (md_flags.blocks ? md.blocks() : 0),
+                    (md_flags.atime ? md.atime() : 0),
+                    (md_flags.mtime ? md.mtime() : 0),
+                    (md_flags.ctime ? md.ctime() : 0),
+                    (md_flags.layout ? md.layout().chunk_size : 0),
+                    (md_flags.layout ? md.layout().stripe_width : 0),
+                    bool_to_merc_bool(md_flags.link_count),
+                    /* mode_flag */ false,
+                    bool_to_merc_bool(md_flags.size),
+                    bool_to_merc_bool(md_flags.blocks),
+                    bool_to_merc_bool(md_flags.atime),
+                    bool_to_merc_bool(md_flags.mtime),
+                    bool_to_merc_bool(md_flags.ctime),
+                    bool_to_merc_bool(md_flags.layout));
+        });
 
         LOG(DEBUG, "Got response success: {}", out.err());
 
@@ -277,6 +291,10 @@ int forward_update_metadentry(const string& path, const gkfs::metadata::Metadata
 
         return 0;
 
+    } catch (const rpc_timeout_error& ex) {
+        LOG(ERROR, "while getting rpc output: {}", ex.what());
+        errno = ETIMEDOUT;
+        return -1;
     } catch (const std::exception& ex) {
         LOG(ERROR, "while getting rpc output");
         errno = EBUSY;
@@ -286,21 +304,23 @@ int forward_update_metadentry(const string& path, const gkfs::metadata::Metadata
 
 int
 forward_update_metadentry_size(const string& path, const size_t size, const off64_t offset, const bool append_flag,
-                               off64_t& ret_size) {
+                               off64_t& ret_size, const std::function<void()>& overlap) {
 
-    auto endp = CTX->hosts().at(CTX->distributor()->locate_file_metadata(path));
+    auto host = CTX->distributor()->locate_file_metadata(path);
+    auto endp = CTX->hosts().at(host);
 
     try {
 
         LOG(DEBUG, "Sending RPC ...");
-        // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we can
-        // retry for RPC_TRIES (see old commits with margo)
-        // TODO(amiranda): hermes will eventually provide a post(endpoint)
-        // returning one result and a broadcast(endpoint_set) returning a
-        // result_set. When that happens we can remove the .at(0) :/
-        auto out = ld_network_service->post<gkfs::rpc::update_metadentry_size>(
-                endp, path, size, offset,
-                bool_to_merc_bool(append_flag)).get().at(0);
+        OutstandingRpc<gkfs::rpc::update_metadentry_size> rpc(host, [&]() {
+            return ld_network_service->post<gkfs::rpc::update_metadentry_size>(
+                    endp, path, size, offset,
+                    bool_to_merc_bool(append_flag));
+        });
+        if (overlap) {
+            overlap();
+        }
+        auto out = rpc.get();
 
         LOG(DEBUG, "Got response success: {}", out.err());
 
@@ -310,10 +330,13 @@ forward_update_metadentry_size(const string& path, const size_t size, const off6
         }
 
         ret_size = out.ret_size();
-        return out.err();
-
         return 0;
 
+    } catch (const rpc_timeout_error& ex) {
+        LOG(ERROR, "while getting rpc output: {}", ex.what());
+        errno = ETIMEDOUT;
+        ret_size = 0;
+        return -1;
     } catch (const std::exception& ex) {
         LOG(ERROR, "while getting rpc output");
         errno = EBUSY;
@@ -324,23 +347,32 @@ forward_update_metadentry_size(const string& path, const size_t size, const off6
 
 int forward_get_metadentry_size(const std::string& path, off64_t& ret_size) {
 
-    auto endp = CTX->hosts().at(CTX->distributor()->locate_file_metadata(path));
+    auto host = CTX->distributor()->locate_file_metadata(path);
+    auto endp = CTX->hosts().at(host);
 
     try {
 
         LOG(DEBUG, "Sending RPC ...");
-        // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we can
-        // retry for RPC_TRIES (see old commits with margo)
-        // TODO(amiranda): hermes will eventually provide a post(endpoint)
-        // returning one result and a broadcast(endpoint_set) returning a
-        // result_set. When that happens we can remove the .at(0) :/
-        auto out = ld_network_service->post<gkfs::rpc::get_metadentry_size>(endp, path).get().at(0);
+        auto out = forward_and_wait<gkfs::rpc::get_metadentry_size>(host, [&]() {
+            return ld_network_service->post<gkfs::rpc::get_metadentry_size>(endp, path);
+        }, RpcRetry::hedged);
 
         LOG(DEBUG, "Got response success: {}", out.err());
 
+        if (out.err() != 0) {
+            errno = out.err();
+            ret_size = 0;
+            return -1;
+        }
+
         ret_size = out.ret_size();
-        return out.err();
+        return 0;
 
+    } catch (const rpc_timeout_error& ex) {
+        LOG(ERROR, "while getting rpc output: {}", ex.what());
+        errno = ETIMEDOUT;
+        ret_size = 0;
+        return -1;
     } catch (const std::exception& ex) {
         LOG(ERROR, "while getting rpc output");
         errno = EBUSY;
@@ -357,38 +389,25 @@ void forward_get_dirents(gkfs::filemap::OpenDir& open_dir) {
     auto const root_dir = open_dir.path();
     auto const targets = CTX->distributor()->locate_directory_metadata(root_dir);
 
-    /* preallocate receiving buffer. The actual size is not known yet.
-     *
-     * On C++14 make_unique function also zeroes the newly allocated buffer.
-     * It turns out that this operation is increadibly slow for such a big
-     * buffer. Moreover we don't need a zeroed buffer here.
-     */
-    auto large_buffer = std::unique_ptr<char[]>(new char[gkfs::config::rpc::dirents_buff_size]);
-
     //XXX there is a rounding error here depending on the number of targets...
     const std::size_t per_host_buff_size = gkfs::config::rpc::dirents_buff_size / targets.size();
 
-    // expose local buffers for RMA from servers
-    std::vector<hermes::exposed_memory> exposed_buffers;
-    exposed_buffers.reserve(targets.size());
+    /* receiving buffers of each host, exposed for RMA from servers. The actual size is not known yet.
+     * A copy of a request that is still in flight after a retry keeps its buffer alive until it is done.
+     */
+    std::vector<TransferBuffer> buffers;
+    buffers.reserve(targets.size());
 
     for (std::size_t i = 0; i < targets.size(); ++i) {
         try {
-            exposed_buffers.emplace_back(ld_network_service->expose(
-                    std::vector<hermes::mutable_buffer>{
-                            hermes::mutable_buffer{
-                                    large_buffer.get() + (i * per_host_buff_size),
-                                    per_host_buff_size
-                            }
-                    },
-                    hermes::access_mode::write_only));
+            buffers.emplace_back(per_host_buff_size, hermes::access_mode::write_only);
         } catch (const std::exception& ex) {
             throw std::runtime_error("Failed to expose buffers for RMA");
         }
     }
 
     // send RPCs
-    std::vector<hermes::rpc_handle<gkfs::rpc::get_dirents>> handles;
+    std::vector<OutstandingRpc<gkfs::rpc::get_dirents>> handles;
 
     for (std::size_t i = 0; i < targets.size(); ++i) {
 
@@ -397,12 +416,14 @@ void forward_get_dirents(gkfs::filemap::OpenDir& open_dir) {
         // Setup rpc input parameters for each host
         auto endp = CTX->hosts().at(targets[i]);
 
-        gkfs::rpc::get_dirents::input in(root_dir, exposed_buffers[i]);
+        gkfs::rpc::get_dirents::input in(root_dir, buffers[i].exposed());
 
         try {
 
             LOG(DEBUG, "Sending RPC to host: {}", targets[i]);
-            handles.emplace_back(ld_network_service->post<gkfs::rpc::get_dirents>(endp, in));
+            handles.emplace_back(targets[i], [endp, in]() mutable {
+                return ld_network_service->post<gkfs::rpc::get_dirents>(endp, in);
+            }, RpcRetry::idempotent, buffers[i].transfer());
         } catch (const std::exception& ex) {
             LOG(ERROR, "Unable to send non-blocking get_dirents() "
                        "on {} [peer: {}]", root_dir, targets[i]);
@@ -416,9 +437,7 @@ void forward_get_dirents(gkfs::filemap::OpenDir& open_dir) {
         gkfs::rpc::get_dirents::output out;
 
         try {
-            // XXX We might need a timeout here to not wait forever for an
-            // output that never comes?
-            out = handles[i].get().at(0);
+            out = handles[i].get();
 
             if (out.err() != 0) {
                 throw std::runtime_error(
@@ -432,11 +451,9 @@ void forward_get_dirents(gkfs::filemap::OpenDir& open_dir) {
                                 "target host: {}]", root_dir, targets[i]));
         }
 
-        // each server wrote information to its pre-defined region in
-        // large_buffer, recover it by computing the base_address for each
-        // particular server and adding the appropriate offsets
-        assert(exposed_buffers[i].count() == 1);
-        void* base_ptr = exposed_buffers[i].begin()->data();
+        // each server wrote information to its own buffer, recover it by
+        // adding the appropriate offsets to the buffer's base address
+        void* base_ptr = buffers[i].data();
 
         bool* bool_ptr = reinterpret_cast<bool*>(base_ptr);
         char* names_ptr = reinterpret_cast<char*>(base_ptr) +
@@ -464,17 +481,15 @@ void forward_get_dirents(gkfs::filemap::OpenDir& open_dir) {
 
 int forward_mk_symlink(const std::string& path, const std::string& target_path) {
 
-    auto endp = CTX->hosts().at(CTX->distributor()->locate_file_metadata(path));
+    auto host = CTX->distributor()->locate_file_metadata(path);
+    auto endp = CTX->hosts().at(host);
 
     try {
 
         LOG(DEBUG, "Sending RPC ...");
-        // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we can
-        // retry for RPC_TRIES (see old commits with margo)
-        // TODO(amiranda): hermes will eventually provide a post(endpoint)
-        // returning one result and a broadcast(endpoint_set) returning a
-        // result_set. When that happens we can remove the .at(0) :/
-        auto out = ld_network_service->post<gkfs::rpc::mk_symlink>(endp, path, target_path).get().at(0);
+        auto out = forward_and_wait<gkfs::rpc::mk_symlink>(host, [&]() {
+            return ld_network_service->post<gkfs::rpc::mk_symlink>(endp, path, target_path);
+        });
 
         LOG(DEBUG, "Got response success: {}", out.err());
 
@@ -485,6 +500,10 @@ int forward_mk_symlink(const std::string& path, const std::string& target_path)
 
         return 0;
 
+    } catch (const rpc_timeout_error& ex) {
+        LOG(ERROR, "while getting rpc output: {}", ex.what());
+        errno = ETIMEDOUT;
+        return -1;
     } catch (const std::exception& ex) {
         LOG(ERROR, "while getting rpc output");
         errno = EBUSY;
@@ -0,0 +1,121 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <client/rpc/registration_cache.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+namespace gkfs {
+namespace rpc {
+
+RegistrationCache::RegistrationCache(size_t budget, expose_function expose) :
+        budget_(budget),
+        expose_(move(expose)),
+        pinned_(0),
+        max_entry_size_(0),
+        empty_(true) {}
+
+RegistrationCache::entry_map::iterator RegistrationCache::find(uintptr_t addr, hermes::access_mode mode) {
+    auto range = entries_.equal_range(addr);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.mode == mode) {
+            return it;
+        }
+    }
+    return entries_.end();
+}
+
+void RegistrationCache::erase(entry_map::iterator it) {
+    pinned_ -= it->second.size;
+    lru_.erase(it->second.lru_pos);
+    entries_.erase(it);
+    if (entries_.empty()) {
+        max_entry_size_ = 0;
+        empty_ = true;
+    }
+}
+
+shared_ptr<hermes::exposed_memory> RegistrationCache::expose(void* buf, size_t size, hermes::access_mode mode) {
+    auto addr = reinterpret_cast<uintptr_t>(buf);
+    {
+        lock_guard<mutex> lock(mutex_);
+        auto it = find(addr, mode);
+        // daemons derive transfer sizes from the size of the exposed region, so it must match exactly
+        if (it != entries_.end() && it->second.size == size) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+            return it->second.memory;
+        }
+    }
+
+    // registering may take long, don't block other threads meanwhile
+    auto memory = expose_(buf, size, mode);
+    if (size > budget_) {
+        return memory;
+    }
+
+    lock_guard<mutex> lock(mutex_);
+    auto it = find(addr, mode);
+    if (it != entries_.end()) {
+        // a region of another size or one registered by a concurrent call
+        erase(it);
+    }
+    while (pinned_ + size > budget_ && !lru_.empty()) {
+        erase(lru_.back());
+    }
+    it = entries_.emplace(addr, Entry{size, mode, memory, {}});
+    lru_.push_front(it);
+    it->second.lru_pos = lru_.begin();
+    pinned_ += size;
+    max_entry_size_ = max(max_entry_size_, size);
+    empty_ = false;
+    return memory;
+}
+
+void RegistrationCache::invalidate(const void* addr, size_t size) {
+    // munmap() and brk() are frequent, most of them don't concern cached buffers
+    if (empty_ || size == 0) {
+        return;
+    }
+    auto begin = reinterpret_cast<uintptr_t>(addr);
+    auto end = begin + size;
+
+    lock_guard<mutex> lock(mutex_);
+    auto it = entries_.lower_bound(begin > max_entry_size_ ? begin - max_entry_size_ : 0);
+    while (it != entries_.end() && it->first < end) {
+        auto next = std::next(it);
+        if (it->first + it->second.size > begin) {
+            erase(it);
+        }
+        it = next;
+    }
+}
+
+void RegistrationCache::clear() {
+    lock_guard<mutex> lock(mutex_);
+    entries_.clear();
+    lru_.clear();
+    pinned_ = 0;
+    max_entry_size_ = 0;
+    empty_ = true;
+}
+
+size_t RegistrationCache::pinned() const {
+    lock_guard<mutex> lock(mutex_);
+    return pinned_;
+}
+
+} // namespace rpc
+} // namespace gkfs
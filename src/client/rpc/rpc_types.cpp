@@ -36,5 +36,11 @@ void hermes::detail::register_user_request_types() {
     (void) registered_requests().add<gkfs::rpc::trunc_data>();
     (void) registered_requests().add<gkfs::rpc::get_dirents>();
     (void) registered_requests().add<gkfs::rpc::chunk_stat>();
+    (void) registered_requests().add<gkfs::rpc::get_load>();
+    (void) registered_requests().add<gkfs::rpc::write_inline>();
+    (void) registered_requests().add<gkfs::rpc::read_inline>();
+    (void) registered_requests().add<gkfs::rpc::promote_inline>();
+    (void) registered_requests().add<gkfs::rpc::seek_data>();
+    (void) registered_requests().add<gkfs::rpc::reclaim_chunks>();
 
 }
\ No newline at end of file
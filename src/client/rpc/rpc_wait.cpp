@@ -0,0 +1,182 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <client/rpc/rpc_wait.hpp>
+#include <client/env.hpp>
+#include <client/logging.hpp>
+
+#include <global/env_util.hpp>
+#include <config.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+
+using namespace std;
+
+namespace gkfs {
+namespace rpc {
+
+namespace {
+
+chrono::milliseconds timeout{gkfs::config::rpc::timeout_ms};
+unsigned int retries = gkfs::config::rpc::retries;
+bool hedging = false;
+
+unsigned int histograms_size = 0;
+// never freed: waiter threads may still record latencies while the library is unloaded
+gkfs::util::LatencyHistogram* histograms = nullptr;
+
+// waits for the copies of requests with a deadline and the threads running them
+mutex waits_mutex;
+condition_variable waits_cv;
+// signaled when a reserved waiter becomes free again
+condition_variable waiters_cv;
+deque<function<void()>> waits;
+size_t waiters = 0;
+// reserved by copies that are queued or being waited for, never more than waiters
+size_t reserved_waiters = 0;
+
+void run_waiter() {
+    unique_lock<mutex> lock(waits_mutex);
+    while (true) {
+        waits_cv.wait(lock, []() { return !waits.empty(); });
+        {
+            auto wait = move(waits.front());
+            waits.pop_front();
+            lock.unlock();
+            wait();
+            // what the copy kept alive is released outside of the lock
+        }
+        lock.lock();
+        reserved_waiters--;
+        waiters_cv.notify_one();
+    }
+}
+
+unsigned long env_to_ulong(const char* name, unsigned long default_value) {
+    auto value = gkfs::env::get_var(name, to_string(default_value));
+    try {
+        return stoul(value);
+    } catch (const exception& e) {
+        LOG(WARNING, "Ignoring invalid value '{}' of {}", value, name);
+        return default_value;
+    }
+}
+
+} // namespace
+
+/**
+ * Reads the RPC deadline settings from the environment and sets up a latency histogram per daemon.
+ * Must be called before the first request is sent
+ * @param hosts_size
+ */
+void init_rpc_wait(unsigned int hosts_size) {
+    timeout = chrono::milliseconds(env_to_ulong(gkfs::env::RPC_TIMEOUT, gkfs::config::rpc::timeout_ms));
+    retries = static_cast<unsigned int>(env_to_ulong(gkfs::env::RPC_RETRIES, gkfs::config::rpc::retries));
+    hedging = env_to_ulong(gkfs::env::RPC_HEDGE, 0) != 0;
+
+    histograms_size = hosts_size;
+    histograms = new gkfs::util::LatencyHistogram[hosts_size];
+
+    LOG(INFO, "RPC timeout {} ms, {} retries, hedging {}", timeout.count(), retries, hedging ? "on" : "off");
+}
+
+chrono::milliseconds rpc_timeout() {
+    return timeout;
+}
+
+unsigned int rpc_retries() {
+    return retries;
+}
+
+bool rpc_hedging() {
+    return hedging;
+}
+
+bool waits_with_deadline(RpcRetry retry) {
+    return timeout.count() > 0 || (retry == RpcRetry::hedged && hedging);
+}
+
+gkfs::util::LatencyHistogram& host_latency(unsigned int host) {
+    return histograms[host];
+}
+
+/**
+ * Time after which a duplicate of a request to the host is sent: the host's p99 latency
+ * @param host
+ * @return zero if too few latencies of the host are known
+ */
+chrono::microseconds hedge_delay(unsigned int host) {
+    auto& histogram = host_latency(host);
+    if (histogram.count() < gkfs::config::rpc::hedge_min_samples) {
+        return chrono::microseconds(0);
+    }
+    return chrono::microseconds(histogram.quantile(gkfs::config::rpc::hedge_percentile));
+}
+
+void log_host_latencies() {
+    for (unsigned int host = 0; host < histograms_size; host++) {
+        auto& histogram = histograms[host];
+        if (histogram.count() == 0) {
+            continue;
+        }
+        LOG(INFO, "Daemon {}: {} requests, p50 < {} us, p99 < {} us", host, histogram.count(),
+            histogram.quantile(0.5), histogram.quantile(0.99));
+    }
+}
+
+namespace detail {
+
+bool reserve_waiter(chrono::steady_clock::time_point until) {
+    unique_lock<mutex> lock(waits_mutex);
+    auto has_free = []() { return reserved_waiters < gkfs::config::rpc::max_waiters; };
+    if (!waiters_cv.wait_until(lock, until, has_free)) {
+        return false;
+    }
+    reserved_waiters++;
+    if (reserved_waiters <= waiters) {
+        return true;
+    }
+    // waiters block on copies that may never answer, so none is taken away from them. Waiters are detached, as one
+    // may still wait for a daemon that is gone when the library is unloaded
+    try {
+        thread(run_waiter).detach();
+    } catch (const system_error& e) {
+        reserved_waiters--;
+        LOG(ERROR, "Failed to start a thread waiting for daemons: {}", e.what());
+        return false;
+    }
+    waiters++;
+    return true;
+}
+
+void release_waiter() {
+    lock_guard<mutex> lock(waits_mutex);
+    reserved_waiters--;
+    waiters_cv.notify_one();
+}
+
+void wait_in_background(function<void()> wait) {
+    lock_guard<mutex> lock(waits_mutex);
+    waits.push_back(move(wait));
+    waits_cv.notify_one();
+}
+
+} // namespace detail
+
+} // namespace rpc
+} // namespace gkfs
@@ -0,0 +1,203 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <client/rpc/shm_region.hpp>
+#include <client/preload_util.hpp>
+#include <client/logging.hpp>
+#include <client/env.hpp>
+
+#include <global/env_util.hpp>
+#include <global/rpc/shm_region.hpp>
+#include <config.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <system_error>
+
+#include <libsyscall_intercept_hook_point.h>
+
+extern "C" {
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+}
+
+// glibc < 2.27 does not define them
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+
+using namespace std;
+
+namespace gkfs {
+namespace rpc {
+
+ShmRegion::ShmRegion(size_t size) : id_(0), fd_(-1), base_(nullptr), size_(size), pid_(getpid()) {
+    auto fd = syscall_no_intercept(SYS_memfd_create, gkfs::rpc::shm::memfd_name, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (syscall_error_code(fd) != 0) {
+        throw system_error(syscall_error_code(fd), system_category(), "Failed to create shared memory");
+    }
+    fd_ = CTX->register_internal_fd(static_cast<int>(fd));
+    auto ret = syscall_no_intercept(SYS_ftruncate, fd_, size_);
+    if (syscall_error_code(ret) == 0) {
+        // the daemon only maps sealed regions, which cannot be truncated under its mapping
+        ret = syscall_no_intercept(SYS_fcntl, fd_, F_ADD_SEALS, gkfs::rpc::shm::required_seals);
+    }
+    if (syscall_error_code(ret) == 0) {
+        ret = syscall_no_intercept(SYS_mmap, nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    }
+    if (syscall_error_code(ret) != 0) {
+        CTX->unregister_internal_fd(fd_);
+        syscall_no_intercept(SYS_close, fd_);
+        throw system_error(syscall_error_code(ret), system_category(), "Failed to map shared memory");
+    }
+    base_ = reinterpret_cast<char*>(ret);
+
+    random_device rd;
+    while (id_ == 0) {
+        id_ = (static_cast<uint64_t>(rd()) << 32) | rd();
+    }
+    gkfs::rpc::shm::Header header{id_};
+    memcpy(base_, &header, sizeof(header));
+}
+
+ShmRegion::~ShmRegion() {
+    syscall_no_intercept(SYS_munmap, base_, size_);
+    CTX->unregister_internal_fd(fd_);
+    syscall_no_intercept(SYS_close, fd_);
+}
+
+uint64_t ShmRegion::id() const {
+    return id_;
+}
+
+int ShmRegion::fd() const {
+    return fd_;
+}
+
+pid_t ShmRegion::pid() const {
+    return pid_;
+}
+
+char* ShmRegion::data() const {
+    return base_ + gkfs::rpc::shm::data_offset;
+}
+
+size_t ShmRegion::capacity() const {
+    return size_ - gkfs::rpc::shm::data_offset;
+}
+
+namespace {
+
+size_t region_size = 0;
+atomic<bool> enabled{false};
+mutex region_mutex;
+// created on first use, so that processes without I/O do not allocate it
+unique_ptr<ShmRegion> region;
+
+} // namespace
+
+ShmLease::ShmLease() : region_(nullptr) {}
+
+ShmLease::ShmLease(unique_lock<mutex> lock, ShmRegion* region) : lock_(move(lock)), region_(region) {}
+
+ShmLease::operator bool() const {
+    return region_ != nullptr;
+}
+
+ShmRegion* ShmLease::operator->() const {
+    return region_;
+}
+
+void ShmLease::discard() {
+    if (region_) {
+        LOG(WARNING, "Dropping shared memory region {}, its daemon may still access it", region_->id());
+        region.reset();
+        region_ = nullptr;
+        lock_ = {};
+    }
+}
+
+/**
+ * Enables shared memory with the daemon on this node with the region size from LIBGKFS_SHM_SIZE. A size of 0
+ * disables it
+ */
+void init_shm_region() {
+#ifdef GKFS_ENABLE_FORWARDING
+    // data goes to I/O forwarders, which do not run on the client's node
+    LOG(INFO, "Shared memory is not used with I/O forwarding");
+#else
+    auto size_str = gkfs::env::get_var(gkfs::env::SHM_SIZE, to_string(gkfs::config::rpc::shm_region_size));
+    try {
+        region_size = stoull(size_str);
+    } catch (const exception& e) {
+        LOG(WARNING, "Ignoring invalid shared memory size '{}'", size_str);
+        region_size = gkfs::config::rpc::shm_region_size;
+    }
+    if (region_size > 0 && region_size <= gkfs::rpc::shm::data_offset) {
+        LOG(WARNING, "Shared memory size {} leaves no room for data, disabling it", region_size);
+        region_size = 0;
+    }
+    enabled = region_size > 0;
+    LOG(INFO, "Shared memory with the local daemon: {} bytes", region_size);
+#endif
+}
+
+void destroy_shm_region() {
+    enabled = false;
+    lock_guard<mutex> lock(region_mutex);
+    region.reset();
+}
+
+bool shm_host(uint64_t host) {
+    return enabled && host == CTX->local_host_id();
+}
+
+ShmLease lease_shm_region(size_t size) {
+    if (!enabled || size > region_size - gkfs::rpc::shm::data_offset) {
+        return {};
+    }
+    unique_lock<mutex> lock(region_mutex, try_to_lock);
+    if (!lock.owns_lock() || !enabled) {
+        return {};
+    }
+    if (!region || region->pid() != getpid()) {
+        // after fork() the region is shared with the parent, which may be using it
+        region.reset();
+        try {
+            region = make_unique<ShmRegion>(region_size);
+        } catch (const system_error& e) {
+            LOG(ERROR, "Disabling shared memory: {}", e.what());
+            enabled = false;
+            return {};
+        }
+        LOG(DEBUG, "Created shared memory region {} (fd {}, {} bytes)", region->id(), region->fd(), region_size);
+    }
+    return {move(lock), region.get()};
+}
+
+void disable_shm_region() {
+    if (enabled.exchange(false)) {
+        LOG(WARNING, "The local daemon cannot use shared memory, using bulk transfers");
+    }
+}
+
+} // namespace rpc
+} // namespace gkfs
@@ -0,0 +1,72 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <client/rpc/transfer_buffer.hpp>
+#include <client/rpc/registration_cache.hpp>
+#include <client/preload_util.hpp>
+
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+namespace gkfs {
+namespace rpc {
+
+TransferBuffer::TransferBuffer(void* buf, size_t size, hermes::access_mode mode, RpcRetry retry) :
+        buf_(static_cast<char*>(buf)) {
+    if (!waits_with_deadline(retry)) {
+        cached_ = expose_user_buffer(buf, size, mode);
+        return;
+    }
+    own_ = make_shared<Memory>();
+    own_->data.reset(new char[size]);
+    if (mode == hermes::access_mode::read_only) {
+        memcpy(own_->data.get(), buf, size);
+    }
+    vector<hermes::mutable_buffer> bufseq{
+            hermes::mutable_buffer{own_->data.get(), size},
+    };
+    own_->exposed = make_unique<hermes::exposed_memory>(ld_network_service->expose(bufseq, mode));
+}
+
+TransferBuffer::TransferBuffer(size_t size, hermes::access_mode mode) : buf_(nullptr) {
+    own_ = make_shared<Memory>();
+    // not zeroed, as that takes long for large buffers and daemons tell how much they have written
+    own_->data.reset(new char[size]);
+    vector<hermes::mutable_buffer> bufseq{
+            hermes::mutable_buffer{own_->data.get(), size},
+    };
+    own_->exposed = make_unique<hermes::exposed_memory>(ld_network_service->expose(bufseq, mode));
+}
+
+const hermes::exposed_memory& TransferBuffer::exposed() const {
+    return own_ ? *own_->exposed : *cached_;
+}
+
+char* TransferBuffer::data() const {
+    return own_ ? own_->data.get() : buf_;
+}
+
+shared_ptr<void> TransferBuffer::transfer() const {
+    return own_;
+}
+
+void TransferBuffer::copy_out(size_t pos, size_t size) const {
+    if (own_ && buf_ && size > 0) {
+        memcpy(buf_ + pos, own_->data.get() + pos, size);
+    }
+}
+
+} // namespace rpc
+} // namespace gkfs
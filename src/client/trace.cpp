@@ -0,0 +1,365 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <client/trace.hpp>
+#include <client/env.hpp>
+#include <client/logging.hpp>
+#include <client/syscalls/syscall.hpp>
+
+#include <global/env_util.hpp>
+
+#include <cstring>
+#include <unordered_set>
+#include <vector>
+
+extern "C" {
+#include <fcntl.h>
+#include <syscall.h>
+#include <sys/uio.h>
+#include <libsyscall_intercept_hook_point.h>
+}
+
+namespace gkfs {
+namespace trace {
+
+std::atomic<bool> tracing{false};
+
+namespace {
+
+constexpr auto buffer_records = gkfs::config::log::trace_buffer_records;
+
+/*
+ * Records of one thread. Only the owning thread appends, `busy` just keeps finalize() from writing the buffer while
+ * its owner is appending. Buffers are never freed but handed to new threads once their owner has exited.
+ */
+struct Buffer {
+    std::atomic_flag busy = ATOMIC_FLAG_INIT;
+    std::atomic<bool> in_use{true};
+    uint32_t tid{0};
+    uint32_t count{0};
+    Buffer* next{nullptr};
+    Record records[buffer_records];
+    // paths not yet written and the hashes of all paths this buffer has written
+    std::vector<char> paths;
+    uint32_t path_count{0};
+    std::unordered_set<uint64_t> known_paths;
+};
+
+std::atomic<Buffer*> buffers{nullptr};
+int trace_fd = -1;
+uint32_t trace_pid = 0;
+
+BlockHeader block_header(BlockType type, uint32_t count, uint32_t tid) {
+    struct timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    BlockHeader header{};
+    header.magic = BLOCK_MAGIC;
+    header.version = VERSION;
+    header.type = static_cast<uint16_t>(type);
+    header.count = count;
+    header.pid = trace_pid;
+    header.tid = tid;
+    header.tsc = now();
+    header.ns = static_cast<uint64_t>(ts.tv_sec) * 1000000000ul + ts.tv_nsec;
+    return header;
+}
+
+/*
+ * A single writev() to a file opened with O_APPEND, so blocks of different threads do not interleave
+ */
+void write_block(const BlockHeader& header, const void* entries, size_t size) {
+    struct iovec iov[2] = {
+            {const_cast<BlockHeader*>(&header), sizeof(header)},
+            {const_cast<void*>(entries), size}
+    };
+    ::syscall_no_intercept(SYS_writev, trace_fd, iov, 2);
+}
+
+void flush(Buffer& buf) {
+    if (buf.count == 0) {
+        return;
+    }
+    if (buf.path_count > 0) {
+        write_block(block_header(BlockType::paths, buf.path_count, buf.tid), buf.paths.data(), buf.paths.size());
+        buf.paths.clear();
+        buf.path_count = 0;
+    }
+    write_block(block_header(BlockType::records, buf.count, buf.tid), buf.records, buf.count * sizeof(Record));
+    buf.count = 0;
+}
+
+Buffer* acquire_buffer() {
+    auto tid = static_cast<uint32_t>(::syscall_no_intercept(SYS_gettid));
+    for (auto buf = buffers.load(std::memory_order_acquire); buf != nullptr; buf = buf->next) {
+        bool free = false;
+        if (!buf->in_use.load(std::memory_order_relaxed) &&
+            buf->in_use.compare_exchange_strong(free, true, std::memory_order_acquire)) {
+            buf->tid = tid;
+            return buf;
+        }
+    }
+    auto buf = new Buffer;
+    buf->tid = tid;
+    buf->next = buffers.load(std::memory_order_relaxed);
+    while (!buffers.compare_exchange_weak(buf->next, buf, std::memory_order_release, std::memory_order_relaxed));
+    return buf;
+}
+
+// hands the buffer back when the thread exits
+struct ThreadBuffer {
+    Buffer* buf{nullptr};
+
+    ~ThreadBuffer() {
+        if (buf == nullptr) {
+            return;
+        }
+        while (buf->busy.test_and_set(std::memory_order_acquire));
+        flush(*buf);
+        buf->busy.clear(std::memory_order_release);
+        buf->in_use.store(false, std::memory_order_release);
+    }
+};
+
+thread_local ThreadBuffer thread_buffer;
+
+void add_path(Buffer& buf, uint64_t hash, const char* path) {
+    if (!buf.known_paths.insert(hash).second) {
+        return;
+    }
+    PathHeader header{};
+    header.hash = hash;
+    header.length = static_cast<uint32_t>(::strlen(path));
+    auto pos = buf.paths.size();
+    buf.paths.resize(pos + path_entry_size(header.length), '\0');
+    ::memcpy(buf.paths.data() + pos, &header, sizeof(header));
+    ::memcpy(buf.paths.data() + pos + sizeof(header), path, header.length);
+    buf.path_count++;
+}
+
+uint64_t path_hash(long arg) {
+    auto path = reinterpret_cast<const char*>(arg);
+    if (path == nullptr) {
+        return 0;
+    }
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ul;
+    for (; *path != '\0'; ++path) {
+        hash ^= static_cast<unsigned char>(*path);
+        hash *= 1099511628211ul;
+    }
+    return hash;
+}
+
+uint64_t iov_size(long iov_arg, long iovcnt) {
+    auto iov = reinterpret_cast<const struct iovec*>(iov_arg);
+    uint64_t size = 0;
+    for (long i = 0; iov != nullptr && i < iovcnt; ++i) {
+        size += iov[i].iov_len;
+    }
+    return size;
+}
+
+/*
+ * Picks the fd, offset, size, flags and mode arguments of the file system syscalls that GekkoFS handles
+ * @return the path argument, nullptr if there is none
+ */
+const char* fill_arguments(Record& rec, long syscall_number, const long args[6]) {
+    rec.fd = -1;
+    rec.offset = -1;
+    long path = 0;
+    switch (syscall_number) {
+        case SYS_read:
+        case SYS_write:
+        case SYS_getdents:
+        case SYS_getdents64:
+            rec.fd = args[0];
+            rec.size = args[2];
+            break;
+        case SYS_pread64:
+        case SYS_pwrite64:
+            rec.fd = args[0];
+            rec.size = args[2];
+            rec.offset = args[3];
+            break;
+        case SYS_readv:
+        case SYS_writev:
+            rec.fd = args[0];
+            rec.size = iov_size(args[1], args[2]);
+            break;
+        case SYS_preadv:
+        case SYS_pwritev:
+        case SYS_preadv2:
+        case SYS_pwritev2:
+            rec.fd = args[0];
+            rec.size = iov_size(args[1], args[2]);
+            rec.offset = args[3];
+            break;
+        case SYS_lseek:
+            rec.fd = args[0];
+            rec.offset = args[1];
+            rec.flags = args[2];
+            break;
+        case SYS_ftruncate:
+            rec.fd = args[0];
+            rec.offset = args[1];
+            break;
+        case SYS_close:
+        case SYS_fstat:
+        case SYS_fsync:
+        case SYS_fdatasync:
+        case SYS_fchdir:
+        case SYS_fchmod:
+        case SYS_fchown:
+        case SYS_fstatfs:
+        case SYS_fcntl:
+        case SYS_dup:
+        case SYS_dup2:
+        case SYS_dup3:
+            rec.fd = args[0];
+            break;
+        case SYS_truncate:
+            path = args[0];
+            rec.offset = args[1];
+            break;
+        case SYS_open:
+            path = args[0];
+            rec.flags = args[1];
+            rec.mode = args[2];
+            break;
+        case SYS_creat:
+        case SYS_access:
+        case SYS_mkdir:
+        case SYS_chmod:
+            path = args[0];
+            rec.mode = args[1];
+            break;
+        case SYS_stat:
+        case SYS_lstat:
+        case SYS_rmdir:
+        case SYS_unlink:
+        case SYS_chdir:
+        case SYS_chown:
+        case SYS_readlink:
+        case SYS_statfs:
+            path = args[0];
+            break;
+        case SYS_openat:
+            rec.fd = args[0];
+            path = args[1];
+            rec.flags = args[2];
+            rec.mode = args[3];
+            break;
+        case SYS_mkdirat:
+        case SYS_faccessat:
+        case SYS_fchmodat:
+            rec.fd = args[0];
+            path = args[1];
+            rec.mode = args[2];
+            break;
+        case SYS_unlinkat:
+#ifdef SYS_statx
+        case SYS_statx:
+#endif
+            rec.fd = args[0];
+            path = args[1];
+            rec.flags = args[2];
+            break;
+        case SYS_newfstatat:
+            rec.fd = args[0];
+            path = args[1];
+            rec.flags = args[3];
+            break;
+        case SYS_readlinkat:
+        case SYS_fchownat:
+            rec.fd = args[0];
+            path = args[1];
+            break;
+        default:
+            break;
+    }
+    rec.path_hash = path_hash(path);
+    return reinterpret_cast<const char*>(path);
+}
+
+} // namespace
+
+void init() {
+    auto path = gkfs::env::get_var(gkfs::env::TRACE_FILE);
+    if (path.empty()) {
+        return;
+    }
+    trace_pid = static_cast<uint32_t>(::syscall_no_intercept(SYS_getpid));
+    path += "." + std::to_string(trace_pid);
+    // ::open() rather than syscall_no_intercept() so that the fd is moved to the internal range, see logger
+    trace_fd = ::open(path.c_str(), O_CREAT | O_WRONLY | O_APPEND | O_TRUNC | O_CLOEXEC, 0600);
+    if (trace_fd < 0) {
+        LOG(ERROR, "Failed to open trace file '{}': {}", path, ::strerror(errno));
+        return;
+    }
+
+    std::vector<SyscallName> names;
+    for (long nr = 0; nr < 512; ++nr) {
+        auto desc = gkfs::syscall::lookup_by_number(nr);
+        if (desc.number() != nr) {
+            continue;
+        }
+        SyscallName name{};
+        name.syscall = static_cast<uint16_t>(nr);
+        ::strncpy(name.name, desc.name(), sizeof(name.name) - 1);
+        names.push_back(name);
+    }
+    write_block(block_header(BlockType::names, names.size(), 0), names.data(), names.size() * sizeof(SyscallName));
+
+    LOG(INFO, "Tracing system calls to '{}'", path);
+    tracing = true;
+}
+
+void finalize() {
+    if (!tracing.exchange(false)) {
+        return;
+    }
+    for (auto buf = buffers.load(std::memory_order_acquire); buf != nullptr; buf = buf->next) {
+        while (buf->busy.test_and_set(std::memory_order_acquire));
+        flush(*buf);
+        buf->busy.clear(std::memory_order_release);
+    }
+}
+
+void record(long syscall_number, const long args[6], long result, uint64_t start, uint64_t end) {
+    auto& tb = thread_buffer;
+    if (tb.buf == nullptr) {
+        tb.buf = acquire_buffer();
+    }
+    auto& buf = *tb.buf;
+    if (buf.busy.test_and_set(std::memory_order_acquire)) {
+        // finalize() is writing this buffer
+        return;
+    }
+    auto& rec = buf.records[buf.count];
+    rec = Record{};
+    rec.start = start;
+    rec.end = end;
+    rec.result = result;
+    rec.syscall = static_cast<uint16_t>(syscall_number);
+    auto path = fill_arguments(rec, syscall_number, args);
+    if (path != nullptr) {
+        add_path(buf, rec.path_hash, path);
+    }
+    if (++buf.count == buffer_records) {
+        flush(buf);
+    }
+    buf.busy.clear(std::memory_order_release);
+}
+
+} // namespace trace
+} // namespace gkfs
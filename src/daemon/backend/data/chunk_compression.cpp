@@ -0,0 +1,165 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <daemon/backend/data/chunk_compression.hpp>
+#include <config.hpp>
+
+#include <stdexcept>
+#include <climits>
+#include <cstring>
+
+#include <lz4.h>
+#include <lz4hc.h>
+#include <zstd.h>
+#include <snappy-c.h>
+
+using namespace std;
+
+namespace gkfs {
+namespace data {
+
+CompressionType compression_type_from_string(const string& name) {
+    if (name == "none")
+        return CompressionType::none;
+    if (name == "lz4")
+        return CompressionType::lz4;
+    if (name == "zstd")
+        return CompressionType::zstd;
+    if (name == "snappy")
+        return CompressionType::snappy;
+    throw invalid_argument("Unknown compression '" + name + "'. Valid values: none, lz4, zstd, snappy");
+}
+
+string to_string(CompressionType type) {
+    switch (type) {
+        case CompressionType::none:
+            return "none";
+        case CompressionType::lz4:
+            return "lz4";
+        case CompressionType::zstd:
+            return "zstd";
+        case CompressionType::snappy:
+            return "snappy";
+    }
+    return "unknown";
+}
+
+ChunkCompressor::ChunkCompressor(CompressionType type, int level) :
+        type_(type),
+        level_(level) {}
+
+CompressionType ChunkCompressor::type() const {
+    return type_;
+}
+
+int ChunkCompressor::level() const {
+    return level_;
+}
+
+/**
+ * Estimates whether a buffer is worth compressing by compressing a few samples spread over it with LZ4, which is
+ * much cheaper than compressing everything with a slower algorithm only to throw the result away
+ * @param data
+ * @param size
+ * @return
+ */
+bool ChunkCompressor::sample_compressible(const char* data, size_t size) const {
+    constexpr size_t sample_size = gkfs::config::io::compression_sample_size;
+    constexpr size_t sample_count = gkfs::config::io::compression_sample_count;
+    if (sample_count < 2 || size <= sample_size * sample_count) {
+        return true;
+    }
+    char sample_out[LZ4_COMPRESSBOUND(sample_size)];
+    size_t compressed = 0;
+    for (size_t i = 0; i < sample_count; ++i) {
+        auto pos = i * (size - sample_size) / (sample_count - 1);
+        auto ret = LZ4_compress_default(data + pos, sample_out, sample_size, sizeof(sample_out));
+        compressed += ret > 0 ? static_cast<size_t>(ret) : sample_size;
+    }
+    return compressed * 100 <= sample_size * sample_count * (100 - gkfs::config::io::compression_min_saving_percent);
+}
+
+bool ChunkCompressor::compress(const char* data, size_t size, vector<char>& out) const {
+    if (type_ == CompressionType::none || size == 0 || size > INT_MAX || !sample_compressible(data, size)) {
+        return false;
+    }
+    size_t compressed = 0;
+    switch (type_) {
+        case CompressionType::lz4: {
+            out.resize(LZ4_compressBound(size));
+            auto ret = level_ > 0 ?
+                       LZ4_compress_HC(data, out.data(), size, out.size(), level_) :
+                       LZ4_compress_default(data, out.data(), size, out.size());
+            if (ret <= 0) {
+                return false;
+            }
+            compressed = ret;
+            break;
+        }
+        case CompressionType::zstd: {
+            out.resize(ZSTD_compressBound(size));
+            auto ret = ZSTD_compress(out.data(), out.size(), data, size, level_ > 0 ? level_ : ZSTD_CLEVEL_DEFAULT);
+            if (ZSTD_isError(ret)) {
+                return false;
+            }
+            compressed = ret;
+            break;
+        }
+        case CompressionType::snappy: {
+            auto out_size = snappy_max_compressed_length(size);
+            out.resize(out_size);
+            if (snappy_compress(data, size, out.data(), &out_size) != SNAPPY_OK) {
+                return false;
+            }
+            compressed = out_size;
+            break;
+        }
+        case CompressionType::none:
+            return false;
+    }
+    if (compressed * 100 > size * (100 - gkfs::config::io::compression_min_saving_percent)) {
+        return false;
+    }
+    out.resize(compressed);
+    return true;
+}
+
+void ChunkCompressor::decompress(CompressionType type, const char* in, size_t in_size, char* out,
+                                 size_t out_size) {
+    bool ok = false;
+    switch (type) {
+        case CompressionType::none:
+            ok = in_size == out_size;
+            if (ok) {
+                ::memcpy(out, in, out_size);
+            }
+            break;
+        case CompressionType::lz4:
+            ok = LZ4_decompress_safe(in, out, in_size, out_size) == static_cast<int>(out_size);
+            break;
+        case CompressionType::zstd:
+            ok = ZSTD_decompress(out, out_size, in, in_size) == out_size;
+            break;
+        case CompressionType::snappy: {
+            auto len = out_size;
+            ok = snappy_uncompress(in, in_size, out, &len) == SNAPPY_OK && len == out_size;
+            break;
+        }
+    }
+    if (!ok) {
+        throw runtime_error("Corrupt " + to_string(type) + " chunk payload");
+    }
+}
+
+} // namespace data
+} // namespace gkfs
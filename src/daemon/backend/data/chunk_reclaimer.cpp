@@ -0,0 +1,145 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <daemon/backend/data/chunk_reclaimer.hpp>
+#include <daemon/backend/data/chunk_storage.hpp>
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <spdlog/spdlog.h>
+
+extern "C" {
+#include <unistd.h>
+}
+
+namespace bfs = boost::filesystem;
+using namespace std;
+
+namespace gkfs {
+namespace data {
+
+ChunkReclaimer::ChunkReclaimer(shared_ptr<ChunkStorage> storage, const string& reclaim_path, size_t batch_size,
+                               chrono::milliseconds batch_interval) :
+        storage_(move(storage)),
+        reclaim_path_(reclaim_path),
+        batch_size_(batch_size),
+        batch_interval_(batch_interval),
+        rng_(random_device{}()) {
+    log = spdlog::get(LOGGER_NAME);
+    assert(log);
+
+    bfs::create_directories(reclaim_path_);
+    // chunks of files removed before the last shutdown
+    const bfs::directory_iterator end;
+    for (bfs::directory_iterator dir(reclaim_path_); dir != end; ++dir) {
+        queue_.push_back(dir->path().native());
+    }
+    log->debug("Chunk reclaimer initialized with path: '{}', {} directories left to reclaim", reclaim_path_,
+               queue_.size());
+    worker_ = thread(&ChunkReclaimer::run, this);
+}
+
+ChunkReclaimer::~ChunkReclaimer() {
+    {
+        lock_guard<mutex> lock(mtx_);
+        shutdown_ = true;
+    }
+    cv_.notify_all();
+    worker_.join();
+}
+
+void ChunkReclaimer::reclaim(const string& file_path) {
+    string target;
+    {
+        lock_guard<mutex> lock(mtx_);
+        target = fmt::format("{}/{:016x}", reclaim_path_, rng_());
+    }
+    if (!storage_->detach_chunk_space(file_path, target)) {
+        // no chunks on this daemon
+        return;
+    }
+    log->debug("Queued chunks of '{}' for reclamation in '{}'", file_path, target);
+    {
+        lock_guard<mutex> lock(mtx_);
+        queue_.push_back(target);
+    }
+    cv_.notify_one();
+}
+
+size_t ChunkReclaimer::pending() const {
+    lock_guard<mutex> lock(mtx_);
+    return queue_.size();
+}
+
+void ChunkReclaimer::run() {
+    unique_lock<mutex> lock(mtx_);
+    while (true) {
+        cv_.wait(lock, [this]() { return shutdown_ || !queue_.empty(); });
+        if (shutdown_) {
+            // the remaining directories are reclaimed after the next start
+            return;
+        }
+        auto dir = queue_.front();
+        queue_.pop_front();
+        lock.unlock();
+        auto done = reclaim_batch(dir);
+        lock.lock();
+        if (!done) {
+            // round robin so that a huge file does not delay the others
+            queue_.push_back(dir);
+        }
+        cv_.wait_for(lock, batch_interval_, [this]() { return shutdown_; });
+    }
+}
+
+/**
+ * Unlinks up to batch_size chunk files of a detached chunk directory and removes the directory once it is empty
+ * @param dir
+ * @return true if the directory is gone
+ */
+bool ChunkReclaimer::reclaim_batch(const string& dir) {
+    vector<bfs::path> chunk_files;
+    boost::system::error_code ec;
+    const bfs::directory_iterator end;
+    for (bfs::directory_iterator chunk_file(dir, ec); !ec && chunk_file != end && chunk_files.size() < batch_size_;
+         chunk_file.increment(ec)) {
+        chunk_files.push_back(chunk_file->path());
+    }
+    if (ec) {
+        if (ec != boost::system::errc::no_such_file_or_directory) {
+            log->error("Failed to list chunk directory for reclamation. Path: '{}', Error: '{}'", dir, ec.message());
+        }
+        return true;
+    }
+    for (const auto& chunk_file : chunk_files) {
+        // another daemon sharing the root directory may reclaim the same directory after a restart
+        if (unlink(chunk_file.c_str()) == -1 && errno != ENOENT) {
+            log->error("Failed to remove chunk file. File: '{}', Error: '{}'", chunk_file.native(),
+                       ::strerror(errno));
+        }
+    }
+    if (chunk_files.size() == batch_size_) {
+        return false;
+    }
+    if (rmdir(dir.c_str()) == -1 && errno != ENOENT) {
+        log->error("Failed to remove chunk directory. Path: '{}', Error: '{}'", dir, ::strerror(errno));
+    }
+    log->trace("Reclaimed chunk directory '{}'", dir);
+    return true;
+}
+
+} // namespace data
+} // namespace gkfs
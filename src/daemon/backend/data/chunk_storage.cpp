@@ -12,14 +12,20 @@
 */
 
 #include <daemon/backend/data/chunk_storage.hpp>
+#include <daemon/backend/data/zero_blocks.hpp>
+#include <daemon/backend/data/direct_io.hpp>
 #include <global/path_util.hpp>
+#include <config.hpp>
 
+#include <algorithm>
 #include <cerrno>
+#include <limits>
 #include <boost/filesystem.hpp>
 #include <spdlog/spdlog.h>
 
 extern "C" {
 #include <sys/statfs.h>
+#include <sys/uio.h>
 }
 
 namespace bfs = boost::filesystem;
@@ -28,14 +34,40 @@ using namespace std;
 namespace gkfs {
 namespace data {
 
+namespace {
+
+/**
+ * Parses the name of a chunk file. Other files in a chunk directory, e.g., left behind by an operator, are not chunks
+ * @param name
+ * @param chunk_id
+ * @return false if name is not a chunk id
+ */
+bool parse_chunk_id(const string& name, unsigned int& chunk_id) {
+    if (name.empty() || !all_of(name.begin(), name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        return false;
+    }
+    errno = 0;
+    auto id = ::strtoul(name.c_str(), nullptr, 10);
+    if (errno == ERANGE || id > numeric_limits<unsigned int>::max()) {
+        return false;
+    }
+    chunk_id = static_cast<unsigned int>(id);
+    return true;
+}
+
+} // namespace
+
 string ChunkStorage::absolute(const string& internal_path) const {
     assert(gkfs::path::is_relative(internal_path));
     return root_path + '/' + internal_path;
 }
 
-ChunkStorage::ChunkStorage(const string& path, const size_t chunksize) :
+ChunkStorage::ChunkStorage(const string& path, const size_t chunksize, CompressionType compression,
+                           int compression_level, bool direct_io) :
         root_path(path),
-        chunksize(chunksize) {
+        chunksize(chunksize),
+        compressor(compression, compression_level),
+        direct_io_(direct_io) {
     //TODO check path: absolute, exists, permission to write etc...
     assert(gkfs::path::is_absolute(root_path));
 
@@ -43,20 +75,107 @@ ChunkStorage::ChunkStorage(const string& path, const size_t chunksize) :
     log = spdlog::get(LOGGER_NAME);
     assert(log);
 
-    log->debug("Chunk storage initialized with path: '{}'", root_path);
+    if (direct_io_) {
+        if (compression != CompressionType::none) {
+            throw invalid_argument("Direct I/O cannot be used with chunk compression");
+        }
+        // e.g., tmpfs on older kernels fails with EINVAL
+        auto probe_path = root_path + "/.direct_io_probe";
+        int fd = open(probe_path.c_str(), O_WRONLY | O_CREAT | O_DIRECT, 0640);
+        if (fd < 0) {
+            log->error("File system of chunk directory does not support direct I/O. Path: '{}', Error: '{}'",
+                       root_path, ::strerror(errno));
+            throw ::system_error(errno, ::system_category(), "Direct I/O is not supported in chunk directory");
+        }
+        close(fd);
+        unlink(probe_path.c_str());
+    }
+
+    log->debug("Chunk storage initialized with path: '{}', compression: '{}', level: '{}', direct I/O: '{}'",
+               root_path, to_string(compression), compression_level, direct_io_);
 }
 
-string ChunkStorage::get_chunks_dir(const string& file_path) {
+bool ChunkStorage::direct_io() const {
+    return direct_io_;
+}
+
+/**
+ * Name of the directory holding the chunks of a file: the path without its leading '/' and with '/' replaced by ':'.
+ * ':' and '%' in file names are escaped as "%3A" and "%25", so that get_file_path() can map the name back
+ * @param file_path
+ * @return
+ */
+string ChunkStorage::encode_chunks_dir(const string& file_path) {
     assert(gkfs::path::is_absolute(file_path));
-    string chunk_dir = file_path.substr(1);
-    ::replace(chunk_dir.begin(), chunk_dir.end(), '/', ':');
+    string chunk_dir;
+    chunk_dir.reserve(file_path.size());
+    for (auto it = file_path.begin() + 1; it != file_path.end(); ++it) {
+        switch (*it) {
+            case '/':
+                chunk_dir += ':';
+                break;
+            case ':':
+                chunk_dir += "%3A";
+                break;
+            case '%':
+                chunk_dir += "%25";
+                break;
+            default:
+                chunk_dir += *it;
+        }
+    }
+    return chunk_dir;
+}
+
+/**
+ * Chunk directory of a file. Chunks of files with ':' or '%' in their name that were written before these
+ * characters were escaped stay in the directory named without escapes
+ * @param file_path
+ * @return
+ */
+string ChunkStorage::get_chunks_dir(const string& file_path) const {
+    auto chunk_dir = encode_chunks_dir(file_path);
+    if (file_path.find_first_of(":%") == string::npos) {
+        return chunk_dir;
+    }
+    string legacy_dir = file_path.substr(1);
+    ::replace(legacy_dir.begin(), legacy_dir.end(), '/', ':');
+    boost::system::error_code ec;
+    if (!bfs::exists(absolute(chunk_dir), ec) && bfs::exists(absolute(legacy_dir), ec)) {
+        return legacy_dir;
+    }
     return chunk_dir;
 }
 
-string ChunkStorage::get_chunk_path(const string& file_path, unsigned int chunk_id) {
+string ChunkStorage::get_chunk_path(const string& file_path, unsigned int chunk_id) const {
     return get_chunks_dir(file_path) + '/' + ::to_string(chunk_id);
 }
 
+/**
+ * Inverse of encode_chunks_dir(). A '%' that does not start an escape is kept, as in directories written before
+ * escaping. In those, ':' in file names cannot be told apart from '/' and is read as '/'
+ * @param chunks_dir
+ * @return
+ */
+string ChunkStorage::get_file_path(const string& chunks_dir) {
+    string file_path = "/";
+    file_path.reserve(chunks_dir.size() + 1);
+    for (size_t i = 0; i < chunks_dir.size(); i++) {
+        if (chunks_dir[i] == ':') {
+            file_path += '/';
+        } else if (chunks_dir.compare(i, 3, "%3A") == 0) {
+            file_path += ':';
+            i += 2;
+        } else if (chunks_dir.compare(i, 3, "%25") == 0) {
+            file_path += '%';
+            i += 2;
+        } else {
+            file_path += chunks_dir[i];
+        }
+    }
+    return file_path;
+}
+
 void ChunkStorage::destroy_chunk_space(const string& file_path) const {
     auto chunk_dir = absolute(get_chunks_dir(file_path));
     try {
@@ -66,6 +185,27 @@ void ChunkStorage::destroy_chunk_space(const string& file_path) const {
     }
 }
 
+/**
+ * Moves the chunk directory of a file to `target` on the same file system, after which chunks written for the path
+ * go into a new directory
+ * @param file_path
+ * @param target
+ * @return false if there are no chunks of the file
+ * @throws system_error
+ */
+bool ChunkStorage::detach_chunk_space(const string& file_path, const string& target) const {
+    auto chunk_dir = absolute(get_chunks_dir(file_path));
+    if (rename(chunk_dir.c_str(), target.c_str()) == -1) {
+        if (errno == ENOENT) {
+            return false;
+        }
+        log->error("Failed to detach chunk directory. Path: '{}', Target: '{}', Error: '{}'", chunk_dir, target,
+                   ::strerror(errno));
+        throw ::system_error(errno, ::system_category(), "Failed to detach chunk directory");
+    }
+    return true;
+}
+
 void ChunkStorage::init_chunk_space(const string& file_path) const {
     auto chunk_dir = absolute(get_chunks_dir(file_path));
     auto err = mkdir(chunk_dir.c_str(), 0750);
@@ -75,6 +215,111 @@ void ChunkStorage::init_chunk_space(const string& file_path) const {
     }
 }
 
+mutex& ChunkStorage::chunk_lock(const string& file_path, unsigned int chunk_id) const {
+    auto idx = (hash<string>()(file_path) ^ chunk_id) % chunk_lock_count;
+    return chunk_locks[idx];
+}
+
+/**
+ * Reads a chunk written with compression enabled and returns its decompressed data
+ * @param chunk_path absolute path of the chunk file
+ * @param must_exist if false, a missing chunk file is returned as an empty chunk
+ * @return
+ * @throws system_error
+ */
+vector<char> ChunkStorage::load_chunk(const string& chunk_path, bool must_exist) const {
+    int fd = open(chunk_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT && !must_exist) {
+            return {};
+        }
+        log->error("Failed to open chunk file for read. File: '{}', Error: '{}'", chunk_path, ::strerror(errno));
+        throw ::system_error(errno, ::system_category(), "Failed to open chunk file for read");
+    }
+    ChunkHeader header{};
+    vector<char> payload;
+    auto read = pread64(fd, &header, sizeof(header), 0);
+    if (read == static_cast<ssize_t>(sizeof(header)) && header.magic == ChunkHeader::MAGIC &&
+        header.stored_size <= gkfs::config::rpc::max_chunksize + sizeof(header) &&
+        header.data_size <= gkfs::config::rpc::max_chunksize) {
+        payload.resize(header.stored_size);
+        read = pread64(fd, payload.data(), payload.size(), sizeof(header));
+    }
+    auto err = errno;
+    close(fd);
+    if (read < 0) {
+        log->error("Failed to read chunk file. File: '{}', Error: '{}'", chunk_path, ::strerror(err));
+        throw ::system_error(err, ::system_category(), "Failed to read chunk file");
+    }
+    if (read == 0 && payload.empty()) {
+        // truncated to zero length
+        return {};
+    }
+    if (header.magic != ChunkHeader::MAGIC || static_cast<size_t>(read) != header.stored_size) {
+        log->error("Chunk file has no valid header. It was possibly written without compression. File: '{}'",
+                   chunk_path);
+        throw ::system_error(EIO, ::system_category(), "Invalid chunk file header");
+    }
+
+    vector<char> data(header.data_size);
+    try {
+        ChunkCompressor::decompress(static_cast<CompressionType>(header.type), payload.data(), payload.size(),
+                                    data.data(), data.size());
+    } catch (const runtime_error& e) {
+        log->error("Failed to decompress chunk file. File: '{}', Error: '{}'", chunk_path, e.what());
+        throw ::system_error(EIO, ::system_category(), "Failed to decompress chunk file");
+    }
+    return data;
+}
+
+/**
+ * Writes the whole chunk, compressed if it compresses well and raw otherwise, behind a header
+ * @param chunk_path absolute path of the chunk file
+ * @param data decompressed chunk data
+ * @throws system_error
+ */
+void ChunkStorage::store_chunk(const string& chunk_path, const vector<char>& data) const {
+    vector<char> compressed;
+    auto is_compressed = compressor.compress(data.data(), data.size(), compressed);
+    const auto& payload = is_compressed ? compressed : data;
+
+    ChunkHeader header{};
+    header.magic = ChunkHeader::MAGIC;
+    header.type = static_cast<uint8_t>(is_compressed ? compressor.type() : CompressionType::none);
+    header.data_size = data.size();
+    header.stored_size = payload.size();
+
+    // the chunk is replaced by renaming a complete copy over it, so a failed or interrupted write never leaves a
+    // torn chunk behind. The name is no chunk id and concurrent writers of a chunk are serialized by its lock
+    auto tmp_path = chunk_path + ".tmp";
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0640);
+    if (fd < 0) {
+        log->error("Failed to open chunk file for write. File: '{}', Error: '{}'", tmp_path, ::strerror(errno));
+        throw ::system_error(errno, ::system_category(), "Failed to open chunk file for write");
+    }
+    struct iovec iov[2] = {
+            {&header,                               sizeof(header)},
+            {const_cast<char*>(payload.data()), payload.size()}
+    };
+    auto total = static_cast<ssize_t>(sizeof(header) + payload.size());
+    auto wrote = pwritev(fd, iov, 2, 0);
+    auto err = wrote < 0 ? errno : EIO;
+    if (close(fd) != 0 && wrote == total) {
+        wrote = -1;
+        err = errno;
+    }
+    if (wrote == total && rename(tmp_path.c_str(), chunk_path.c_str()) != 0) {
+        wrote = -1;
+        err = errno;
+    }
+    if (wrote != total) {
+        unlink(tmp_path.c_str());
+        log->error("Failed to write chunk file. File: '{}', size: '{}', Error: '{}'", chunk_path, total,
+                   ::strerror(err));
+        throw ::system_error(err, ::system_category(), "Failed to write chunk file");
+    }
+}
+
 /* Delete all chunks stored on this node that falls in the gap [chunk_start, chunk_end]
  *
  * This is pretty slow method because it cycle over all the chunks sapce for this file.
@@ -87,7 +332,10 @@ void ChunkStorage::trim_chunk_space(const string& file_path,
 
     for (bfs::directory_iterator chunk_file(chunk_dir); chunk_file != end; ++chunk_file) {
         auto chunk_path = chunk_file->path();
-        auto chunk_id = ::stoul(chunk_path.filename().c_str());
+        unsigned int chunk_id;
+        if (!parse_chunk_id(chunk_path.filename().native(), chunk_id)) {
+            continue;
+        }
         if (chunk_id >= chunk_start && chunk_id <= chunk_end) {
             int ret = unlink(chunk_path.c_str());
             if (ret == -1) {
@@ -110,7 +358,21 @@ void ChunkStorage::delete_chunk(const string& file_path, unsigned int chunk_id)
 
 void ChunkStorage::truncate_chunk(const string& file_path, unsigned int chunk_id, off_t length) {
     auto chunk_path = absolute(get_chunk_path(file_path, chunk_id));
-    assert(length > 0 && (unsigned int) length <= chunksize);
+    assert(length > 0 && (unsigned int) length <= gkfs::config::rpc::max_chunksize);
+    if (compressor.type() != CompressionType::none) {
+        lock_guard<mutex> lock(chunk_lock(file_path, chunk_id));
+        auto data = load_chunk(chunk_path, true);
+        if (data.size() > static_cast<size_t>(length)) {
+            data.resize(length);
+            store_chunk(chunk_path, data);
+        }
+        return;
+    }
+    // a direct write in progress would restore the size it saw before
+    unique_lock<mutex> lock(chunk_lock(file_path, chunk_id), defer_lock);
+    if (direct_io_) {
+        lock.lock();
+    }
     int ret = truncate(chunk_path.c_str(), length);
     if (ret == -1) {
         log->error("Failed to truncate chunk file. File: '{}', Error: '{}'", chunk_path, ::strerror(errno));
@@ -118,26 +380,140 @@ void ChunkStorage::truncate_chunk(const string& file_path, unsigned int chunk_id
     }
 }
 
+/**
+ * Finds the next data or hole position within a chunk, using the extents the local file system keeps for the chunk
+ * file. Compressed chunks are data up to their end.
+ * @param file_path
+ * @param chunk_id
+ * @param offset offset within the chunk to start from
+ * @param whence SEEK_DATA or SEEK_HOLE
+ * @return offset within the chunk. For SEEK_DATA -1 if there is no data behind offset, for SEEK_HOLE at most the
+ * length of the chunk, which is a hole for all following positions of the chunk
+ * @throws system_error
+ */
+off64_t ChunkStorage::seek_chunk(const string& file_path, unsigned int chunk_id, off64_t offset, int whence) const {
+    assert(whence == SEEK_DATA || whence == SEEK_HOLE);
+    auto chunk_path = absolute(get_chunk_path(file_path, chunk_id));
+    int fd = open(chunk_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return whence == SEEK_DATA ? -1 : offset;
+        }
+        log->error("Failed to open chunk file for seek. File: '{}', Error: '{}'", chunk_path, ::strerror(errno));
+        throw ::system_error(errno, ::system_category(), "Failed to open chunk file for seek");
+    }
+    off64_t ret;
+    if (compressor.type() != CompressionType::none) {
+        ChunkHeader header{};
+        off64_t length = 0;
+        if (pread64(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+            header.magic == ChunkHeader::MAGIC) {
+            length = header.data_size;
+        }
+        if (whence == SEEK_DATA) {
+            ret = offset < length ? offset : -1;
+        } else {
+            ret = max(offset, length);
+        }
+    } else {
+        ret = lseek64(fd, offset, whence);
+        if (ret < 0) {
+            if (errno != ENXIO) {
+                log->error("Failed to seek chunk file. File: '{}', Error: '{}'", chunk_path, ::strerror(errno));
+                auto err = errno;
+                close(fd);
+                throw ::system_error(err, ::system_category(), "Failed to seek chunk file");
+            }
+            // offset is at or behind the end of the chunk file
+            ret = whence == SEEK_DATA ? -1 : offset;
+        }
+    }
+    close(fd);
+    return ret;
+}
+
+/**
+ * Lists the chunks of a file stored on this node
+ * @param file_path
+ * @return sorted chunk ids
+ */
+vector<unsigned int> ChunkStorage::chunk_ids(const string& file_path) const {
+    vector<unsigned int> ids;
+    auto chunk_dir = absolute(get_chunks_dir(file_path));
+    boost::system::error_code ec;
+    const bfs::directory_iterator end;
+    for (bfs::directory_iterator chunk_file(chunk_dir, ec); !ec && chunk_file != end; chunk_file.increment(ec)) {
+        unsigned int chunk_id;
+        if (parse_chunk_id(chunk_file->path().filename().native(), chunk_id)) {
+            ids.push_back(chunk_id);
+        }
+    }
+    sort(ids.begin(), ids.end());
+    return ids;
+}
+
 void ChunkStorage::write_chunk(const string& file_path, unsigned int chunk_id,
-                               const char* buff, size_t size, off64_t offset, ABT_eventual& eventual) const {
+                               const char* buff, size_t size, off64_t offset, size_t chunk_size,
+                               ABT_eventual& eventual) const {
 
-    assert((offset + size) <= chunksize);
+    // chunks are as large as the chunk size of their file's layout
+    assert((offset + size) <= chunk_size && chunk_size <= gkfs::config::rpc::max_chunksize);
 
     init_chunk_space(file_path);
 
     auto chunk_path = absolute(get_chunk_path(file_path, chunk_id));
-    int fd = open(chunk_path.c_str(), O_WRONLY | O_CREAT, 0640);
+    if (compressor.type() != CompressionType::none) {
+        {
+            lock_guard<mutex> lock(chunk_lock(file_path, chunk_id));
+            // a partial write must merge with the current content, a write of the whole chunk replaces it
+            vector<char> data;
+            if (offset != 0 || size != chunk_size) {
+                data = load_chunk(chunk_path, false);
+            }
+            if (data.size() < offset + size) {
+                data.resize(offset + size);
+            }
+            ::memcpy(data.data() + offset, buff, size);
+            store_chunk(chunk_path, data);
+        }
+        ssize_t wrote = size;
+        ABT_eventual_set(eventual, &wrote, sizeof(size_t));
+        return;
+    }
+
+    // unaligned fragments of a direct write are read, merged and written back as whole blocks
+    unique_lock<mutex> lock(chunk_lock(file_path, chunk_id), defer_lock);
+    if (direct_io_) {
+        lock.lock();
+    }
+    int fd = open(chunk_path.c_str(), direct_io_ ? O_RDWR | O_CREAT | O_DIRECT : O_WRONLY | O_CREAT, 0640);
     if (fd < 0) {
         log->error("Failed to open chunk file for write. File: '{}', Error: '{}'", chunk_path, ::strerror(errno));
         throw ::system_error(errno, ::system_category(), "Failed to open chunk file for write");
     }
 
-    auto wrote = pwrite(fd, buff, size, offset);
+    ssize_t wrote;
+    if (direct_io_) {
+        wrote = pwrite_direct(fd, buff, size, offset, gkfs::config::io::direct_io_alignment,
+                              gkfs::config::io::direct_io_bounce_size);
+    } else if (gkfs::config::io::punch_zero_blocks) {
+        size_t on_disk = 0;
+        wrote = pwrite_sparse(fd, buff, size, offset, gkfs::config::io::zero_block_size, on_disk);
+        if (wrote >= 0 && on_disk < size) {
+            log->trace("Skipped {} zero bytes of {} bytes written to chunk file '{}'", size - on_disk, size,
+                       chunk_path);
+        }
+    } else {
+        wrote = pwrite(fd, buff, size, offset);
+    }
     if (wrote < 0) {
         log->error("Failed to write chunk file. File: '{}', size: '{}', offset: '{}', Error: '{}'",
                    chunk_path, size, offset, ::strerror(errno));
-        throw ::system_error(errno, ::system_category(), "Failed to write chunk file");
+        auto err = errno;
+        close(fd);
+        throw ::system_error(err, ::system_category(), "Failed to write chunk file");
     }
+    lock.unlock();
 
     ABT_eventual_set(eventual, &wrote, sizeof(size_t));
 
@@ -151,41 +527,86 @@ void ChunkStorage::write_chunk(const string& file_path, unsigned int chunk_id,
 
 void ChunkStorage::read_chunk(const string& file_path, unsigned int chunk_id,
                               char* buff, size_t size, off64_t offset, ABT_eventual& eventual) const {
-    assert((offset + size) <= chunksize);
+    // chunks are as large as the chunk size of their file's layout
+    assert((offset + size) <= gkfs::config::rpc::max_chunksize);
     auto chunk_path = absolute(get_chunk_path(file_path, chunk_id));
-    int fd = open(chunk_path.c_str(), O_RDONLY);
+    if (compressor.type() != CompressionType::none) {
+        // runs on the I/O xstreams like the raw read
+        vector<char> data;
+        {
+            lock_guard<mutex> lock(chunk_lock(file_path, chunk_id));
+            data = load_chunk(chunk_path, true);
+        }
+        size_t tot_read = 0;
+        if (static_cast<size_t>(offset) < data.size()) {
+            tot_read = min(size, data.size() - offset);
+            ::memcpy(buff, data.data() + offset, tot_read);
+        }
+        ABT_eventual_set(eventual, &tot_read, sizeof(size_t));
+        return;
+    }
+    int fd = open(chunk_path.c_str(), direct_io_ ? O_RDONLY | O_DIRECT : O_RDONLY);
     if (fd < 0) {
         log->error("Failed to open chunk file for read. File: '{}', Error: '{}'", chunk_path, ::strerror(errno));
         throw ::system_error(errno, ::system_category(), "Failed to open chunk file for read");
     }
-    size_t tot_read = 0;
-    ssize_t read = 0;
-
-    do {
-        read = pread64(fd,
-                       buff + tot_read,
-                       size - tot_read,
-                       offset + tot_read);
-        if (read == 0) {
-            break;
-        }
-
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+        log->error("Failed to stat chunk file. File: '{}', Error: '{}'", chunk_path, ::strerror(errno));
+        close(fd);
+        throw ::system_error(errno, ::system_category(), "Failed to stat chunk file");
+    }
+    // bytes up to the end of the chunk file. Only its data extents are read, holes are zero-filled
+    size_t tot_read = offset < st.st_size ? min(size, static_cast<size_t>(st.st_size - offset)) : 0;
+    auto end = offset + static_cast<off64_t>(tot_read);
+    auto pos = offset;
+    if (direct_io_ && tot_read > 0) {
+        // holes are read as zeros without disk I/O by the file system
+        auto read = pread_direct(fd, buff, tot_read, offset, gkfs::config::io::direct_io_alignment,
+                                 gkfs::config::io::direct_io_bounce_size);
         if (read < 0) {
             log->error("Failed to read chunk file. File: '{}', size: '{}', offset: '{}', Error: '{}'",
                        chunk_path, size, offset, ::strerror(errno));
-            throw ::system_error(errno, ::system_category(), "Failed to read chunk file");
+            auto err = errno;
+            close(fd);
+            throw ::system_error(err, ::system_category(), "Failed to read chunk file");
         }
-
-#ifndef NDEBUG
-        if (tot_read + read < size) {
-            log->warn("Read less bytes than requested: '{}'/{}. Total read was '{}'", read, size - tot_read, size);
+        // truncated concurrently
+        ::memset(buff + read, 0, tot_read - read);
+        pos = end;
+    }
+    while (pos < end) {
+        auto data = lseek64(fd, pos, SEEK_DATA);
+        if (data < 0) {
+            // ENXIO: only a hole is left. Other errors: the file system cannot tell, read everything
+            data = errno == ENXIO ? end : pos;
         }
-#endif
-        assert(read > 0);
-        tot_read += read;
-
-
-    } while (tot_read != size);
+        data = min(data, end);
+        ::memset(buff + (pos - offset), 0, data - pos);
+        if (data == end) {
+            break;
+        }
+        auto hole = lseek64(fd, data, SEEK_HOLE);
+        hole = hole < 0 ? end : min(hole, end);
+        pos = data;
+        while (pos < hole) {
+            auto read = pread64(fd, buff + (pos - offset), hole - pos, pos);
+            if (read < 0) {
+                log->error("Failed to read chunk file. File: '{}', size: '{}', offset: '{}', Error: '{}'",
+                           chunk_path, size, offset, ::strerror(errno));
+                auto err = errno;
+                close(fd);
+                throw ::system_error(err, ::system_category(), "Failed to read chunk file");
+            }
+            if (read == 0) {
+                // truncated concurrently
+                ::memset(buff + (pos - offset), 0, end - pos);
+                pos = end;
+                break;
+            }
+            pos += read;
+        }
+    }
 
     ABT_eventual_set(eventual, &tot_read, sizeof(size_t));
 
@@ -218,5 +639,28 @@ ChunkStat ChunkStorage::chunk_stat() const {
             bytes_free / chunksize};
 }
 
+/**
+ * Lists all chunks stored on this node
+ * @return vector of pairs <file path, chunk id>
+ */
+vector<pair<string, unsigned int>> ChunkStorage::chunk_list() const {
+    vector<pair<string, unsigned int>> chunks;
+    const bfs::directory_iterator end;
+    for (bfs::directory_iterator chunk_dir(root_path); chunk_dir != end; ++chunk_dir) {
+        if (!bfs::is_directory(chunk_dir->status()))
+            continue;
+        auto file_path = get_file_path(chunk_dir->path().filename().native());
+        for (bfs::directory_iterator chunk_file(chunk_dir->path()); chunk_file != end; ++chunk_file) {
+            unsigned int chunk_id;
+            if (parse_chunk_id(chunk_file->path().filename().native(), chunk_id)) {
+                chunks.emplace_back(file_path, chunk_id);
+            } else {
+                log->warn("Skipping file that is not a chunk: '{}'", chunk_file->path().native());
+            }
+        }
+    }
+    return chunks;
+}
+
 } // namespace data
 } // namespace gkfs
\ No newline at end of file
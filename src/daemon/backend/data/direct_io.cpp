@@ -0,0 +1,207 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <daemon/backend/data/direct_io.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+extern "C" {
+#include <sys/stat.h>
+#include <unistd.h>
+}
+
+using namespace std;
+
+namespace gkfs {
+namespace data {
+
+void FreeDeleter::operator()(void* ptr) const {
+    free(ptr);
+}
+
+AlignedBuffer make_aligned_buffer(size_t size, size_t alignment) {
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, max(alignment, sizeof(void*)), max<size_t>(size, 1)) != 0) {
+        throw bad_alloc();
+    }
+    return AlignedBuffer(static_cast<char*>(ptr));
+}
+
+namespace {
+
+inline off64_t align_down(off64_t value, size_t alignment) {
+    return value & ~static_cast<off64_t>(alignment - 1);
+}
+
+inline off64_t align_up(off64_t value, size_t alignment) {
+    return align_down(value + alignment - 1, alignment);
+}
+
+ssize_t pwrite_all(int fd, const char* buf, size_t size, off64_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        auto ret = pwrite64(fd, buf + done, size - done, offset + done);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        done += ret;
+    }
+    return done;
+}
+
+/*
+ * A short read ends at the end of the file. It is not continued, as the next offset would not be aligned
+ */
+ssize_t pread_once(int fd, char* buf, size_t size, off64_t offset) {
+    ssize_t ret;
+    do {
+        ret = pread64(fd, buf, size, offset);
+    } while (ret < 0 && errno == EINTR);
+    return ret;
+}
+
+/**
+ * Writes the block at block_off, of which [offset, offset + size) is only a part, merged with its current content
+ */
+int merge_block(int fd, char* block, off64_t block_off, const char* buf, size_t size, off64_t offset,
+                size_t alignment, off64_t file_size) {
+    ::memset(block, 0, alignment);
+    if (block_off < file_size && pread_once(fd, block, alignment, block_off) < 0) {
+        return -1;
+    }
+    auto first = max(offset, block_off);
+    auto last = min(offset + static_cast<off64_t>(size), block_off + static_cast<off64_t>(alignment));
+    ::memcpy(block + (first - block_off), buf + (first - offset), last - first);
+    return pwrite_all(fd, block, alignment, block_off) < 0 ? -1 : 0;
+}
+
+} // namespace
+
+ssize_t pwrite_direct(int fd, const char* buf, size_t size, off64_t offset, size_t alignment, size_t bounce_size) {
+    if (size == 0) {
+        return 0;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) < 0) {
+        return -1;
+    }
+    const off64_t end = offset + size;
+    // aligned part of the range. Empty (head >= tail) if the range lies within a single block
+    const auto head = align_up(offset, alignment);
+    const auto tail = align_down(end, alignment);
+    const char* middle = buf + (head - offset);
+    const bool middle_aligned = head >= tail || is_aligned(middle, alignment);
+    AlignedBuffer bounce;
+    size_t bounce_len = 0;
+    if (head != offset || tail != end || !middle_aligned) {
+        bounce_len = middle_aligned ? alignment : max(alignment, min<size_t>(bounce_size, tail - head));
+        try {
+            bounce = make_aligned_buffer(bounce_len, alignment);
+        } catch (const bad_alloc&) {
+            errno = ENOMEM;
+            return -1;
+        }
+    }
+
+    if (head > tail) {
+        if (merge_block(fd, bounce.get(), tail, buf, size, offset, alignment, st.st_size) < 0) {
+            return -1;
+        }
+    } else {
+        if (head != offset &&
+            merge_block(fd, bounce.get(), head - alignment, buf, size, offset, alignment, st.st_size) < 0) {
+            return -1;
+        }
+        if (middle_aligned) {
+            if (pwrite_all(fd, middle, tail - head, head) < 0) {
+                return -1;
+            }
+        } else {
+            for (auto pos = head; pos < tail; pos += bounce_len) {
+                auto len = min<size_t>(bounce_len, tail - pos);
+                ::memcpy(bounce.get(), middle + (pos - head), len);
+                if (pwrite_all(fd, bounce.get(), len, pos) < 0) {
+                    return -1;
+                }
+            }
+        }
+        if (tail != end && merge_block(fd, bounce.get(), tail, buf, size, offset, alignment, st.st_size) < 0) {
+            return -1;
+        }
+    }
+    // the tail block was written as a whole and may have grown the file beyond the end of the range
+    if (align_up(end, alignment) > max<off64_t>(end, st.st_size) && ftruncate(fd, max<off64_t>(end, st.st_size)) < 0) {
+        return -1;
+    }
+    return size;
+}
+
+ssize_t pread_direct(int fd, char* buf, size_t size, off64_t offset, size_t alignment, size_t bounce_size) {
+    const off64_t end = offset + size;
+    AlignedBuffer bounce;
+    size_t bounce_len = 0;
+    size_t total = 0;
+    auto pos = offset;
+    while (pos < end) {
+        auto block = align_down(pos, alignment);
+        char* dest = buf + (pos - offset);
+        if (block == pos && is_aligned(dest, alignment) && end - pos >= static_cast<off64_t>(alignment)) {
+            auto len = static_cast<size_t>(align_down(end - pos, alignment));
+            auto ret = pread_once(fd, dest, len, pos);
+            if (ret < 0) {
+                return -1;
+            }
+            total += ret;
+            pos += ret;
+            if (static_cast<size_t>(ret) < len) {
+                break;
+            }
+            continue;
+        }
+        if (!bounce) {
+            bounce_len = max(alignment, min<size_t>(bounce_size, align_up(end, alignment) - block));
+            try {
+                bounce = make_aligned_buffer(bounce_len, alignment);
+            } catch (const bad_alloc&) {
+                errno = ENOMEM;
+                return -1;
+            }
+        }
+        auto len = min<size_t>(bounce_len, align_up(end, alignment) - block);
+        auto ret = pread_once(fd, bounce.get(), len, block);
+        if (ret < 0) {
+            return -1;
+        }
+        if (block + ret <= pos) {
+            break;
+        }
+        auto copy = min<size_t>(block + ret - pos, end - pos);
+        ::memcpy(dest, bounce.get() + (pos - block), copy);
+        total += copy;
+        pos += copy;
+        if (static_cast<size_t>(ret) < len) {
+            break;
+        }
+    }
+    return total;
+}
+
+} // namespace data
+} // namespace gkfs
@@ -0,0 +1,158 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <daemon/backend/data/zero_blocks.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+extern "C" {
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+
+using namespace std;
+
+namespace gkfs {
+namespace data {
+
+bool is_zero(const char* buf, size_t size) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 128 <= size; i += 128) {
+        auto p = reinterpret_cast<const __m256i*>(buf + i);
+        auto acc = _mm256_or_si256(_mm256_or_si256(_mm256_loadu_si256(p), _mm256_loadu_si256(p + 1)),
+                                   _mm256_or_si256(_mm256_loadu_si256(p + 2), _mm256_loadu_si256(p + 3)));
+        if (!_mm256_testz_si256(acc, acc)) {
+            return false;
+        }
+    }
+#elif defined(__SSE2__)
+    const auto zero = _mm_setzero_si128();
+    for (; i + 64 <= size; i += 64) {
+        auto p = reinterpret_cast<const __m128i*>(buf + i);
+        auto acc = _mm_or_si128(_mm_or_si128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)),
+                                _mm_or_si128(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(acc, zero)) != 0xFFFF) {
+            return false;
+        }
+    }
+#endif
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        ::memcpy(&word, buf + i, sizeof(word));
+        if (word != 0) {
+            return false;
+        }
+    }
+    for (; i < size; ++i) {
+        if (buf[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+namespace {
+
+ssize_t pwrite_all(int fd, const char* buf, size_t size, off64_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        auto ret = pwrite64(fd, buf + done, size - done, offset + done);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        done += ret;
+    }
+    return done;
+}
+
+} // namespace
+
+ssize_t pwrite_sparse(int fd, const char* buf, size_t size, off64_t offset, size_t block_size, size_t& written) {
+    written = 0;
+    if (size == 0) {
+        return 0;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) < 0) {
+        return -1;
+    }
+    const off64_t file_size = st.st_size;
+    const off64_t end = offset + size;
+    // end of the file after the runs handled so far
+    auto cur_size = file_size;
+
+    size_t pos = 0;
+    while (pos < size) {
+        // extend the run block by block until the next block is of the other kind
+        auto block_end = [&](size_t p) {
+            return min(size, static_cast<size_t>(((offset + p) / block_size + 1) * block_size - offset));
+        };
+        auto run_end = block_end(pos);
+        const auto zero = is_zero(buf + pos, run_end - pos);
+        while (run_end < size) {
+            auto next_end = block_end(run_end);
+            if (is_zero(buf + run_end, next_end - run_end) != zero) {
+                break;
+            }
+            run_end = next_end;
+        }
+        const off64_t run_off = offset + pos;
+        const off64_t run_len = run_end - pos;
+        if (!zero) {
+            if (pwrite_all(fd, buf + pos, run_len, run_off) < 0) {
+                return -1;
+            }
+            written += run_len;
+            cur_size = max(cur_size, run_off + run_len);
+        } else if (run_off < file_size) {
+            // existing data must be replaced by a hole, zeros behind the end of the file are implicit
+            auto punch_len = min(run_len, file_size - run_off);
+            if (fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, run_off, punch_len) < 0) {
+                if (errno != EOPNOTSUPP) {
+                    return -1;
+                }
+                if (pwrite_all(fd, buf + pos, punch_len, run_off) < 0) {
+                    return -1;
+                }
+                written += punch_len;
+            }
+        }
+        pos = run_end;
+    }
+    // trailing zeros behind the end of the file: write the last byte so that the file has its full size. Unlike
+    // ftruncate() this never shrinks a file that a concurrent write has just extended
+    if (cur_size < end) {
+        if (pwrite_all(fd, buf + size - 1, 1, end - 1) < 0) {
+            return -1;
+        }
+        written += 1;
+    }
+    return size;
+}
+
+} // namespace data
+} // namespace gkfs
@@ -127,6 +127,22 @@ void MetadataDB::decrease_size(const std::string& key, size_t size) {
     }
 }
 
+void MetadataDB::write_inline(const std::string& key, size_t offset, const std::string& data) {
+    auto uop = WriteInlineOperand(offset, data);
+    auto s = db->Merge(write_opts, key, uop.serialize());
+    if (!s.ok()) {
+        MetadataDB::throw_rdb_status_excpt(s);
+    }
+}
+
+void MetadataDB::promote_inline(const std::string& key) {
+    auto uop = PromoteInlineOperand();
+    auto s = db->Merge(write_opts, key, uop.serialize());
+    if (!s.ok()) {
+        MetadataDB::throw_rdb_status_excpt(s);
+    }
+}
+
 /**
  * Return all the first-level entries of the directory @dir
  *
@@ -179,14 +195,18 @@ std::vector<std::pair<std::string, bool>> MetadataDB::get_dirents(const std::str
     return entries;
 }
 
-void MetadataDB::iterate_all() {
-    std::string key;
-    std::string val;
-    // Do RangeScan on parent inode
-    auto iter = db->NewIterator(rdb::ReadOptions());
+/**
+ * Calls fn for every key/value pair in the DB. The iteration works on an implicit snapshot,
+ * so fn may modify the DB.
+ * @param fn
+ */
+void MetadataDB::iterate_all(const std::function<void(const std::string&, const std::string&)>& fn) const {
+    std::unique_ptr<rdb::Iterator> iter(db->NewIterator(rdb::ReadOptions()));
     for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
-        key = iter->key().ToString();
-        val = iter->value().ToString();
+        fn(iter->key().ToString(), iter->value().ToString());
+    }
+    if (!iter->status().ok()) {
+        MetadataDB::throw_rdb_status_excpt(iter->status());
     }
 }
 
@@ -108,6 +108,43 @@ string CreateOperand::serialize_params() const {
 }
 
 
+WriteInlineOperand::WriteInlineOperand(const size_t offset, const string& data) :
+        offset(offset), data(data) {}
+
+WriteInlineOperand::WriteInlineOperand(const rdb::Slice& serialized_op) {
+    size_t read = 0;
+
+    //Parse offset
+    offset = ::stoul(serialized_op.data(), &read);
+    assert(serialized_op[read] == separator);
+
+    //the rest is binary data
+    data.assign(serialized_op.data() + read + 1, serialized_op.size() - read - 1);
+}
+
+OperandID WriteInlineOperand::id() const {
+    return OperandID::write_inline;
+}
+
+string WriteInlineOperand::serialize_params() const {
+    string s;
+    s.reserve(21 + data.size());
+    s += ::to_string(offset);
+    s += this->separator;
+    s += data;
+    return s;
+}
+
+
+OperandID PromoteInlineOperand::id() const {
+    return OperandID::promote_inline;
+}
+
+string PromoteInlineOperand::serialize_params() const {
+    return {};
+}
+
+
 bool MetadataMergeOperator::FullMergeV2(
         const MergeOperationInput& merge_in,
         MergeOperationOutput* merge_out) const {
@@ -132,6 +169,7 @@ bool MetadataMergeOperator::FullMergeV2(
     Metadata md{prev_md_value};
 
     size_t fsize = md.size();
+    string inline_data = md.inline_data();
 
     for (; ops_it != merge_in.operand_list.cend(); ++ops_it) {
         const rdb::Slice& serialized_op = *ops_it;
@@ -151,14 +189,34 @@ bool MetadataMergeOperator::FullMergeV2(
             auto op = DecreaseSizeOperand(parameters);
             assert(op.size < fsize); // we assume no concurrency here
             fsize = op.size;
+            if (inline_data.size() > fsize) {
+                inline_data.resize(fsize);
+            }
         } else if (operand_id == OperandID::create) {
             continue;
+        } else if (operand_id == OperandID::write_inline) {
+            auto op = WriteInlineOperand(parameters);
+            // daemons serialize inline writes with promotions, so the file must still be inline
+            assert(md.stored_inline());
+            auto end = op.offset + op.data.size();
+            if (inline_data.size() < end) {
+                // a gap before the offset reads as zeros
+                inline_data.resize(end, '\0');
+            }
+            inline_data.replace(op.offset, op.data.size(), op.data);
+            fsize = ::max(end, fsize);
+        } else if (operand_id == OperandID::promote_inline) {
+            md.stored_inline(false);
+            inline_data.clear();
         } else {
             throw ::runtime_error("Unrecognized merge operand ID: " + (char) operand_id);
         }
     }
 
     md.size(fsize);
+    if (md.stored_inline()) {
+        md.inline_data(inline_data);
+    }
     merge_out->new_value = md.serialize();
     return true;
 }
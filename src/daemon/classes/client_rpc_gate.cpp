@@ -0,0 +1,80 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <daemon/classes/client_rpc_gate.hpp>
+
+#include <stdexcept>
+
+using namespace std;
+
+namespace gkfs {
+namespace daemon {
+
+void ClientRpcGate::init() {
+    call_once(init_flag_, [this]() {
+        if (ABT_mutex_create(&mutex_) != ABT_SUCCESS || ABT_cond_create(&cond_) != ABT_SUCCESS) {
+            throw runtime_error("Failed to create client RPC gate");
+        }
+    });
+}
+
+void ClientRpcGate::enter() {
+    init();
+    ABT_mutex_lock(mutex_);
+    while (closed_) {
+        ABT_cond_wait(cond_, mutex_);
+    }
+    active_++;
+    ABT_mutex_unlock(mutex_);
+}
+
+void ClientRpcGate::leave() {
+    ABT_mutex_lock(mutex_);
+    if (--active_ == 0) {
+        ABT_cond_broadcast(cond_);
+    }
+    ABT_mutex_unlock(mutex_);
+}
+
+void ClientRpcGate::close() {
+    init();
+    ABT_mutex_lock(mutex_);
+    closed_ = true;
+    while (active_ > 0) {
+        ABT_cond_wait(cond_, mutex_);
+    }
+    ABT_mutex_unlock(mutex_);
+}
+
+void ClientRpcGate::open() {
+    init();
+    ABT_mutex_lock(mutex_);
+    closed_ = false;
+    ABT_cond_broadcast(cond_);
+    ABT_mutex_unlock(mutex_);
+}
+
+ClientRpc::ClientRpc(ClientRpcGate& gate, bool counted) : gate_(counted ? &gate : nullptr) {
+    if (gate_) {
+        gate_->enter();
+    }
+}
+
+ClientRpc::~ClientRpc() {
+    if (gate_) {
+        gate_->leave();
+    }
+}
+
+} // namespace daemon
+} // namespace gkfs
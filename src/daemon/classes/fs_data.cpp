@@ -48,6 +48,18 @@ void FsData::storage(const std::shared_ptr<gkfs::data::ChunkStorage>& storage) {
     storage_ = storage;
 }
 
+const std::shared_ptr<gkfs::data::ChunkReclaimer>& FsData::reclaimer() const {
+    return reclaimer_;
+}
+
+void FsData::reclaimer(const std::shared_ptr<gkfs::data::ChunkReclaimer>& reclaimer) {
+    reclaimer_ = reclaimer;
+}
+
+void FsData::close_reclaimer() {
+    reclaimer_.reset();
+}
+
 const std::string& FsData::rootdir() const {
     return rootdir_;
 }
@@ -88,6 +100,94 @@ void FsData::hosts_file(const std::string& lookup_file) {
     hosts_file_ = lookup_file;
 }
 
+gkfs::rpc::DistributorType FsData::distributor_type() const {
+    return distributor_type_;
+}
+
+void FsData::distributor_type(gkfs::rpc::DistributorType distributor_type) {
+    FsData::distributor_type_ = distributor_type;
+}
+
+size_t FsData::inline_data_size() const {
+    return inline_data_size_;
+}
+
+void FsData::inline_data_size(size_t inline_data_size) {
+    FsData::inline_data_size_ = inline_data_size;
+}
+
+gkfs::data::CompressionType FsData::compression_type() const {
+    return compression_type_;
+}
+
+void FsData::compression_type(gkfs::data::CompressionType compression_type) {
+    FsData::compression_type_ = compression_type;
+}
+
+int FsData::compression_level() const {
+    return compression_level_;
+}
+
+void FsData::compression_level(int compression_level) {
+    FsData::compression_level_ = compression_level;
+}
+
+bool FsData::direct_io() const {
+    return direct_io_;
+}
+
+void FsData::direct_io(bool direct_io) {
+    FsData::direct_io_ = direct_io;
+}
+
+unsigned int FsData::io_xstreams() const {
+    return io_xstreams_;
+}
+
+void FsData::io_xstreams(unsigned int io_xstreams) {
+    FsData::io_xstreams_ = io_xstreams;
+}
+
+IOPoolLayout FsData::io_pool_layout() const {
+    return io_pool_layout_;
+}
+
+void FsData::io_pool_layout(IOPoolLayout io_pool_layout) {
+    FsData::io_pool_layout_ = io_pool_layout;
+}
+
+bool FsData::io_pin() const {
+    return io_pin_;
+}
+
+void FsData::io_pin(bool io_pin) {
+    FsData::io_pin_ = io_pin;
+}
+
+unsigned int FsData::handler_xstreams() const {
+    return handler_xstreams_;
+}
+
+void FsData::handler_xstreams(unsigned int handler_xstreams) {
+    FsData::handler_xstreams_ = handler_xstreams;
+}
+
+unsigned int FsData::metadata_handler_xstreams() const {
+    return metadata_handler_xstreams_;
+}
+
+void FsData::metadata_handler_xstreams(unsigned int metadata_handler_xstreams) {
+    FsData::metadata_handler_xstreams_ = metadata_handler_xstreams;
+}
+
+int FsData::metadata_handler_nice() const {
+    return metadata_handler_nice_;
+}
+
+void FsData::metadata_handler_nice(int metadata_handler_nice) {
+    FsData::metadata_handler_nice_ = metadata_handler_nice;
+}
+
 bool FsData::atime_state() const {
     return atime_state_;
 }
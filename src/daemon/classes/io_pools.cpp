@@ -0,0 +1,326 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <daemon/classes/io_pools.hpp>
+#include <config.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+extern "C" {
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+}
+
+using namespace std;
+
+namespace gkfs {
+namespace daemon {
+
+namespace {
+
+// work units an I/O xstream runs between checking whether it has to stop
+constexpr unsigned int event_freq = 50;
+
+/**
+ * Parses a sysfs list like "0-3,8-11"
+ */
+vector<int> parse_list(const string& list) {
+    vector<int> values;
+    istringstream iss(list);
+    string range;
+    while (getline(iss, range, ',')) {
+        if (range.empty() || range == "\n") {
+            continue;
+        }
+        auto dash = range.find('-');
+        try {
+            auto first = stoi(range.substr(0, dash));
+            auto last = dash == string::npos ? first : stoi(range.substr(dash + 1));
+            for (auto v = first; v <= last; ++v) {
+                values.push_back(v);
+            }
+        } catch (const logic_error&) {
+            return {};
+        }
+    }
+    return values;
+}
+
+string read_line(const string& path) {
+    ifstream f(path);
+    string line;
+    getline(f, line);
+    return line;
+}
+
+int sched_init(ABT_sched, ABT_sched_config) {
+    return ABT_SUCCESS;
+}
+
+int sched_free(ABT_sched) {
+    return ABT_SUCCESS;
+}
+
+} // namespace
+
+/*
+ * Work-stealing scheduler of an I/O xstream. The first pool is the xstream's own, the others are stolen from in the
+ * given order when it is empty. An idle xstream sleeps on its own pool and looks for tasks to steal every
+ * daemon_io_steal_interval_us
+ */
+void IOPools::run_sched(ABT_sched sched) {
+    void* data = nullptr;
+    ABT_sched_get_data(sched, &data);
+    auto io_pools = static_cast<IOPools*>(data);
+    if (io_pools->nice_ != 0) {
+        // the nice value is per thread on Linux
+        if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), io_pools->nice_) == 0) {
+            io_pools->reniced_++;
+        }
+        io_pools->renice_attempts_++;
+    }
+
+    int num_pools = 0;
+    ABT_sched_get_num_pools(sched, &num_pools);
+    vector<ABT_pool> pools(num_pools);
+    ABT_sched_get_pools(sched, num_pools, 0, pools.data());
+    const double steal_interval = gkfs::config::rpc::daemon_io_steal_interval_us / 1e6;
+    unsigned int work_count = 0;
+    while (true) {
+        ABT_unit unit = ABT_UNIT_NULL;
+        for (int i = 0; i < num_pools; ++i) {
+            ABT_pool_pop(pools[i], &unit);
+            if (unit != ABT_UNIT_NULL) {
+                ABT_xstream_run_unit(unit, pools[i]);
+                break;
+            }
+        }
+        if (unit == ABT_UNIT_NULL) {
+            ABT_pool_pop_timedwait(pools[0], &unit, ABT_get_wtime() + steal_interval);
+            if (unit != ABT_UNIT_NULL) {
+                ABT_xstream_run_unit(unit, pools[0]);
+            }
+        }
+        if (unit == ABT_UNIT_NULL || ++work_count >= event_freq) {
+            work_count = 0;
+            ABT_bool stop;
+            ABT_sched_has_to_stop(sched, &stop);
+            if (stop == ABT_TRUE) {
+                break;
+            }
+            ABT_xstream_check_events(sched);
+        }
+    }
+}
+
+IOPoolLayout io_pool_layout_from_string(const string& name) {
+    if (name == "shared")
+        return IOPoolLayout::shared;
+    if (name == "numa")
+        return IOPoolLayout::numa;
+    if (name == "xstream")
+        return IOPoolLayout::xstream;
+    throw invalid_argument("Unknown I/O pool layout '" + name + "'. Valid values: shared, numa, xstream");
+}
+
+string to_string(IOPoolLayout layout) {
+    switch (layout) {
+        case IOPoolLayout::shared:
+            return "shared";
+        case IOPoolLayout::numa:
+            return "numa";
+        case IOPoolLayout::xstream:
+            return "xstream";
+    }
+    return "unknown";
+}
+
+vector<vector<int>> numa_cpus() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    auto have_mask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+    auto usable = [&](int cpu) {
+        return !have_mask || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed));
+    };
+    vector<vector<int>> nodes;
+    for (auto node : parse_list(read_line("/sys/devices/system/node/online"))) {
+        vector<int> cpus;
+        for (auto cpu : parse_list(read_line("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"))) {
+            if (usable(cpu)) {
+                cpus.push_back(cpu);
+            }
+        }
+        // nodes without CPUs, e.g., of memory-only devices, cannot run xstreams
+        if (!cpus.empty()) {
+            nodes.push_back(cpus);
+        }
+    }
+    if (nodes.empty()) {
+        vector<int> cpus;
+        auto online = sysconf(_SC_NPROCESSORS_ONLN);
+        for (int cpu = 0; cpu < online; ++cpu) {
+            if (usable(cpu)) {
+                cpus.push_back(cpu);
+            }
+        }
+        if (cpus.empty()) {
+            cpus.push_back(0);
+        }
+        nodes.push_back(cpus);
+    }
+    return nodes;
+}
+
+IOPools::IOPools(IOPoolLayout layout, unsigned int xstreams, bool pin, int nice) : layout_(layout), nice_(nice) {
+    if (xstreams == 0) {
+        throw runtime_error("At least one I/O xstream is required");
+    }
+    // xstreams are spread round-robin over the NUMA nodes and the CPUs within each node
+    auto nodes = numa_cpus();
+    vector<size_t> node_of(xstreams);
+    vector<int> cpu_of(xstreams);
+    vector<size_t> next_cpu(nodes.size(), 0);
+    for (unsigned int i = 0; i < xstreams; ++i) {
+        auto node = i % nodes.size();
+        node_of[i] = node;
+        cpu_of[i] = nodes[node][next_cpu[node]++ % nodes[node].size()];
+    }
+
+    size_t partitions = 1;
+    if (layout == IOPoolLayout::numa) {
+        partitions = min<size_t>(nodes.size(), xstreams);
+    } else if (layout == IOPoolLayout::xstream) {
+        partitions = xstreams;
+    }
+    pools_.resize(partitions, ABT_POOL_NULL);
+    for (auto& pool : pools_) {
+        // MPMC, other xstreams steal from it
+        if (ABT_pool_create_basic(ABT_POOL_FIFO_WAIT, ABT_POOL_ACCESS_MPMC, ABT_TRUE, &pool) != ABT_SUCCESS) {
+            stop();
+            throw runtime_error("Failed to create I/O tasks pool");
+        }
+    }
+    auto node_of_pool = [&](size_t pool) {
+        return layout == IOPoolLayout::numa ? pool : node_of[pool];
+    };
+
+    static ABT_sched_def sched_def = {
+            ABT_SCHED_TYPE_ULT,
+            sched_init,
+            run_sched,
+            sched_free,
+            nullptr
+    };
+    for (unsigned int i = 0; i < xstreams; ++i) {
+        ABT_xstream xstream;
+        int ret;
+        // the nice value is set by the custom scheduler on its xstream
+        if (layout == IOPoolLayout::shared && nice == 0) {
+            ret = ABT_xstream_create_basic(ABT_SCHED_BASIC_WAIT, 1, &pools_[0], ABT_SCHED_CONFIG_NULL, &xstream);
+        } else {
+            // own pool, then the pools of the same NUMA node, then all others. Each xstream starts with its
+            // neighbours so that idle xstreams do not all steal from the same pool
+            auto own = layout == IOPoolLayout::numa ? node_of[i] : layout == IOPoolLayout::xstream ? i : 0;
+            vector<ABT_pool> order{pools_[own]};
+            for (auto same_node : {true, false}) {
+                for (size_t k = 1; k < partitions; ++k) {
+                    auto pool = (own + k) % partitions;
+                    if ((node_of_pool(pool) == node_of_pool(own)) == same_node) {
+                        order.push_back(pools_[pool]);
+                    }
+                }
+            }
+            ABT_sched sched;
+            ret = ABT_sched_create(&sched_def, static_cast<int>(order.size()), order.data(), ABT_SCHED_CONFIG_NULL,
+                                   &sched);
+            if (ret == ABT_SUCCESS) {
+                scheds_.push_back(sched);
+                ABT_sched_set_data(sched, this);
+                ret = ABT_xstream_create(sched, &xstream);
+            }
+        }
+        if (ret != ABT_SUCCESS) {
+            stop();
+            throw runtime_error("Failed to create task execution streams for I/O operations");
+        }
+        xstreams_.push_back(xstream);
+        // fails if Argobots was built without affinity support
+        if (pin && ABT_xstream_set_cpubind(xstream, cpu_of[i]) == ABT_SUCCESS) {
+            pinned_++;
+        }
+    }
+    // waits until reniced() is known
+    for (unsigned int wait_ms = 0; nice != 0 && renice_attempts_ < xstreams && wait_ms < 5000; ++wait_ms) {
+        usleep(1000);
+    }
+}
+
+IOPools::~IOPools() {
+    stop();
+}
+
+void IOPools::stop() {
+    for (auto& xstream : xstreams_) {
+        ABT_xstream_join(xstream);
+        ABT_xstream_free(&xstream);
+    }
+    xstreams_.clear();
+    // schedulers created with ABT_sched_create are not freed with their xstream. The pools are freed with the last
+    // scheduler that uses them
+    for (auto& sched : scheds_) {
+        ABT_sched_free(&sched);
+    }
+    scheds_.clear();
+}
+
+IOPoolLayout IOPools::layout() const {
+    return layout_;
+}
+
+size_t IOPools::partitions() const {
+    return pools_.size();
+}
+
+size_t IOPools::xstreams() const {
+    return xstreams_.size();
+}
+
+unsigned int IOPools::pinned() const {
+    return pinned_;
+}
+
+unsigned int IOPools::reniced() const {
+    return reniced_;
+}
+
+ABT_pool IOPools::pool(uint64_t key) const {
+    return pools_[key % pools_.size()];
+}
+
+size_t IOPools::queue_depth() const {
+    size_t depth = 0;
+    for (const auto& pool : pools_) {
+        size_t size = 0;
+        ABT_pool_get_size(pool, &size);
+        depth += size;
+    }
+    return depth;
+}
+
+} // namespace daemon
+} // namespace gkfs
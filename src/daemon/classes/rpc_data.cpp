@@ -29,20 +29,28 @@ void RPCData::server_rpc_mid(margo_instance* server_rpc_mid) {
     RPCData::server_rpc_mid_ = server_rpc_mid;
 }
 
-ABT_pool RPCData::io_pool() const {
-    return io_pool_;
+IOPools& RPCData::io_pools() {
+    return *io_pools_;
 }
 
-void RPCData::io_pool(ABT_pool io_pool) {
-    RPCData::io_pool_ = io_pool;
+void RPCData::io_pools(unique_ptr<IOPools> io_pools) {
+    io_pools_ = move(io_pools);
 }
 
-vector<ABT_xstream>& RPCData::io_streams() {
-    return io_streams_;
+void RPCData::close_io_pools() {
+    io_pools_.reset();
 }
 
-void RPCData::io_streams(const vector<ABT_xstream>& io_streams) {
-    RPCData::io_streams_ = io_streams;
+ABT_pool RPCData::metadata_handler_pool() const {
+    return metadata_handler_pools_ ? metadata_handler_pools_->pool(0) : ABT_POOL_NULL;
+}
+
+void RPCData::metadata_handler_pools(unique_ptr<IOPools> metadata_handler_pools) {
+    metadata_handler_pools_ = move(metadata_handler_pools);
+}
+
+void RPCData::close_metadata_handler_pools() {
+    metadata_handler_pools_.reset();
 }
 
 const std::string& RPCData::self_addr_str() const {
@@ -53,5 +61,25 @@ void RPCData::self_addr_str(const std::string& addr_str) {
     self_addr_str_ = addr_str;
 }
 
+std::atomic<uint64_t>& RPCData::bytes_in_flight() {
+    return bytes_in_flight_;
+}
+
+std::atomic<uint64_t>& RPCData::agios_backlog() {
+    return agios_backlog_;
+}
+
+ClientRpcGate& RPCData::client_rpc_gate() {
+    return client_rpc_gate_;
+}
+
+gkfs::util::StageStats& RPCData::stage_stats() {
+    return stage_stats_;
+}
+
+ShmRegions& RPCData::shm_regions() {
+    return shm_regions_;
+}
+
 } // namespace daemon
 } // namespace gkfs
\ No newline at end of file
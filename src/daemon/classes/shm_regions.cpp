@@ -0,0 +1,173 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <daemon/classes/shm_regions.hpp>
+#include <global/rpc/shm_region.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <system_error>
+
+extern "C" {
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+
+using namespace std;
+
+namespace gkfs {
+namespace daemon {
+
+namespace {
+
+[[noreturn]] void throw_errno(int err, const string& what) {
+    throw system_error(err, system_category(), what);
+}
+
+/**
+ * Maps the memfd fd of process pid after checking that it is a region of a GekkoFS client that may use this daemon
+ */
+shared_ptr<ShmRegion> map_region(uint64_t id, pid_t pid, int fd) {
+    auto proc = "/proc/"s + to_string(pid);
+    struct stat st{};
+    if (stat(proc.c_str(), &st) != 0) {
+        throw_errno(errno, "Client process " + to_string(pid) + " not found");
+    }
+    if (st.st_uid != geteuid() && geteuid() != 0) {
+        throw_errno(EACCES, "Client process " + to_string(pid) + " belongs to another user");
+    }
+    auto fd_path = proc + "/fd/" + to_string(fd);
+    char target[256]{};
+    auto len = readlink(fd_path.c_str(), target, sizeof(target) - 1);
+    if (len < 0) {
+        throw_errno(errno, "Failed to resolve " + fd_path);
+    }
+    const string prefix = "/memfd:"s + gkfs::rpc::shm::memfd_name;
+    if (string(target, len).compare(0, prefix.size(), prefix) != 0) {
+        throw_errno(EINVAL, fd_path + " is not a shared-memory region of a client");
+    }
+
+    auto region_fd = open(fd_path.c_str(), O_RDWR | O_CLOEXEC);
+    if (region_fd < 0) {
+        throw_errno(errno, "Failed to open " + fd_path);
+    }
+    auto seals = fcntl(region_fd, F_GET_SEALS);
+    if (seals < 0 || (seals & gkfs::rpc::shm::required_seals) != gkfs::rpc::shm::required_seals) {
+        close(region_fd);
+        throw_errno(EACCES, fd_path + " is not sealed against resizing");
+    }
+    errno = 0;
+    if (fstat(region_fd, &st) != 0 || static_cast<size_t>(st.st_size) <= gkfs::rpc::shm::data_offset) {
+        auto err = errno;
+        close(region_fd);
+        throw_errno(err ? err : EINVAL, fd_path + " has no data");
+    }
+    auto size = static_cast<size_t>(st.st_size);
+    auto base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, region_fd, 0);
+    auto err = errno;
+    // the mapping stays valid without the descriptor
+    close(region_fd);
+    if (base == MAP_FAILED) {
+        throw_errno(err, "Failed to map " + fd_path);
+    }
+    auto region = make_shared<ShmRegion>(static_cast<char*>(base), size, pid);
+    gkfs::rpc::shm::Header header{};
+    memcpy(&header, base, sizeof(header));
+    if (header.id != id) {
+        throw_errno(EACCES, fd_path + " is not region " + to_string(id));
+    }
+    return region;
+}
+
+} // namespace
+
+ShmRegion::ShmRegion(char* base, size_t size, pid_t pid) : base_(base), size_(size), pid_(pid) {}
+
+ShmRegion::~ShmRegion() {
+    munmap(base_, size_);
+}
+
+pid_t ShmRegion::pid() const {
+    return pid_;
+}
+
+size_t ShmRegion::size() const {
+    return size_;
+}
+
+char* ShmRegion::span(int64_t pos, size_t size) const {
+    if (pos < static_cast<int64_t>(gkfs::rpc::shm::data_offset) || static_cast<uint64_t>(pos) > size_ ||
+        size > size_ - pos) {
+        return nullptr;
+    }
+    return base_ + pos;
+}
+
+ShmRegions::ShmRegions(size_t max_size) : max_size_(max_size), mapped_size_(0) {}
+
+/**
+ * Drops the regions of exited processes and then arbitrary ones until needed more bytes fit. Requests still using a
+ * dropped region keep it mapped until they are done
+ */
+void ShmRegions::evict(size_t needed) {
+    for (auto it = regions_.begin(); it != regions_.end();) {
+        if (kill(it->second->pid(), 0) != 0 && errno == ESRCH) {
+            mapped_size_ -= it->second->size();
+            it = regions_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    while (!regions_.empty() && mapped_size_ + needed > max_size_) {
+        mapped_size_ -= regions_.begin()->second->size();
+        regions_.erase(regions_.begin());
+    }
+}
+
+shared_ptr<ShmRegion> ShmRegions::get(uint64_t id, pid_t pid, int fd) {
+    lock_guard<mutex> lock(mutex_);
+    auto it = regions_.find(id);
+    if (it != regions_.end() && it->second->pid() == pid) {
+        return it->second;
+    }
+    auto region = map_region(id, pid, fd);
+    if (it != regions_.end()) {
+        // the id was reused by another process
+        mapped_size_ -= it->second->size();
+        regions_.erase(it);
+    }
+    evict(region->size());
+    // a region larger than all that may be kept only serves the current request
+    if (mapped_size_ + region->size() <= max_size_) {
+        mapped_size_ += region->size();
+        regions_.emplace(id, region);
+    }
+    return region;
+}
+
+size_t ShmRegions::size() const {
+    lock_guard<mutex> lock(mutex_);
+    return regions_.size();
+}
+
+size_t ShmRegions::mapped_size() const {
+    lock_guard<mutex> lock(mutex_);
+    return mapped_size_;
+}
+
+} // namespace daemon
+} // namespace gkfs
@@ -21,8 +21,10 @@
 #include <daemon/env.hpp>
 #include <daemon/handler/rpc_defs.hpp>
 #include <daemon/ops/metadentry.hpp>
+#include <daemon/ops/rebalance.hpp>
 #include <daemon/backend/metadata/db.hpp>
 #include <daemon/backend/data/chunk_storage.hpp>
+#include <daemon/backend/data/chunk_reclaimer.hpp>
 #include <daemon/util.hpp>
 #ifdef GKFS_ENABLE_AGIOS
 #include <daemon/scheduler/agios.hpp>
@@ -36,6 +38,7 @@
 #include <fstream>
 #include <csignal>
 #include <condition_variable>
+#include <atomic>
 
 extern "C" {
 #include <unistd.h>
@@ -48,58 +51,75 @@ namespace bfs = boost::filesystem;
 
 static condition_variable shutdown_please;
 static mutex mtx;
+static atomic<bool> rebalance_please{false};
 
 void init_io_tasklet_pool() {
-    assert(gkfs::config::rpc::daemon_io_xstreams >= 0);
-    unsigned int xstreams_num = gkfs::config::rpc::daemon_io_xstreams;
-
-    //retrieve the pool of the just created scheduler
-    ABT_pool pool;
-    auto ret = ABT_pool_create_basic(ABT_POOL_FIFO_WAIT, ABT_POOL_ACCESS_MPMC, ABT_TRUE, &pool);
-    if (ret != ABT_SUCCESS) {
-        throw runtime_error("Failed to create I/O tasks pool");
-    }
-
-    //create all subsequent xstream and the associated scheduler, all tapping into the same pool
-    vector<ABT_xstream> xstreams(xstreams_num);
-    for (unsigned int i = 0; i < xstreams_num; ++i) {
-        ret = ABT_xstream_create_basic(ABT_SCHED_BASIC_WAIT, 1, &pool,
-                                       ABT_SCHED_CONFIG_NULL, &xstreams[i]);
-        if (ret != ABT_SUCCESS) {
-            throw runtime_error("Failed to create task execution streams for I/O operations");
-        }
+    auto xstreams = GKFS_DATA->io_xstreams();
+    auto layout = GKFS_DATA->io_pool_layout();
+    unique_ptr<gkfs::daemon::IOPools> pools(new gkfs::daemon::IOPools(layout, xstreams, GKFS_DATA->io_pin()));
+    GKFS_DATA->spdlogger()->info("{}() {} I/O xstreams with {} '{}' pools", __func__, pools->xstreams(),
+                                 pools->partitions(), gkfs::daemon::to_string(layout));
+    if (GKFS_DATA->io_pin() && pools->pinned() < pools->xstreams()) {
+        GKFS_DATA->spdlogger()->warn("{}() Only {} of {} I/O xstreams could be bound to a CPU", __func__,
+                                     pools->pinned(), pools->xstreams());
     }
-
-    RPC_DATA->io_streams(xstreams);
-    RPC_DATA->io_pool(pool);
+    RPC_DATA->io_pools(move(pools));
 }
 
 /**
- * Registers RPC handlers to Margo instance
+ * Registers RPC handlers to Margo instance. Metadata RPCs run on their own handler pool, if there is one, so that they
+ * do not queue behind data RPCs
  * @param hg_class
  */
 void register_server_rpcs(margo_instance_id mid) {
-    MARGO_REGISTER(mid, gkfs::rpc::tag::fs_config, void, rpc_config_out_t, rpc_srv_get_fs_config);
-    MARGO_REGISTER(mid, gkfs::rpc::tag::create, rpc_mk_node_in_t, rpc_err_out_t, rpc_srv_create);
-    MARGO_REGISTER(mid, gkfs::rpc::tag::stat, rpc_path_only_in_t, rpc_stat_out_t, rpc_srv_stat);
-    MARGO_REGISTER(mid, gkfs::rpc::tag::decr_size, rpc_trunc_in_t, rpc_err_out_t, rpc_srv_decr_size);
-    MARGO_REGISTER(mid, gkfs::rpc::tag::remove, rpc_rm_node_in_t, rpc_err_out_t, rpc_srv_remove);
-    MARGO_REGISTER(mid, gkfs::rpc::tag::update_metadentry, rpc_update_metadentry_in_t, rpc_err_out_t,
-                   rpc_srv_update_metadentry);
-    MARGO_REGISTER(mid, gkfs::rpc::tag::get_metadentry_size, rpc_path_only_in_t, rpc_get_metadentry_size_out_t,
-                   rpc_srv_get_metadentry_size);
-    MARGO_REGISTER(mid, gkfs::rpc::tag::update_metadentry_size, rpc_update_metadentry_size_in_t,
-                   rpc_update_metadentry_size_out_t, rpc_srv_update_metadentry_size);
-    MARGO_REGISTER(mid, gkfs::rpc::tag::get_dirents, rpc_get_dirents_in_t, rpc_get_dirents_out_t,
-                   rpc_srv_get_dirents);
+    auto md_pool = RPC_DATA->metadata_handler_pool();
+    auto provider = MARGO_DEFAULT_PROVIDER_ID;
+    // metadata RPCs
+    MARGO_REGISTER_PROVIDER(mid, gkfs::rpc::tag::fs_config, void, rpc_config_out_t, rpc_srv_get_fs_config, provider,
+                            md_pool);
+    MARGO_REGISTER_PROVIDER(mid, gkfs::rpc::tag::create, rpc_mk_node_in_t, rpc_err_out_t, rpc_srv_create, provider,
+                            md_pool);
+    MARGO_REGISTER_PROVIDER(mid, gkfs::rpc::tag::stat, rpc_path_only_in_t, rpc_stat_out_t, rpc_srv_stat, provider,
+                            md_pool);
+    MARGO_REGISTER_PROVIDER(mid, gkfs::rpc::tag::decr_size, rpc_trunc_in_t, rpc_err_out_t, rpc_srv_decr_size,
+                            provider, md_pool);
+    MARGO_REGISTER_PROVIDER(mid, gkfs::rpc::tag::remove, rpc_rm_node_in_t, rpc_err_out_t, rpc_srv_remove, provider,
+                            md_pool);
+    MARGO_REGISTER_PROVIDER(mid, gkfs::rpc::tag::update_metadentry, rpc_update_metadentry_in_t, rpc_err_out_t,
+                            rpc_srv_update_metadentry, provider, md_pool);
+    MARGO_REGISTER_PROVIDER(mid, gkfs::rpc::tag::get_metadentry_size, rpc_path_only_in_t,
+                            rpc_get_metadentry_size_out_t, rpc_srv_get_metadentry_size, provider, md_pool);
+    MARGO_REGISTER_PROVIDER(mid, gkfs::rpc::tag::update_metadentry_size, rpc_update_metadentry_size_in_t,
+                            rpc_update_metadentry_size_out_t, rpc_srv_update_metadentry_size, provider, md_pool);
+    MARGO_REGISTER_PROVIDER(mid, gkfs::rpc::tag::get_dirents, rpc_get_dirents_in_t, rpc_get_dirents_out_t,
+                            rpc_srv_get_dirents, provider, md_pool);
 #ifdef HAS_SYMLINKS
-    MARGO_REGISTER(mid, gkfs::rpc::tag::mk_symlink, rpc_mk_symlink_in_t, rpc_err_out_t, rpc_srv_mk_symlink);
+    MARGO_REGISTER_PROVIDER(mid, gkfs::rpc::tag::mk_symlink, rpc_mk_symlink_in_t, rpc_err_out_t, rpc_srv_mk_symlink,
+                            provider, md_pool);
 #endif
+    MARGO_REGISTER_PROVIDER(mid, gkfs::rpc::tag::get_chunk_stat, rpc_chunk_stat_in_t, rpc_chunk_stat_out_t,
+                            rpc_srv_get_chunk_stat, provider, md_pool);
+    MARGO_REGISTER_PROVIDER(mid, gkfs::rpc::tag::migrate_metadentry, rpc_migrate_metadentry_in_t, rpc_err_out_t,
+                            rpc_srv_migrate_metadentry, provider, md_pool);
+    MARGO_REGISTER_PROVIDER(mid, gkfs::rpc::tag::get_load, void, rpc_load_out_t, rpc_srv_get_load, provider, md_pool);
+    MARGO_REGISTER_PROVIDER(mid, gkfs::rpc::tag::get_stage_stats, rpc_stage_stats_in_t, rpc_stage_stats_out_t,
+                            rpc_srv_get_stage_stats, provider, md_pool);
+    // inline data is read and written in the metadata backend
+    MARGO_REGISTER_PROVIDER(mid, gkfs::rpc::tag::write_inline, rpc_inline_data_in_t, rpc_inline_data_out_t,
+                            rpc_srv_write_inline, provider, md_pool);
+    MARGO_REGISTER_PROVIDER(mid, gkfs::rpc::tag::migrate_inline, rpc_inline_data_in_t, rpc_inline_data_out_t,
+                            rpc_srv_migrate_inline, provider, md_pool);
+    MARGO_REGISTER_PROVIDER(mid, gkfs::rpc::tag::read_inline, rpc_inline_data_in_t, rpc_inline_data_out_t,
+                            rpc_srv_read_inline, provider, md_pool);
+    MARGO_REGISTER_PROVIDER(mid, gkfs::rpc::tag::promote_inline, rpc_path_only_in_t, rpc_inline_data_out_t,
+                            rpc_srv_promote_inline, provider, md_pool);
+    // data RPCs
     MARGO_REGISTER(mid, gkfs::rpc::tag::write, rpc_write_data_in_t, rpc_data_out_t, rpc_srv_write);
-    MARGO_REGISTER(mid, gkfs::rpc::tag::read, rpc_read_data_in_t, rpc_data_out_t, rpc_srv_read);
+    MARGO_REGISTER(mid, gkfs::rpc::tag::migrate_chunk, rpc_write_data_in_t, rpc_data_out_t, rpc_srv_migrate_chunk);
+    MARGO_REGISTER(mid, gkfs::rpc::tag::read, rpc_read_data_in_t, rpc_read_data_out_t, rpc_srv_read);
     MARGO_REGISTER(mid, gkfs::rpc::tag::truncate, rpc_trunc_in_t, rpc_err_out_t, rpc_srv_truncate);
-    MARGO_REGISTER(mid, gkfs::rpc::tag::get_chunk_stat, rpc_chunk_stat_in_t, rpc_chunk_stat_out_t,
-                   rpc_srv_get_chunk_stat);
+    MARGO_REGISTER(mid, gkfs::rpc::tag::seek_data, rpc_seek_data_in_t, rpc_seek_data_out_t, rpc_srv_seek_data);
+    MARGO_REGISTER(mid, gkfs::rpc::tag::reclaim_chunks, rpc_rm_node_in_t, rpc_err_out_t, rpc_srv_reclaim_chunks);
 }
 
 void init_rpc_server(const string& protocol_port) {
@@ -120,10 +140,25 @@ void init_rpc_server(const string& protocol_port) {
                               MARGO_SERVER_MODE,
                               &hg_options,
                               HG_TRUE,
-                              gkfs::config::rpc::daemon_handler_xstreams);
+                              GKFS_DATA->handler_xstreams());
     if (mid == MARGO_INSTANCE_NULL) {
         throw runtime_error("Failed to initialize the Margo RPC server");
     }
+    // Margo has initialized Argobots
+    if (GKFS_DATA->metadata_handler_xstreams() > 0) {
+        auto nice = GKFS_DATA->metadata_handler_nice();
+        unique_ptr<gkfs::daemon::IOPools> md_pools(
+                new gkfs::daemon::IOPools(gkfs::daemon::IOPoolLayout::shared, GKFS_DATA->metadata_handler_xstreams(),
+                                          false, nice));
+        if (nice != 0 && md_pools->reniced() < md_pools->xstreams()) {
+            GKFS_DATA->spdlogger()->warn("{}() Failed to set the nice value of {} of {} metadata handler xstreams",
+                                         __func__, md_pools->xstreams() - md_pools->reniced(),
+                                         md_pools->xstreams());
+        }
+        RPC_DATA->metadata_handler_pools(move(md_pools));
+    }
+    GKFS_DATA->spdlogger()->info("{}() {} data and {} metadata RPC handler xstreams", __func__,
+                                 GKFS_DATA->handler_xstreams(), GKFS_DATA->metadata_handler_xstreams());
     // Figure out what address this server is listening on (must be freed when finished)
     auto hret = margo_addr_self(mid, &addr_self);
     if (hret != HG_SUCCESS) {
@@ -182,11 +217,24 @@ void init_environment() {
     bfs::create_directories(chunk_storage_path);
     try {
         GKFS_DATA->storage(
-                std::make_shared<gkfs::data::ChunkStorage>(chunk_storage_path, gkfs::config::rpc::chunksize));
+                std::make_shared<gkfs::data::ChunkStorage>(chunk_storage_path, gkfs::config::rpc::chunksize,
+                                                           GKFS_DATA->compression_type(),
+                                                           GKFS_DATA->compression_level(),
+                                                           GKFS_DATA->direct_io()));
     } catch (const std::exception& e) {
         GKFS_DATA->spdlogger()->error("{}() Failed to initialize storage backend: {}", __func__, e.what());
         throw;
     }
+    std::string reclaim_path = GKFS_DATA->rootdir() + "/data/reclaim"s;
+    GKFS_DATA->spdlogger()->debug("{}() Initializing chunk reclaimer: '{}'", __func__, reclaim_path);
+    try {
+        GKFS_DATA->reclaimer(std::make_shared<gkfs::data::ChunkReclaimer>(
+                GKFS_DATA->storage(), reclaim_path, gkfs::config::io::reclaim_batch_size,
+                std::chrono::milliseconds(gkfs::config::io::reclaim_batch_interval_ms)));
+    } catch (const std::exception& e) {
+        GKFS_DATA->spdlogger()->error("{}() Failed to initialize chunk reclaimer: {}", __func__, e.what());
+        throw;
+    }
 
     // Init margo for RPC
     GKFS_DATA->spdlogger()->debug("{}() Initializing RPC server: '{}'",
@@ -251,10 +299,9 @@ void destroy_enviroment() {
     boost::system::error_code ecode;
     bfs::remove_all(GKFS_DATA->mountdir(), ecode);
     GKFS_DATA->spdlogger()->debug("{}() Freeing I/O executions streams", __func__);
-    for (unsigned int i = 0; i < RPC_DATA->io_streams().size(); i++) {
-        ABT_xstream_join(RPC_DATA->io_streams().at(i));
-        ABT_xstream_free(&RPC_DATA->io_streams().at(i));
-    }
+    RPC_DATA->close_io_pools();
+    // before Margo finalizes Argobots
+    RPC_DATA->close_metadata_handler_pools();
 
     if (!GKFS_DATA->hosts_file().empty()) {
         GKFS_DATA->spdlogger()->debug("{}() Removing hosts file", __func__);
@@ -270,6 +317,9 @@ void destroy_enviroment() {
         margo_finalize(RPC_DATA->server_rpc_mid());
     }
 
+    GKFS_DATA->spdlogger()->info("{}() Stopping chunk reclaimer", __func__);
+    GKFS_DATA->close_reclaimer();
+
     GKFS_DATA->spdlogger()->info("{}() Closing metadata DB", __func__);
     GKFS_DATA->close_mdb();
 }
@@ -279,6 +329,15 @@ void shutdown_handler(int dummy) {
     shutdown_please.notify_all();
 }
 
+/**
+ * Wakes up the main thread to rebalance data and metadata after the hosts file has changed
+ */
+void rebalance_handler(int dummy) {
+    GKFS_DATA->spdlogger()->info("{}() Received signal: '{}'", __func__, strsignal(dummy));
+    rebalance_please = true;
+    shutdown_please.notify_all();
+}
+
 void initialize_loggers() {
     std::string path = gkfs::config::log::daemon_log_path;
     // Try to get log path from env variable
@@ -302,6 +361,7 @@ void initialize_loggers() {
             "main",
             "MetadataDB",
             "ChunkStorage",
+            "ChunkReclaimer",
     };
 
     gkfs::log::setup(logger_names, level, path);
@@ -323,6 +383,40 @@ int main(int argc, const char* argv[]) {
             ("hosts-file,H", po::value<string>(),
              "Shared file used by deamons to register their "
              "enpoints. (default './gkfs_hosts.txt')")
+            ("distributor,d", po::value<string>()->default_value("simple"),
+             "Data and metadata placement: 'simple' (hash modulo host count) or 'jump' (jump consistent "
+             "hashing, moves only a minimal amount of data when daemons are added or removed) or 'locality' "
+             "(all chunks of a file go to the daemon on the node that created it). "
+             "All daemons of a file system must use the same value.")
+            ("inline-data-size", po::value<unsigned int>()->default_value(gkfs::config::metadata::inline_data_size),
+             "Files of up to this many bytes are stored in their metadentry instead of chunks. At most the chunk "
+             "size. 0 disables inline data. All daemons of a file system must use the same value.")
+            ("compression", po::value<string>()->default_value(gkfs::config::io::compression),
+             "Compression of chunk files: 'none', 'lz4', 'zstd' or 'snappy'. Chunks that do not compress well are "
+             "stored raw. Must not be changed for existing data.")
+            ("compression-level", po::value<int>()->default_value(gkfs::config::io::compression_level),
+             "Compression level for lz4 (uses LZ4HC if > 0) and zstd. 0 uses the algorithm's default.")
+            ("direct-io", po::bool_switch()->default_value(gkfs::config::io::direct_io),
+             "Read and write chunk files with O_DIRECT, bypassing the page cache. Cannot be combined with "
+             "compression. The chunk directory's file system must support it.")
+            ("handler-xstreams", po::value<unsigned int>()->default_value(gkfs::config::rpc::daemon_handler_xstreams),
+             "Number of Argobots execution streams running the handlers of data RPCs (read, write, truncate).")
+            ("metadata-handler-xstreams",
+             po::value<unsigned int>()->default_value(gkfs::config::rpc::daemon_metadata_handler_xstreams),
+             "Number of Argobots execution streams running the handlers of metadata RPCs, e.g., stat, create, "
+             "readdir, so that they do not wait for data RPCs. 0 runs them on the data handler execution streams.")
+            ("metadata-handler-nice",
+             po::value<int>()->default_value(gkfs::config::rpc::daemon_metadata_handler_nice),
+             "Nice value of the metadata handler execution streams. Negative values prioritize them over the other "
+             "threads of the daemon and need CAP_SYS_NICE.")
+            ("io-xstreams", po::value<unsigned int>()->default_value(gkfs::config::rpc::daemon_io_xstreams),
+             "Number of Argobots execution streams running chunk I/O.")
+            ("io-pools", po::value<string>()->default_value(gkfs::config::rpc::daemon_io_pools),
+             "Pools of chunk I/O tasks: 'shared' (one pool for all I/O xstreams), 'numa' (one pool per NUMA node) or "
+             "'xstream' (one pool per I/O xstream). Tasks of a chunk always go to the same pool and idle xstreams "
+             "steal from other pools, those of their NUMA node first.")
+            ("io-pin", po::bool_switch(),
+             "Bind each I/O xstream to a CPU, spread over the NUMA nodes. Requires Argobots with affinity support.")
             ("version", "print version and exit");
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -393,6 +487,51 @@ int main(int argc, const char* argv[]) {
     }
     GKFS_DATA->hosts_file(hosts_file);
 
+    try {
+        GKFS_DATA->distributor_type(gkfs::rpc::distributor_type_from_string(vm["distributor"].as<string>()));
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    auto inline_data_size = vm["inline-data-size"].as<unsigned int>();
+    if (inline_data_size > gkfs::config::rpc::chunksize) {
+        std::cerr << "Error: inline data size must not exceed the chunk size of " << gkfs::config::rpc::chunksize
+                  << " bytes\n";
+        return 1;
+    }
+    GKFS_DATA->inline_data_size(inline_data_size);
+
+    try {
+        GKFS_DATA->compression_type(gkfs::data::compression_type_from_string(vm["compression"].as<string>()));
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    GKFS_DATA->compression_level(vm["compression-level"].as<int>());
+    GKFS_DATA->direct_io(vm["direct-io"].as<bool>());
+    if (GKFS_DATA->direct_io() && GKFS_DATA->compression_type() != gkfs::data::CompressionType::none) {
+        std::cerr << "Error: direct I/O cannot be used with chunk compression\n";
+        return 1;
+    }
+
+    auto io_xstreams = vm["io-xstreams"].as<unsigned int>();
+    if (io_xstreams == 0) {
+        std::cerr << "Error: at least one I/O xstream is required\n";
+        return 1;
+    }
+    GKFS_DATA->io_xstreams(io_xstreams);
+    try {
+        GKFS_DATA->io_pool_layout(gkfs::daemon::io_pool_layout_from_string(vm["io-pools"].as<string>()));
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    GKFS_DATA->io_pin(vm["io-pin"].as<bool>());
+    GKFS_DATA->handler_xstreams(vm["handler-xstreams"].as<unsigned int>());
+    GKFS_DATA->metadata_handler_xstreams(vm["metadata-handler-xstreams"].as<unsigned int>());
+    GKFS_DATA->metadata_handler_nice(vm["metadata-handler-nice"].as<int>());
+
     GKFS_DATA->spdlogger()->info("{}() Initializing environment", __func__);
 
     assert(vm.count("mountdir"));
@@ -454,10 +593,20 @@ int main(int argc, const char* argv[]) {
     signal(SIGINT, shutdown_handler);
     signal(SIGTERM, shutdown_handler);
     signal(SIGKILL, shutdown_handler);
+    signal(SIGUSR1, rebalance_handler);
 
     unique_lock<mutex> lk(mtx);
-    // Wait for shutdown signal to initiate shutdown protocols
-    shutdown_please.wait(lk);
+    // Wait for shutdown signal to initiate shutdown protocols. Rebalancing runs on this (primary) ULT
+    while (true) {
+        shutdown_please.wait(lk);
+        if (!rebalance_please.exchange(false))
+            break;
+        try {
+            gkfs::daemon::rebalance();
+        } catch (const std::exception& e) {
+            GKFS_DATA->spdlogger()->error("{}() Rebalancing failed: {}", __func__, e.what());
+        }
+    }
     GKFS_DATA->spdlogger()->info("{}() Shutting down...", __func__);
     destroy_enviroment();
     GKFS_DATA->spdlogger()->info("{}() Complete. Exiting...", __func__);
@@ -16,10 +16,14 @@
 #include <daemon/handler/rpc_defs.hpp>
 #include <daemon/handler/rpc_util.hpp>
 #include <daemon/backend/data/chunk_storage.hpp>
+#include <daemon/backend/data/chunk_reclaimer.hpp>
+#include <daemon/backend/data/direct_io.hpp>
 
 #include <global/rpc/rpc_types.hpp>
 #include <global/rpc/distributor.hpp>
 #include <global/chunk_calc_util.hpp>
+#include <global/stage_stats.hpp>
+#include <global/metadata.hpp>
 
 #ifdef GKFS_ENABLE_AGIOS
 #include <daemon/scheduler/agios.hpp>
@@ -29,6 +33,10 @@
 #define AGIOS_SERVER_ID_IGNORE 0
 #endif
 
+#include <functional>
+#include <new>
+#include <system_error>
+
 using namespace std;
 
 struct write_chunk_args {
@@ -37,9 +45,33 @@ struct write_chunk_args {
     gkfs::types::rpc_chnk_id_t chnk_id;
     size_t size;
     off64_t off;
+    // chunk size of the file, a write of this size replaces the whole chunk
+    size_t chunk_size;
     ABT_eventual eventual;
+    // when the task was created, for the queue stage
+    gkfs::util::StageTimer::clock::time_point queued;
 };
 
+/**
+ * Records how long a chunk task waited in the I/O pool and returns when it started running
+ */
+gkfs::util::StageTimer::clock::time_point record_task_queued(gkfs::util::RpcOp op,
+                                                             gkfs::util::StageTimer::clock::time_point queued) {
+    auto now = gkfs::util::StageTimer::clock::now();
+    RPC_DATA->stage_stats().record(op, gkfs::util::RpcStage::queue,
+                                   chrono::duration_cast<chrono::microseconds>(now - queued).count());
+    return now;
+}
+
+/**
+ * Records the chunk I/O of a task that started running at `start`
+ */
+void record_task_storage(gkfs::util::RpcOp op, gkfs::util::StageTimer::clock::time_point start) {
+    RPC_DATA->stage_stats().record(op, gkfs::util::RpcStage::storage,
+                                   chrono::duration_cast<chrono::microseconds>(
+                                           gkfs::util::StageTimer::clock::now() - start).count());
+}
+
 /**
  * Used by an argobots threads. Argument args has the following fields:
  * const std::string* path;
@@ -56,15 +88,17 @@ void write_file_abt(void* _arg) {
     // Unpack args
     auto* arg = static_cast<struct write_chunk_args*>(_arg);
     const std::string& path = *(arg->path);
+    auto start = record_task_queued(gkfs::util::RpcOp::write, arg->queued);
 
     try {
         GKFS_DATA->storage()->write_chunk(path, arg->chnk_id,
-                                          arg->buf, arg->size, arg->off, arg->eventual);
+                                          arg->buf, arg->size, arg->off, arg->chunk_size, arg->eventual);
     } catch (const std::system_error& serr) {
         GKFS_DATA->spdlogger()->error("{}() Error writing chunk {} of file {}", __func__, arg->chnk_id, path);
         ssize_t wrote = -(serr.code().value());
         ABT_eventual_set(arg->eventual, &wrote, sizeof(ssize_t));
     }
+    record_task_storage(gkfs::util::RpcOp::write, start);
 
 }
 
@@ -75,6 +109,8 @@ struct read_chunk_args {
     size_t size;
     off64_t off;
     ABT_eventual eventual;
+    // when the task was created, for the queue stage
+    gkfs::util::StageTimer::clock::time_point queued;
 };
 
 /**
@@ -93,6 +129,7 @@ void read_file_abt(void* _arg) {
     //unpack args
     auto* arg = static_cast<struct read_chunk_args*>(_arg);
     const std::string& path = *(arg->path);
+    auto start = record_task_queued(gkfs::util::RpcOp::read, arg->queued);
 
     try {
         GKFS_DATA->storage()->read_chunk(path, arg->chnk_id,
@@ -102,6 +139,7 @@ void read_file_abt(void* _arg) {
         ssize_t read = -(serr.code().value());
         ABT_eventual_set(arg->eventual, &read, sizeof(ssize_t));
     }
+    record_task_storage(gkfs::util::RpcOp::read, start);
 }
 
 /**
@@ -127,8 +165,100 @@ void cancel_abt_io(vector<ABT_task>* abt_tasks, vector<ABT_eventual>* abt_eventu
     }
 }
 
+/**
+ * Returns the host of a chunk as the client located it, so that a data handler finds the chunks of a request that
+ * belong to it. Chunks are placed by the daemon's distributor unless the file's layout limits it to a stripe of the
+ * daemons
+ * @param path
+ * @param host_id
+ * @param host_size
+ * @param stripe_width of the file's layout
+ * @return
+ */
+function<gkfs::rpc::host_t(uint64_t)> chunk_locator(const string& path, uint64_t host_id, uint64_t host_size,
+                                                     uint32_t stripe_width) {
+    #ifdef GKFS_ENABLE_FORWARDING
+    // chunks striped across forwarders are hashed within the client's forwarders. host_id and host_size are the
+    // position of this daemon among them and their number
+    auto distributor = make_shared<gkfs::rpc::SimpleHashDistributor>(host_id, host_size);
+    #else
+    if (gkfs::rpc::is_striped(stripe_width, host_size)) {
+        return [path, stripe_width, host_size](uint64_t chnk_id) {
+            return gkfs::rpc::locate_striped_data(path, chnk_id, stripe_width, host_size);
+        };
+    }
+    auto distributor = gkfs::rpc::make_hash_distributor(GKFS_DATA->distributor_type(), host_id, host_size);
+    #endif
+    return [path, distributor](uint64_t chnk_id) {
+        return distributor->locate_data(path, chnk_id);
+    };
+}
 
-static hg_return_t rpc_srv_write(hg_handle_t handle) {
+/**
+ * Checks the layout a data request was sent with. Chunk ids, offsets and buffer sizes are derived from its chunk size
+ * @param caller name of the handler, for the log
+ * @param path
+ * @param layout
+ * @return false if the chunk size is not one a file can have
+ */
+bool valid_layout(const char* caller, const string& path, const gkfs::metadata::Layout& layout) {
+    try {
+        gkfs::metadata::check_layout(layout);
+        return true;
+    } catch (const invalid_argument& e) {
+        GKFS_DATA->spdlogger()->error("{}() Rejected layout of '{}': {}", caller, path, e.what());
+        return false;
+    }
+}
+
+/**
+ * Allocates the buffer for the chunks of a data request if the chunk storage uses direct I/O. The data of each chunk
+ * then lies at the same offset modulo config::io::direct_io_alignment as within its chunk file, so that the chunk
+ * storage only copies the unaligned fragments at the ends of a request. Otherwise, or if the allocation fails, margo
+ * allocates the buffer
+ * @param size
+ * @param first_offset offset within its chunk of the first chunk of this host
+ * @param bulk_buf set to the start of the chunk data
+ * @return owner of the buffer or null
+ */
+gkfs::data::AlignedBuffer direct_io_buffer(hg_size_t size, uint64_t first_offset, void*& bulk_buf) {
+    if (!GKFS_DATA->storage()->direct_io()) {
+        return nullptr;
+    }
+    constexpr size_t alignment = gkfs::config::io::direct_io_alignment;
+    auto pad = first_offset % alignment;
+    try {
+        auto buf = gkfs::data::make_aligned_buffer(pad + size, alignment);
+        bulk_buf = buf.get() + pad;
+        return buf;
+    } catch (const bad_alloc&) {
+        GKFS_DATA->spdlogger()->warn("{}() Failed to allocate aligned buffer of {} bytes", __func__, size);
+        return nullptr;
+    }
+}
+
+/**
+ * Accounts the bytes of a data request as in flight while the handler runs. Reported by the load RPC
+ */
+class BytesInFlight {
+private:
+    uint64_t size_;
+public:
+    explicit BytesInFlight(uint64_t size) : size_(size) {
+        RPC_DATA->bytes_in_flight() += size_;
+    }
+
+    ~BytesInFlight() {
+        RPC_DATA->bytes_in_flight() -= size_;
+    }
+};
+
+/**
+ * Writes the chunks of a write request of a client or of a chunk another daemon writes to this one, e.g., when it
+ * rebalances or promotes an inline file. The latter are served while this daemon rebalances itself
+ */
+static hg_return_t write_data(hg_handle_t handle, bool from_peer) {
+    gkfs::util::StageTimer timer(RPC_DATA->stage_stats(), gkfs::util::RpcOp::write);
     /*
      * 1. Setup
      */
@@ -144,12 +274,38 @@ static hg_return_t rpc_srv_write(hg_handle_t handle) {
         GKFS_DATA->spdlogger()->error("{}() Could not get RPC input data with err {}", __func__, ret);
         return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
     }
+    timer.stage(gkfs::util::RpcStage::decode);
+    if (!valid_layout(__func__, in.path, {in.chunk_size, in.stripe_width})) {
+        out.err = EINVAL;
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+    }
+    gkfs::daemon::ClientRpc client_rpc(RPC_DATA->client_rpc_gate(), !from_peer);
     auto hgi = margo_get_info(handle);
     auto mid = margo_hg_info_get_instance(hgi);
-    auto bulk_size = margo_bulk_get_size(in.bulk_handle);
+    // a client on this node may pass its data in shared memory instead of a buffer for bulk transfers
+    shared_ptr<gkfs::daemon::ShmRegion> shm_region;
+    if (in.shm_id != 0) {
+        try {
+            shm_region = RPC_DATA->shm_regions().get(in.shm_id, in.shm_pid, in.shm_fd);
+        } catch (const system_error& e) {
+            GKFS_DATA->spdlogger()->warn("{}() Cannot use the shared memory of client process {}: {}", __func__,
+                                         in.shm_pid, e.what());
+            // tells the client to repeat the request with a bulk transfer
+            out.err = ENOTSUP;
+            return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+        }
+    }
+    /*
+     * size of the client's buffer, i.e., of the whole request. Without one, the total size of this host's chunks
+     * yields the same chunk sizes below: the two only differ if the request spans chunks of several hosts, and then
+     * both exceed the first chunk and, if this host has several chunks, the chunk size
+     */
+    auto bulk_size = shm_region ? in.total_chunk_size : margo_bulk_get_size(in.bulk_handle);
+    BytesInFlight in_flight(in.total_chunk_size);
     GKFS_DATA->spdlogger()->debug("{}() path: {}, size: {}, offset: {}", __func__,
                                   in.path, bulk_size, in.offset);
     #ifdef GKFS_ENABLE_AGIOS
+    timer.mark();
     int *data;
     ABT_eventual eventual = ABT_EVENTUAL_NULL;
 
@@ -160,6 +316,7 @@ static hg_return_t rpc_srv_write(hg_handle_t handle) {
     char *agios_path = (char*) in.path;
 
     // We should call AGIOS before chunking (as that is an internal way to handle the requests)
+    RPC_DATA->agios_backlog()++;
     if (!agios_add_request(agios_path, AGIOS_WRITE, in.offset, in.total_chunk_size, request_id, AGIOS_SERVER_ID_IGNORE, agios_eventual_callback, eventual)) {
         GKFS_DATA->spdlogger()->error("{}() Failed to send request to AGIOS", __func__);
     } else {
@@ -168,11 +325,13 @@ static hg_return_t rpc_srv_write(hg_handle_t handle) {
 
     /* Block until the eventual is signaled */
     ABT_eventual_wait(eventual, (void **)&data);
+    RPC_DATA->agios_backlog()--;
 
     unsigned long long int result = *data;
     GKFS_DATA->spdlogger()->debug("{}() request {} was unblocked (offset = {})!", __func__, result, in.offset);
 
     ABT_eventual_free(&eventual);
+    timer.stage(gkfs::util::RpcStage::schedule);
 
     // Let AGIOS knows it can release the request, as it is completed
     if (!agios_release_request(agios_path, AGIOS_WRITE, in.total_chunk_size, in.offset)) {
@@ -182,27 +341,39 @@ static hg_return_t rpc_srv_write(hg_handle_t handle) {
     /*
      * 2. Set up buffers for pull bulk transfers
      */
-    void* bulk_buf; // buffer for bulk transfer
+    auto const host_id = in.host_id;
+    auto const chunksize = gkfs::metadata::chunk_size({in.chunk_size, in.stripe_width});
+    auto locate_chunk = chunk_locator(in.path, host_id, in.host_size, in.stripe_width);
+    // the whole chunk range was sent to this host, e.g., for a file with a data host. No need to filter by hash
+    auto const all_chunks = (in.chunk_n == in.chunk_end - in.chunk_start + 1);
+    void* bulk_buf = nullptr; // buffer for bulk transfer
     vector<char*> bulk_buf_ptrs(in.chunk_n); // buffer-chunk offsets
-    // create bulk handle and allocated memory for buffer with buf_sizes information
-    ret = margo_bulk_create(mid, 1, nullptr, &in.total_chunk_size, HG_BULK_READWRITE, &bulk_handle);
-    if (ret != HG_SUCCESS) {
-        GKFS_DATA->spdlogger()->error("{}() Failed to create bulk handle", __func__);
-        return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
-    }
-    // access the internally allocated memory buffer and put it into buf_ptrs
-    uint32_t actual_count;
-    ret = margo_bulk_access(bulk_handle, 0, in.total_chunk_size, HG_BULK_READWRITE, 1, &bulk_buf,
-                            &in.total_chunk_size, &actual_count);
-    if (ret != HG_SUCCESS || actual_count != 1) {
-        GKFS_DATA->spdlogger()->error("{}() Failed to access allocated buffer from bulk handle", __func__);
-        return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+    // chunks are read from and written to the shared memory in place
+    if (!shm_region) {
+        // only the first chunk of the request starts at an offset
+        auto direct_buf = direct_io_buffer(in.total_chunk_size,
+                                           (all_chunks || locate_chunk(in.chunk_start) == host_id) ? in.offset : 0,
+                                           bulk_buf);
+        // create bulk handle and allocated memory for buffer with buf_sizes information
+        ret = margo_bulk_create(mid, 1, direct_buf ? &bulk_buf : nullptr, &in.total_chunk_size, HG_BULK_READWRITE,
+                                &bulk_handle);
+        if (ret != HG_SUCCESS) {
+            GKFS_DATA->spdlogger()->error("{}() Failed to create bulk handle", __func__);
+            return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+        }
+        // access the internally allocated memory buffer and put it into buf_ptrs
+        uint32_t actual_count;
+        ret = margo_bulk_access(bulk_handle, 0, in.total_chunk_size, HG_BULK_READWRITE, 1, &bulk_buf,
+                                &in.total_chunk_size, &actual_count);
+        if (ret != HG_SUCCESS || actual_count != 1) {
+            GKFS_DATA->spdlogger()->error("{}() Failed to access allocated buffer from bulk handle", __func__);
+            return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+        }
     }
-    auto const host_id = in.host_id;
-    auto const host_size = in.host_size;
-    gkfs::rpc::SimpleHashDistributor distributor(host_id, host_size);
 
     auto path = make_shared<string>(in.path);
+    // chunk tasks are routed to an I/O pool by file and chunk id
+    auto const path_hash = hash<string>{}(*path);
     // chnk_ids used by this host
     vector<uint64_t> chnk_ids_host(in.chunk_n);
     // counter to track how many chunks have been assigned
@@ -216,47 +387,53 @@ static hg_return_t rpc_srv_write(hg_handle_t handle) {
     /*
      * consider the following cases:
      * 1. Very first chunk has offset or not and is serviced by this node
-     * 2. If offset, will still be only 1 chunk written (small IO): (offset + bulk_size <= CHUNKSIZE) ? bulk_size
-     * 3. If no offset, will only be 1 chunk written (small IO): (bulk_size <= CHUNKSIZE) ? bulk_size
-     * 4. Chunks between start and end chunk have size of the CHUNKSIZE
-     * 5. Last chunk (if multiple chunks are written): Don't write CHUNKSIZE but chnk_size_left for this destination
+     * 2. If offset, will still be only 1 chunk written (small IO): (offset + bulk_size <= chunksize) ? bulk_size
+     * 3. If no offset, will only be 1 chunk written (small IO): (bulk_size <= chunksize) ? bulk_size
+     * 4. Chunks between start and end chunk have size of the chunksize of the file
+     * 5. Last chunk (if multiple chunks are written): Don't write chunksize but chnk_size_left for this destination
      *    Last chunk can also happen if only one chunk is written. This is covered by 2 and 3.
      */
     // temporary variables
-    auto transfer_size = (bulk_size <= gkfs::config::rpc::chunksize) ? bulk_size : gkfs::config::rpc::chunksize;
+    auto transfer_size = (bulk_size <= chunksize) ? bulk_size : chunksize;
     uint64_t origin_offset;
     uint64_t local_offset;
     // task structures for async writing
     vector<ABT_task> abt_tasks(in.chunk_n);
     vector<ABT_eventual> task_eventuals(in.chunk_n);
     vector<struct write_chunk_args> task_args(in.chunk_n);
+    // time spent pulling data from the client
+    gkfs::util::StageTimer::clock::duration transfer_time{};
     /*
      * 3. Calculate chunk sizes that correspond to this host, transfer data, and start tasks to write to disk
      */
     // Start to look for a chunk that hashes to this host with the first chunk in the buffer
     for (auto chnk_id_file = in.chunk_start; chnk_id_file < in.chunk_end || chnk_id_curr < in.chunk_n; chnk_id_file++) {
         // Continue if chunk does not hash to this host
-        #ifndef GKFS_ENABLE_FORWARDING
-        if (distributor.locate_data(in.path, chnk_id_file) != host_id)
+        if (!all_chunks && locate_chunk(chnk_id_file) != host_id)
             continue;
-        #endif
         chnk_ids_host[chnk_id_curr] = chnk_id_file; // save this id to host chunk list
         // offset case. Only relevant in the first iteration of the loop and if the chunk hashes to this host
         if (chnk_id_file == in.chunk_start && in.offset > 0) {
             // if only 1 destination and 1 chunk (small write) the transfer_size == bulk_size
-            auto offset_transfer_size = (in.offset + bulk_size <= gkfs::config::rpc::chunksize) ? bulk_size
-                                                                                                : static_cast<size_t>(
-                                                gkfs::config::rpc::chunksize - in.offset);
-            ret = margo_bulk_transfer(mid, HG_BULK_PULL, hgi->addr, in.bulk_handle, 0,
-                                      bulk_handle, 0, offset_transfer_size);
-            if (ret != HG_SUCCESS) {
-                GKFS_DATA->spdlogger()->error(
-                        "{}() Failed to pull data from client for chunk {} (startchunk {}; endchunk {}", __func__,
-                        chnk_id_file, in.chunk_start, in.chunk_end - 1);
-                cancel_abt_io(&abt_tasks, &task_eventuals, chnk_id_curr);
-                return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+            auto offset_transfer_size = (in.offset + bulk_size <= chunksize) ? bulk_size
+                                                                             : static_cast<size_t>(chunksize -
+                                                                                                   in.offset);
+            if (shm_region) {
+                bulk_buf_ptrs[chnk_id_curr] = shm_region->span(in.shm_offset, offset_transfer_size);
+            } else {
+                auto transfer_start = gkfs::util::StageTimer::clock::now();
+                ret = margo_bulk_transfer(mid, HG_BULK_PULL, hgi->addr, in.bulk_handle, 0,
+                                          bulk_handle, 0, offset_transfer_size);
+                transfer_time += gkfs::util::StageTimer::clock::now() - transfer_start;
+                if (ret != HG_SUCCESS) {
+                    GKFS_DATA->spdlogger()->error(
+                            "{}() Failed to pull data from client for chunk {} (startchunk {}; endchunk {}", __func__,
+                            chnk_id_file, in.chunk_start, in.chunk_end - 1);
+                    cancel_abt_io(&abt_tasks, &task_eventuals, chnk_id_curr);
+                    return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+                }
+                bulk_buf_ptrs[chnk_id_curr] = chnk_ptr;
             }
-            bulk_buf_ptrs[chnk_id_curr] = chnk_ptr;
             chnk_sizes[chnk_id_curr] = offset_transfer_size;
             chnk_ptr += offset_transfer_size;
             chnk_size_left_host -= offset_transfer_size;
@@ -264,10 +441,9 @@ static hg_return_t rpc_srv_write(hg_handle_t handle) {
             local_offset = in.total_chunk_size - chnk_size_left_host;
             // origin offset of a chunk is dependent on a given offset in a write operation
             if (in.offset > 0)
-                origin_offset = (gkfs::config::rpc::chunksize - in.offset) +
-                                ((chnk_id_file - in.chunk_start) - 1) * gkfs::config::rpc::chunksize;
+                origin_offset = (chunksize - in.offset) + ((chnk_id_file - in.chunk_start) - 1) * chunksize;
             else
-                origin_offset = (chnk_id_file - in.chunk_start) * gkfs::config::rpc::chunksize;
+                origin_offset = (chnk_id_file - in.chunk_start) * chunksize;
             // last chunk might have different transfer_size
             if (chnk_id_curr == in.chunk_n - 1)
                 transfer_size = chnk_size_left_host;
@@ -275,21 +451,34 @@ static hg_return_t rpc_srv_write(hg_handle_t handle) {
                     "{}() BULK_TRANSFER hostid {} file {} chnkid {} total_Csize {} Csize_left {} origin offset {} local offset {} transfersize {}",
                     __func__, host_id, in.path, chnk_id_file, in.total_chunk_size, chnk_size_left_host,
                     origin_offset, local_offset, transfer_size);
-            // RDMA the data to here
-            ret = margo_bulk_transfer(mid, HG_BULK_PULL, hgi->addr, in.bulk_handle, origin_offset,
-                                      bulk_handle, local_offset, transfer_size);
-            if (ret != HG_SUCCESS) {
-                GKFS_DATA->spdlogger()->error(
-                        "{}() Failed to pull data from client. file {} chunk {} (startchunk {}; endchunk {})", __func__,
-                        *path, chnk_id_file, in.chunk_start, (in.chunk_end - 1));
-                cancel_abt_io(&abt_tasks, &task_eventuals, chnk_id_curr);
-                return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+            if (shm_region) {
+                bulk_buf_ptrs[chnk_id_curr] = shm_region->span(in.shm_offset + origin_offset, transfer_size);
+            } else {
+                // RDMA the data to here
+                auto transfer_start = gkfs::util::StageTimer::clock::now();
+                ret = margo_bulk_transfer(mid, HG_BULK_PULL, hgi->addr, in.bulk_handle, origin_offset,
+                                          bulk_handle, local_offset, transfer_size);
+                transfer_time += gkfs::util::StageTimer::clock::now() - transfer_start;
+                if (ret != HG_SUCCESS) {
+                    GKFS_DATA->spdlogger()->error(
+                            "{}() Failed to pull data from client. file {} chunk {} (startchunk {}; endchunk {})",
+                            __func__, *path, chnk_id_file, in.chunk_start, (in.chunk_end - 1));
+                    cancel_abt_io(&abt_tasks, &task_eventuals, chnk_id_curr);
+                    return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+                }
+                bulk_buf_ptrs[chnk_id_curr] = chnk_ptr;
             }
-            bulk_buf_ptrs[chnk_id_curr] = chnk_ptr;
             chnk_sizes[chnk_id_curr] = transfer_size;
             chnk_ptr += transfer_size;
             chnk_size_left_host -= transfer_size;
         }
+        if (!bulk_buf_ptrs[chnk_id_curr]) {
+            GKFS_DATA->spdlogger()->error("{}() Chunk {} lies outside of the shared memory of client process {}",
+                                          __func__, chnk_id_file, in.shm_pid);
+            out.err = EINVAL;
+            cancel_abt_io(&abt_tasks, &task_eventuals, chnk_id_curr);
+            return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+        }
         // Delegate chunk I/O operation to local FS to an I/O dedicated ABT pool
         // Starting tasklets for parallel I/O
         ABT_eventual_create(sizeof(ssize_t), &task_eventuals[chnk_id_curr]); // written file return value
@@ -300,9 +489,11 @@ static hg_return_t rpc_srv_write(hg_handle_t handle) {
         task_arg.size = chnk_sizes[chnk_id_curr];
         // only the first chunk gets the offset. the chunks are sorted on the client side
         task_arg.off = (chnk_id_file == in.chunk_start) ? in.offset : 0;
+        task_arg.chunk_size = chunksize;
         task_arg.eventual = task_eventuals[chnk_id_curr];
-        auto abt_ret = ABT_task_create(RPC_DATA->io_pool(), write_file_abt, &task_args[chnk_id_curr],
-                                       &abt_tasks[chnk_id_curr]);
+        task_arg.queued = gkfs::util::StageTimer::clock::now();
+        auto abt_ret = ABT_task_create(RPC_DATA->io_pools().pool(path_hash + task_arg.chnk_id), write_file_abt,
+                                       &task_args[chnk_id_curr], &abt_tasks[chnk_id_curr]);
         if (abt_ret != ABT_SUCCESS) {
             GKFS_DATA->spdlogger()->error("{}() task create failed", __func__);
             cancel_abt_io(&abt_tasks, &task_eventuals, chnk_id_curr + 1);
@@ -312,6 +503,7 @@ static hg_return_t rpc_srv_write(hg_handle_t handle) {
         chnk_id_curr++;
 
     }
+    timer.record(gkfs::util::RpcStage::transfer, transfer_time);
     // Sanity check that all chunks where detected in previous loop
     if (chnk_size_left_host != 0)
         GKFS_DATA->spdlogger()->warn("{}() Not all chunks were detected!!! Size left {}", __func__,
@@ -354,7 +546,9 @@ static hg_return_t rpc_srv_write(hg_handle_t handle) {
      * 5. Respond and cleanup
      */
     GKFS_DATA->spdlogger()->debug("{}() Sending output response {}", __func__, out.err);
+    timer.mark();
     ret = gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+    timer.stage(gkfs::util::RpcStage::respond);
     // free tasks after responding
     for (auto&& task : abt_tasks) {
         ABT_task_join(task);
@@ -363,30 +557,68 @@ static hg_return_t rpc_srv_write(hg_handle_t handle) {
     return ret;
 }
 
+static hg_return_t rpc_srv_write(hg_handle_t handle) {
+    return write_data(handle, false);
+}
+
 DEFINE_MARGO_RPC_HANDLER(rpc_srv_write)
 
+static hg_return_t rpc_srv_migrate_chunk(hg_handle_t handle) {
+    return write_data(handle, true);
+}
+
+DEFINE_MARGO_RPC_HANDLER(rpc_srv_migrate_chunk)
+
 static hg_return_t rpc_srv_read(hg_handle_t handle) {
+    gkfs::util::StageTimer timer(RPC_DATA->stage_stats(), gkfs::util::RpcOp::read);
     /*
      * 1. Setup
      */
     rpc_read_data_in_t in{};
-    rpc_data_out_t out{};
+    rpc_read_data_out_t out{};
     hg_bulk_t bulk_handle = nullptr;
     // Set default out for error
     out.err = EIO;
     out.io_size = 0;
+    out.data_end = 0;
     // Getting some information from margo
     auto ret = margo_get_input(handle, &in);
     if (ret != HG_SUCCESS) {
         GKFS_DATA->spdlogger()->error("{}() Could not get RPC input data with err {}", __func__, ret);
         return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
     }
+    timer.stage(gkfs::util::RpcStage::decode);
+    if (!valid_layout(__func__, in.path, {in.chunk_size, in.stripe_width})) {
+        out.err = EINVAL;
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+    }
+    gkfs::daemon::ClientRpc client_rpc(RPC_DATA->client_rpc_gate());
     auto hgi = margo_get_info(handle);
     auto mid = margo_hg_info_get_instance(hgi);
-    auto bulk_size = margo_bulk_get_size(in.bulk_handle);
+    // a client on this node may pass its data in shared memory instead of a buffer for bulk transfers
+    shared_ptr<gkfs::daemon::ShmRegion> shm_region;
+    if (in.shm_id != 0) {
+        try {
+            shm_region = RPC_DATA->shm_regions().get(in.shm_id, in.shm_pid, in.shm_fd);
+        } catch (const system_error& e) {
+            GKFS_DATA->spdlogger()->warn("{}() Cannot use the shared memory of client process {}: {}", __func__,
+                                         in.shm_pid, e.what());
+            // tells the client to repeat the request with a bulk transfer
+            out.err = ENOTSUP;
+            return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+        }
+    }
+    /*
+     * size of the client's buffer, i.e., of the whole request. Without one, the total size of this host's chunks
+     * yields the same chunk sizes below: the two only differ if the request spans chunks of several hosts, and then
+     * both exceed the first chunk and, if this host has several chunks, the chunk size
+     */
+    auto bulk_size = shm_region ? in.total_chunk_size : margo_bulk_get_size(in.bulk_handle);
+    BytesInFlight in_flight(in.total_chunk_size);
     GKFS_DATA->spdlogger()->debug("{}() path: {}, size: {}, offset: {}", __func__,
                                   in.path, bulk_size, in.offset);
     #ifdef GKFS_ENABLE_AGIOS
+    timer.mark();
     int *data;
     ABT_eventual eventual = ABT_EVENTUAL_NULL;
 
@@ -397,6 +629,7 @@ static hg_return_t rpc_srv_read(hg_handle_t handle) {
     char *agios_path = (char*) in.path;
 
     // We should call AGIOS before chunking (as that is an internal way to handle the requests)
+    RPC_DATA->agios_backlog()++;
     if (!agios_add_request(agios_path, AGIOS_READ, in.offset, in.total_chunk_size, request_id, AGIOS_SERVER_ID_IGNORE, agios_eventual_callback, eventual)) {
         GKFS_DATA->spdlogger()->error("{}() Failed to send request to AGIOS", __func__);
     } else {
@@ -405,11 +638,13 @@ static hg_return_t rpc_srv_read(hg_handle_t handle) {
 
     /* block until the eventual is signaled */
     ABT_eventual_wait(eventual, (void **)&data);
+    RPC_DATA->agios_backlog()--;
 
     unsigned long long int result = *data;
     GKFS_DATA->spdlogger()->debug("{}() request {} was unblocked (offset = {})!", __func__, result, in.offset);
 
     ABT_eventual_free(&eventual);
+    timer.stage(gkfs::util::RpcStage::schedule);
 
     // let AGIOS knows it can release the request, as it is completed
     if (!agios_release_request(agios_path, AGIOS_READ, in.total_chunk_size, in.offset)) {
@@ -420,29 +655,39 @@ static hg_return_t rpc_srv_read(hg_handle_t handle) {
     /*
      * 2. Set up buffers for pull bulk transfers
      */
-    void* bulk_buf; // buffer for bulk transfer
+    auto const host_id = in.host_id;
+    auto const chunksize = gkfs::metadata::chunk_size({in.chunk_size, in.stripe_width});
+    auto locate_chunk = chunk_locator(in.path, host_id, in.host_size, in.stripe_width);
+    // the whole chunk range was sent to this host, e.g., for a file with a data host. No need to filter by hash
+    auto const all_chunks = (in.chunk_n == in.chunk_end - in.chunk_start + 1);
+    void* bulk_buf = nullptr; // buffer for bulk transfer
     vector<char*> bulk_buf_ptrs(in.chunk_n); // buffer-chunk offsets
-    // create bulk handle and allocated memory for buffer with buf_sizes information
-    ret = margo_bulk_create(mid, 1, nullptr, &in.total_chunk_size, HG_BULK_READWRITE, &bulk_handle);
-    if (ret != HG_SUCCESS) {
-        GKFS_DATA->spdlogger()->error("{}() Failed to create bulk handle", __func__);
-        return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
-    }
-    // access the internally allocated memory buffer and put it into buf_ptrs
-    uint32_t actual_count;
-    ret = margo_bulk_access(bulk_handle, 0, in.total_chunk_size, HG_BULK_READWRITE, 1, &bulk_buf,
-                            &in.total_chunk_size, &actual_count);
-    if (ret != HG_SUCCESS || actual_count != 1) {
-        GKFS_DATA->spdlogger()->error("{}() Failed to access allocated buffer from bulk handle", __func__);
-        return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+    // chunks are read from and written to the shared memory in place
+    if (!shm_region) {
+        // only the first chunk of the request starts at an offset
+        auto direct_buf = direct_io_buffer(in.total_chunk_size,
+                                           (all_chunks || locate_chunk(in.chunk_start) == host_id) ? in.offset : 0,
+                                           bulk_buf);
+        // create bulk handle and allocated memory for buffer with buf_sizes information
+        ret = margo_bulk_create(mid, 1, direct_buf ? &bulk_buf : nullptr, &in.total_chunk_size, HG_BULK_READWRITE,
+                                &bulk_handle);
+        if (ret != HG_SUCCESS) {
+            GKFS_DATA->spdlogger()->error("{}() Failed to create bulk handle", __func__);
+            return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+        }
+        // access the internally allocated memory buffer and put it into buf_ptrs
+        uint32_t actual_count;
+        ret = margo_bulk_access(bulk_handle, 0, in.total_chunk_size, HG_BULK_READWRITE, 1, &bulk_buf,
+                                &in.total_chunk_size, &actual_count);
+        if (ret != HG_SUCCESS || actual_count != 1) {
+            GKFS_DATA->spdlogger()->error("{}() Failed to access allocated buffer from bulk handle", __func__);
+            return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+        }
     }
-    #ifndef GKFS_ENABLE_FORWARDING
-    auto const host_id = in.host_id;
-    auto const host_size = in.host_size;
-    gkfs::rpc::SimpleHashDistributor distributor(host_id, host_size);
-    #endif
 
     auto path = make_shared<string>(in.path);
+    // chunk tasks are routed to an I/O pool by file and chunk id
+    auto const path_hash = hash<string>{}(*path);
     // chnk_ids used by this host
     vector<uint64_t> chnk_ids_host(in.chunk_n);
     // counter to track how many chunks have been assigned
@@ -457,32 +702,33 @@ static hg_return_t rpc_srv_read(hg_handle_t handle) {
     // temporary traveling pointer
     auto chnk_ptr = static_cast<char*>(bulk_buf);
     // temporary variables
-    auto transfer_size = (bulk_size <= gkfs::config::rpc::chunksize) ? bulk_size : gkfs::config::rpc::chunksize;
+    auto transfer_size = (bulk_size <= chunksize) ? bulk_size : chunksize;
     // tasks structures
     vector<ABT_task> abt_tasks(in.chunk_n);
     vector<ABT_eventual> task_eventuals(in.chunk_n);
     vector<struct read_chunk_args> task_args(in.chunk_n);
+    // time spent pushing data to the client
+    gkfs::util::StageTimer::clock::duration transfer_time{};
     /*
      * 3. Calculate chunk sizes that correspond to this host and start tasks to read from disk
      */
     // Start to look for a chunk that hashes to this host with the first chunk in the buffer
     for (auto chnk_id_file = in.chunk_start; chnk_id_file < in.chunk_end || chnk_id_curr < in.chunk_n; chnk_id_file++) {
         // Continue if chunk does not hash to this host
-        #ifndef GKFS_ENABLE_FORWARDING
-        if (distributor.locate_data(in.path, chnk_id_file) != host_id)
+        if (!all_chunks && locate_chunk(chnk_id_file) != host_id)
             continue;
-        #endif
         chnk_ids_host[chnk_id_curr] = chnk_id_file; // save this id to host chunk list
         // Only relevant in the first iteration of the loop and if the chunk hashes to this host
         if (chnk_id_file == in.chunk_start && in.offset > 0) {
             // if only 1 destination and 1 chunk (small read) the transfer_size == bulk_size
-            auto offset_transfer_size = (in.offset + bulk_size <= gkfs::config::rpc::chunksize) ? bulk_size
-                                                                                                : static_cast<size_t>(
-                                                gkfs::config::rpc::chunksize - in.offset);
+            auto offset_transfer_size = (in.offset + bulk_size <= chunksize) ? bulk_size
+                                                                             : static_cast<size_t>(chunksize -
+                                                                                                   in.offset);
             // Setting later transfer offsets
             local_offsets[chnk_id_curr] = 0;
             origin_offsets[chnk_id_curr] = 0;
-            bulk_buf_ptrs[chnk_id_curr] = chnk_ptr;
+            bulk_buf_ptrs[chnk_id_curr] = shm_region ? shm_region->span(in.shm_offset, offset_transfer_size)
+                                                     : chnk_ptr;
             chnk_sizes[chnk_id_curr] = offset_transfer_size;
             // util variables
             chnk_ptr += offset_transfer_size;
@@ -492,19 +738,27 @@ static hg_return_t rpc_srv_read(hg_handle_t handle) {
             // origin offset of a chunk is dependent on a given offset in a write operation
             if (in.offset > 0)
                 origin_offsets[chnk_id_curr] =
-                        (gkfs::config::rpc::chunksize - in.offset) +
-                        ((chnk_id_file - in.chunk_start) - 1) * gkfs::config::rpc::chunksize;
+                        (chunksize - in.offset) + ((chnk_id_file - in.chunk_start) - 1) * chunksize;
             else
-                origin_offsets[chnk_id_curr] = (chnk_id_file - in.chunk_start) * gkfs::config::rpc::chunksize;
+                origin_offsets[chnk_id_curr] = (chnk_id_file - in.chunk_start) * chunksize;
             // last chunk might have different transfer_size
             if (chnk_id_curr == in.chunk_n - 1)
                 transfer_size = chnk_size_left_host;
-            bulk_buf_ptrs[chnk_id_curr] = chnk_ptr;
+            bulk_buf_ptrs[chnk_id_curr] = shm_region ? shm_region->span(in.shm_offset + origin_offsets[chnk_id_curr],
+                                                                        transfer_size)
+                                                     : chnk_ptr;
             chnk_sizes[chnk_id_curr] = transfer_size;
             // util variables
             chnk_ptr += transfer_size;
             chnk_size_left_host -= transfer_size;
         }
+        if (!bulk_buf_ptrs[chnk_id_curr]) {
+            GKFS_DATA->spdlogger()->error("{}() Chunk {} lies outside of the shared memory of client process {}",
+                                          __func__, chnk_id_file, in.shm_pid);
+            out.err = EINVAL;
+            cancel_abt_io(&abt_tasks, &task_eventuals, chnk_id_curr);
+            return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+        }
         // Delegate chunk I/O operation to local FS to an I/O dedicated ABT pool
         // Starting tasklets for parallel I/O
         ABT_eventual_create(sizeof(ssize_t), &task_eventuals[chnk_id_curr]); // written file return value
@@ -516,8 +770,9 @@ static hg_return_t rpc_srv_read(hg_handle_t handle) {
         // only the first chunk gets the offset. the chunks are sorted on the client side
         task_arg.off = (chnk_id_file == in.chunk_start) ? in.offset : 0;
         task_arg.eventual = task_eventuals[chnk_id_curr];
-        auto abt_ret = ABT_task_create(RPC_DATA->io_pool(), read_file_abt, &task_args[chnk_id_curr],
-                                       &abt_tasks[chnk_id_curr]);
+        task_arg.queued = gkfs::util::StageTimer::clock::now();
+        auto abt_ret = ABT_task_create(RPC_DATA->io_pools().pool(path_hash + task_arg.chnk_id), read_file_abt,
+                                       &task_args[chnk_id_curr], &abt_tasks[chnk_id_curr]);
         if (abt_ret != ABT_SUCCESS) {
             GKFS_DATA->spdlogger()->error("{}() task create failed", __func__);
             cancel_abt_io(&abt_tasks, &task_eventuals, chnk_id_curr + 1);
@@ -530,10 +785,14 @@ static hg_return_t rpc_srv_read(hg_handle_t handle) {
         GKFS_DATA->spdlogger()->warn("{}() Not all chunks were detected!!! Size left {}", __func__,
                                      chnk_size_left_host);
     /*
-     * 4. Read task results and accumulate in out.io_size
+     * 4. Read task results and push them to the client. A task reads up to the end of its chunk file and zero-fills
+     * holes within. Chunks read completely are pushed right away. Chunks that are missing or end early are only
+     * pushed, zero-filled, if a later chunk of this request has data. The client zeroes what lies behind data_end
      */
     out.err = 0;
     out.io_size = 0;
+    vector<uint64_t> read_sizes(in.chunk_n, 0);
+    vector<uint64_t> deferred{};
     for (chnk_id_curr = 0; chnk_id_curr < in.chunk_n; chnk_id_curr++) {
         ssize_t* task_read_size = nullptr;
         // wait causes the calling ult to go into BLOCKED state, implicitly yielding to the pool scheduler
@@ -548,6 +807,8 @@ static hg_return_t rpc_srv_read(hg_handle_t handle) {
         assert(task_read_size != nullptr);
         if (*task_read_size < 0) {
             if (-(*task_read_size) == ENOENT) {
+                // a hole
+                deferred.push_back(chnk_id_curr);
                 continue;
             }
             GKFS_DATA->spdlogger()->warn(
@@ -556,29 +817,77 @@ static hg_return_t rpc_srv_read(hg_handle_t handle) {
             out.err = -(*task_read_size);
             break;
         }
-
-        if (*task_read_size == 0) {
+        read_sizes[chnk_id_curr] = *task_read_size;
+        if (read_sizes[chnk_id_curr] > 0) {
+            // the first byte of the chunk in the file. Only the first chunk of the request starts at an offset
+            auto chnk_offset = chnk_ids_host[chnk_id_curr] * chunksize +
+                               ((chnk_ids_host[chnk_id_curr] == in.chunk_start) ? in.offset : 0);
+            out.data_end = chnk_offset + read_sizes[chnk_id_curr];
+        }
+        if (read_sizes[chnk_id_curr] < chnk_sizes[chnk_id_curr]) {
+            deferred.push_back(chnk_id_curr);
             continue;
         }
 
-        ret = margo_bulk_transfer(mid, HG_BULK_PUSH, hgi->addr, in.bulk_handle, origin_offsets[chnk_id_curr],
-                                  bulk_handle, local_offsets[chnk_id_curr], *task_read_size);
-        if (ret != HG_SUCCESS) {
-            GKFS_DATA->spdlogger()->error(
-                    "{}() Failed push chnkid {} on path {} to client. origin offset {} local offset {} chunk size {}",
-                    __func__, chnk_id_curr, in.path, origin_offsets[chnk_id_curr], local_offsets[chnk_id_curr],
-                    chnk_sizes[chnk_id_curr]);
-            out.err = EIO;
+        // chunks read into shared memory are already in place
+        if (!shm_region) {
+            auto transfer_start = gkfs::util::StageTimer::clock::now();
+            ret = margo_bulk_transfer(mid, HG_BULK_PUSH, hgi->addr, in.bulk_handle, origin_offsets[chnk_id_curr],
+                                      bulk_handle, local_offsets[chnk_id_curr], chnk_sizes[chnk_id_curr]);
+            transfer_time += gkfs::util::StageTimer::clock::now() - transfer_start;
+            if (ret != HG_SUCCESS) {
+                GKFS_DATA->spdlogger()->error(
+                        "{}() Failed push chnkid {} on path {} to client. origin offset {} local offset {} "
+                        "chunk size {}",
+                        __func__, chnk_id_curr, in.path, origin_offsets[chnk_id_curr], local_offsets[chnk_id_curr],
+                        chnk_sizes[chnk_id_curr]);
+                out.err = EIO;
+                break;
+            }
+        }
+        out.io_size += chnk_sizes[chnk_id_curr]; // add task read size to output size
+    }
+
+    // chunks behind the last chunk with data are left to the client
+    uint64_t last_data = 0;
+    for (uint64_t idx = 0; idx < in.chunk_n; ++idx) {
+        if (read_sizes[idx] > 0) {
+            last_data = idx;
+        }
+    }
+    for (auto idx : deferred) {
+        if (out.err != 0 || idx > last_data || read_sizes[last_data] == 0) {
             break;
         }
-        out.io_size += *task_read_size; // add task read size to output size
+        auto push_size = (idx == last_data) ? read_sizes[idx] : chnk_sizes[idx];
+        if (push_size > read_sizes[idx]) {
+            memset(bulk_buf_ptrs[idx] + read_sizes[idx], 0, push_size - read_sizes[idx]);
+        }
+        if (!shm_region) {
+            auto transfer_start = gkfs::util::StageTimer::clock::now();
+            ret = margo_bulk_transfer(mid, HG_BULK_PUSH, hgi->addr, in.bulk_handle, origin_offsets[idx],
+                                      bulk_handle, local_offsets[idx], push_size);
+            transfer_time += gkfs::util::StageTimer::clock::now() - transfer_start;
+            if (ret != HG_SUCCESS) {
+                GKFS_DATA->spdlogger()->error(
+                        "{}() Failed push chnkid {} on path {} to client. origin offset {} local offset {} "
+                        "chunk size {}",
+                        __func__, idx, in.path, origin_offsets[idx], local_offsets[idx], push_size);
+                out.err = EIO;
+                break;
+            }
+        }
+        out.io_size += push_size;
     }
 
     /*
      * 5. Respond and cleanup
      */
+    timer.record(gkfs::util::RpcStage::transfer, transfer_time);
     GKFS_DATA->spdlogger()->debug("{}() Sending output response, err: {}", __func__, out.err);
+    timer.mark();
     ret = gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+    timer.stage(gkfs::util::RpcStage::respond);
     // free tasks after responding
     cancel_abt_io(&abt_tasks, &task_eventuals, in.chunk_n);
     return ret;
@@ -595,12 +904,19 @@ static hg_return_t rpc_srv_truncate(hg_handle_t handle) {
         GKFS_DATA->spdlogger()->error("{}() Could not get RPC input data with err {}", __func__, ret);
         throw runtime_error("Failed to get RPC input data");
     }
-    GKFS_DATA->spdlogger()->debug("{}() path: '{}', length: {}", __func__, in.path, in.length);
+    GKFS_DATA->spdlogger()->debug("{}() path: '{}', length: {}, chunk size: {}", __func__, in.path, in.length,
+                                  in.chunk_size);
+    if (!valid_layout(__func__, in.path, {in.chunk_size, 0})) {
+        out.err = EINVAL;
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+    }
+    gkfs::daemon::ClientRpc client_rpc(RPC_DATA->client_rpc_gate());
+    auto chunksize = gkfs::metadata::chunk_size({in.chunk_size, 0});
 
-    unsigned int chunk_start = gkfs::util::chnk_id_for_offset(in.length, gkfs::config::rpc::chunksize);
+    unsigned int chunk_start = gkfs::util::chnk_id_for_offset(in.length, chunksize);
 
     // If we trunc in the the middle of a chunk, do not delete that chunk
-    auto left_pad = gkfs::util::chnk_lpad(in.length, gkfs::config::rpc::chunksize);
+    auto left_pad = gkfs::util::chnk_lpad(in.length, chunksize);
     if (left_pad != 0) {
         GKFS_DATA->storage()->truncate_chunk(in.path, chunk_start, left_pad);
         ++chunk_start;
@@ -643,6 +959,104 @@ static hg_return_t rpc_srv_get_chunk_stat(hg_handle_t handle) {
 
 DEFINE_MARGO_RPC_HANDLER(rpc_srv_get_chunk_stat)
 
+/**
+ * Finds the next data or hole position at or behind in.offset in the chunks of this daemon within
+ * [chunk_start, chunk_end]. Each chunk is owned by a single daemon, so the client takes the minimum over all daemons.
+ * A chunk that this daemon owns but does not store is a hole.
+ */
+static hg_return_t rpc_srv_seek_data(hg_handle_t handle) {
+    rpc_seek_data_in_t in{};
+    rpc_seek_data_out_t out{};
+    out.err = EIO;
+    out.offset = -1;
+
+    auto ret = margo_get_input(handle, &in);
+    if (ret != HG_SUCCESS) {
+        GKFS_DATA->spdlogger()->error("{}() Could not get RPC input data with err {}", __func__, ret);
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+    }
+    GKFS_DATA->spdlogger()->debug("{}() path: '{}', offset: {}, whence: {}, chunks: [{}, {}]", __func__, in.path,
+                                  in.offset, in.whence == SEEK_DATA ? "SEEK_DATA" : "SEEK_HOLE", in.chunk_start,
+                                  in.chunk_end);
+    if (!valid_layout(__func__, in.path, {in.chunk_size, in.stripe_width})) {
+        out.err = EINVAL;
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+    }
+
+    gkfs::daemon::ClientRpc client_rpc(RPC_DATA->client_rpc_gate());
+
+    auto chunksize = static_cast<int64_t>(gkfs::metadata::chunk_size({in.chunk_size, in.stripe_width}));
+    auto chunk_offset = [&](uint64_t chunk_id) -> off64_t {
+        return chunk_id == in.chunk_start ? in.offset % chunksize : 0;
+    };
+    try {
+        if (in.whence == SEEK_DATA) {
+            for (auto chunk_id : GKFS_DATA->storage()->chunk_ids(in.path)) {
+                if (chunk_id < in.chunk_start || chunk_id > in.chunk_end) {
+                    continue;
+                }
+                auto pos = GKFS_DATA->storage()->seek_chunk(in.path, chunk_id, chunk_offset(chunk_id), SEEK_DATA);
+                if (pos >= 0) {
+                    out.offset = chunk_id * chunksize + pos;
+                    break;
+                }
+            }
+        } else {
+            auto locate_chunk = chunk_locator(in.path, in.host_id, in.host_size, in.stripe_width);
+            for (auto chunk_id = in.chunk_start; chunk_id <= in.chunk_end; ++chunk_id) {
+                if (!in.all_chunks && locate_chunk(chunk_id) != in.host_id) {
+                    continue;
+                }
+                auto pos = GKFS_DATA->storage()->seek_chunk(in.path, chunk_id, chunk_offset(chunk_id), SEEK_HOLE);
+                if (pos < chunksize) {
+                    out.offset = chunk_id * chunksize + pos;
+                    break;
+                }
+            }
+        }
+        out.err = 0;
+    } catch (const std::system_error& e) {
+        GKFS_DATA->spdlogger()->error("{}() Failed to seek in chunks of '{}': {}", __func__, in.path, e.what());
+        out.err = e.code().value();
+    }
+
+    GKFS_DATA->spdlogger()->debug("{}() Sending output err {} offset {}", __func__, out.err, out.offset);
+    return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+}
+
+DEFINE_MARGO_RPC_HANDLER(rpc_srv_seek_data)
+
+/**
+ * Queues the chunks of a removed file on this daemon for deletion and responds without waiting for it. Sent to the
+ * daemons that hold chunks of the file but not its metadentry.
+ */
+static hg_return_t rpc_srv_reclaim_chunks(hg_handle_t handle) {
+    rpc_rm_node_in_t in{};
+    rpc_err_out_t out{};
+    out.err = EIO;
+
+    auto ret = margo_get_input(handle, &in);
+    if (ret != HG_SUCCESS) {
+        GKFS_DATA->spdlogger()->error("{}() Could not get RPC input data with err {}", __func__, ret);
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+    }
+    GKFS_DATA->spdlogger()->debug("{}() path: '{}'", __func__, in.path);
+
+    gkfs::daemon::ClientRpc client_rpc(RPC_DATA->client_rpc_gate());
+    try {
+        GKFS_DATA->reclaimer()->reclaim(in.path);
+        out.err = 0;
+    } catch (const std::system_error& e) {
+        GKFS_DATA->spdlogger()->error("{}() Failed to reclaim chunks of '{}': {}", __func__, in.path, e.what());
+        out.err = e.code().value();
+    }
+
+    GKFS_DATA->spdlogger()->debug("{}() Sending output {}", __func__, out.err);
+    return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+}
+
+DEFINE_MARGO_RPC_HANDLER(rpc_srv_reclaim_chunks)
+
 #ifdef GKFS_ENABLE_AGIOS
 void *agios_eventual_callback(int64_t request_id, void* info) {
     GKFS_DATA->spdlogger()->debug("{}() custom callback request {} is ready", __func__, request_id);
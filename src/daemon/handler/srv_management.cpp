@@ -14,8 +14,10 @@
 
 #include <daemon/daemon.hpp>
 #include <daemon/handler/rpc_defs.hpp>
+#include <daemon/handler/rpc_util.hpp>
 
 #include <global/rpc/rpc_types.hpp>
+#include <global/stage_stats.hpp>
 
 
 using namespace std;
@@ -35,6 +37,8 @@ static hg_return_t rpc_srv_get_fs_config(hg_handle_t handle) {
     out.blocks_state = static_cast<hg_bool_t>(GKFS_DATA->blocks_state());
     out.uid = getuid();
     out.gid = getgid();
+    out.distributor = static_cast<hg_uint32_t>(GKFS_DATA->distributor_type());
+    out.inline_data_size = GKFS_DATA->inline_data_size();
     GKFS_DATA->spdlogger()->debug("{}() Sending output configs back to library", __func__);
     auto hret = margo_respond(handle, &out);
     if (hret != HG_SUCCESS) {
@@ -47,4 +51,75 @@ static hg_return_t rpc_srv_get_fs_config(hg_handle_t handle) {
     return HG_SUCCESS;
 }
 
-DEFINE_MARGO_RPC_HANDLER(rpc_srv_get_fs_config)
\ No newline at end of file
+DEFINE_MARGO_RPC_HANDLER(rpc_srv_get_fs_config)
+
+/**
+ * Reports how busy this daemon is so that clients can pick the least loaded forwarder
+ */
+static hg_return_t rpc_srv_get_load(hg_handle_t handle) {
+    rpc_load_out_t out{};
+
+    out.io_queue_depth = RPC_DATA->io_pools().queue_depth();
+    out.bytes_in_flight = RPC_DATA->bytes_in_flight();
+    out.agios_backlog = RPC_DATA->agios_backlog();
+    GKFS_DATA->spdlogger()->trace("{}() queue depth '{}' bytes in flight '{}' agios backlog '{}'", __func__,
+                                  out.io_queue_depth, out.bytes_in_flight, out.agios_backlog);
+    auto hret = margo_respond(handle, &out);
+    if (hret != HG_SUCCESS) {
+        GKFS_DATA->spdlogger()->error("{}() Failed to respond", __func__);
+    }
+
+    // Destroy handle when finished
+    margo_destroy(handle);
+    return HG_SUCCESS;
+}
+
+DEFINE_MARGO_RPC_HANDLER(rpc_srv_get_load)
+
+/**
+ * Pushes the latency histograms of the RPC handler stages to the caller, e.g., gkfs_stats, and optionally resets them
+ */
+static hg_return_t rpc_srv_get_stage_stats(hg_handle_t handle) {
+    rpc_stage_stats_in_t in{};
+    rpc_stage_stats_out_t out{};
+    hg_bulk_t bulk_handle = nullptr;
+    out.err = EIO;
+    out.op_count = gkfs::util::rpc_op_count;
+    out.stage_count = gkfs::util::rpc_stage_count;
+    out.bucket_count = gkfs::util::LatencyHistogram::bucket_count;
+
+    auto ret = margo_get_input(handle, &in);
+    if (ret != HG_SUCCESS) {
+        GKFS_DATA->spdlogger()->error("{}() Could not get RPC input data with err {}", __func__, ret);
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+    }
+    auto hgi = margo_get_info(handle);
+    auto mid = margo_hg_info_get_instance(hgi);
+
+    auto counts = RPC_DATA->stage_stats().snapshot();
+    if (in.reset == HG_TRUE) {
+        RPC_DATA->stage_stats().reset();
+    }
+    hg_size_t size = counts.size() * sizeof(uint64_t);
+    if (margo_bulk_get_size(in.bulk_handle) < size) {
+        GKFS_DATA->spdlogger()->error("{}() Stage stats do not fit the caller's buffer", __func__);
+        out.err = ENOBUFS;
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+    }
+    void* buf = counts.data();
+    ret = margo_bulk_create(mid, 1, &buf, &size, HG_BULK_READ_ONLY, &bulk_handle);
+    if (ret != HG_SUCCESS) {
+        GKFS_DATA->spdlogger()->error("{}() Failed to create bulk handle", __func__);
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+    }
+    ret = margo_bulk_transfer(mid, HG_BULK_PUSH, hgi->addr, in.bulk_handle, 0, bulk_handle, 0, size);
+    if (ret != HG_SUCCESS) {
+        GKFS_DATA->spdlogger()->error("{}() Failed to push stage stats to caller", __func__);
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+    }
+    out.err = 0;
+    GKFS_DATA->spdlogger()->debug("{}() Sending stage stats, reset: {}", __func__, in.reset == HG_TRUE);
+    return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+}
+
+DEFINE_MARGO_RPC_HANDLER(rpc_srv_get_stage_stats)
@@ -12,16 +12,19 @@
 */
 
 
+#include <daemon/daemon.hpp>
 #include <daemon/handler/rpc_defs.hpp>
 #include <daemon/handler/rpc_util.hpp>
 #include <daemon/backend/metadata/db.hpp>
 #include <daemon/ops/metadentry.hpp>
 
 #include <global/rpc/rpc_types.hpp>
+#include <global/stage_stats.hpp>
 
 using namespace std;
 
 static hg_return_t rpc_srv_create(hg_handle_t handle) {
+    gkfs::util::StageTimer timer(RPC_DATA->stage_stats(), gkfs::util::RpcOp::create);
     rpc_mk_node_in_t in;
     rpc_err_out_t out;
 
@@ -29,8 +32,14 @@ static hg_return_t rpc_srv_create(hg_handle_t handle) {
     if (ret != HG_SUCCESS)
         GKFS_DATA->spdlogger()->error("{}() Failed to retrieve input from handle", __func__);
     assert(ret == HG_SUCCESS);
-    GKFS_DATA->spdlogger()->debug("{}() Got RPC with path '{}'", __func__, in.path);
+    timer.stage(gkfs::util::RpcStage::decode);
+    GKFS_DATA->spdlogger()->debug("{}() Got RPC with path '{}' data host '{}'", __func__, in.path, in.data_host);
     gkfs::metadata::Metadata md(in.mode);
+    md.data_host(in.data_host);
+    md.layout({in.chunk_size, in.stripe_width});
+    // new regular files start in their metadentry
+    md.stored_inline(S_ISREG(in.mode) && GKFS_DATA->inline_data_size() > 0);
+    gkfs::daemon::ClientRpc client_rpc(RPC_DATA->client_rpc_gate());
     try {
         // create metadentry
         gkfs::metadata::create(in.path, md);
@@ -40,10 +49,12 @@ static hg_return_t rpc_srv_create(hg_handle_t handle) {
         out.err = -1;
     }
     GKFS_DATA->spdlogger()->debug("{}() Sending output err '{}'", __func__, out.err);
+    timer.stage(gkfs::util::RpcStage::storage);
     auto hret = margo_respond(handle, &out);
     if (hret != HG_SUCCESS) {
         GKFS_DATA->spdlogger()->error("{}() Failed to respond", __func__);
     }
+    timer.stage(gkfs::util::RpcStage::respond);
 
     // Destroy handle when finished
     margo_free_input(handle, &in);
@@ -54,17 +65,19 @@ static hg_return_t rpc_srv_create(hg_handle_t handle) {
 DEFINE_MARGO_RPC_HANDLER(rpc_srv_create)
 
 static hg_return_t rpc_srv_stat(hg_handle_t handle) {
+    gkfs::util::StageTimer timer(RPC_DATA->stage_stats(), gkfs::util::RpcOp::stat);
     rpc_path_only_in_t in{};
     rpc_stat_out_t out{};
     auto ret = margo_get_input(handle, &in);
     if (ret != HG_SUCCESS)
         GKFS_DATA->spdlogger()->error("{}() Failed to retrieve input from handle", __func__);
     assert(ret == HG_SUCCESS);
+    timer.stage(gkfs::util::RpcStage::decode);
     GKFS_DATA->spdlogger()->debug("{}() path: '{}'", __func__, in.path);
     std::string val;
 
     try {
-        // get the metadata
+        // get the metadata. Inline data after the text part is not sent
         val = gkfs::metadata::get_str(in.path);
         out.db_val = val.c_str();
         out.err = 0;
@@ -77,10 +90,12 @@ static hg_return_t rpc_srv_stat(hg_handle_t handle) {
         out.err = EBUSY;
     }
 
+    timer.stage(gkfs::util::RpcStage::storage);
     auto hret = margo_respond(handle, &out);
     if (hret != HG_SUCCESS) {
         GKFS_DATA->spdlogger()->error("{}() Failed to respond", __func__);
     }
+    timer.stage(gkfs::util::RpcStage::respond);
 
     // Destroy handle when finished
     margo_free_input(handle, &in);
@@ -102,6 +117,7 @@ static hg_return_t rpc_srv_decr_size(hg_handle_t handle) {
 
     GKFS_DATA->spdlogger()->debug("{}() path: '{}', length: {}", __func__, in.path, in.length);
 
+    gkfs::daemon::ClientRpc client_rpc(RPC_DATA->client_rpc_gate());
     try {
         GKFS_DATA->mdb()->decrease_size(in.path, in.length);
         out.err = 0;
@@ -125,6 +141,7 @@ static hg_return_t rpc_srv_decr_size(hg_handle_t handle) {
 DEFINE_MARGO_RPC_HANDLER(rpc_srv_decr_size)
 
 static hg_return_t rpc_srv_remove(hg_handle_t handle) {
+    gkfs::util::StageTimer timer(RPC_DATA->stage_stats(), gkfs::util::RpcOp::remove);
     rpc_rm_node_in_t in{};
     rpc_err_out_t out{};
 
@@ -132,8 +149,10 @@ static hg_return_t rpc_srv_remove(hg_handle_t handle) {
     if (ret != HG_SUCCESS)
         GKFS_DATA->spdlogger()->error("{}() Failed to retrieve input from handle", __func__);
     assert(ret == HG_SUCCESS);
+    timer.stage(gkfs::util::RpcStage::decode);
     GKFS_DATA->spdlogger()->debug("{}() Got remove node RPC with path '{}'", __func__, in.path);
 
+    gkfs::daemon::ClientRpc client_rpc(RPC_DATA->client_rpc_gate());
     try {
         // Remove metadentry if exists on the node
         // and remove all chunks for that file
@@ -154,10 +173,12 @@ static hg_return_t rpc_srv_remove(hg_handle_t handle) {
     }
 
     GKFS_DATA->spdlogger()->debug("{}() Sending output {}", __func__, out.err);
+    timer.stage(gkfs::util::RpcStage::storage);
     auto hret = margo_respond(handle, &out);
     if (hret != HG_SUCCESS) {
         GKFS_DATA->spdlogger()->error("{}() Failed to respond", __func__);
     }
+    timer.stage(gkfs::util::RpcStage::respond);
     // Destroy handle when finished
     margo_free_input(handle, &in);
     margo_destroy(handle);
@@ -178,6 +199,7 @@ static hg_return_t rpc_srv_update_metadentry(hg_handle_t handle) {
     assert(ret == HG_SUCCESS);
     GKFS_DATA->spdlogger()->debug("{}() Got update metadentry RPC with path '{}'", __func__, in.path);
 
+    gkfs::daemon::ClientRpc client_rpc(RPC_DATA->client_rpc_gate());
     // do update
     try {
         gkfs::metadata::Metadata md = gkfs::metadata::get(in.path);
@@ -193,8 +215,20 @@ static hg_return_t rpc_srv_update_metadentry(hg_handle_t handle) {
             md.mtime(in.mtime);
         if (in.ctime_flag == HG_TRUE)
             md.ctime(in.ctime);
+        if (in.layout_flag == HG_TRUE) {
+            gkfs::metadata::Layout layout{in.chunk_size, in.stripe_width};
+            gkfs::metadata::check_layout(layout);
+            // chunks that were already written keep their layout, so only empty files may change theirs
+            if (!S_ISDIR(md.mode()) && !(S_ISREG(md.mode()) && md.size() == 0)) {
+                throw std::invalid_argument("Only directories and empty files can change their layout");
+            }
+            md.layout(layout);
+        }
         gkfs::metadata::update(in.path, md);
         out.err = 0;
+    } catch (const std::invalid_argument& e) {
+        GKFS_DATA->spdlogger()->debug("{}() Rejected layout of '{}': {}", __func__, in.path, e.what());
+        out.err = EINVAL;
     } catch (const std::exception& e) {
         //TODO handle NotFoundException
         GKFS_DATA->spdlogger()->error("{}() Failed to update entry", __func__);
@@ -216,6 +250,7 @@ static hg_return_t rpc_srv_update_metadentry(hg_handle_t handle) {
 DEFINE_MARGO_RPC_HANDLER(rpc_srv_update_metadentry)
 
 static hg_return_t rpc_srv_update_metadentry_size(hg_handle_t handle) {
+    gkfs::util::StageTimer timer(RPC_DATA->stage_stats(), gkfs::util::RpcOp::update_size);
     rpc_update_metadentry_size_in_t in{};
     rpc_update_metadentry_size_out_t out{};
 
@@ -224,15 +259,16 @@ static hg_return_t rpc_srv_update_metadentry_size(hg_handle_t handle) {
     if (ret != HG_SUCCESS)
         GKFS_DATA->spdlogger()->error("{}() Failed to retrieve input from handle", __func__);
     assert(ret == HG_SUCCESS);
+    timer.stage(gkfs::util::RpcStage::decode);
     GKFS_DATA->spdlogger()->debug("{}() path: {}, size: {}, offset: {}, append: {}", __func__, in.path, in.size,
                                   in.offset, in.append);
 
+    gkfs::daemon::ClientRpc client_rpc(RPC_DATA->client_rpc_gate());
     try {
-        gkfs::metadata::update_size(in.path, in.size, in.offset, (in.append == HG_TRUE));
+        auto start = gkfs::metadata::update_size(in.path, in.size, in.offset, (in.append == HG_TRUE));
         out.err = 0;
-        //TODO the actual size of the file could be different after the size update
-        // do to concurrency on size
-        out.ret_size = in.size + in.offset;
+        // end of the written range. For appends, the file may have grown further by concurrent writes meanwhile
+        out.ret_size = start + in.size;
     } catch (const NotFoundException& e) {
         GKFS_DATA->spdlogger()->debug("{}() Entry not found: '{}'", __func__, in.path);
         out.err = ENOENT;
@@ -242,10 +278,12 @@ static hg_return_t rpc_srv_update_metadentry_size(hg_handle_t handle) {
     }
 
     GKFS_DATA->spdlogger()->debug("{}() Sending output {}", __func__, out.err);
+    timer.stage(gkfs::util::RpcStage::storage);
     auto hret = margo_respond(handle, &out);
     if (hret != HG_SUCCESS) {
         GKFS_DATA->spdlogger()->error("{}() Failed to respond", __func__);
     }
+    timer.stage(gkfs::util::RpcStage::respond);
 
     // Destroy handle when finished
     margo_free_input(handle, &in);
@@ -256,6 +294,7 @@ static hg_return_t rpc_srv_update_metadentry_size(hg_handle_t handle) {
 DEFINE_MARGO_RPC_HANDLER(rpc_srv_update_metadentry_size)
 
 static hg_return_t rpc_srv_get_metadentry_size(hg_handle_t handle) {
+    gkfs::util::StageTimer timer(RPC_DATA->stage_stats(), gkfs::util::RpcOp::get_size);
     rpc_path_only_in_t in{};
     rpc_get_metadentry_size_out_t out{};
 
@@ -264,6 +303,7 @@ static hg_return_t rpc_srv_get_metadentry_size(hg_handle_t handle) {
     if (ret != HG_SUCCESS)
         GKFS_DATA->spdlogger()->error("{}() Failed to retrieve input from handle", __func__);
     assert(ret == HG_SUCCESS);
+    timer.stage(gkfs::util::RpcStage::decode);
     GKFS_DATA->spdlogger()->debug("{}() Got update metadentry size RPC with path '{}'", __func__, in.path);
 
     // do update
@@ -279,10 +319,12 @@ static hg_return_t rpc_srv_get_metadentry_size(hg_handle_t handle) {
     }
 
     GKFS_DATA->spdlogger()->debug("{}() Sending output '{}'", __func__, out.err);
+    timer.stage(gkfs::util::RpcStage::storage);
     auto hret = margo_respond(handle, &out);
     if (hret != HG_SUCCESS) {
         GKFS_DATA->spdlogger()->error("{}() Failed to respond", __func__);
     }
+    timer.stage(gkfs::util::RpcStage::respond);
 
     // Destroy handle when finished
     margo_free_input(handle, &in);
@@ -292,7 +334,207 @@ static hg_return_t rpc_srv_get_metadentry_size(hg_handle_t handle) {
 
 DEFINE_MARGO_RPC_HANDLER(rpc_srv_get_metadentry_size)
 
+/**
+ * Writes data into the metadentry of a small file. If the file is not stored inline, out.stored_inline is false. If
+ * the file would grow beyond the inline data size, out.err is EFBIG and the client has to promote it. Inline data a
+ * rebalancing peer migrates to this daemon is served while this daemon rebalances itself
+ * @param handle
+ * @param from_peer
+ * @return
+ */
+static hg_return_t write_inline(hg_handle_t handle, bool from_peer) {
+    rpc_inline_data_in_t in{};
+    rpc_inline_data_out_t out{};
+    hg_bulk_t bulk_handle = nullptr;
+
+    auto ret = margo_get_input(handle, &in);
+    if (ret != HG_SUCCESS) {
+        GKFS_DATA->spdlogger()->error("{}() Failed to retrieve input from handle", __func__);
+        out.err = EIO;
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+    }
+    auto hgi = margo_get_info(handle);
+    auto mid = margo_hg_info_get_instance(hgi);
+    GKFS_DATA->spdlogger()->debug("{}() path: '{}', size: {}, offset: {}, append: {}", __func__, in.path, in.size,
+                                  in.offset, in.append);
+
+    gkfs::daemon::ClientRpc client_rpc(RPC_DATA->client_rpc_gate(), !from_peer);
+    try {
+        bool written = false;
+        if (in.size <= GKFS_DATA->inline_data_size()) {
+            string data(in.size, '\0');
+            if (in.size > 0) {
+                void* buf_ptr = &data[0];
+                hg_size_t size = in.size;
+                ret = margo_bulk_create(mid, 1, &buf_ptr, &size, HG_BULK_WRITE_ONLY, &bulk_handle);
+                if (ret != HG_SUCCESS) {
+                    GKFS_DATA->spdlogger()->error("{}() Failed to create bulk handle", __func__);
+                    out.err = EBUSY;
+                    return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+                }
+                ret = margo_bulk_transfer(mid, HG_BULK_PULL, hgi->addr, in.bulk_handle, 0, bulk_handle, 0, size);
+                if (ret != HG_SUCCESS) {
+                    GKFS_DATA->spdlogger()->error("{}() Failed to pull data from client for path '{}'", __func__,
+                                                  in.path);
+                    out.err = EBUSY;
+                    return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+                }
+            }
+            off64_t write_offset = 0;
+            size_t file_size = 0;
+            written = gkfs::metadata::write_inline(in.path, data, in.offset, in.append == HG_TRUE, write_offset,
+                                                   file_size);
+            if (written) {
+                out.stored_inline = HG_TRUE;
+                out.offset = write_offset;
+                out.io_size = in.size;
+                out.file_size = file_size;
+                out.err = 0;
+            }
+        }
+        if (!written) {
+            out.stored_inline = static_cast<hg_bool_t>(gkfs::metadata::get(in.path).stored_inline());
+            out.err = out.stored_inline ? EFBIG : 0;
+        }
+    } catch (const NotFoundException& e) {
+        GKFS_DATA->spdlogger()->debug("{}() Entry not found: '{}'", __func__, in.path);
+        out.err = ENOENT;
+    } catch (const std::exception& e) {
+        GKFS_DATA->spdlogger()->error("{}() Failed to write inline data: '{}'", __func__, e.what());
+        out.err = EBUSY;
+    }
+
+    GKFS_DATA->spdlogger()->debug("{}() Sending output err '{}' stored inline '{}' io_size '{}'", __func__, out.err,
+                                  out.stored_inline, out.io_size);
+    return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+}
+
+static hg_return_t rpc_srv_write_inline(hg_handle_t handle) {
+    return write_inline(handle, false);
+}
+
+DEFINE_MARGO_RPC_HANDLER(rpc_srv_write_inline)
+
+static hg_return_t rpc_srv_migrate_inline(hg_handle_t handle) {
+    return write_inline(handle, true);
+}
+
+DEFINE_MARGO_RPC_HANDLER(rpc_srv_migrate_inline)
+
+/**
+ * Reads from a small file stored in its metadentry and returns its size with the data, so the client needs no
+ * other RPC. If the file is not stored inline, out.stored_inline is false and nothing is read
+ * @param handle
+ * @return
+ */
+static hg_return_t rpc_srv_read_inline(hg_handle_t handle) {
+    rpc_inline_data_in_t in{};
+    rpc_inline_data_out_t out{};
+    hg_bulk_t bulk_handle = nullptr;
+
+    auto ret = margo_get_input(handle, &in);
+    if (ret != HG_SUCCESS) {
+        GKFS_DATA->spdlogger()->error("{}() Failed to retrieve input from handle", __func__);
+        out.err = EIO;
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+    }
+    auto hgi = margo_get_info(handle);
+    auto mid = margo_hg_info_get_instance(hgi);
+    GKFS_DATA->spdlogger()->debug("{}() path: '{}', size: {}, offset: {}", __func__, in.path, in.size, in.offset);
+
+    try {
+        auto md = gkfs::metadata::get(in.path);
+        out.stored_inline = static_cast<hg_bool_t>(md.stored_inline());
+        out.file_size = md.size();
+        out.offset = in.offset;
+        out.err = 0;
+        if (md.stored_inline() && static_cast<size_t>(in.offset) < md.size()) {
+            auto read_size = min(static_cast<size_t>(in.size), md.size() - in.offset);
+            // the part of the file beyond the inline data is a hole
+            string data(read_size, '\0');
+            const auto& inline_data = md.inline_data();
+            if (static_cast<size_t>(in.offset) < inline_data.size()) {
+                inline_data.copy(&data[0], read_size, in.offset);
+            }
+            void* buf_ptr = &data[0];
+            hg_size_t size = read_size;
+            ret = margo_bulk_create(mid, 1, &buf_ptr, &size, HG_BULK_READ_ONLY, &bulk_handle);
+            if (ret != HG_SUCCESS) {
+                GKFS_DATA->spdlogger()->error("{}() Failed to create bulk handle", __func__);
+                out.err = EBUSY;
+                return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+            }
+            ret = margo_bulk_transfer(mid, HG_BULK_PUSH, hgi->addr, in.bulk_handle, 0, bulk_handle, 0, size);
+            if (ret != HG_SUCCESS) {
+                GKFS_DATA->spdlogger()->error("{}() Failed to push data to client for path '{}'", __func__,
+                                              in.path);
+                out.err = EBUSY;
+                return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+            }
+            out.io_size = read_size;
+        }
+    } catch (const NotFoundException& e) {
+        GKFS_DATA->spdlogger()->debug("{}() Entry not found: '{}'", __func__, in.path);
+        out.err = ENOENT;
+    } catch (const std::exception& e) {
+        GKFS_DATA->spdlogger()->error("{}() Failed to read inline data: '{}'", __func__, e.what());
+        out.err = EBUSY;
+    }
+
+    GKFS_DATA->spdlogger()->debug("{}() Sending output err '{}' stored inline '{}' io_size '{}'", __func__, out.err,
+                                  out.stored_inline, out.io_size);
+    return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+}
+
+DEFINE_MARGO_RPC_HANDLER(rpc_srv_read_inline)
+
+/**
+ * Moves the content of a small file from its metadentry to its chunks and marks the file as stored in chunks. If
+ * the file is not stored inline anymore, out.stored_inline is false
+ * @param handle
+ * @return
+ */
+static hg_return_t rpc_srv_promote_inline(hg_handle_t handle) {
+    rpc_path_only_in_t in{};
+    rpc_inline_data_out_t out{};
+
+    auto ret = margo_get_input(handle, &in);
+    if (ret != HG_SUCCESS) {
+        GKFS_DATA->spdlogger()->error("{}() Failed to retrieve input from handle", __func__);
+        out.err = EIO;
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+    }
+    GKFS_DATA->spdlogger()->debug("{}() path: '{}'", __func__, in.path);
+
+    gkfs::daemon::ClientRpc client_rpc(RPC_DATA->client_rpc_gate());
+    try {
+        size_t io_size = 0;
+        size_t file_size = 0;
+        out.stored_inline = gkfs::metadata::promote_inline(in.path, io_size, file_size) ? HG_TRUE : HG_FALSE;
+        out.io_size = io_size;
+        out.file_size = file_size;
+        out.err = 0;
+    } catch (const NotFoundException& e) {
+        GKFS_DATA->spdlogger()->debug("{}() Entry not found: '{}'", __func__, in.path);
+        out.err = ENOENT;
+    } catch (const std::system_error& e) {
+        GKFS_DATA->spdlogger()->error("{}() Failed to write inline data of '{}' to chunks: '{}'", __func__,
+                                      in.path, e.what());
+        out.err = e.code().value();
+    } catch (const std::exception& e) {
+        GKFS_DATA->spdlogger()->error("{}() Failed to promote inline data: '{}'", __func__, e.what());
+        out.err = EBUSY;
+    }
+
+    GKFS_DATA->spdlogger()->debug("{}() Sending output err '{}' stored inline '{}' io_size '{}'", __func__, out.err,
+                                  out.stored_inline, out.io_size);
+    return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+}
+
+DEFINE_MARGO_RPC_HANDLER(rpc_srv_promote_inline)
+
 static hg_return_t rpc_srv_get_dirents(hg_handle_t handle) {
+    gkfs::util::StageTimer timer(RPC_DATA->stage_stats(), gkfs::util::RpcOp::get_dirents);
     rpc_get_dirents_in_t in{};
     rpc_get_dirents_out_t out{};
     hg_bulk_t bulk_handle = nullptr;
@@ -304,6 +546,7 @@ static hg_return_t rpc_srv_get_dirents(hg_handle_t handle) {
                 "{}() Could not get RPC input data with err {}", __func__, ret);
         return ret;
     }
+    timer.stage(gkfs::util::RpcStage::decode);
 
     // Retrieve size of source buffer
     auto hgi = margo_get_info(handle);
@@ -313,7 +556,9 @@ static hg_return_t rpc_srv_get_dirents(hg_handle_t handle) {
     auto bulk_size = margo_bulk_get_size(in.bulk_handle);
 
     //Get directory entries from local DB
+    timer.mark();
     std::vector<std::pair<std::string, bool>> entries = gkfs::metadata::get_dirents(in.path);
+    timer.stage(gkfs::util::RpcStage::storage);
 
     out.dirents_size = entries.size();
 
@@ -360,10 +605,12 @@ static hg_return_t rpc_srv_get_dirents(hg_handle_t handle) {
         return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
     }
 
+    timer.mark();
     ret = margo_bulk_transfer(mid, HG_BULK_PUSH, hgi->addr,
                               in.bulk_handle, 0,
                               bulk_handle, 0,
                               out_size);
+    timer.stage(gkfs::util::RpcStage::transfer);
     if (ret != HG_SUCCESS) {
         GKFS_DATA->spdlogger()->error(
                 "{}() Failed push dirents on path {} to client",
@@ -376,11 +623,44 @@ static hg_return_t rpc_srv_get_dirents(hg_handle_t handle) {
     out.err = 0;
     GKFS_DATA->spdlogger()->debug(
             "{}() Sending output response", __func__);
-    return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+    ret = gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+    timer.stage(gkfs::util::RpcStage::respond);
+    return ret;
 }
 
 DEFINE_MARGO_RPC_HANDLER(rpc_srv_get_dirents)
 
+/**
+ * Receives a metadentry from another daemon during rebalancing and stores it as is
+ * @param handle
+ * @return
+ */
+static hg_return_t rpc_srv_migrate_metadentry(hg_handle_t handle) {
+    rpc_migrate_metadentry_in_t in{};
+    rpc_err_out_t out{};
+
+    auto ret = margo_get_input(handle, &in);
+    if (ret != HG_SUCCESS) {
+        GKFS_DATA->spdlogger()->error("{}() Failed to retrieve input from handle", __func__);
+        out.err = EIO;
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+    }
+    GKFS_DATA->spdlogger()->debug("{}() Got RPC with path '{}'", __func__, in.path);
+
+    try {
+        gkfs::metadata::Metadata md(in.db_val);
+        gkfs::metadata::update(in.path, md);
+        out.err = 0;
+    } catch (const std::exception& e) {
+        GKFS_DATA->spdlogger()->error("{}() Failed to store migrated metadentry: '{}'", __func__, e.what());
+        out.err = EIO;
+    }
+    GKFS_DATA->spdlogger()->debug("{}() Sending output err '{}'", __func__, out.err);
+    return gkfs::rpc::cleanup_respond(&handle, &in, &out, static_cast<hg_bulk_t*>(nullptr));
+}
+
+DEFINE_MARGO_RPC_HANDLER(rpc_srv_migrate_metadentry)
+
 #ifdef HAS_SYMLINKS
 
 static hg_return_t rpc_srv_mk_symlink(hg_handle_t handle) {
@@ -393,6 +673,7 @@ static hg_return_t rpc_srv_mk_symlink(hg_handle_t handle) {
     }
     GKFS_DATA->spdlogger()->debug("{}() Got RPC with path '{}'", __func__, in.path);
 
+    gkfs::daemon::ClientRpc client_rpc(RPC_DATA->client_rpc_gate());
     try {
         gkfs::metadata::Metadata md = {gkfs::metadata::LINK_MODE, in.target_path};
         // create metadentry
@@ -14,10 +14,59 @@
 
 #include <daemon/ops/metadentry.hpp>
 #include <daemon/backend/metadata/db.hpp>
-#include <daemon/backend/data/chunk_storage.hpp>
+#include <daemon/backend/data/chunk_reclaimer.hpp>
+#include <daemon/ops/peers.hpp>
+
+#include <array>
+#include <functional>
+#include <stdexcept>
 
 using namespace std;
 
+namespace {
+
+/**
+ * Serializes the decision whether data still fits into a metadentry with promotions out of it, and appends, per
+ * file. Files share one of inline_lock_count mutexes by the hash of their path, so that appends to different files
+ * and a promotion waiting for its chunk writes rarely hold up each other. Argobots mutexes, as a promotion waits for
+ * chunk writes on other daemons and must let other ULTs run meanwhile
+ */
+class InlineLock {
+private:
+    static constexpr size_t inline_lock_count = 64;
+
+    ABT_mutex mutex_;
+
+    static ABT_mutex mutex(const string& path) {
+        // created on first use, Argobots is initialized by then
+        static const array<ABT_mutex, inline_lock_count> mutexes = []() {
+            array<ABT_mutex, inline_lock_count> m{};
+            for (auto& mutex : m) {
+                if (ABT_mutex_create(&mutex) != ABT_SUCCESS) {
+                    throw runtime_error("Failed to create inline data mutex");
+                }
+            }
+            return m;
+        }();
+        return mutexes[hash<string>()(path) % inline_lock_count];
+    }
+
+public:
+    explicit InlineLock(const string& path) : mutex_(mutex(path)) {
+        ABT_mutex_lock(mutex_);
+    }
+
+    ~InlineLock() {
+        ABT_mutex_unlock(mutex_);
+    }
+
+    InlineLock(const InlineLock&) = delete;
+
+    InlineLock& operator=(const InlineLock&) = delete;
+};
+
+} // namespace
+
 namespace gkfs {
 namespace metadata {
 
@@ -91,23 +140,88 @@ void update(const string& path, Metadata& md) {
 }
 
 /**
- * Updates a metadentry's size atomically and returns the corresponding size after update
+ * Updates a metadentry's size atomically after a write. An append reserves the next io_size bytes at the end of the
+ * file: appends are serialized from reading the size to merging its increment, so concurrent appenders get disjoint
+ * ranges. They take the same mutex as inline writes to the file, which also append at the current size
  * @param path
  * @param io_size
- * @return the updated size
+ * @param offset ignored for appends
+ * @param append
+ * @return the offset the write starts at
+ */
+off64_t update_size(const string& path, size_t io_size, off64_t offset, bool append) {
+    if (!append) {
+        GKFS_DATA->mdb()->increase_size(path, io_size + offset, false);
+        return offset;
+    }
+    InlineLock lock(path);
+    auto start = static_cast<off64_t>(get(path).size());
+    GKFS_DATA->mdb()->increase_size(path, io_size, true);
+    return start;
+}
+
+/**
+ * Writes data into the metadentry of a file stored inline. Nothing is written if the file is not stored inline
+ * or if it would grow beyond the inline data size. Size updates of other requests only shrink the file, so the
+ * decision stays valid until the merge is applied
+ * @param path
+ * @param data
+ * @param offset ignored for appends
+ * @param append
+ * @param write_offset (return val) offset the data was written at
+ * @param file_size (return val) file size after the write
+ * @return true if the data was written
+ */
+bool write_inline(const string& path, const string& data, off64_t offset, bool append, off64_t& write_offset,
+                  size_t& file_size) {
+    InlineLock lock(path);
+    auto md = get(path);
+    if (!md.stored_inline()) {
+        return false;
+    }
+    write_offset = append ? static_cast<off64_t>(md.size()) : offset;
+    auto end = static_cast<size_t>(write_offset) + data.size();
+    if (end > GKFS_DATA->inline_data_size()) {
+        return false;
+    }
+    GKFS_DATA->mdb()->write_inline(path, write_offset, data);
+    file_size = max(end, md.size());
+    return true;
+}
+
+/**
+ * Moves the content of a file stored inline to its chunks and then marks it as stored in chunks. Both happen under
+ * the inline lock, so no write to the metadentry is lost in between, and a file marked as stored in chunks always
+ * has its content there. The file size is kept
+ * @param path
+ * @param io_size (return val) bytes written to chunks
+ * @param file_size (return val)
+ * @return false if the file is not stored inline
  */
-void update_size(const string& path, size_t io_size, off64_t offset, bool append) {
-    GKFS_DATA->mdb()->increase_size(path, io_size + offset, append);
+bool promote_inline(const string& path, size_t& io_size, size_t& file_size) {
+    InlineLock lock(path);
+    auto md = get(path);
+    file_size = md.size();
+    if (!md.stored_inline()) {
+        return false;
+    }
+    const auto& data = md.inline_data();
+    if (!data.empty()) {
+        gkfs::daemon::write_file_chunks(path, md, data);
+    }
+    GKFS_DATA->mdb()->promote_inline(path);
+    io_size = data.size();
+    return true;
 }
 
 /**
- * Remove metadentry if exists and try to remove all chunks for path
+ * Remove metadentry if exists and queue all chunks for path on this node for deletion in the background
  * @param path
  * @return
  */
 void remove_node(const string& path) {
     GKFS_DATA->mdb()->remove(path); // remove metadentry
-    GKFS_DATA->storage()->destroy_chunk_space(path); // destroys all chunks for the path on this node
+    GKFS_DATA->reclaimer()->reclaim(path);
 }
 
 } // namespace metadata
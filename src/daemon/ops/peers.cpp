@@ -0,0 +1,197 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <daemon/ops/peers.hpp>
+#include <daemon/backend/data/chunk_storage.hpp>
+
+#include <global/rpc/rpc_types.hpp>
+#include <global/rpc/distributor.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+using namespace std;
+
+namespace gkfs {
+namespace daemon {
+
+vector<pair<string, string>> read_hosts_file(const string& hosts_file) {
+    ifstream lf(hosts_file);
+    if (!lf) {
+        throw runtime_error(fmt::format("Failed to open hosts file '{}': {}", hosts_file, strerror(errno)));
+    }
+    vector<pair<string, string>> hosts;
+    string line;
+    while (getline(lf, line)) {
+        istringstream iss(line);
+        string host;
+        string uri;
+        if (!(iss >> host >> uri)) {
+            throw runtime_error(fmt::format("Unrecognized line format in hosts file: '{}'", line));
+        }
+        hosts.emplace_back(host, uri);
+    }
+    return hosts;
+}
+
+unsigned int self_host_id(const vector<pair<string, string>>& hosts) {
+    for (unsigned int i = 0; i < hosts.size(); i++) {
+        if (hosts[i].second == RPC_DATA->self_addr_str()) {
+            return i;
+        }
+    }
+    return hosts.size();
+}
+
+hg_id_t registered_id(margo_instance_id mid, const char* name) {
+    hg_id_t id;
+    hg_bool_t flag;
+    auto ret = margo_registered_name(mid, name, &id, &flag);
+    if (ret != HG_SUCCESS || flag == HG_FALSE) {
+        throw runtime_error(fmt::format("RPC '{}' is not registered", name));
+    }
+    return id;
+}
+
+void push_chunk(margo_instance_id mid, hg_addr_t addr, const char* rpc_name, const string& path,
+                unsigned int chunk_id, unsigned int owner, unsigned int hosts_size, char* buf, hg_size_t size) {
+    hg_bulk_t bulk_handle = nullptr;
+    void* buf_ptr = buf;
+    auto ret = margo_bulk_create(mid, 1, &buf_ptr, &size, HG_BULK_READ_ONLY, &bulk_handle);
+    if (ret != HG_SUCCESS) {
+        throw runtime_error("Failed to create bulk handle");
+    }
+    rpc_write_data_in_t in{};
+    rpc_data_out_t out{};
+    in.path = path.c_str();
+    in.offset = 0;
+    in.host_id = owner;
+    in.host_size = hosts_size;
+    // the whole chunk is written at offset 0, any chunk size that holds it will do
+    in.chunk_size = gkfs::config::rpc::max_chunksize;
+    in.stripe_width = 0;
+    in.chunk_n = 1;
+    in.chunk_start = chunk_id;
+    in.chunk_end = chunk_id;
+    in.total_chunk_size = size;
+    in.bulk_handle = bulk_handle;
+    hg_handle_t handle;
+    try {
+        handle = forward_to_peer(mid, addr, registered_id(mid, rpc_name), &in, &out);
+    } catch (const exception& e) {
+        margo_bulk_free(bulk_handle);
+        throw;
+    }
+    auto err = out.err;
+    auto io_size = out.io_size;
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+    margo_bulk_free(bulk_handle);
+    if (err != 0) {
+        throw system_error(err, system_category(), "Peer failed to write chunk");
+    }
+    if (io_size != size) {
+        throw runtime_error(fmt::format("Peer wrote {} of {} bytes", io_size, size));
+    }
+}
+
+void write_file_chunks(const string& path, const gkfs::metadata::Metadata& md, const string& data) {
+    auto chunk_size = gkfs::metadata::chunk_size(md.layout());
+    auto chunk_n = (data.size() + chunk_size - 1) / chunk_size;
+    // the buffer is handed to bulk transfers, which need it writable
+    vector<char> buf(data.begin(), data.end());
+
+    auto write_local = [&](unsigned int chunk_id, char* chunk, size_t size) {
+        ABT_eventual eventual;
+        ABT_eventual_create(sizeof(ssize_t), &eventual);
+        try {
+            GKFS_DATA->storage()->write_chunk(path, chunk_id, chunk, size, 0, chunk_size, eventual);
+        } catch (const exception& e) {
+            ABT_eventual_free(&eventual);
+            throw;
+        }
+        ssize_t* wrote = nullptr;
+        ABT_eventual_wait(eventual, (void**) &wrote);
+        auto ok = wrote != nullptr && *wrote == static_cast<ssize_t>(size);
+        ABT_eventual_free(&eventual);
+        if (!ok) {
+            throw runtime_error(fmt::format("Short write of chunk {} of '{}'", chunk_id, path));
+        }
+    };
+
+#ifdef GKFS_ENABLE_FORWARDING
+    // the data backend is shared between all daemons
+    for (unsigned int chunk_id = 0; chunk_id < chunk_n; chunk_id++) {
+        auto offset = chunk_id * chunk_size;
+        write_local(chunk_id, buf.data() + offset, min(chunk_size, buf.size() - offset));
+    }
+#else
+    auto hosts = read_hosts_file(GKFS_DATA->hosts_file());
+    if (hosts.empty()) {
+        throw runtime_error("Hosts file is empty");
+    }
+    unsigned int hosts_size = hosts.size();
+    auto self_id = self_host_id(hosts);
+    auto distributor = gkfs::rpc::make_hash_distributor(GKFS_DATA->distributor_type(), self_id, hosts_size);
+    auto mid = RPC_DATA->server_rpc_mid();
+    vector<hg_addr_t> addrs(hosts_size, HG_ADDR_NULL);
+    auto free_addrs = [&]() {
+        for (auto& addr : addrs) {
+            if (addr != HG_ADDR_NULL)
+                margo_addr_free(mid, addr);
+        }
+    };
+    try {
+        for (unsigned int chunk_id = 0; chunk_id < chunk_n; chunk_id++) {
+            // placed as clients place them, see locate_chunk() of the client
+            gkfs::rpc::host_t owner;
+            if (md.data_host() != gkfs::metadata::NO_DATA_HOST) {
+                owner = static_cast<gkfs::rpc::host_t>(md.data_host());
+            } else if (gkfs::rpc::is_striped(md.layout().stripe_width, hosts_size)) {
+                owner = gkfs::rpc::locate_striped_data(path, chunk_id, md.layout().stripe_width, hosts_size);
+            } else {
+                owner = distributor->locate_data(path, chunk_id);
+            }
+            if (owner >= hosts_size) {
+                throw runtime_error(fmt::format("Chunk {} of '{}' belongs to unknown host {}", chunk_id, path,
+                                                owner));
+            }
+            auto offset = chunk_id * chunk_size;
+            auto size = min(chunk_size, buf.size() - offset);
+            if (owner == self_id) {
+                write_local(chunk_id, buf.data() + offset, size);
+                continue;
+            }
+            if (addrs[owner] == HG_ADDR_NULL) {
+                auto ret = margo_addr_lookup(mid, hosts[owner].second.c_str(), &addrs[owner]);
+                if (ret != HG_SUCCESS) {
+                    throw runtime_error(fmt::format("Failed to lookup address '{}'", hosts[owner].second));
+                }
+            }
+            // the peer variant of the write RPC, which a rebalancing owner does not hold back. This daemon
+            // waits for the promotion before it rebalances itself
+            push_chunk(mid, addrs[owner], gkfs::rpc::tag::migrate_chunk, path, chunk_id, owner, hosts_size,
+                       buf.data() + offset, size);
+        }
+    } catch (const exception& e) {
+        free_addrs();
+        throw;
+    }
+    free_addrs();
+#endif
+}
+
+} // namespace daemon
+} // namespace gkfs
@@ -0,0 +1,262 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <daemon/ops/rebalance.hpp>
+#include <daemon/ops/peers.hpp>
+#include <daemon/daemon.hpp>
+#include <daemon/backend/metadata/db.hpp>
+#include <daemon/backend/data/chunk_storage.hpp>
+
+#include <global/rpc/rpc_types.hpp>
+#include <global/rpc/distributor.hpp>
+#include <global/metadata.hpp>
+
+#include <chrono>
+
+using namespace std;
+
+namespace {
+
+using gkfs::daemon::forward_to_peer;
+using gkfs::daemon::registered_id;
+
+void migrate_metadentry(margo_instance_id mid, hg_addr_t addr, const string& path, const string& val) {
+    rpc_migrate_metadentry_in_t in{};
+    rpc_err_out_t out{};
+    in.path = path.c_str();
+    in.db_val = val.c_str();
+    auto handle = forward_to_peer(mid, addr, registered_id(mid, gkfs::rpc::tag::migrate_metadentry), &in, &out);
+    auto err = out.err;
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+    if (err != 0) {
+        throw system_error(err, system_category(), "Peer failed to store metadentry");
+    }
+}
+
+/**
+ * Sends the inline data of a migrated metadentry, which is not part of the migrate_metadentry RPC, with the
+ * migration variant of the inline write RPC
+ */
+void migrate_inline_data(margo_instance_id mid, hg_addr_t addr, const string& path, const string& data) {
+    hg_bulk_t bulk_handle = nullptr;
+    void* buf_ptr = const_cast<char*>(data.data());
+    hg_size_t size = data.size();
+    auto ret = margo_bulk_create(mid, 1, &buf_ptr, &size, HG_BULK_READ_ONLY, &bulk_handle);
+    if (ret != HG_SUCCESS) {
+        throw runtime_error("Failed to create bulk handle");
+    }
+    rpc_inline_data_in_t in{};
+    rpc_inline_data_out_t out{};
+    in.path = path.c_str();
+    in.offset = 0;
+    in.size = size;
+    in.append = HG_FALSE;
+    in.bulk_handle = bulk_handle;
+    hg_handle_t handle;
+    try {
+        handle = forward_to_peer(mid, addr, registered_id(mid, gkfs::rpc::tag::migrate_inline), &in, &out);
+    } catch (const exception& e) {
+        margo_bulk_free(bulk_handle);
+        throw;
+    }
+    auto err = out.err;
+    auto stored_inline = out.stored_inline;
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+    margo_bulk_free(bulk_handle);
+    if (err != 0) {
+        throw system_error(err, system_category(), "Peer failed to store inline data");
+    }
+    if (!stored_inline) {
+        throw runtime_error("Peer did not store the file inline");
+    }
+}
+
+/**
+ * Fetches the layout of a file from a daemon
+ * @return false if the daemon does not hold the file's metadentry
+ */
+bool fetch_layout(margo_instance_id mid, hg_addr_t addr, const string& path, gkfs::metadata::Layout& layout) {
+    rpc_path_only_in_t in{};
+    rpc_stat_out_t out{};
+    in.path = path.c_str();
+    auto handle = forward_to_peer(mid, addr, registered_id(mid, gkfs::rpc::tag::stat), &in, &out);
+    auto err = out.err;
+    if (err == 0) {
+        layout = gkfs::metadata::Metadata(out.db_val).layout();
+    }
+    margo_free_output(handle, &out);
+    margo_destroy(handle);
+    if (err != 0 && err != ENOENT) {
+        throw system_error(err, system_category(), "Peer failed to stat metadentry");
+    }
+    return err == 0;
+}
+
+/**
+ * Holds back client RPCs that access data or modify metadata while the daemon rebalances and waits for those in
+ * flight, so that no metadentry or chunk changes while it is moved. Data migrated by peers is still accepted
+ */
+class Quiesce {
+public:
+    Quiesce() {
+        RPC_DATA->client_rpc_gate().close();
+    }
+
+    ~Quiesce() {
+        RPC_DATA->client_rpc_gate().open();
+    }
+
+    Quiesce(const Quiesce&) = delete;
+
+    Quiesce& operator=(const Quiesce&) = delete;
+};
+
+} // namespace
+
+namespace gkfs {
+namespace daemon {
+
+/**
+ * Moves every metadentry and chunk that no longer belongs to this daemon to its owner under the current
+ * hosts file. A daemon that is not listed in the hosts file anymore hands off all its data.
+ * Must be called from an Argobots ULT (e.g., the primary ULT) as it blocks on margo_forward().
+ */
+void rebalance() {
+    auto start_t = chrono::steady_clock::now();
+    auto hosts = read_hosts_file(GKFS_DATA->hosts_file());
+    if (hosts.empty()) {
+        throw runtime_error("Hosts file is empty");
+    }
+    unsigned int hosts_size = hosts.size();
+    // a daemon that has been removed from the hosts file gets an id that never owns anything
+    gkfs::rpc::host_t self_id = self_host_id(hosts);
+    GKFS_DATA->spdlogger()->info("{}() Rebalancing with {} hosts. Local host id: {}, distributor: '{}'", __func__,
+                                 hosts_size, self_id, gkfs::rpc::to_string(GKFS_DATA->distributor_type()));
+
+    auto distributor = gkfs::rpc::make_hash_distributor(GKFS_DATA->distributor_type(), self_id, hosts_size);
+    auto mid = RPC_DATA->server_rpc_mid();
+    Quiesce quiesce;
+    vector<hg_addr_t> addrs(hosts_size, HG_ADDR_NULL);
+    auto addr_of = [&](gkfs::rpc::host_t host) {
+        if (addrs[host] == HG_ADDR_NULL) {
+            auto ret = margo_addr_lookup(mid, hosts[host].second.c_str(), &addrs[host]);
+            if (ret != HG_SUCCESS) {
+                throw runtime_error(fmt::format("Failed to lookup address '{}'", hosts[host].second));
+            }
+        }
+        return addrs[host];
+    };
+
+    size_t moved_mds = 0;
+    size_t moved_chunks = 0;
+    size_t skipped_chunks = 0;
+    try {
+        // 1. metadentries. The root entry exists on every daemon
+        GKFS_DATA->mdb()->iterate_all([&](const string& path, const string& val) {
+            if (path == "/")
+                return;
+            auto owner = distributor->locate_file_metadata(path);
+            if (owner == self_id)
+                return;
+            migrate_metadentry(mid, addr_of(owner), path, val);
+            gkfs::metadata::Metadata md(val);
+            if (!md.inline_data().empty()) {
+                migrate_inline_data(mid, addr_of(owner), path, md.inline_data());
+            }
+            GKFS_DATA->mdb()->remove(path);
+            moved_mds++;
+        });
+
+#ifndef GKFS_ENABLE_FORWARDING
+        // 2. chunks. In forwarding mode the data backend is shared between all daemons and nothing has to move
+        // Locality files keep their chunks on the data host recorded in their metadata, so chunks stay put
+        if (GKFS_DATA->distributor_type() == gkfs::rpc::DistributorType::locality) {
+            GKFS_DATA->spdlogger()->info("{}() Locality distributor in use. Chunks are not moved", __func__);
+        } else {
+            auto buf = make_unique<char[]>(gkfs::config::rpc::max_chunksize);
+            // the layout of the file of the previous chunk. Chunks are listed file by file
+            string layout_path;
+            gkfs::metadata::Layout layout{};
+            bool has_layout = false;
+            for (const auto& chunk : GKFS_DATA->storage()->chunk_list()) {
+                const auto& path = chunk.first;
+                auto chunk_id = chunk.second;
+                if (path != layout_path) {
+                    // the metadentries have been moved to their owners under the new hosts file by now, unless
+                    // their daemon is still rebalancing and holds them itself. A metadentry is copied before it
+                    // is removed, so one of the daemons always has it
+                    auto md_owner = distributor->locate_file_metadata(path);
+                    has_layout = fetch_layout(mid, addr_of(md_owner), path, layout);
+                    for (gkfs::rpc::host_t host = 0; !has_layout && host < hosts_size; host++) {
+                        if (host != md_owner) {
+                            has_layout = fetch_layout(mid, addr_of(host), path, layout);
+                        }
+                    }
+                    if (!has_layout) {
+                        // e.g., chunks of a file named with ':' written before chunk directories escaped it,
+                        // whose path cannot be recovered. Moving them under a wrong path would lose them
+                        GKFS_DATA->spdlogger()->warn("{}() No metadentry of '{}'. Its chunks are not moved",
+                                                     __func__, path);
+                    }
+                    layout_path = path;
+                }
+                if (!has_layout) {
+                    skipped_chunks++;
+                    continue;
+                }
+                auto owner = gkfs::rpc::is_striped(layout.stripe_width, hosts_size) ?
+                             gkfs::rpc::locate_striped_data(path, chunk_id, layout.stripe_width, hosts_size) :
+                             distributor->locate_data(path, chunk_id);
+                if (owner == self_id)
+                    continue;
+                ABT_eventual eventual;
+                ABT_eventual_create(sizeof(ssize_t), &eventual);
+                ssize_t* read_size = nullptr;
+                // reads up to the end of the chunk file, whatever the chunk size of the file is
+                GKFS_DATA->storage()->read_chunk(path, chunk_id, buf.get(), gkfs::config::rpc::max_chunksize, 0,
+                                                 eventual);
+                ABT_eventual_wait(eventual, (void**) &read_size);
+                auto size = static_cast<hg_size_t>(*read_size);
+                ABT_eventual_free(&eventual);
+                if (size > 0) {
+                    // the migration variant of the write RPC, which the owner serves even while it rebalances
+                    push_chunk(mid, addr_of(owner), gkfs::rpc::tag::migrate_chunk, path, chunk_id, owner,
+                               hosts_size, buf.get(), size);
+                }
+                GKFS_DATA->storage()->delete_chunk(path, chunk_id);
+                moved_chunks++;
+            }
+        }
+#endif
+    } catch (const exception& e) {
+        GKFS_DATA->spdlogger()->error("{}() Rebalancing aborted after moving {} metadentries and {} chunks: {}",
+                                      __func__, moved_mds, moved_chunks, e.what());
+        for (auto& addr : addrs) {
+            if (addr != HG_ADDR_NULL)
+                margo_addr_free(mid, addr);
+        }
+        throw;
+    }
+    for (auto& addr : addrs) {
+        if (addr != HG_ADDR_NULL)
+            margo_addr_free(mid, addr);
+    }
+    auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start_t).count();
+    GKFS_DATA->spdlogger()->info("{}() Moved {} metadentries and {} chunks in {} ms. Kept {} chunks of unknown "
+                                 "files", __func__, moved_mds, moved_chunks, elapsed, skipped_chunks);
+}
+
+} // namespace daemon
+} // namespace gkfs
@@ -0,0 +1,96 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <global/histogram.hpp>
+
+#include <cmath>
+
+using namespace std;
+
+namespace gkfs {
+namespace util {
+
+constexpr unsigned int LatencyHistogram::bucket_count;
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+unsigned int LatencyHistogram::bucket_of(uint64_t usec) {
+    if (usec == 0) {
+        return 0;
+    }
+    // number of significant bits
+    auto bucket = static_cast<unsigned int>(64 - __builtin_clzll(usec));
+    return bucket < bucket_count ? bucket : bucket_count - 1;
+}
+
+uint64_t LatencyHistogram::bucket_upper_bound(unsigned int bucket) {
+    return static_cast<uint64_t>(1) << bucket;
+}
+
+void LatencyHistogram::record(uint64_t usec) {
+    buckets_[bucket_of(usec)].fetch_add(1, memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const {
+    uint64_t total = 0;
+    for (const auto& b : buckets_) {
+        total += b.load(memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t LatencyHistogram::quantile(double q) const {
+    return quantile(snapshot(), q);
+}
+
+uint64_t LatencyHistogram::quantile(const array<uint64_t, bucket_count>& counts, double q) {
+    uint64_t total = 0;
+    for (auto c : counts) {
+        total += c;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    // rank of the sample at the quantile, at least the first one
+    auto rank = static_cast<uint64_t>(ceil(q * static_cast<double>(total)));
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (unsigned int i = 0; i < bucket_count; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return bucket_upper_bound(i);
+        }
+    }
+    return bucket_upper_bound(bucket_count - 1);
+}
+
+array<uint64_t, LatencyHistogram::bucket_count> LatencyHistogram::snapshot() const {
+    array<uint64_t, bucket_count> counts{};
+    for (unsigned int i = 0; i < bucket_count; i++) {
+        counts[i] = buckets_[i].load(memory_order_relaxed);
+    }
+    return counts;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& b : buckets_) {
+        b.store(0, memory_order_relaxed);
+    }
+}
+
+} // namespace util
+} // namespace gkfs
@@ -21,14 +21,87 @@ extern "C" {
 #include <unistd.h>
 }
 
+#include <cctype>
 #include <ctime>
 #include <cassert>
+#include <sstream>
+#include <stdexcept>
 
 namespace gkfs {
 namespace metadata {
 
 static const char MSP = '|'; // metadata separator
 
+size_t chunk_size(const Layout& layout) {
+    return layout.chunk_size != 0 ? layout.chunk_size : gkfs::config::rpc::chunksize;
+}
+
+void check_layout(const Layout& layout) {
+    auto size = layout.chunk_size;
+    if (size != 0 && (size < gkfs::config::rpc::min_chunksize || size > gkfs::config::rpc::max_chunksize ||
+                      (size & (size - 1)) != 0)) {
+        throw std::invalid_argument(fmt::format("Chunk size {} is not a power of two between {} and {}", size,
+                                                gkfs::config::rpc::min_chunksize, gkfs::config::rpc::max_chunksize));
+    }
+}
+
+Layout layout_from_string(const std::string& value) {
+    Layout layout{};
+    std::istringstream iss(value);
+    std::string field;
+    while (std::getline(iss, field, ',')) {
+        auto eq = field.find('=');
+        if (eq == std::string::npos) {
+            throw std::invalid_argument("Layout field '" + field + "' is not of the form key=value");
+        }
+        auto key = field.substr(0, eq);
+        auto val = field.substr(eq + 1);
+        size_t read = 0;
+        unsigned long long number;
+        try {
+            number = std::stoull(val, &read);
+        } catch (const std::logic_error&) {
+            throw std::invalid_argument("Layout field '" + field + "' has no numeric value");
+        }
+        // sizes may have a binary unit suffix
+        if (read < val.size() && read + 1 == val.size()) {
+            switch (val[read]) {
+                case 'K':
+                case 'k':
+                    number <<= 10;
+                    break;
+                case 'M':
+                case 'm':
+                    number <<= 20;
+                    break;
+                case 'G':
+                case 'g':
+                    number <<= 30;
+                    break;
+                default:
+                    throw std::invalid_argument("Unknown unit in layout field '" + field + "'");
+            }
+            read++;
+        }
+        if (read != val.size()) {
+            throw std::invalid_argument("Layout field '" + field + "' has trailing characters");
+        }
+        if (key == "chunk_size") {
+            layout.chunk_size = number;
+        } else if (key == "stripe_width") {
+            layout.stripe_width = static_cast<unsigned int>(number);
+        } else {
+            throw std::invalid_argument("Unknown layout field '" + key + "'. Valid fields: chunk_size, stripe_width");
+        }
+    }
+    check_layout(layout);
+    return layout;
+}
+
+std::string to_string(const Layout& layout) {
+    return fmt::format("chunk_size={},stripe_width={}", chunk_size(layout), layout.stripe_width);
+}
+
 Metadata::Metadata(const mode_t mode) :
         atime_(),
         mtime_(),
@@ -36,7 +109,9 @@ Metadata::Metadata(const mode_t mode) :
         mode_(mode),
         link_count_(0),
         size_(0),
-        blocks_(0) {
+        blocks_(0),
+        data_host_(NO_DATA_HOST),
+        stored_inline_(false) {
     assert(S_ISDIR(mode_) || S_ISREG(mode_));
 }
 
@@ -50,6 +125,8 @@ Metadata::Metadata(const mode_t mode, const std::string& target_path) :
         link_count_(0),
         size_(0),
         blocks_(0),
+        data_host_(NO_DATA_HOST),
+        stored_inline_(false),
         target_path_(target_path) {
     assert(S_ISLNK(mode_) || S_ISDIR(mode_) || S_ISREG(mode_));
     // target_path should be there only if this is a link
@@ -108,6 +185,37 @@ Metadata::Metadata(const std::string& binary_str) {
         assert(read > 0);
         ptr += read;
     }
+    /*
+     * Fields added after the first release are optional, so that entries written before them are still read. They
+     * are numbers, whereas a symlink target, the only field behind them, is absolute or empty
+     */
+    auto has_number = [&ptr]() {
+        return *ptr == MSP && (std::isdigit(static_cast<unsigned char>(ptr[1])) || ptr[1] == '-');
+    };
+    data_host_ = NO_DATA_HOST;
+    stored_inline_ = false;
+    if (has_number()) {
+        data_host_ = std::stoi(++ptr, &read);
+        assert(read > 0);
+        ptr += read;
+    }
+    if (has_number()) {
+        ++ptr;
+        assert(*ptr == '0' || *ptr == '1');
+        stored_inline_ = *ptr == '1';
+        ++ptr;
+    }
+
+    // layout, the default one if the entry has none
+    if (has_number()) {
+        layout_.chunk_size = std::stoul(++ptr, &read);
+        assert(read > 0);
+        ptr += read;
+        assert(*ptr == MSP);
+        layout_.stripe_width = static_cast<unsigned int>(std::stoul(++ptr, &read));
+        assert(read > 0);
+        ptr += read;
+    }
 
 #ifdef HAS_SYMLINKS
     // Read target_path
@@ -118,8 +226,15 @@ Metadata::Metadata(const std::string& binary_str) {
     ptr += target_path_.size();
 #endif
 
-    // we consumed all the binary string
+    // we consumed all the text part of the binary string
     assert(*ptr == '\0');
+
+    // inline data follows the terminating null character
+    auto consumed = static_cast<size_t>(ptr - binary_str.data());
+    if (consumed < binary_str.size()) {
+        assert(stored_inline_);
+        inline_data_ = binary_str.substr(consumed + 1);
+    }
 }
 
 std::string Metadata::serialize() const {
@@ -148,12 +263,27 @@ std::string Metadata::serialize() const {
         s += MSP;
         s += fmt::format_int(blocks_).c_str();
     }
+    s += MSP;
+    s += fmt::format_int(data_host_).c_str(); // add data host, optional when parsed
+    s += MSP;
+    s += stored_inline_ ? '1' : '0'; // add inline flag, optional when parsed
+    s += MSP;
+    s += fmt::format_int(layout_.chunk_size).c_str(); // add layout, optional when parsed
+    s += MSP;
+    s += fmt::format_int(layout_.stripe_width).c_str();
 
 #ifdef HAS_SYMLINKS
     s += MSP;
     s += target_path_;
 #endif
 
+    // Inline data is binary and is appended after a null character. Receivers of the value as a C string,
+    // e.g., stat RPCs, only get the text part
+    if (!inline_data_.empty()) {
+        s += '\0';
+        s += inline_data_;
+    }
+
     return s;
 }
 
@@ -234,6 +364,43 @@ void Metadata::blocks(blkcnt_t blocks) {
     Metadata::blocks_ = blocks;
 }
 
+int Metadata::data_host() const {
+    return data_host_;
+}
+
+void Metadata::data_host(int data_host) {
+    Metadata::data_host_ = data_host;
+}
+
+bool Metadata::stored_inline() const {
+    return stored_inline_;
+}
+
+void Metadata::stored_inline(bool stored_inline) {
+    assert(!stored_inline || S_ISREG(mode_));
+    Metadata::stored_inline_ = stored_inline;
+    if (!stored_inline) {
+        inline_data_.clear();
+    }
+}
+
+const std::string& Metadata::inline_data() const {
+    return inline_data_;
+}
+
+void Metadata::inline_data(const std::string& inline_data) {
+    assert(stored_inline_ || inline_data.empty());
+    Metadata::inline_data_ = inline_data;
+}
+
+const Layout& Metadata::layout() const {
+    return layout_;
+}
+
+void Metadata::layout(const Layout& layout) {
+    Metadata::layout_ = layout;
+}
+
 #ifdef HAS_SYMLINKS
 
 std::string Metadata::target_path() const {
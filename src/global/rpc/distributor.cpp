@@ -13,11 +13,46 @@
 
 #include <global/rpc/distributor.hpp>
 
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
 using namespace std;
 
 namespace gkfs {
 namespace rpc {
 
+pair<host_t, unsigned int> Distributor::
+data_request_host(host_t host, unsigned int hosts_size) const {
+    return {host, hosts_size};
+}
+
+bool Distributor::
+pin_file(const std::string& path, host_t& host) const {
+    return false;
+}
+
+void Distributor::
+unpin_file(const std::string& path) const {}
+
+host_t Distributor::
+alternative_data_host(host_t host) const {
+    return host;
+}
+
+namespace {
+
+// the host after `host` in hosts, or `host` if it is not one of them
+host_t next_host(const std::vector<host_t>& hosts, host_t host) {
+    auto it = find(hosts.begin(), hosts.end(), host);
+    if (it == hosts.end()) {
+        return host;
+    }
+    return ++it == hosts.end() ? hosts.front() : *it;
+}
+
+} // namespace
+
 SimpleHashDistributor::
 SimpleHashDistributor(host_t localhost, unsigned int hosts_size) :
         localhost_(localhost),
@@ -95,5 +130,260 @@ std::vector<host_t> ForwarderDistributor::
 locate_directory_metadata(const std::string& path) const {
     return all_hosts_;
 }
+
+constexpr std::size_t DynamicForwarderDistributor::max_sticky_files;
+
+DynamicForwarderDistributor::
+DynamicForwarderDistributor(std::vector<host_t> candidates, unsigned int hosts_size, selector_t selector) :
+        candidates_(std::move(candidates)),
+        hosts_size_(hosts_size),
+        all_hosts_(hosts_size),
+        selector_(std::move(selector)) {
+    if (candidates_.empty()) {
+        throw invalid_argument("Forwarder candidate set must not be empty");
+    }
+    ::iota(all_hosts_.begin(), all_hosts_.end(), 0);
+}
+
+host_t DynamicForwarderDistributor::
+localhost() const {
+    return candidates_.front();
+}
+
+/**
+ * Remembers the forwarder of a file unless a concurrent request has chosen first. Forgets the least recently
+ * used files that are not pinned to make room. Called with sticky_mutex_ held
+ */
+DynamicForwarderDistributor::StickyFile& DynamicForwarderDistributor::
+remember(const std::string& path, host_t host) const {
+    auto it = sticky_.find(path);
+    if (it != sticky_.end()) {
+        return it->second;
+    }
+    while (sticky_.size() >= max_sticky_files && !unpinned_.empty()) {
+        sticky_.erase(unpinned_.front());
+        unpinned_.pop_front();
+    }
+    unpinned_.push_back(path);
+    return sticky_.emplace(path, StickyFile{host, 0, prev(unpinned_.end())}).first->second;
+}
+
+host_t DynamicForwarderDistributor::
+locate_data(const std::string& path, const chunkid_t& chnk_id) const {
+    if (candidates_.size() == 1) {
+        return candidates_.front();
+    }
+    {
+        lock_guard<mutex> lock(sticky_mutex_);
+        auto it = sticky_.find(path);
+        if (it != sticky_.end()) {
+            if (it->second.pins == 0) {
+                unpinned_.splice(unpinned_.end(), unpinned_, it->second.unpinned_pos);
+            }
+            return it->second.host;
+        }
+    }
+    // the selector may query the forwarders. Don't block other files meanwhile
+    auto fwd_host = selector_(candidates_);
+    lock_guard<mutex> lock(sticky_mutex_);
+    return remember(path, fwd_host).host;
+}
+
+bool DynamicForwarderDistributor::
+pin_file(const std::string& path, host_t& host) const {
+    if (candidates_.size() == 1) {
+        return false;
+    }
+    unique_lock<mutex> lock(sticky_mutex_);
+    auto it = sticky_.find(path);
+    StickyFile* file;
+    if (it != sticky_.end()) {
+        file = &it->second;
+    } else {
+        lock.unlock();
+        auto fwd_host = selector_(candidates_);
+        lock.lock();
+        file = &remember(path, fwd_host);
+    }
+    if (file->pins++ == 0) {
+        unpinned_.erase(file->unpinned_pos);
+    }
+    host = file->host;
+    return true;
+}
+
+void DynamicForwarderDistributor::
+unpin_file(const std::string& path) const {
+    lock_guard<mutex> lock(sticky_mutex_);
+    auto it = sticky_.find(path);
+    if (it == sticky_.end() || it->second.pins == 0 || --it->second.pins > 0) {
+        return;
+    }
+    // files pinned beyond the limit are forgotten as soon as they are unpinned
+    if (sticky_.size() > max_sticky_files) {
+        sticky_.erase(it);
+        return;
+    }
+    unpinned_.push_back(path);
+    it->second.unpinned_pos = prev(unpinned_.end());
+}
+
+host_t DynamicForwarderDistributor::
+locate_file_metadata(const std::string& path) const {
+    return str_hash(path) % hosts_size_;
+}
+
+std::vector<host_t> DynamicForwarderDistributor::
+locate_directory_metadata(const std::string& path) const {
+    return all_hosts_;
+}
+
+host_t DynamicForwarderDistributor::
+alternative_data_host(host_t host) const {
+    return next_host(candidates_, host);
+}
+
+const std::vector<host_t>& DynamicForwarderDistributor::
+candidates() const {
+    return candidates_;
+}
+
+std::size_t DynamicForwarderDistributor::
+sticky_files() const {
+    lock_guard<mutex> lock(sticky_mutex_);
+    return sticky_.size();
+}
+
+StripedForwarderDistributor::
+StripedForwarderDistributor(std::vector<host_t> forwarders, unsigned int hosts_size) :
+        forwarders_(std::move(forwarders)),
+        hosts_size_(hosts_size),
+        all_hosts_(hosts_size) {
+    if (forwarders_.empty()) {
+        throw invalid_argument("StripedForwarderDistributor needs at least one forwarder");
+    }
+    ::iota(all_hosts_.begin(), all_hosts_.end(), 0);
+}
+
+host_t StripedForwarderDistributor::
+localhost() const {
+    return forwarders_.front();
+}
+
+host_t StripedForwarderDistributor::
+locate_data(const string& path, const chunkid_t& chnk_id) const {
+    // same hash as SimpleHashDistributor, which the forwarders use to find their chunks of a request
+    return forwarders_[str_hash(path + ::to_string(chnk_id)) % forwarders_.size()];
+}
+
+host_t StripedForwarderDistributor::
+locate_file_metadata(const string& path) const {
+    return str_hash(path) % hosts_size_;
+}
+
+::vector<host_t> StripedForwarderDistributor::
+locate_directory_metadata(const string& path) const {
+    return all_hosts_;
+}
+
+pair<host_t, unsigned int> StripedForwarderDistributor::
+data_request_host(host_t host, unsigned int hosts_size) const {
+    auto it = find(forwarders_.begin(), forwarders_.end(), host);
+    if (it == forwarders_.end()) {
+        return {host, hosts_size};
+    }
+    return {static_cast<host_t>(it - forwarders_.begin()), static_cast<unsigned int>(forwarders_.size())};
+}
+
+host_t StripedForwarderDistributor::
+alternative_data_host(host_t host) const {
+    return next_host(forwarders_, host);
+}
+
+JumpHashDistributor::
+JumpHashDistributor(host_t localhost, unsigned int hosts_size) :
+        localhost_(localhost),
+        hosts_size_(hosts_size),
+        all_hosts_(hosts_size) {
+    ::iota(all_hosts_.begin(), all_hosts_.end(), 0);
+}
+
+host_t JumpHashDistributor::
+localhost() const {
+    return localhost_;
+}
+
+host_t JumpHashDistributor::
+locate_data(const string& path, const chunkid_t& chnk_id) const {
+    return jump_hash(str_hash(path + ::to_string(chnk_id)), hosts_size_);
+}
+
+host_t JumpHashDistributor::
+locate_file_metadata(const string& path) const {
+    return jump_hash(str_hash(path), hosts_size_);
+}
+
+::vector<host_t> JumpHashDistributor::
+locate_directory_metadata(const string& path) const {
+    return all_hosts_;
+}
+
+/**
+ * Jump consistent hash: "A Fast, Minimal Memory, Consistent Hash Algorithm", Lamping and Veach, 2014
+ * @param key
+ * @param num_buckets
+ * @return bucket in [0, num_buckets)
+ */
+host_t JumpHashDistributor::
+jump_hash(uint64_t key, unsigned int num_buckets) {
+    int64_t b = -1;
+    int64_t j = 0;
+    while (j < static_cast<int64_t>(num_buckets)) {
+        b = j;
+        key = key * 2862933555777941757ULL + 1;
+        j = static_cast<int64_t>((b + 1) * (static_cast<double>(1LL << 31) / static_cast<double>((key >> 33) + 1)));
+    }
+    return static_cast<host_t>(b);
+}
+
+host_t locate_striped_data(const string& path, const chunkid_t chnk_id, unsigned int stripe_width,
+                           unsigned int hosts_size) {
+    return (hash<string>{}(path) + chnk_id % stripe_width) % hosts_size;
+}
+
+DistributorType distributor_type_from_string(const string& name) {
+    if (name == "simple")
+        return DistributorType::simple_hash;
+    if (name == "jump")
+        return DistributorType::jump_hash;
+    if (name == "locality")
+        return DistributorType::locality;
+    throw invalid_argument("Unknown distributor '" + name + "'. Valid values: simple, jump, locality");
+}
+
+string to_string(DistributorType type) {
+    switch (type) {
+        case DistributorType::simple_hash:
+            return "simple";
+        case DistributorType::jump_hash:
+            return "jump";
+        case DistributorType::locality:
+            return "locality";
+    }
+    return "unknown";
+}
+
+/**
+ * Builds the hash distributor of the given type. Used by clients and by daemons that recompute chunk placement.
+ * @param type
+ * @param localhost
+ * @param hosts_size
+ * @return
+ */
+shared_ptr<Distributor> make_hash_distributor(DistributorType type, host_t localhost, unsigned int hosts_size) {
+    if (type == DistributorType::jump_hash)
+        return make_shared<JumpHashDistributor>(localhost, hosts_size);
+    return make_shared<SimpleHashDistributor>(localhost, hosts_size);
+}
 } // namespace rpc
 } // namespace gkfs
@@ -0,0 +1,116 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <global/stage_stats.hpp>
+
+#include <algorithm>
+
+using namespace std;
+
+namespace gkfs {
+namespace util {
+
+constexpr size_t StageStats::counts_size;
+
+const char* to_string(RpcOp op) {
+    switch (op) {
+        case RpcOp::write:
+            return "write";
+        case RpcOp::read:
+            return "read";
+        case RpcOp::create:
+            return "create";
+        case RpcOp::stat:
+            return "stat";
+        case RpcOp::remove:
+            return "remove";
+        case RpcOp::update_size:
+            return "update_size";
+        case RpcOp::get_size:
+            return "get_size";
+        case RpcOp::get_dirents:
+            return "get_dirents";
+    }
+    return "unknown";
+}
+
+const char* to_string(RpcStage stage) {
+    switch (stage) {
+        case RpcStage::decode:
+            return "decode";
+        case RpcStage::schedule:
+            return "schedule";
+        case RpcStage::transfer:
+            return "transfer";
+        case RpcStage::queue:
+            return "queue";
+        case RpcStage::storage:
+            return "storage";
+        case RpcStage::respond:
+            return "respond";
+        case RpcStage::total:
+            return "total";
+    }
+    return "unknown";
+}
+
+void StageStats::record(RpcOp op, RpcStage stage, uint64_t usec) {
+    histograms_[static_cast<unsigned int>(op) * rpc_stage_count + static_cast<unsigned int>(stage)].record(usec);
+}
+
+vector<uint64_t> StageStats::snapshot() const {
+    vector<uint64_t> counts(counts_size);
+    auto pos = counts.begin();
+    for (const auto& histogram : histograms_) {
+        auto buckets = histogram.snapshot();
+        pos = copy(buckets.begin(), buckets.end(), pos);
+    }
+    return counts;
+}
+
+void StageStats::reset() {
+    for (auto& histogram : histograms_) {
+        histogram.reset();
+    }
+}
+
+size_t StageStats::offset(RpcOp op, RpcStage stage) {
+    return (static_cast<size_t>(op) * rpc_stage_count + static_cast<size_t>(stage)) * LatencyHistogram::bucket_count;
+}
+
+StageTimer::StageTimer(StageStats& stats, RpcOp op) :
+        stats_(stats),
+        op_(op),
+        start_(clock::now()),
+        last_(start_) {}
+
+StageTimer::~StageTimer() {
+    record(RpcStage::total, clock::now() - start_);
+}
+
+void StageTimer::stage(RpcStage stage) {
+    auto now = clock::now();
+    record(stage, now - last_);
+    last_ = now;
+}
+
+void StageTimer::record(RpcStage stage, clock::duration duration) {
+    stats_.record(op_, stage, chrono::duration_cast<chrono::microseconds>(duration).count());
+}
+
+void StageTimer::mark() {
+    last_ = clock::now();
+}
+
+} // namespace util
+} // namespace gkfs
@@ -0,0 +1,741 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+/*
+ * Replays the syscalls recorded with LIBGKFS_TRACE_FILE. Runs under LD_PRELOAD of the client library so that the
+ * replayed syscalls are handled by GekkoFS. Each trace file, i.e., each traced process, is replayed by its own
+ * process and each traced thread by its own thread, keeping the inter-arrival times of the trace scaled by --speed.
+ * Prints the latency percentiles per syscall, summed up over all processes.
+ */
+
+#include <client/trace.hpp>
+#include <global/histogram.hpp>
+
+#include <fmt/format.h>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <fcntl.h>
+#include <linux/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+}
+
+using namespace std;
+namespace po = boost::program_options;
+
+using gkfs::util::LatencyHistogram;
+
+namespace {
+
+// largest transfer replayed by a single syscall, larger requests are truncated
+constexpr size_t max_transfer = 64 * 1024 * 1024;
+
+struct Options {
+    vector<string> prefixes;
+    vector<pair<string, string>> remaps;
+    double speed;
+};
+
+struct OpStats {
+    uint64_t count;
+    uint64_t errors;
+    // syscalls that succeeded in the trace and failed in the replay or vice versa
+    uint64_t mismatches;
+    // not replayed, e.g., not below a prefix or on an fd that was opened before tracing started
+    uint64_t skipped;
+    uint64_t total_ns;
+    array<uint64_t, LatencyHistogram::bucket_count> buckets;
+};
+
+// per syscall number
+using Stats = map<uint16_t, OpStats>;
+
+// sent from a replay process to the parent
+struct StatsEntry {
+    uint16_t syscall;
+    uint16_t reserved[3];
+    OpStats stats;
+};
+
+void merge(Stats& into, const Stats& from) {
+    for (const auto& entry : from) {
+        auto& s = into[entry.first];
+        s.count += entry.second.count;
+        s.errors += entry.second.errors;
+        s.mismatches += entry.second.mismatches;
+        s.skipped += entry.second.skipped;
+        s.total_ns += entry.second.total_ns;
+        for (unsigned int b = 0; b < LatencyHistogram::bucket_count; ++b) {
+            s.buckets[b] += entry.second.buckets[b];
+        }
+    }
+}
+
+uint64_t monotonic_ns() {
+    struct timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ul + ts.tv_nsec;
+}
+
+/**
+ * Syscalls of one traced process
+ */
+struct Trace {
+    uint32_t pid = 0;
+    unordered_map<uint16_t, string> names;
+    unordered_map<uint64_t, string> paths;
+    // records per thread in the order they were written, which is the order of the syscalls in the thread
+    map<uint32_t, vector<gkfs::trace::Record>> threads;
+    // (tsc, ns) pairs of the first and last block
+    pair<uint64_t, uint64_t> first_clock{0, 0};
+    pair<uint64_t, uint64_t> last_clock{0, 0};
+
+    // converts a timestamp of a record to CLOCK_MONOTONIC nanoseconds
+    uint64_t to_ns(uint64_t tsc) const {
+        auto ticks = static_cast<double>(last_clock.first) - static_cast<double>(first_clock.first);
+        auto nanos = static_cast<double>(last_clock.second) - static_cast<double>(first_clock.second);
+        auto ns_per_tick = (ticks > 0 && nanos > 0) ? nanos / ticks : 1.0;
+        auto ns = static_cast<double>(first_clock.second) +
+                  (static_cast<double>(tsc) - static_cast<double>(first_clock.first)) * ns_per_tick;
+        return ns > 0 ? static_cast<uint64_t>(ns) : 0;
+    }
+
+    uint64_t start_ns() const {
+        auto start = numeric_limits<uint64_t>::max();
+        for (const auto& thread : threads) {
+            if (!thread.second.empty()) {
+                start = min(start, to_ns(thread.second.front().start));
+            }
+        }
+        return start;
+    }
+};
+
+Trace load_trace(const string& trace_file) {
+    ifstream tf(trace_file, ios::binary);
+    if (!tf) {
+        throw runtime_error(fmt::format("Failed to open trace file '{}': {}", trace_file, strerror(errno)));
+    }
+    vector<char> data((istreambuf_iterator<char>(tf)), istreambuf_iterator<char>());
+    Trace trace{};
+    bool first = true;
+    size_t pos = 0;
+    while (pos + sizeof(gkfs::trace::BlockHeader) <= data.size()) {
+        gkfs::trace::BlockHeader header{};
+        memcpy(&header, data.data() + pos, sizeof(header));
+        pos += sizeof(header);
+        if (header.magic != gkfs::trace::BLOCK_MAGIC) {
+            throw runtime_error(fmt::format("Trace file '{}' is corrupted at offset {}", trace_file,
+                                            pos - sizeof(header)));
+        }
+        if (header.version != gkfs::trace::VERSION) {
+            throw runtime_error(fmt::format("Trace file '{}' has version {}, only version {} can be replayed",
+                                            trace_file, header.version, gkfs::trace::VERSION));
+        }
+        trace.pid = header.pid;
+        if (first) {
+            trace.first_clock = make_pair(header.tsc, header.ns);
+            first = false;
+        }
+        trace.last_clock = make_pair(header.tsc, header.ns);
+        switch (static_cast<gkfs::trace::BlockType>(header.type)) {
+            case gkfs::trace::BlockType::names:
+                for (uint32_t i = 0; i < header.count && pos + sizeof(gkfs::trace::SyscallName) <= data.size(); ++i) {
+                    gkfs::trace::SyscallName name{};
+                    memcpy(&name, data.data() + pos, sizeof(name));
+                    pos += sizeof(name);
+                    trace.names[name.syscall] = string(name.name, strnlen(name.name, sizeof(name.name)));
+                }
+                break;
+            case gkfs::trace::BlockType::paths:
+                for (uint32_t i = 0; i < header.count && pos + sizeof(gkfs::trace::PathHeader) <= data.size(); ++i) {
+                    gkfs::trace::PathHeader path{};
+                    memcpy(&path, data.data() + pos, sizeof(path));
+                    if (pos + gkfs::trace::path_entry_size(path.length) > data.size()) {
+                        // truncated file
+                        pos = data.size();
+                        break;
+                    }
+                    trace.paths[path.hash] = string(data.data() + pos + sizeof(path), path.length);
+                    pos += gkfs::trace::path_entry_size(path.length);
+                }
+                break;
+            case gkfs::trace::BlockType::records: {
+                auto& records = trace.threads[header.tid];
+                for (uint32_t i = 0; i < header.count && pos + sizeof(gkfs::trace::Record) <= data.size(); ++i) {
+                    gkfs::trace::Record record{};
+                    memcpy(&record, data.data() + pos, sizeof(record));
+                    pos += sizeof(record);
+                    records.push_back(record);
+                }
+                break;
+            }
+            default:
+                throw runtime_error(fmt::format("Trace file '{}' has an unknown block type {}", trace_file,
+                                                header.type));
+        }
+    }
+    return trace;
+}
+
+/**
+ * Replays the threads of one traced process. Traced fds are mapped to the fds opened during the replay, which all
+ * threads of the process share
+ */
+class Replayer {
+public:
+    Replayer(const Trace& trace, const Options& opts, uint64_t trace_start_ns, uint64_t replay_start_ns) :
+            trace_(trace),
+            opts_(opts),
+            trace_start_ns_(trace_start_ns),
+            replay_start_ns_(replay_start_ns) {}
+
+    Stats run() {
+        vector<Stats> thread_stats(trace_.threads.size());
+        vector<thread> threads;
+        size_t i = 0;
+        for (const auto& t : trace_.threads) {
+            threads.emplace_back(&Replayer::replay_thread, this, cref(t.second), ref(thread_stats[i++]));
+        }
+        Stats stats;
+        for (i = 0; i < threads.size(); ++i) {
+            threads[i].join();
+            merge(stats, thread_stats[i]);
+        }
+        return stats;
+    }
+
+private:
+    const Trace& trace_;
+    const Options& opts_;
+    uint64_t trace_start_ns_;
+    uint64_t replay_start_ns_;
+    mutex fds_mutex_;
+    unordered_map<int, int> fds_;
+
+    // waits until the syscall is due, relative to the start of the replay
+    void wait_for(const gkfs::trace::Record& record) const {
+        if (opts_.speed <= 0) {
+            return;
+        }
+        auto offset = static_cast<double>(trace_.to_ns(record.start) - trace_start_ns_) / opts_.speed;
+        auto due = replay_start_ns_ + static_cast<uint64_t>(offset);
+        struct timespec ts{};
+        ts.tv_sec = static_cast<time_t>(due / 1000000000ul);
+        ts.tv_nsec = static_cast<long>(due % 1000000000ul);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+        }
+    }
+
+    void replay_thread(const vector<gkfs::trace::Record>& records, Stats& stats) {
+        // large enough for every buffer a replayed syscall fills or sends
+        size_t buf_size = 64 * 1024;
+        for (const auto& record : records) {
+            buf_size = max<size_t>(buf_size, min<uint64_t>(record.size, max_transfer));
+        }
+        vector<char> buf(buf_size);
+        for (const auto& record : records) {
+            wait_for(record);
+            auto& s = stats[record.syscall];
+            auto start = chrono::steady_clock::now();
+            long result = 0;
+            if (!replay(record, buf.data(), result)) {
+                s.skipped++;
+                continue;
+            }
+            auto ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+            s.count++;
+            s.total_ns += ns;
+            s.buckets[LatencyHistogram::bucket_of(ns / 1000)]++;
+            if (result < 0) {
+                s.errors++;
+            }
+            if ((result < 0) != (record.result < 0)) {
+                s.mismatches++;
+            }
+        }
+    }
+
+    /**
+     * Path of the record after remapping, empty if it is not replayed. Relative paths are replayed only relative to
+     * an fd of the replay
+     */
+    string path_of(const gkfs::trace::Record& record, bool relative_ok) const {
+        auto it = trace_.paths.find(record.path_hash);
+        if (record.path_hash == 0 || it == trace_.paths.end()) {
+            return {};
+        }
+        auto path = it->second;
+        if (path.empty() || path.front() != '/') {
+            return relative_ok ? path : string{};
+        }
+        for (const auto& remap : opts_.remaps) {
+            if (path.compare(0, remap.first.size(), remap.first) == 0) {
+                path = remap.second + path.substr(remap.first.size());
+                break;
+            }
+        }
+        for (const auto& prefix : opts_.prefixes) {
+            if (path.compare(0, prefix.size(), prefix) == 0) {
+                return path;
+            }
+        }
+        return {};
+    }
+
+    // fd of the replay for a traced fd, -1 if it is not replayed
+    int fd_of(int traced_fd) {
+        lock_guard<mutex> lock(fds_mutex_);
+        auto it = fds_.find(traced_fd);
+        return it == fds_.end() ? -1 : it->second;
+    }
+
+    // fd of the replay for the dirfd of an *at syscall, AT_FDCWD if relative paths are resolved against the cwd
+    int dirfd_of(int traced_fd) {
+        return traced_fd == AT_FDCWD ? AT_FDCWD : fd_of(traced_fd);
+    }
+
+    void add_fd(int traced_fd, long fd) {
+        if (traced_fd < 0 || fd < 0) {
+            return;
+        }
+        lock_guard<mutex> lock(fds_mutex_);
+        auto it = fds_.find(traced_fd);
+        if (it != fds_.end()) {
+            // the traced process reused an fd that it did not close while tracing
+            ::close(it->second);
+        }
+        fds_[traced_fd] = static_cast<int>(fd);
+    }
+
+    void remove_fd(int traced_fd) {
+        lock_guard<mutex> lock(fds_mutex_);
+        fds_.erase(traced_fd);
+    }
+
+    static long ret(long res) {
+        return res < 0 ? -errno : res;
+    }
+
+    /**
+     * Issues the syscall of a record
+     * @return false if the syscall is not replayed
+     */
+    bool replay(const gkfs::trace::Record& record, char* buf, long& result) {
+        auto size = min<uint64_t>(record.size, max_transfer);
+        struct iovec iov{buf, size};
+        switch (record.syscall) {
+            case SYS_open:
+            case SYS_creat:
+            case SYS_stat:
+            case SYS_lstat:
+            case SYS_statfs:
+            case SYS_truncate:
+            case SYS_access:
+            case SYS_mkdir:
+            case SYS_rmdir:
+            case SYS_unlink:
+            case SYS_chdir:
+            case SYS_chmod:
+            case SYS_readlink: {
+                auto path = path_of(record, false);
+                if (path.empty()) {
+                    return false;
+                }
+                switch (record.syscall) {
+                    case SYS_open:
+                        result = ret(::syscall(SYS_open, path.c_str(), record.flags, record.mode));
+                        add_fd(static_cast<int>(record.result), result);
+                        break;
+                    case SYS_creat:
+                        result = ret(::syscall(SYS_creat, path.c_str(), record.mode));
+                        add_fd(static_cast<int>(record.result), result);
+                        break;
+                    case SYS_truncate:
+                        result = ret(::syscall(SYS_truncate, path.c_str(), record.offset));
+                        break;
+                    case SYS_access:
+                    case SYS_mkdir:
+                    case SYS_chmod:
+                        result = ret(::syscall(record.syscall, path.c_str(), record.mode));
+                        break;
+                    case SYS_readlink:
+                        result = ret(::syscall(SYS_readlink, path.c_str(), buf, PATH_MAX));
+                        break;
+                    default:
+                        // stat, lstat and statfs fill a buffer, the others only take the path
+                        result = ret(::syscall(record.syscall, path.c_str(), buf));
+                }
+                return true;
+            }
+            case SYS_openat:
+            case SYS_newfstatat:
+            case SYS_statx:
+            case SYS_faccessat:
+            case SYS_mkdirat:
+            case SYS_unlinkat:
+            case SYS_fchmodat:
+            case SYS_readlinkat: {
+                auto dirfd = dirfd_of(record.fd);
+                auto path = path_of(record, dirfd >= 0);
+                if (path.empty() || (dirfd < 0 && dirfd != AT_FDCWD)) {
+                    return false;
+                }
+                switch (record.syscall) {
+                    case SYS_openat:
+                        result = ret(::syscall(SYS_openat, dirfd, path.c_str(), record.flags, record.mode));
+                        add_fd(static_cast<int>(record.result), result);
+                        break;
+                    case SYS_newfstatat:
+                        result = ret(::syscall(SYS_newfstatat, dirfd, path.c_str(), buf, record.flags));
+                        break;
+                    case SYS_statx:
+                        // the mask is not recorded
+                        result = ret(::syscall(SYS_statx, dirfd, path.c_str(), record.flags, STATX_BASIC_STATS,
+                                               buf));
+                        break;
+                    case SYS_unlinkat:
+                        result = ret(::syscall(SYS_unlinkat, dirfd, path.c_str(), record.flags));
+                        break;
+                    case SYS_readlinkat:
+                        result = ret(::syscall(SYS_readlinkat, dirfd, path.c_str(), buf, PATH_MAX));
+                        break;
+                    default:
+                        // faccessat, mkdirat and fchmodat take a mode
+                        result = ret(::syscall(record.syscall, dirfd, path.c_str(), record.mode));
+                }
+                return true;
+            }
+            default:
+                break;
+        }
+
+        auto fd = fd_of(record.fd);
+        if (fd < 0) {
+            return false;
+        }
+        switch (record.syscall) {
+            case SYS_close:
+                remove_fd(record.fd);
+                result = ret(::syscall(SYS_close, fd));
+                break;
+            case SYS_read:
+            case SYS_write:
+            case SYS_getdents:
+            case SYS_getdents64:
+                result = ret(::syscall(record.syscall, fd, buf, size));
+                break;
+            case SYS_pread64:
+            case SYS_pwrite64:
+                result = ret(::syscall(record.syscall, fd, buf, size, record.offset));
+                break;
+            case SYS_readv:
+            case SYS_writev:
+                // the sizes of the single buffers are not recorded, only their sum
+                result = ret(::syscall(record.syscall, fd, &iov, 1));
+                break;
+            case SYS_preadv:
+            case SYS_pwritev:
+                result = ret(::syscall(record.syscall, fd, &iov, 1, record.offset, 0));
+                break;
+            case SYS_preadv2:
+            case SYS_pwritev2:
+                result = ret(::syscall(record.syscall, fd, &iov, 1, record.offset, 0, 0));
+                break;
+            case SYS_lseek:
+                result = ret(::syscall(SYS_lseek, fd, record.offset, record.flags));
+                break;
+            case SYS_ftruncate:
+                result = ret(::syscall(SYS_ftruncate, fd, record.offset));
+                break;
+            case SYS_fsync:
+            case SYS_fdatasync:
+            case SYS_fchdir:
+                result = ret(::syscall(record.syscall, fd));
+                break;
+            case SYS_fstat:
+            case SYS_fstatfs:
+                result = ret(::syscall(record.syscall, fd, buf));
+                break;
+            case SYS_dup:
+            case SYS_dup2:
+            case SYS_dup3:
+                // the new fd of dup2 and dup3 is not recorded, the one of the replay is mapped to the traced result
+                result = ret(::syscall(SYS_dup, fd));
+                add_fd(static_cast<int>(record.result), result);
+                break;
+            default:
+                // e.g., fcntl whose command is not recorded
+                return false;
+        }
+        return true;
+    }
+};
+
+void print_stats(const Stats& stats, const unordered_map<uint16_t, string>& names) {
+    fmt::print("{:<14} {:>10} {:>8} {:>8} {:>8} {:>9} {:>9} {:>9} {:>9} {:>9}\n", "syscall", "count", "errors",
+               "mismatch", "skipped", "mean", "p50", "p90", "p99", "max");
+    for (const auto& entry : stats) {
+        const auto& s = entry.second;
+        auto name = names.find(entry.first);
+        fmt::print("{:<14} {:>10} {:>8} {:>8} {:>8} {:>9.1f} {:>9} {:>9} {:>9} {:>9}\n",
+                   name != names.end() ? name->second : fmt::format("syscall_{}", entry.first), s.count, s.errors,
+                   s.mismatches, s.skipped, s.count ? static_cast<double>(s.total_ns) / s.count / 1000 : 0.0,
+                   LatencyHistogram::quantile(s.buckets, 0.5), LatencyHistogram::quantile(s.buckets, 0.9),
+                   LatencyHistogram::quantile(s.buckets, 0.99), LatencyHistogram::quantile(s.buckets, 1.0));
+    }
+}
+
+/**
+ * Replays one trace in this process and sends the stats to the parent
+ */
+int replay_process(const string& trace_file, const Options& opts, uint64_t trace_start_ns, uint64_t replay_start_ns,
+                   int result_fd) {
+    Trace trace;
+    try {
+        trace = load_trace(trace_file);
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    Replayer replayer(trace, opts, trace_start_ns, replay_start_ns);
+    auto stats = replayer.run();
+    vector<StatsEntry> entries;
+    for (const auto& entry : stats) {
+        StatsEntry e{};
+        e.syscall = entry.first;
+        e.stats = entry.second;
+        entries.push_back(e);
+    }
+    auto data = reinterpret_cast<const char*>(entries.data());
+    size_t left = entries.size() * sizeof(StatsEntry);
+    while (left > 0) {
+        auto written = ::write(result_fd, data, left);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            cerr << "Failed to send stats: " << strerror(errno) << endl;
+            return EXIT_FAILURE;
+        }
+        data += written;
+        left -= written;
+    }
+    ::close(result_fd);
+    return EXIT_SUCCESS;
+}
+
+Stats receive_stats(int fd) {
+    vector<char> data;
+    char buf[4096];
+    ssize_t n;
+    while ((n = ::read(fd, buf, sizeof(buf))) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        data.insert(data.end(), buf, buf + n);
+    }
+    Stats stats;
+    for (size_t pos = 0; pos + sizeof(StatsEntry) <= data.size(); pos += sizeof(StatsEntry)) {
+        StatsEntry e{};
+        memcpy(&e, data.data() + pos, sizeof(e));
+        Stats single;
+        single[e.syscall] = e.stats;
+        merge(stats, single);
+    }
+    return stats;
+}
+
+} // namespace
+
+int main(int argc, const char* argv[]) {
+    po::options_description desc("Replays syscall traces recorded with LIBGKFS_TRACE_FILE, one process per trace "
+                                 "file and one thread per traced thread. Run it with LD_PRELOAD of the client "
+                                 "library. Prints latencies in microseconds, percentiles are upper bounds of "
+                                 "power-of-two buckets.\n\n"
+                                 "Usage: gkfs_replay [options] -p PREFIX TRACE_FILE...\n\n"
+                                 "Allowed options");
+    desc.add_options()
+            ("help,h", "Help message")
+            ("prefix,p", po::value<vector<string>>()->required(),
+             "Replay only syscalls on paths below this prefix, e.g., the mount directory, and on the fds opened "
+             "for them. Can be given several times")
+            ("remap,r", po::value<vector<string>>(),
+             "OLD=NEW: replaces the path prefix OLD with NEW before checking --prefix. Can be given several times")
+            ("speed,s", po::value<double>(),
+             "Scales the inter-arrival times of the trace, e.g., 2 replays twice as fast. 0 replays without waiting "
+             "(default 1)");
+    // used to start the replay processes
+    po::options_description hidden;
+    hidden.add_options()
+            ("trace-file", po::value<vector<string>>())
+            ("process", po::value<unsigned int>())
+            ("trace-start", po::value<uint64_t>())
+            ("replay-start", po::value<uint64_t>())
+            ("result-fd", po::value<int>());
+    po::options_description all;
+    all.add(desc).add(hidden);
+    po::positional_options_description pos;
+    pos.add("trace-file", -1);
+    po::variables_map vm{};
+    try {
+        po::store(po::command_line_parser(argc, argv).options(all).positional(pos).run(), vm);
+        if (vm.count("help")) {
+            cout << desc << endl;
+            return EXIT_SUCCESS;
+        }
+        po::notify(vm);
+    } catch (const po::error& e) {
+        cerr << e.what() << endl << desc << endl;
+        return EXIT_FAILURE;
+    }
+    if (!vm.count("trace-file")) {
+        cerr << "No trace files given" << endl << desc << endl;
+        return EXIT_FAILURE;
+    }
+    auto trace_files = vm["trace-file"].as<vector<string>>();
+
+    Options opts{};
+    opts.prefixes = vm["prefix"].as<vector<string>>();
+    opts.speed = vm.count("speed") ? vm["speed"].as<double>() : 1.0;
+    if (opts.speed < 0) {
+        cerr << "--speed must not be negative" << endl;
+        return EXIT_FAILURE;
+    }
+    if (vm.count("remap")) {
+        for (const auto& remap : vm["remap"].as<vector<string>>()) {
+            auto sep = remap.find('=');
+            if (sep == string::npos || sep == 0) {
+                cerr << "Invalid remap '" << remap << "', expected OLD=NEW" << endl;
+                return EXIT_FAILURE;
+            }
+            opts.remaps.emplace_back(remap.substr(0, sep), remap.substr(sep + 1));
+        }
+    }
+
+    if (vm.count("process")) {
+        auto process = vm["process"].as<unsigned int>();
+        if (process >= trace_files.size() || !vm.count("trace-start") || !vm.count("replay-start") ||
+            !vm.count("result-fd")) {
+            cerr << "Invalid replay process arguments" << endl;
+            return EXIT_FAILURE;
+        }
+        return replay_process(trace_files[process], opts, vm["trace-start"].as<uint64_t>(),
+                              vm["replay-start"].as<uint64_t>(), vm["result-fd"].as<int>());
+    }
+
+    // all processes share the time base so that their syscalls keep their order across processes
+    unordered_map<uint16_t, string> names;
+    auto trace_start = numeric_limits<uint64_t>::max();
+    try {
+        for (const auto& trace_file : trace_files) {
+            auto trace = load_trace(trace_file);
+            trace_start = min(trace_start, trace.start_ns());
+            names.insert(trace.names.begin(), trace.names.end());
+        }
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    if (trace_start == numeric_limits<uint64_t>::max()) {
+        cerr << "Trace files contain no syscalls" << endl;
+        return EXIT_FAILURE;
+    }
+
+    // the replay processes are started from scratch so that each one sets up its own client
+    char exe[PATH_MAX]{};
+    if (::readlink("/proc/self/exe", exe, sizeof(exe) - 1) < 0) {
+        cerr << "Failed to find the executable: " << strerror(errno) << endl;
+        return EXIT_FAILURE;
+    }
+    // leaves the processes time to start up
+    auto replay_start = monotonic_ns() + 500 * 1000000ul;
+    vector<pair<pid_t, int>> children;
+    for (unsigned int i = 0; i < trace_files.size(); ++i) {
+        int fds[2];
+        if (::pipe(fds) != 0) {
+            cerr << "Failed to create pipe: " << strerror(errno) << endl;
+            return EXIT_FAILURE;
+        }
+        vector<string> args{exe, "--process", to_string(i), "--trace-start", to_string(trace_start),
+                            "--replay-start", to_string(replay_start), "--result-fd", to_string(fds[1]),
+                            "--speed", to_string(opts.speed)};
+        for (const auto& prefix : opts.prefixes) {
+            args.emplace_back("--prefix");
+            args.emplace_back(prefix);
+        }
+        for (const auto& remap : opts.remaps) {
+            args.emplace_back("--remap");
+            args.emplace_back(remap.first + "=" + remap.second);
+        }
+        args.insert(args.end(), trace_files.begin(), trace_files.end());
+        vector<char*> argv_child;
+        for (auto& arg : args) {
+            argv_child.push_back(&arg[0]);
+        }
+        argv_child.push_back(nullptr);
+        auto pid = fork();
+        if (pid < 0) {
+            cerr << "Failed to fork: " << strerror(errno) << endl;
+            return EXIT_FAILURE;
+        }
+        if (pid == 0) {
+            ::close(fds[0]);
+            execv(exe, argv_child.data());
+            _exit(127);
+        }
+        ::close(fds[1]);
+        children.emplace_back(pid, fds[0]);
+    }
+
+    Stats stats;
+    unsigned int failed = 0;
+    for (const auto& child : children) {
+        merge(stats, receive_stats(child.second));
+        ::close(child.second);
+        int status = 0;
+        if (waitpid(child.first, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failed++;
+        }
+    }
+    auto elapsed = static_cast<double>(monotonic_ns() - replay_start) / 1e9;
+    fmt::print("{} of {} processes replayed in {:.3f} s\n", children.size() - failed, children.size(), elapsed);
+    print_stats(stats, names);
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,236 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+/*
+ * Polls the latency histograms of the RPC handler stages from all daemons in the hosts file and prints their
+ * percentiles, summed up over all daemons or per daemon.
+ */
+
+#include <config.hpp>
+#include <global/env_util.hpp>
+#include <global/global_defs.hpp>
+#include <global/stage_stats.hpp>
+#include <global/rpc/rpc_types.hpp>
+#include <daemon/env.hpp>
+
+#include <fmt/format.h>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <margo.h>
+}
+
+using namespace std;
+namespace po = boost::program_options;
+
+using gkfs::util::LatencyHistogram;
+using gkfs::util::RpcOp;
+using gkfs::util::RpcStage;
+using gkfs::util::StageStats;
+
+namespace {
+
+constexpr double timeout_ms = 5000;
+
+/**
+ * Reads the hosts file in the same way clients do
+ * @param hosts_file
+ * @return vector of pair <hostname, uri>
+ */
+vector<pair<string, string>> read_hosts_file(const string& hosts_file) {
+    ifstream lf(hosts_file);
+    if (!lf) {
+        throw runtime_error(fmt::format("Failed to open hosts file '{}': {}", hosts_file, strerror(errno)));
+    }
+    vector<pair<string, string>> hosts;
+    string line;
+    while (getline(lf, line)) {
+        istringstream iss(line);
+        string host;
+        string uri;
+        if (!(iss >> host >> uri)) {
+            throw runtime_error(fmt::format("Unrecognized line format in hosts file: '{}'", line));
+        }
+        hosts.emplace_back(host, uri);
+    }
+    if (hosts.empty()) {
+        throw runtime_error(fmt::format("Hosts file '{}' is empty", hosts_file));
+    }
+    return hosts;
+}
+
+/**
+ * Fetches the bucket counts of all stage histograms of one daemon
+ */
+vector<uint64_t> fetch_stage_stats(margo_instance_id mid, hg_id_t rpc_id, const string& uri, bool reset) {
+    hg_addr_t addr;
+    auto ret = margo_addr_lookup(mid, uri.c_str(), &addr);
+    if (ret != HG_SUCCESS) {
+        throw runtime_error(fmt::format("Failed to look up address: {}", HG_Error_to_string(ret)));
+    }
+    vector<uint64_t> counts(StageStats::counts_size);
+    void* buf = counts.data();
+    hg_size_t size = counts.size() * sizeof(uint64_t);
+    hg_bulk_t bulk_handle = nullptr;
+    ret = margo_bulk_create(mid, 1, &buf, &size, HG_BULK_WRITE_ONLY, &bulk_handle);
+    if (ret != HG_SUCCESS) {
+        margo_addr_free(mid, addr);
+        throw runtime_error("Failed to create bulk handle");
+    }
+    hg_handle_t handle;
+    ret = margo_create(mid, addr, rpc_id, &handle);
+    if (ret != HG_SUCCESS) {
+        margo_bulk_free(bulk_handle);
+        margo_addr_free(mid, addr);
+        throw runtime_error("Failed to create RPC handle");
+    }
+    rpc_stage_stats_in_t in{};
+    rpc_stage_stats_out_t out{};
+    in.reset = reset ? HG_TRUE : HG_FALSE;
+    in.bulk_handle = bulk_handle;
+    ret = margo_forward_timed(handle, &in, timeout_ms);
+    if (ret == HG_SUCCESS) {
+        ret = margo_get_output(handle, &out);
+    }
+    string err;
+    if (ret != HG_SUCCESS) {
+        err = fmt::format("RPC failed: {}", HG_Error_to_string(ret));
+    } else {
+        if (out.err != 0) {
+            err = fmt::format("Daemon failed to send stage stats: {}", strerror(out.err));
+        } else if (out.op_count != gkfs::util::rpc_op_count || out.stage_count != gkfs::util::rpc_stage_count ||
+                   out.bucket_count != LatencyHistogram::bucket_count) {
+            err = "Daemon runs an incompatible version";
+        }
+        margo_free_output(handle, &out);
+    }
+    margo_destroy(handle);
+    margo_bulk_free(bulk_handle);
+    margo_addr_free(mid, addr);
+    if (!err.empty()) {
+        throw runtime_error(err);
+    }
+    return counts;
+}
+
+void print_stats(const vector<uint64_t>& counts) {
+    fmt::print("{:<12} {:<9} {:>12} {:>9} {:>9} {:>9} {:>9} {:>9}\n", "rpc", "stage", "count", "p50", "p90", "p99",
+               "p99.9", "max");
+    for (unsigned int op = 0; op < gkfs::util::rpc_op_count; ++op) {
+        for (unsigned int stage = 0; stage < gkfs::util::rpc_stage_count; ++stage) {
+            array<uint64_t, LatencyHistogram::bucket_count> buckets{};
+            auto first = counts.begin() + StageStats::offset(static_cast<RpcOp>(op), static_cast<RpcStage>(stage));
+            copy(first, first + LatencyHistogram::bucket_count, buckets.begin());
+            uint64_t total = 0;
+            for (auto c : buckets) {
+                total += c;
+            }
+            if (total == 0) {
+                continue;
+            }
+            fmt::print("{:<12} {:<9} {:>12} {:>9} {:>9} {:>9} {:>9} {:>9}\n",
+                       gkfs::util::to_string(static_cast<RpcOp>(op)),
+                       gkfs::util::to_string(static_cast<RpcStage>(stage)), total,
+                       LatencyHistogram::quantile(buckets, 0.5), LatencyHistogram::quantile(buckets, 0.9),
+                       LatencyHistogram::quantile(buckets, 0.99), LatencyHistogram::quantile(buckets, 0.999),
+                       LatencyHistogram::quantile(buckets, 1.0));
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, const char* argv[]) {
+    po::options_description desc("Prints the latency percentiles in microseconds of the stages of the RPC handlers "
+                                 "of all GekkoFS daemons. Values are upper bounds of power-of-two buckets.\n\n"
+                                 "Allowed options");
+    desc.add_options()
+            ("help,h", "Help message")
+            ("hosts-file,H", po::value<string>(),
+             "Hosts file of the daemons. (default './gkfs_hosts.txt')")
+            ("per-daemon,p", po::bool_switch(), "Print the stats of each daemon instead of their sum")
+            ("reset,r", po::bool_switch(), "Reset the stats of the daemons after reading them");
+    po::variables_map vm{};
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    } catch (const po::error& e) {
+        cerr << e.what() << endl << desc << endl;
+        return EXIT_FAILURE;
+    }
+    if (vm.count("help")) {
+        cout << desc << endl;
+        return EXIT_SUCCESS;
+    }
+    auto hosts_file = vm.count("hosts-file") ? vm["hosts-file"].as<string>() :
+                      gkfs::env::get_var(gkfs::env::HOSTS_FILE, gkfs::config::hostfile_path);
+    vector<pair<string, string>> hosts;
+    try {
+        hosts = read_hosts_file(hosts_file);
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    // all daemons use the same protocol, which prefixes their addresses
+    const auto& uri = hosts.front().second;
+    auto protocol = uri.substr(0, uri.find("://"));
+    auto mid = margo_init_opt(protocol.c_str(), MARGO_CLIENT_MODE, nullptr, HG_FALSE, 0);
+    if (mid == MARGO_INSTANCE_NULL) {
+        cerr << "Failed to initialize Margo for protocol '" << protocol << "'" << endl;
+        return EXIT_FAILURE;
+    }
+    // only sent, so there is no handler
+    auto rpc_id = margo_register_name(mid, gkfs::rpc::tag::get_stage_stats, hg_proc_rpc_stage_stats_in_t,
+                                      hg_proc_rpc_stage_stats_out_t, nullptr);
+
+    auto per_daemon = vm["per-daemon"].as<bool>();
+    auto reset = vm["reset"].as<bool>();
+    vector<uint64_t> sum(StageStats::counts_size, 0);
+    unsigned int failed = 0;
+    for (const auto& host : hosts) {
+        try {
+            auto counts = fetch_stage_stats(mid, rpc_id, host.second, reset);
+            if (per_daemon) {
+                fmt::print("daemon {} ({})\n", host.first, host.second);
+                print_stats(counts);
+                fmt::print("\n");
+            }
+            for (size_t i = 0; i < counts.size(); ++i) {
+                sum[i] += counts[i];
+            }
+        } catch (const exception& e) {
+            cerr << "daemon " << host.first << " (" << host.second << "): " << e.what() << endl;
+            failed++;
+        }
+    }
+    if (!per_daemon) {
+        fmt::print("{} of {} daemons\n", hosts.size() - failed, hosts.size());
+        print_stats(sum);
+    }
+
+    margo_finalize(mid);
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -21,6 +21,7 @@ from harness.cli import add_cli_options, set_default_log_formatter
 from harness.workspace import Workspace, FileCreator
 from harness.gkfs import Daemon, Client, ShellClient, FwdDaemon, FwdClient, ShellFwdClient
 from harness.factory import FwdDaemonCreator, FwdClientCreator
+from harness.perf import PerfCluster, PerfClient, PerfOptions, PerfRecorder, PerfRunner
 from harness.reporter import report_test_status, report_test_headline, report_assertion_pass
 
 def pytest_configure(config):
@@ -83,15 +84,29 @@ def test_workspace(tmp_path, request):
 @pytest.fixture
 def gkfs_daemon(test_workspace, request):
     """
-    Initializes a local gekkofs daemon
+    Initializes a local gekkofs daemon. Tests may pass extra daemon
+    arguments by parametrizing the fixture indirectly
     """
 
     interface = request.config.getoption('--interface')
-    daemon = Daemon(interface, test_workspace)
+    daemon = Daemon(interface, test_workspace, getattr(request, 'param', None))
 
     yield daemon.run()
     daemon.shutdown()
 
+@pytest.fixture
+def gkfs_cluster(test_workspace, request):
+    """
+    Initializes several local gekkofs daemons, each with its own root
+    directory, so that the chunks of a file are spread among them
+    """
+
+    interface = request.config.getoption('--interface')
+    cluster = PerfCluster(interface, test_workspace, 4)
+
+    yield cluster.run()
+    cluster.shutdown()
+
 @pytest.fixture
 def gkfs_client(test_workspace, request):
     """
@@ -140,3 +155,35 @@ def gkfwd_client_factory(test_workspace, request):
     """
 
     return FwdClientCreator(test_workspace)
+
+@pytest.fixture(scope='session')
+def perf_recorder(request):
+    """
+    Collects the results of the performance scenarios of a session, compares
+    them against the baseline and stores them when the session ends.
+    """
+
+    recorder = PerfRecorder(request.config.getoption('--perf-baseline'),
+                            request.config.getoption('--perf-tolerance'),
+                            request.config.getoption('--perf-update-baseline'),
+                            request.config.getoption('--perf-results'))
+
+    yield recorder
+    recorder.save()
+
+@pytest.fixture
+def gkfs_perf(test_workspace, request):
+    """
+    Starts a local cluster of gekkofs daemons and returns a runner for
+    performance scenarios on it. Only available with --perf.
+    """
+
+    if not request.config.getoption('--perf'):
+        pytest.skip("performance scenarios only run with --perf")
+
+    options = PerfOptions.from_config(request.config)
+    interface = request.config.getoption('--interface')
+    cluster = PerfCluster(interface, test_workspace, options.daemons)
+
+    yield PerfRunner(cluster.run(), PerfClient(test_workspace), options)
+    cluster.shutdown()
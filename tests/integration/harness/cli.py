@@ -48,6 +48,99 @@ def add_cli_options(parser):
             help="directory that should be considered when searching "
                 "for libraries (multi-allowed)."
         )
+
+        parser.addoption(
+            "--perf",
+            action='store_true',
+            default=False,
+            help="run the performance scenarios (skipped otherwise)."
+        )
+
+        parser.addoption(
+            "--perf-daemons",
+            action='store',
+            type=int,
+            default=2,
+            help="number of local daemons in performance scenarios "
+                "(default: 2)."
+        )
+
+        parser.addoption(
+            "--perf-clients",
+            action='store',
+            type=int,
+            default=4,
+            help="number of concurrent client processes in performance "
+                "scenarios (default: 4)."
+        )
+
+        parser.addoption(
+            "--perf-block-size",
+            action='store',
+            type=int,
+            default=524288,
+            help="bytes per read or write in performance scenarios "
+                "(default: 524288)."
+        )
+
+        parser.addoption(
+            "--perf-blocks",
+            action='store',
+            type=int,
+            default=64,
+            help="blocks read or written per client process (default: 64)."
+        )
+
+        parser.addoption(
+            "--perf-files",
+            action='store',
+            type=int,
+            default=1000,
+            help="small files created per client process (default: 1000)."
+        )
+
+        parser.addoption(
+            "--perf-listings",
+            action='store',
+            type=int,
+            default=10,
+            help="directory listings per client process (default: 10)."
+        )
+
+        parser.addoption(
+            "--perf-baseline",
+            action='store',
+            type=str,
+            default=None,
+            help="JSON file with baseline results that performance "
+                "scenarios are compared against."
+        )
+
+        parser.addoption(
+            "--perf-update-baseline",
+            action='store_true',
+            default=False,
+            help="store the results of the performance scenarios in the "
+                "baseline file instead of comparing against it."
+        )
+
+        parser.addoption(
+            "--perf-tolerance",
+            action='store',
+            type=float,
+            default=0.25,
+            help="fraction by which throughput may drop or latency may grow "
+                "before a scenario fails (default: 0.25)."
+        )
+
+        parser.addoption(
+            "--perf-results",
+            action='store',
+            type=str,
+            default=None,
+            help="JSON file to write the results of the performance "
+                "scenarios to."
+        )
     except ValueError:
         # if the CLI args have already been added, we have been called both
         # from the build directory's conftest.py and from the source
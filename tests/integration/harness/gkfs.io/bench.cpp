@@ -0,0 +1,346 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+
+/* C++ includes */
+#include <CLI/CLI.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <fmt/format.h>
+#include <commands.hpp>
+#include <reflection.hpp>
+#include <serialize.hpp>
+#include <binary_buffer.hpp>
+
+/* C includes */
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+using json = nlohmann::json;
+
+struct bench_options {
+    bool verbose;
+    std::string workload;
+    std::string pathname;
+    int rank;
+    int nranks;
+    bool shared;
+    bool random;
+    ::size_t block_size;
+    ::size_t count;
+    unsigned int seed;
+
+    REFL_DECL_STRUCT(bench_options,
+        REFL_DECL_MEMBER(bool, verbose),
+        REFL_DECL_MEMBER(std::string, workload),
+        REFL_DECL_MEMBER(std::string, pathname),
+        REFL_DECL_MEMBER(int, rank),
+        REFL_DECL_MEMBER(int, nranks),
+        REFL_DECL_MEMBER(bool, shared),
+        REFL_DECL_MEMBER(bool, random),
+        REFL_DECL_MEMBER(::size_t, block_size),
+        REFL_DECL_MEMBER(::size_t, count),
+        REFL_DECL_MEMBER(unsigned int, seed)
+    );
+};
+
+struct bench_output {
+    std::string workload;
+    uint64_t ops;
+    uint64_t bytes;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    std::vector<uint64_t> latencies_ns;
+    int errnum;
+
+    REFL_DECL_STRUCT(bench_output,
+        REFL_DECL_MEMBER(std::string, workload),
+        REFL_DECL_MEMBER(uint64_t, ops),
+        REFL_DECL_MEMBER(uint64_t, bytes),
+        REFL_DECL_MEMBER(uint64_t, start_ns),
+        REFL_DECL_MEMBER(uint64_t, end_ns),
+        REFL_DECL_MEMBER(std::vector<uint64_t>, latencies_ns),
+        REFL_DECL_MEMBER(int, errnum)
+    );
+};
+
+void
+to_json(json& record, 
+        const bench_output& out) {
+    record = serialize(out);
+}
+
+namespace {
+
+// CLOCK_MONOTONIC is system-wide, so timestamps of concurrent ranks can be compared
+uint64_t
+now_ns() {
+    struct ::timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// Times a single operation that returns -1 on failure
+template <typename Op>
+bool
+timed(bench_output& out, Op&& op) {
+    auto start = now_ns();
+    auto ret = op();
+    out.latencies_ns.push_back(now_ns() - start);
+    if(ret == -1) {
+        out.errnum = errno;
+        return false;
+    }
+    out.ops++;
+    return true;
+}
+
+// N-N: each rank uses its own file. N-1: all ranks interleave their blocks in a shared file, or append to it
+std::string
+data_file(const bench_options& opts) {
+    return opts.shared ? opts.pathname + "/shared" :
+                         fmt::format("{}/data.{}", opts.pathname, opts.rank);
+}
+
+::off_t
+block_offset(const bench_options& opts, ::size_t block) {
+    auto index = opts.shared ? block * opts.nranks + opts.rank : block;
+    return static_cast<::off_t>(index * opts.block_size);
+}
+
+// order in which a rank accesses its blocks
+std::vector<::size_t>
+block_order(const bench_options& opts) {
+    std::vector<::size_t> order(opts.count);
+    std::iota(order.begin(), order.end(), 0);
+    if(opts.random) {
+        std::mt19937 gen(opts.seed + opts.rank);
+        std::shuffle(order.begin(), order.end(), gen);
+    }
+    return order;
+}
+
+std::string
+small_file(const bench_options& opts, ::size_t i) {
+    return fmt::format("{}/file.{}.{}", opts.pathname, opts.rank, i);
+}
+
+void
+bench_data(const bench_options& opts, bench_output& out) {
+
+    const bool append = opts.workload == "append";
+    const bool write = opts.workload == "write" || append;
+    int flags = write ? O_CREAT | O_WRONLY : O_RDONLY;
+    if(append) {
+        flags |= O_APPEND;
+    }
+    int fd = ::open(data_file(opts).c_str(), flags, S_IRUSR | S_IWUSR);
+
+    if(fd == -1) {
+        out.errnum = errno;
+        return;
+    }
+
+    // random content, so that the daemons do not skip blocks of zeros
+    io::buffer buf(opts.block_size);
+    std::mt19937 gen(opts.seed);
+    std::generate(buf.m_data.begin(), buf.m_data.end(), [&gen]() { return static_cast<uint8_t>(gen()); });
+
+    for(auto block : block_order(opts)) {
+        auto offset = block_offset(opts, block);
+        bool ok = timed(out, [&]() -> ::ssize_t {
+            auto ret = append ? ::write(fd, buf.data(), opts.block_size) :
+                       write ? ::pwrite(fd, buf.data(), opts.block_size, offset) :
+                               ::pread(fd, buf.data(), opts.block_size, offset);
+            if(ret != -1 && static_cast<::size_t>(ret) != opts.block_size) {
+                errno = EIO;
+                return -1;
+            }
+            return ret;
+        });
+        if(!ok) {
+            break;
+        }
+        out.bytes += opts.block_size;
+    }
+
+    ::close(fd);
+}
+
+void
+bench_metadata(const bench_options& opts, bench_output& out) {
+
+    for(::size_t i = 0; i < opts.count; ++i) {
+        auto path = small_file(opts, i);
+        bool ok;
+        if(opts.workload == "create") {
+            ok = timed(out, [&]() {
+                int fd = ::open(path.c_str(), O_CREAT | O_EXCL | O_WRONLY, S_IRUSR | S_IWUSR);
+                return fd == -1 ? -1 : ::close(fd);
+            });
+        } else if(opts.workload == "stat") {
+            struct ::stat st;
+            ok = timed(out, [&]() { return ::stat(path.c_str(), &st); });
+        } else {
+            ok = timed(out, [&]() { return ::unlink(path.c_str()); });
+        }
+        if(!ok) {
+            break;
+        }
+    }
+}
+
+void
+bench_readdir(const bench_options& opts, bench_output& out) {
+
+    for(::size_t i = 0; i < opts.count; ++i) {
+        bool ok = timed(out, [&]() {
+            ::DIR* dirp = ::opendir(opts.pathname.c_str());
+            if(dirp == NULL) {
+                return -1;
+            }
+            errno = 0;
+            while(::readdir(dirp) != NULL) {
+            }
+            int err = errno;
+            ::closedir(dirp);
+            errno = err;
+            return err == 0 ? 0 : -1;
+        });
+        if(!ok) {
+            break;
+        }
+    }
+}
+
+} // namespace
+
+void 
+bench_exec(const bench_options& opts) {
+
+    bench_output out{opts.workload, 0, 0, 0, 0, {}, 0};
+    out.latencies_ns.reserve(opts.count);
+    out.start_ns = now_ns();
+
+    if(opts.workload == "write" || opts.workload == "append" || opts.workload == "read") {
+        bench_data(opts, out);
+    } else if(opts.workload == "readdir") {
+        bench_readdir(opts, out);
+    } else {
+        bench_metadata(opts, out);
+    }
+
+    out.end_ns = now_ns();
+
+    if(opts.verbose) {
+        fmt::print("bench(workload={}, pathname=\"{}\", rank={}/{}) = {} ops, {} bytes in {} ns, errno: {} [{}]\n",
+                   opts.workload, opts.pathname, opts.rank, opts.nranks, out.ops, out.bytes,
+                   out.end_ns - out.start_ns, out.errnum, ::strerror(out.errnum));
+        return;
+    }
+
+    json j = out;
+    fmt::print("{}\n", j.dump(2));
+}
+
+void
+bench_init(CLI::App& app) {
+
+    // Create the option and subcommand objects
+    auto opts = std::make_shared<bench_options>();
+    opts->rank = 0;
+    opts->nranks = 1;
+    opts->block_size = 524288;
+    opts->count = 64;
+    opts->seed = 42;
+    auto* cmd = app.add_subcommand(
+            "bench", 
+            "Run a workload and report the latency of each operation");
+
+    // Add options to cmd, binding them to opts
+    cmd->add_flag(
+            "-v,--verbose",
+            opts->verbose,
+            "Produce human readable output"
+        );
+
+    cmd->add_option(
+            "workload", 
+            opts->workload,
+            "Workload to run"
+        )
+        ->required()
+        ->check(CLI::IsMember({"write", "append", "read", "create", "stat", "remove", "readdir"}))
+        ->type_name("");
+
+    cmd->add_option(
+            "pathname", 
+            opts->pathname,
+            "Directory to run the workload in"
+        )
+        ->required()
+        ->type_name("");
+
+    cmd->add_option(
+            "--rank", 
+            opts->rank,
+            "Rank of this process (default: 0)"
+        );
+
+    cmd->add_option(
+            "--nranks", 
+            opts->nranks,
+            "Number of processes running the workload (default: 1)"
+        );
+
+    cmd->add_flag(
+            "--shared",
+            opts->shared,
+            "Access a single shared file (N-1) instead of a file per rank (N-N)"
+        );
+
+    cmd->add_flag(
+            "--random",
+            opts->random,
+            "Access blocks in random order"
+        );
+
+    cmd->add_option(
+            "--block-size", 
+            opts->block_size,
+            "Bytes per read or write (default: 524288)"
+        );
+
+    cmd->add_option(
+            "--count", 
+            opts->count,
+            "Number of blocks, files or directory listings per rank (default: 64)"
+        );
+
+    cmd->add_option(
+            "--seed", 
+            opts->seed,
+            "Seed for the data and the random block order (default: 42)"
+        );
+
+    cmd->callback([opts]() { 
+        bench_exec(*opts); 
+    });
+}
@@ -44,6 +44,12 @@ readdir_init(CLI::App& app);
 void
 rmdir_init(CLI::App& app);
 
+void
+unlink_init(CLI::App& app);
+
+void
+truncate_init(CLI::App& app);
+
 void
 stat_init(CLI::App& app);
 
@@ -67,4 +73,7 @@ statx_init(CLI::App& app);
 void
 lseek_init(CLI::App& app);
 
+void
+bench_init(CLI::App& app);
+
 #endif // IO_COMMANDS_HPP
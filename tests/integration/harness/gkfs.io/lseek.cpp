@@ -65,6 +65,8 @@ whence2str(int whence) {
        case SEEK_SET : return "SEEK_SET";
        case SEEK_CUR : return "SEEK_CUR";
        case SEEK_END : return "SEEK_END";
+       case SEEK_DATA : return "SEEK_DATA";
+       case SEEK_HOLE : return "SEEK_HOLE";
        default : return "UNKNOWN";
    }
     return "UNKNOWN";
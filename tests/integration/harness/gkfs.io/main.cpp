@@ -29,6 +29,8 @@ init_commands(CLI::App& app) {
     preadv_init(app);
     readdir_init(app);
     rmdir_init(app);
+    unlink_init(app);
+    truncate_init(app);
     stat_init(app);
     write_init(app);
     pwrite_init(app);
@@ -38,6 +40,7 @@ init_commands(CLI::App& app) {
     statx_init(app);
     #endif
     lseek_init(app);
+    bench_init(app);
 }
 
 
@@ -0,0 +1,107 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+/* C++ includes */
+#include <CLI/CLI.hpp>
+#include <nlohmann/json.hpp>
+#include <memory>
+#include <fmt/format.h>
+#include <commands.hpp>
+#include <reflection.hpp>
+#include <serialize.hpp>
+
+/* C includes */
+#include <sys/types.h>
+#include <unistd.h>
+
+using json = nlohmann::json;
+
+struct truncate_options {
+    bool verbose;
+    std::string pathname;
+    ::off_t length;
+
+    REFL_DECL_STRUCT(truncate_options,
+        REFL_DECL_MEMBER(bool, verbose),
+        REFL_DECL_MEMBER(std::string, pathname),
+        REFL_DECL_MEMBER(::off_t, length)
+    );
+};
+
+struct truncate_output {
+    int retval;
+    int errnum;
+
+    REFL_DECL_STRUCT(truncate_output,
+        REFL_DECL_MEMBER(int, retval),
+        REFL_DECL_MEMBER(int, errnum)
+    );
+};
+
+void
+to_json(json& record,
+        const truncate_output& out) {
+    record = serialize(out);
+}
+
+void
+truncate_exec(const truncate_options& opts) {
+
+    int rv = ::truncate(opts.pathname.c_str(), opts.length);
+
+    if(opts.verbose) {
+        fmt::print("truncate(pathname=\"{}\", length={}) = {}, errno: {} [{}]\n",
+                opts.pathname, opts.length, rv, errno, ::strerror(errno));
+        return;
+    }
+
+    json out = truncate_output{rv, errno};
+    fmt::print("{}\n", out.dump(2));
+}
+
+void
+truncate_init(CLI::App& app) {
+
+    // Create the option and subcommand objects
+    auto opts = std::make_shared<truncate_options>();
+    auto* cmd = app.add_subcommand(
+            "truncate",
+            "Execute the truncate() system call");
+
+    // Add options to cmd, binding them to opts
+    cmd->add_flag(
+            "-v,--verbose",
+            opts->verbose,
+            "Produce human readable output"
+        );
+
+    cmd->add_option(
+            "pathname",
+            opts->pathname,
+            "File name"
+        )
+        ->required()
+        ->type_name("");
+
+    cmd->add_option(
+            "length",
+            opts->length,
+            "New size of the file"
+        )
+        ->required()
+        ->type_name("");
+
+    cmd->callback([opts]() {
+        truncate_exec(*opts);
+    });
+}
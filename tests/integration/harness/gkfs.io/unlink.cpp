@@ -0,0 +1,96 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+/* C++ includes */
+#include <CLI/CLI.hpp>
+#include <nlohmann/json.hpp>
+#include <memory>
+#include <fmt/format.h>
+#include <commands.hpp>
+#include <reflection.hpp>
+#include <serialize.hpp>
+
+/* C includes */
+#include <unistd.h>
+
+using json = nlohmann::json;
+
+struct unlink_options {
+    bool verbose;
+    std::string pathname;
+
+    REFL_DECL_STRUCT(unlink_options,
+        REFL_DECL_MEMBER(bool, verbose),
+        REFL_DECL_MEMBER(std::string, pathname)
+    );
+};
+
+struct unlink_output {
+    int retval;
+    int errnum;
+
+    REFL_DECL_STRUCT(unlink_output,
+        REFL_DECL_MEMBER(int, retval),
+        REFL_DECL_MEMBER(int, errnum)
+    );
+};
+
+void
+to_json(json& record,
+        const unlink_output& out) {
+    record = serialize(out);
+}
+
+void
+unlink_exec(const unlink_options& opts) {
+
+    int rv = ::unlink(opts.pathname.c_str());
+
+    if(opts.verbose) {
+        fmt::print("unlink(pathname=\"{}\") = {}, errno: {} [{}]\n",
+                opts.pathname, rv, errno, ::strerror(errno));
+        return;
+    }
+
+    json out = unlink_output{rv, errno};
+    fmt::print("{}\n", out.dump(2));
+}
+
+void
+unlink_init(CLI::App& app) {
+
+    // Create the option and subcommand objects
+    auto opts = std::make_shared<unlink_options>();
+    auto* cmd = app.add_subcommand(
+            "unlink",
+            "Execute the unlink() system call");
+
+    // Add options to cmd, binding them to opts
+    cmd->add_flag(
+            "-v,--verbose",
+            opts->verbose,
+            "Produce human readable output"
+        );
+
+    cmd->add_option(
+            "pathname",
+            opts->pathname,
+            "File name"
+        )
+        ->required()
+        ->type_name("");
+
+    cmd->callback([opts]() {
+        unlink_exec(*opts);
+    });
+}
@@ -34,12 +34,14 @@ struct write_options {
     std::string pathname;
     std::string data;
     ::size_t count;
+    bool append;
 
     REFL_DECL_STRUCT(write_options,
         REFL_DECL_MEMBER(bool, verbose),
         REFL_DECL_MEMBER(std::string, pathname),
         REFL_DECL_MEMBER(std::string, data),
-        REFL_DECL_MEMBER(::size_t, count)
+        REFL_DECL_MEMBER(::size_t, count),
+        REFL_DECL_MEMBER(bool, append)
     );
 };
 
@@ -62,7 +64,7 @@ to_json(json& record,
 void 
 write_exec(const write_options& opts) {
 
-    int fd = ::open(opts.pathname.c_str(), O_WRONLY);
+    int fd = ::open(opts.pathname.c_str(), opts.append ? O_WRONLY | O_APPEND : O_WRONLY);
 
     if(fd == -1) {
         if(opts.verbose) {
@@ -130,6 +132,12 @@ write_init(CLI::App& app) {
         ->required()
         ->type_name("");
 
+    cmd->add_flag(
+            "--append",
+            opts->append,
+            "Open the file with O_APPEND"
+        );
+
     cmd->callback([opts]() { 
         write_exec(*opts); 
     });
@@ -141,10 +141,11 @@ def _process_exists(pid):
     return True
 
 class Daemon:
-    def __init__(self, interface, workspace):
+    def __init__(self, interface, workspace, extra_args=None):
 
         self._address = get_ephemeral_address(interface)
         self._workspace = workspace
+        self._extra_args = list(extra_args or [])
 
         self._cmd = sh.Command(gkfs_daemon_cmd, self._workspace.bindirs)
         self._env = os.environ.copy()
@@ -165,7 +166,7 @@ class Daemon:
 
         args = [ '--mountdir', self.mountdir,
                  '--rootdir', self.rootdir,
-                 '-l', self._address ]
+                 '-l', self._address ] + self._extra_args
 
         logger.debug(f"spawning daemon")
         logger.debug(f"cmdline: {self._cmd} " + " ".join(map(str, args)))
@@ -220,6 +220,26 @@ class RmdirOutputSchema(Schema):
     def make_object(self, data, **kwargs):
         return namedtuple('RmdirReturn', ['retval', 'errno'])(**data)
 
+class UnlinkOutputSchema(Schema):
+    """Schema to deserialize the results of an unlink() execution"""
+
+    retval = fields.Integer(required=True)
+    errno = Errno(data_key='errnum', required=True)
+
+    @post_load
+    def make_object(self, data, **kwargs):
+        return namedtuple('UnlinkReturn', ['retval', 'errno'])(**data)
+
+class TruncateOutputSchema(Schema):
+    """Schema to deserialize the results of a truncate() execution"""
+
+    retval = fields.Integer(required=True)
+    errno = Errno(data_key='errnum', required=True)
+
+    @post_load
+    def make_object(self, data, **kwargs):
+        return namedtuple('TruncateReturn', ['retval', 'errno'])(**data)
+
 class WriteOutputSchema(Schema):
     """Schema to deserialize the results of a write() execution"""
 
@@ -305,6 +325,8 @@ class IOParser:
         'preadv'  : PreadvOutputSchema(),
         'readdir' : ReaddirOutputSchema(),
         'rmdir'   : RmdirOutputSchema(),
+        'unlink'  : UnlinkOutputSchema(),
+        'truncate': TruncateOutputSchema(),
         'write'   : WriteOutputSchema(),
         'pwrite'  : PwriteOutputSchema(),
         'writev'  : WritevOutputSchema(),
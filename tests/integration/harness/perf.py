@@ -0,0 +1,366 @@
+################################################################################
+#  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain           #
+#  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany         #
+#                                                                              #
+#  This software was partially supported by the                                #
+#  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).   #
+#                                                                              #
+#  This software was partially supported by the                                #
+#  ADA-FS project under the SPPEXA project funded by the DFG.                  #
+#                                                                              #
+#  SPDX-License-Identifier: MIT                                                #
+################################################################################
+
+
+import os, json
+from collections import namedtuple
+from pathlib import Path
+from harness.logger import logger
+from harness.gkfs import Daemon, Client
+
+### performance runs must not be slowed down by logging
+gkfs_perf_daemon_log_level = '3'
+gkfs_perf_client_log_level = 'none'
+
+Phase = namedtuple('Phase', ['workload', 'args'])
+# `load` optionally runs in other client processes while `measure` is measured
+Scenario = namedtuple('Scenario', ['name', 'setup', 'measure', 'load'])
+Scenario.__new__.__defaults__ = (None,)
+
+def _data_scenarios(prefix, args):
+    """
+    Sequential and random writes and reads of a file per client (N-N) or a
+    shared file (N-1). Reads run on data written sequentially beforehand.
+    """
+
+    write = Phase('write', args)
+
+    return [
+        Scenario(f'{prefix}-seq-write',    [], write),
+        Scenario(f'{prefix}-seq-read',     [write], Phase('read', args)),
+        Scenario(f'{prefix}-random-write', [], Phase('write', args + ['--random'])),
+        Scenario(f'{prefix}-random-read',  [write], Phase('read', args + ['--random'])),
+    ]
+
+_create = Phase('create', [])
+
+SCENARIOS = _data_scenarios('nn', []) + _data_scenarios('n1', ['--shared']) + [
+    Scenario('small-file-create', [], _create),
+    Scenario('small-file-stat',   [_create], Phase('stat', [])),
+    Scenario('small-file-remove', [_create], Phase('remove', [])),
+    Scenario('readdir-large',     [_create], Phase('readdir', [])),
+    # per-write latency of small writes, dominated by round trips rather
+    # than by the data transfer
+    Scenario('small-write-latency', [], Phase('write', ['--block-size', 4096])),
+    # all clients append small records to one shared log
+    Scenario('n1-append', [], Phase('append', ['--shared', '--block-size', 4096])),
+    # metadata latency while the data path is saturated, compare with
+    # small-file-stat
+    Scenario('stat-under-write-load', [_create], Phase('stat', []),
+             load=Phase('write', [])),
+]
+
+class PerfOptions(namedtuple('PerfOptions',
+        ['daemons', 'clients', 'block_size', 'blocks', 'files', 'listings'])):
+    """
+    Size of a performance run: number of daemons and client processes, and
+    the amount of work per client process.
+    """
+
+    @classmethod
+    def from_config(cls, config):
+        return cls(config.getoption('--perf-daemons'),
+                   config.getoption('--perf-clients'),
+                   config.getoption('--perf-block-size'),
+                   config.getoption('--perf-blocks'),
+                   config.getoption('--perf-files'),
+                   config.getoption('--perf-listings'))
+
+    def count_args(self, workload):
+        if workload in ('write', 'append', 'read'):
+            return ['--block-size', self.block_size, '--count', self.blocks]
+        if workload == 'readdir':
+            return ['--count', self.listings]
+        return ['--count', self.files]
+
+class PerfResult:
+    """
+    Aggregated results of all client processes of a workload. Throughput is
+    computed over the time from the first process starting the workload to
+    the last one finishing it.
+    """
+
+    def __init__(self, workload, outputs):
+        self._workload = workload
+        self._ops = sum(o['ops'] for o in outputs)
+        self._bytes = sum(o['bytes'] for o in outputs)
+        self._elapsed = (max(o['end_ns'] for o in outputs) -
+                         min(o['start_ns'] for o in outputs)) / 1e9
+        self._latencies = sorted(l for o in outputs for l in o['latencies_ns'])
+
+    def percentile(self, p):
+        """Latency percentile in microseconds (nearest rank)"""
+
+        if not self._latencies:
+            return 0.0
+
+        rank = min(len(self._latencies) - 1, int(p * len(self._latencies)))
+        return self._latencies[rank] / 1000.0
+
+    def summary(self):
+        elapsed = max(self._elapsed, 1e-9)
+
+        return {
+            'workload'  : self._workload,
+            'ops'       : self._ops,
+            'bytes'     : self._bytes,
+            'elapsed_s' : self._elapsed,
+            'ops_per_s' : self._ops / elapsed,
+            'mib_per_s' : self._bytes / elapsed / (1024 * 1024),
+            'p50_us'    : self.percentile(0.5),
+            'p90_us'    : self.percentile(0.9),
+            'p99_us'    : self.percentile(0.99),
+            'p999_us'   : self.percentile(0.999),
+            'max_us'    : self.percentile(1.0),
+        }
+
+class PerfDaemon(Daemon):
+    """
+    A daemon of a local performance cluster. Each daemon gets its own root
+    and log directory in the workspace while all of them share the hosts
+    file.
+    """
+
+    def __init__(self, interface, workspace, index):
+        self._rootdir = workspace.rootdir / f'daemon{index}'
+        self._logdir = workspace.logdir / f'daemon{index}'
+        self._rootdir.mkdir()
+        self._logdir.mkdir()
+
+        super().__init__(interface, workspace)
+
+        self._patched_env['GKFS_LOG_LEVEL'] = gkfs_perf_daemon_log_level
+        self._env.update(self._patched_env)
+
+    @property
+    def rootdir(self):
+        return self._rootdir
+
+    @property
+    def logdir(self):
+        return self._logdir
+
+class PerfCluster:
+    """
+    K daemons on the local host, reachable through the interface of the
+    test run. The RPC protocol (e.g., ofi+sockets or na+sm) is the one
+    GekkoFS was built with.
+    """
+
+    def __init__(self, interface, workspace, daemons):
+        self._workspace = workspace
+        self._daemons = [PerfDaemon(interface, workspace, i)
+                            for i in range(daemons)]
+        self._running = []
+
+    def run(self):
+        # daemons are started one after the other so that their order in
+        # the hosts file is the same for all clients
+        try:
+            for d in self._daemons:
+                self._running.append(d.run())
+        except Exception:
+            self.shutdown()
+            raise
+
+        return self
+
+    def shutdown(self):
+        while self._running:
+            self._running.pop().shutdown()
+
+    @property
+    def mountdir(self):
+        return self._workspace.mountdir
+
+    @property
+    def daemons(self):
+        return self._running
+
+class PerfClient(Client):
+    """
+    A client that runs workloads of the `gkfs.io bench` command in several
+    concurrent processes.
+    """
+
+    def __init__(self, workspace):
+        super().__init__(workspace)
+
+        self._patched_env['LIBGKFS_LOG'] = gkfs_perf_client_log_level
+        self._env.update(self._patched_env)
+
+    def bench(self, workload, pathname, nprocs, *args, timeout=600):
+        """
+        Run a workload in `nprocs` processes and return their aggregated
+        `PerfResult`.
+        """
+
+        procs = self.bench_start(workload, pathname, nprocs, *args,
+                                 timeout=timeout)
+        return self.bench_wait(workload, procs)
+
+    def bench_start(self, workload, pathname, nprocs, *args, timeout=600):
+        """
+        Start a workload in `nprocs` processes in the background. The
+        processes are passed to `bench_wait()`.
+        """
+
+        args = [ str(a) for a in args ]
+
+        logger.debug(f"running workload '{workload}' in {nprocs} processes")
+        logger.debug(f"cmdline: {self._cmd} bench {workload} {pathname} " +
+                     " ".join(args))
+
+        return [ self._cmd(['bench', workload, pathname,
+                            '--rank', rank, '--nranks', nprocs] + args,
+                           _env=self._env,
+                           _bg=True,
+                           _timeout=timeout)
+                 for rank in range(nprocs) ]
+
+    def bench_wait(self, workload, procs):
+        """
+        Wait for the processes of a workload and return their aggregated
+        `PerfResult`.
+        """
+
+        outputs = []
+        for rank, proc in enumerate(procs):
+            proc.wait()
+            out = json.loads(proc.stdout)
+
+            if out['errnum'] != 0:
+                raise RuntimeError(f"workload '{workload}' failed in process "
+                                   f"{rank}: {os.strerror(out['errnum'])}")
+            outputs.append(out)
+
+        return PerfResult(workload, outputs)
+
+class PerfRunner:
+    """
+    Runs the setup phases of a scenario and measures its final phase.
+    """
+
+    def __init__(self, cluster, client, options):
+        self._cluster = cluster
+        self._client = client
+        self._options = options
+
+    def run(self, scenario):
+        pathname = self._cluster.mountdir / scenario.name
+        ret = self._client.mkdir(pathname, 0o755)
+
+        if ret.retval != 0:
+            raise RuntimeError(f"mkdir {pathname} failed: "
+                               f"{os.strerror(ret.errno)}")
+
+        for phase in scenario.setup:
+            logger.info(f"{scenario.name}: setup {phase.workload}")
+            self._run_phase(phase, pathname)
+
+        load = None
+        if scenario.load:
+            logger.info(f"{scenario.name}: starting load {scenario.load.workload}")
+            load = self._client.bench_start(scenario.load.workload, pathname,
+                                            self._options.clients,
+                                            *self._phase_args(scenario.load))
+
+        logger.info(f"{scenario.name}: measuring {scenario.measure.workload}")
+        result = self._run_phase(scenario.measure, pathname).summary()
+        logger.info(f"{scenario.name}: {json.dumps(result)}")
+
+        if load:
+            load_result = self._client.bench_wait(scenario.load.workload, load)
+            logger.info(f"{scenario.name}: load "
+                        f"{json.dumps(load_result.summary())}")
+
+        return result
+
+    def _run_phase(self, phase, pathname):
+        return self._client.bench(phase.workload, pathname,
+                                  self._options.clients,
+                                  *self._phase_args(phase))
+
+    def _phase_args(self, phase):
+        # options given by the scenario take precedence over the run's defaults
+        defaults = self._options.count_args(phase.workload)
+        args = list(phase.args)
+        for opt, value in zip(defaults[::2], defaults[1::2]):
+            if opt not in phase.args:
+                args += [opt, value]
+        return args
+
+class PerfRecorder:
+    """
+    Collects the results of all scenarios of a test session and compares them
+    against a stored baseline. A result regresses if its throughput drops or
+    its median or 99th percentile latency grows by more than `tolerance`
+    (a fraction) compared to the baseline.
+    """
+
+    throughput_metrics = [ 'ops_per_s', 'mib_per_s' ]
+    latency_metrics = [ 'p50_us', 'p99_us' ]
+
+    def __init__(self, baseline, tolerance, update_baseline=False, output=None):
+        self._baseline_path = Path(baseline) if baseline else None
+        self._tolerance = tolerance
+        self._update_baseline = update_baseline
+        self._output = Path(output) if output else None
+        self._baseline = {}
+        self._results = {}
+
+        if self._baseline_path and self._baseline_path.exists():
+            with open(self._baseline_path) as f:
+                self._baseline = json.load(f)['scenarios']
+
+    def record(self, name, result):
+        """
+        Record the result of a scenario and return a list of its regressions
+        against the baseline, if any.
+        """
+
+        self._results[name] = result
+
+        if self._update_baseline or name not in self._baseline:
+            return []
+
+        base = self._baseline[name]
+        regressions = []
+
+        for m in self.throughput_metrics:
+            if base[m] > 0 and result[m] < base[m] * (1 - self._tolerance):
+                regressions.append(f"{name}: {m} dropped from {base[m]:.1f} "
+                                   f"to {result[m]:.1f}")
+
+        for m in self.latency_metrics:
+            if base[m] > 0 and result[m] > base[m] * (1 + self._tolerance):
+                regressions.append(f"{name}: {m} grew from {base[m]:.1f} "
+                                   f"to {result[m]:.1f}")
+
+        return regressions
+
+    def save(self):
+        if not self._results:
+            return
+
+        if self._output:
+            self._write(self._output, self._results)
+
+        if self._update_baseline and self._baseline_path:
+            self._baseline.update(self._results)
+            self._write(self._baseline_path, self._baseline)
+
+    @staticmethod
+    def _write(path, scenarios):
+        with open(path, 'w') as f:
+            json.dump({'scenarios': scenarios}, f, indent=2, sort_keys=True)
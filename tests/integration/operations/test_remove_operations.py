@@ -0,0 +1,66 @@
+################################################################################
+#  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain           #
+#  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany         #
+#                                                                              #
+#  This software was partially supported by the                                #
+#  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).   #
+#                                                                              #
+#  This software was partially supported by the                                #
+#  ADA-FS project under the SPPEXA project funded by the DFG.                  #
+#                                                                              #
+#  SPDX-License-Identifier: MIT                                                #
+################################################################################
+
+import harness
+from pathlib import Path
+import errno
+import stat
+import os
+import time
+import pytest
+from harness.logger import logger
+
+# gkfs::config::rpc::chunksize
+chunksize = 512 * 1024
+nchunks = 16
+
+def chunk_files(daemon, name):
+    """Chunk files of a file on a daemon, including those detached for reclamation"""
+
+    data = Path(daemon.rootdir) / 'data'
+    return list((data / 'chunks' / name).glob('*')) + \
+           list((data / 'reclaim').glob('*/*'))
+
+def test_unlink_reclaims_chunks(gkfs_cluster, gkfs_client):
+    """Chunks of a removed file are deleted from every daemon"""
+
+    file = gkfs_cluster.mountdir / "file"
+
+    ret = gkfs_client.open(file,
+                           os.O_CREAT | os.O_WRONLY,
+                           stat.S_IRWXU | stat.S_IRWXG | stat.S_IRWXO)
+
+    assert ret.retval == 10000
+
+    # one byte pair per chunk, starting from the end so that the file is never
+    # stored inline in its metadentry
+    buf = b'42'
+    for i in reversed(range(nchunks)):
+        ret = gkfs_client.pwrite(file, buf, len(buf), i * chunksize)
+        assert ret.retval == len(buf)
+
+    holders = [ d for d in gkfs_cluster.daemons if chunk_files(d, "file") ]
+    assert len(holders) > 1
+
+    ret = gkfs_client.unlink(file)
+    assert ret.retval == 0
+
+    # daemons delete the chunks in the background
+    deadline = time.monotonic() + 10
+    while any(chunk_files(d, "file") for d in gkfs_cluster.daemons):
+        assert time.monotonic() < deadline, "chunks left behind after unlink"
+        time.sleep(0.1)
+
+    ret = gkfs_client.stat(file)
+    assert ret.retval == -1
+    assert ret.errno == errno.ENOENT
@@ -95,3 +95,143 @@ def test_pwritev(gkfs_daemon, gkfs_client):
 
     assert ret.retval == len(buf_0) + len(buf_1) # Return the number of written bytes
     assert ret.errno == 115 #FIXME: Should be 0!
+
+def test_append(gkfs_daemon, gkfs_client):
+
+    file = gkfs_daemon.mountdir / "file"
+
+    ret = gkfs_client.open(file,
+                           os.O_CREAT | os.O_WRONLY | os.O_APPEND,
+                           stat.S_IRWXU | stat.S_IRWXG | stat.S_IRWXO)
+
+    assert ret.retval == 10000
+    assert ret.errno == 115 #FIXME: Should be 0!
+
+    # the first write is at offset 0, the appends follow it whatever the
+    # position of their file descriptor
+    buf_0 = b'42'
+    ret = gkfs_client.write(file, buf_0, len(buf_0))
+
+    assert ret.retval == len(buf_0)
+
+    buf_1 = b'24'
+    for _ in range(2):
+        ret = gkfs_client.write(file, buf_1, len(buf_1), '--append')
+
+        assert ret.retval == len(buf_1) # Return the number of written bytes
+        assert ret.errno == 115 #FIXME: Should be 0!
+
+    ret = gkfs_client.open(file,
+                           os.O_RDONLY,
+                           stat.S_IRWXU | stat.S_IRWXG | stat.S_IRWXO)
+
+    assert ret.retval == 10000
+
+    expected = buf_0 + buf_1 + buf_1
+    ret = gkfs_client.read(file, len(expected))
+
+    assert ret.buf == expected
+    assert ret.retval == len(expected)
+
+inline_data_size = 4096
+
+@pytest.mark.parametrize('gkfs_daemon',
+                         [['--inline-data-size', str(inline_data_size)]],
+                         indirect=True)
+def test_inline_data(gkfs_daemon, gkfs_client):
+
+    file = gkfs_daemon.mountdir / "file"
+
+    ret = gkfs_client.open(file,
+                           os.O_CREAT | os.O_WRONLY,
+                           stat.S_IRWXU | stat.S_IRWXG | stat.S_IRWXO)
+
+    assert ret.retval == 10000
+
+    # a small file is stored in its metadentry
+    buf_0 = b'x' * 100
+    ret = gkfs_client.write(file, buf_0, len(buf_0))
+
+    assert ret.retval == len(buf_0)
+
+    ret = gkfs_client.read(file, len(buf_0))
+
+    assert ret.buf == buf_0
+    assert ret.retval == len(buf_0)
+
+    ret = gkfs_client.stat(file)
+
+    assert ret.retval == 0
+    assert ret.statbuf.st_size == len(buf_0)
+
+    # growing it past the inline data size moves the content to chunks
+    buf_1 = b'y' * 1000
+    offset = inline_data_size - 96
+    ret = gkfs_client.pwrite(file, buf_1, len(buf_1), offset)
+
+    assert ret.retval == len(buf_1)
+
+    expected = buf_0 + b'\0' * (offset - len(buf_0)) + buf_1
+    ret = gkfs_client.read(file, len(expected))
+
+    assert ret.buf == expected
+    assert ret.retval == len(expected)
+
+    ret = gkfs_client.stat(file)
+
+    assert ret.retval == 0
+    assert ret.statbuf.st_size == len(expected)
+
+@pytest.mark.parametrize('gkfs_daemon',
+                         [['--inline-data-size', str(inline_data_size)]],
+                         indirect=True)
+def test_inline_data_truncate(gkfs_daemon, gkfs_client):
+
+    file = gkfs_daemon.mountdir / "file"
+
+    ret = gkfs_client.open(file,
+                           os.O_CREAT | os.O_WRONLY,
+                           stat.S_IRWXU | stat.S_IRWXG | stat.S_IRWXO)
+
+    assert ret.retval == 10000
+
+    buf_0 = b'x' * 100
+    ret = gkfs_client.write(file, buf_0, len(buf_0))
+
+    assert ret.retval == len(buf_0)
+
+    ret = gkfs_client.truncate(file, 10)
+
+    assert ret.retval == 0
+
+    ret = gkfs_client.stat(file)
+
+    assert ret.retval == 0
+    assert ret.statbuf.st_size == 10
+
+    # extending the file again must not bring back the cut bytes, neither
+    # while it is inline nor after it was moved to chunks
+    buf_1 = b'y'
+    ret = gkfs_client.pwrite(file, buf_1, len(buf_1), 50)
+
+    assert ret.retval == len(buf_1)
+
+    expected = buf_0[:10] + b'\0' * 40 + buf_1
+    ret = gkfs_client.read(file, len(expected))
+
+    assert ret.buf == expected
+    assert ret.retval == len(expected)
+
+    ret = gkfs_client.truncate(file, 10)
+
+    assert ret.retval == 0
+
+    ret = gkfs_client.pwrite(file, buf_1, len(buf_1), inline_data_size)
+
+    assert ret.retval == len(buf_1)
+
+    expected = buf_0[:10] + b'\0' * (inline_data_size - 10) + buf_1
+    ret = gkfs_client.read(file, len(expected))
+
+    assert ret.buf == expected
+    assert ret.retval == len(expected)
@@ -0,0 +1,26 @@
+################################################################################
+#  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain           #
+#  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany         #
+#                                                                              #
+#  This software was partially supported by the                                #
+#  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).   #
+#                                                                              #
+#  This software was partially supported by the                                #
+#  ADA-FS project under the SPPEXA project funded by the DFG.                  #
+#                                                                              #
+#  SPDX-License-Identifier: MIT                                                #
+################################################################################
+
+
+import pytest
+from harness.perf import SCENARIOS
+
+@pytest.mark.parametrize("scenario", SCENARIOS, ids=[s.name for s in SCENARIOS])
+def test_perf(gkfs_perf, perf_recorder, scenario):
+    """Measure a scenario and compare it against the baseline"""
+
+    result = gkfs_perf.run(scenario)
+
+    assert result['ops'] > 0
+    regressions = perf_recorder.record(scenario.name, result)
+    assert not regressions, "\n".join(regressions)
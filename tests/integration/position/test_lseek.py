@@ -122,3 +122,41 @@ def test_lseek(gkfs_daemon, gkfs_client):
     return
 
 
+def test_lseek_data_hole(gkfs_daemon, gkfs_client):
+    """Test SEEK_DATA and SEEK_HOLE on a sparse file"""
+    file_a = gkfs_daemon.mountdir / "sparse_file"
+    chunksize = 512 * 1024
+
+    ret = gkfs_client.open(file_a,
+                           os.O_CREAT | os.O_WRONLY,
+                           stat.S_IRWXU | stat.S_IRWXG | stat.S_IRWXO)
+    assert ret.retval != -1
+
+    # data at the start and in the fifth chunk, everything in between is a hole
+    buf = b'42'
+    ret = gkfs_client.pwrite(file_a, buf, len(buf), 0)
+    assert ret.retval == len(buf)
+
+    ret = gkfs_client.pwrite(file_a, buf, len(buf), 4 * chunksize)
+    assert ret.retval == len(buf)
+
+    ret = gkfs_client.lseek(file_a, 0, os.SEEK_DATA)
+    assert ret.retval == 0
+
+    ret = gkfs_client.lseek(file_a, 0, os.SEEK_HOLE)
+    assert ret.retval == len(buf)
+
+    ret = gkfs_client.lseek(file_a, len(buf), os.SEEK_DATA)
+    assert ret.retval == 4 * chunksize
+
+    ret = gkfs_client.lseek(file_a, 4 * chunksize, os.SEEK_HOLE)
+    assert ret.retval == 4 * chunksize + len(buf)
+
+    ret = gkfs_client.lseek(file_a, 4 * chunksize + len(buf), os.SEEK_DATA)
+    assert ret.retval == -1
+    assert ret.errno == errno.ENXIO
+
+    # holes read as zeros
+    ret = gkfs_client.pread(file_a, 8, chunksize)
+    assert ret.retval == 8
+    assert ret.buf == bytes(8)
@@ -0,0 +1,76 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <benchmark/benchmark.h>
+#include <global/chunk_calc_util.hpp>
+#include <config.hpp>
+
+#include <random>
+#include <vector>
+
+using namespace gkfs::util;
+
+namespace {
+
+constexpr size_t chunksize = gkfs::config::rpc::chunksize;
+
+// offsets and sizes of a mix of small and large unaligned requests
+std::vector<std::pair<off64_t, size_t>> requests() {
+    std::mt19937_64 gen(42);
+    std::uniform_int_distribution<off64_t> offset(0, off64_t(1) << 40);
+    std::uniform_int_distribution<size_t> size(1, 16 * chunksize);
+    std::vector<std::pair<off64_t, size_t>> reqs(1024);
+    for (auto& r : reqs) {
+        r = std::make_pair(offset(gen), size(gen));
+    }
+    return reqs;
+}
+
+} // namespace
+
+static void BM_chnk_id_for_offset(benchmark::State& state) {
+    auto reqs = requests();
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(chnk_id_for_offset(reqs[i++ % reqs.size()].first, chunksize));
+    }
+}
+
+BENCHMARK(BM_chnk_id_for_offset);
+
+static void BM_chnk_count_for_offset(benchmark::State& state) {
+    auto reqs = requests();
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& r = reqs[i++ % reqs.size()];
+        benchmark::DoNotOptimize(chnk_count_for_offset(r.first, r.second, chunksize));
+    }
+}
+
+BENCHMARK(BM_chnk_count_for_offset);
+
+// everything a client computes to split a request into chunks
+static void BM_chunk_request_split(benchmark::State& state) {
+    auto reqs = requests();
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& r = reqs[i++ % reqs.size()];
+        benchmark::DoNotOptimize(chnk_lalign(r.first, chunksize));
+        benchmark::DoNotOptimize(chnk_ralign(r.first + r.second, chunksize));
+        benchmark::DoNotOptimize(chnk_lpad(r.first, chunksize));
+        benchmark::DoNotOptimize(chnk_rpad(r.first + r.second, chunksize));
+        benchmark::DoNotOptimize(chnk_id_for_offset(r.first + r.second - 1, chunksize));
+    }
+}
+
+BENCHMARK(BM_chunk_request_split);
@@ -0,0 +1,115 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <benchmark/benchmark.h>
+#include <daemon/backend/data/chunk_storage.hpp>
+#include <config.hpp>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/null_sink.h>
+
+extern "C" {
+#include <abt.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace gkfs::data;
+
+namespace {
+
+constexpr size_t chunksize = gkfs::config::rpc::chunksize;
+
+/*
+ * Chunk storage in GKFS_BENCH_DIR, /dev/shm by default, so that the benchmarks measure the chunk storage
+ * code and system calls rather than the disk
+ */
+std::string root_path;
+
+ChunkStorage& storage() {
+    static std::unique_ptr<ChunkStorage> storage = [] {
+        ABT_init(0, nullptr);
+        spdlog::create<spdlog::sinks::null_sink_mt>("ChunkStorage");
+        auto dir = getenv("GKFS_BENCH_DIR");
+        root_path = std::string(dir != nullptr ? dir : "/dev/shm") + "/gkfs_microbench_" + std::to_string(getpid());
+        mkdir(root_path.c_str(), 0750);
+        // the benchmarks remove their chunks, which leaves the empty root directory
+        atexit([] { rmdir(root_path.c_str()); });
+        return std::unique_ptr<ChunkStorage>(new ChunkStorage(root_path, chunksize));
+    }();
+    return *storage;
+}
+
+ssize_t wait(ABT_eventual& eventual) {
+    ssize_t* result = nullptr;
+    ABT_eventual_wait(eventual, reinterpret_cast<void**>(&result));
+    auto ret = *result;
+    ABT_eventual_free(&eventual);
+    return ret;
+}
+
+} // namespace
+
+static void BM_chunk_storage_write(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    const std::string file = "/bench_write";
+    std::vector<char> buf(size, 'x');
+    unsigned int chunk_id = 0;
+    try {
+        for (auto _ : state) {
+            ABT_eventual eventual;
+            ABT_eventual_create(sizeof(ssize_t), &eventual);
+            storage().write_chunk(file, chunk_id++ % 16, buf.data(), size, 0, chunksize, eventual);
+            benchmark::DoNotOptimize(wait(eventual));
+        }
+    } catch (const std::exception& e) {
+        state.SkipWithError(e.what());
+    }
+    storage().destroy_chunk_space(file);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+}
+
+BENCHMARK(BM_chunk_storage_write)->RangeMultiplier(4)->Range(4 * 1024, chunksize);
+
+static void BM_chunk_storage_read(benchmark::State& state) {
+    const auto size = static_cast<size_t>(state.range(0));
+    const std::string file = "/bench_read";
+    std::vector<char> buf(chunksize, 'x');
+    try {
+        for (unsigned int chunk_id = 0; chunk_id < 16; ++chunk_id) {
+            ABT_eventual eventual;
+            ABT_eventual_create(sizeof(ssize_t), &eventual);
+            storage().write_chunk(file, chunk_id, buf.data(), chunksize, 0, chunksize, eventual);
+            wait(eventual);
+        }
+        unsigned int chunk_id = 0;
+        for (auto _ : state) {
+            ABT_eventual eventual;
+            ABT_eventual_create(sizeof(ssize_t), &eventual);
+            storage().read_chunk(file, chunk_id++ % 16, buf.data(), size, 0, chunksize, eventual);
+            benchmark::DoNotOptimize(wait(eventual));
+        }
+    } catch (const std::exception& e) {
+        state.SkipWithError(e.what());
+    }
+    storage().destroy_chunk_space(file);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+}
+
+BENCHMARK(BM_chunk_storage_read)->RangeMultiplier(4)->Range(4 * 1024, chunksize);
@@ -0,0 +1,55 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <benchmark/benchmark.h>
+#include <global/rpc/distributor.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace gkfs::rpc;
+
+namespace {
+
+std::vector<std::string> paths() {
+    std::vector<std::string> paths(1024);
+    for (size_t i = 0; i < paths.size(); ++i) {
+        paths[i] = "/output/rank" + std::to_string(i) + "/checkpoint.dat";
+    }
+    return paths;
+}
+
+template<typename D>
+void locate_data(benchmark::State& state) {
+    D distributor(0, static_cast<unsigned int>(state.range(0)));
+    auto files = paths();
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(distributor.locate_data(files[i % files.size()], static_cast<chunkid_t>(i)));
+        i++;
+    }
+}
+
+} // namespace
+
+static void BM_simple_hash_locate_data(benchmark::State& state) {
+    locate_data<SimpleHashDistributor>(state);
+}
+
+BENCHMARK(BM_simple_hash_locate_data)->RangeMultiplier(8)->Range(1, 4096);
+
+static void BM_jump_hash_locate_data(benchmark::State& state) {
+    locate_data<JumpHashDistributor>(state);
+}
+
+BENCHMARK(BM_jump_hash_locate_data)->RangeMultiplier(8)->Range(1, 4096);
@@ -0,0 +1,139 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <benchmark/benchmark.h>
+#include <daemon/backend/data/chunk_storage.hpp>
+#include <daemon/classes/io_pools.hpp>
+#include <config.hpp>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/null_sink.h>
+
+extern "C" {
+#include <abt.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace gkfs::data;
+using gkfs::daemon::IOPoolLayout;
+using gkfs::daemon::IOPools;
+
+namespace {
+
+// chunk tasks submitted per iteration, like the chunks of several concurrent RPCs
+constexpr unsigned int batch = 256;
+constexpr unsigned int files = 16;
+constexpr size_t write_size = 4 * 1024;
+
+std::string root_path;
+
+// a chunk storage of its own in GKFS_BENCH_DIR, /dev/shm by default
+ChunkStorage& storage() {
+    static std::unique_ptr<ChunkStorage> storage = [] {
+        ABT_init(0, nullptr);
+        if (!spdlog::get("ChunkStorage")) {
+            spdlog::create<spdlog::sinks::null_sink_mt>("ChunkStorage");
+        }
+        auto dir = getenv("GKFS_BENCH_DIR");
+        root_path = std::string(dir != nullptr ? dir : "/dev/shm") + "/gkfs_microbench_pools_" +
+                    std::to_string(getpid());
+        mkdir(root_path.c_str(), 0750);
+        atexit([] { rmdir(root_path.c_str()); });
+        return std::unique_ptr<ChunkStorage>(new ChunkStorage(root_path, gkfs::config::rpc::chunksize));
+    }();
+    return *storage;
+}
+
+struct Task {
+    const std::string* path;
+    const char* buf;
+    unsigned int chunk_id;
+    ABT_eventual eventual;
+};
+
+void write_task(void* arg) {
+    auto task = static_cast<Task*>(arg);
+    try {
+        storage().write_chunk(*task->path, task->chunk_id, task->buf, write_size, 0,
+                                  gkfs::config::rpc::chunksize, task->eventual);
+    } catch (const std::exception&) {
+        ssize_t err = -1;
+        ABT_eventual_set(task->eventual, &err, sizeof(err));
+    }
+}
+
+} // namespace
+
+/*
+ * Chunk write IOPS of the I/O pools with 1 to 64 xstreams, routed like the daemon does by file and chunk id. The
+ * first argument is the IOPoolLayout, the second the number of xstreams
+ */
+static void BM_io_pools_chunk_write(benchmark::State& state) {
+    auto layout = static_cast<IOPoolLayout>(state.range(0));
+    auto xstreams = static_cast<unsigned int>(state.range(1));
+    state.SetLabel(gkfs::daemon::to_string(layout));
+    storage();
+    std::vector<std::string> paths;
+    for (unsigned int f = 0; f < files; ++f) {
+        paths.push_back("/bench_pools_" + std::to_string(f));
+    }
+    std::vector<char> buf(write_size, 'x');
+    std::vector<Task> tasks(batch);
+    unsigned int chunk_id = 0;
+    uint64_t failed = 0;
+    {
+        IOPools pools(layout, xstreams, false);
+        for (auto _ : state) {
+            for (auto& task : tasks) {
+                auto f = chunk_id % files;
+                task.path = &paths[f];
+                task.buf = buf.data();
+                task.chunk_id = (chunk_id++ / files) % 64;
+                ABT_eventual_create(sizeof(ssize_t), &task.eventual);
+                ABT_task_create(pools.pool(std::hash<std::string>{}(paths[f]) + task.chunk_id), write_task, &task,
+                                nullptr);
+            }
+            for (auto& task : tasks) {
+                ssize_t* result = nullptr;
+                ABT_eventual_wait(task.eventual, reinterpret_cast<void**>(&result));
+                if (*result < 0) {
+                    failed++;
+                }
+                ABT_eventual_free(&task.eventual);
+            }
+        }
+    }
+    for (const auto& path : paths) {
+        storage().destroy_chunk_space(path);
+    }
+    if (failed > 0) {
+        state.SkipWithError("Chunk writes failed");
+    }
+    state.counters["IOPS"] = benchmark::Counter(static_cast<double>(state.iterations() * batch),
+                                                benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_io_pools_chunk_write)
+        ->ArgsProduct({{static_cast<int64_t>(IOPoolLayout::shared), static_cast<int64_t>(IOPoolLayout::numa),
+                        static_cast<int64_t>(IOPoolLayout::xstream)},
+                       benchmark::CreateRange(1, 64, 2)})
+        ->ArgNames({"layout", "xstreams"})
+        ->UseRealTime();
@@ -0,0 +1,110 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <benchmark/benchmark.h>
+#include <global/metadata.hpp>
+#include <daemon/backend/metadata/merge.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace gkfs::metadata;
+
+namespace {
+
+Metadata file_metadata(size_t inline_size) {
+    Metadata md(S_IFREG | 0644);
+    md.size(123456789);
+    md.data_host(7);
+    if (inline_size > 0) {
+        md.stored_inline(true);
+        md.inline_data(std::string(inline_size, 'x'));
+    }
+    return md;
+}
+
+} // namespace
+
+static void BM_metadata_serialize(benchmark::State& state) {
+    auto md = file_metadata(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(md.serialize());
+    }
+}
+
+BENCHMARK(BM_metadata_serialize)->Arg(0)->Arg(4096);
+
+static void BM_metadata_deserialize(benchmark::State& state) {
+    auto value = file_metadata(state.range(0)).serialize();
+    for (auto _ : state) {
+        Metadata md(value);
+        benchmark::DoNotOptimize(md);
+    }
+}
+
+BENCHMARK(BM_metadata_deserialize)->Arg(0)->Arg(4096);
+
+/*
+ * Full merge of a file's metadentry with a number of size updates as they pile up for a file that is written by many
+ * processes until RocksDB compacts or reads it
+ */
+static void BM_merge_size_updates(benchmark::State& state) {
+    MetadataMergeOperator merge_operator;
+    auto existing_value = file_metadata(0).serialize();
+    rdb::Slice existing(existing_value);
+    std::vector<std::string> serialized;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        if (i % 8 == 7) {
+            serialized.push_back(IncreaseSizeOperand(4096, true).serialize());
+        } else {
+            serialized.push_back(IncreaseSizeOperand(i * 4096, false).serialize());
+        }
+    }
+    std::vector<rdb::Slice> operands(serialized.begin(), serialized.end());
+    rdb::Slice key("/bench/file");
+    for (auto _ : state) {
+        std::string new_value;
+        rdb::Slice existing_operand;
+        rocksdb::MergeOperator::MergeOperationInput merge_in{key, &existing, operands, nullptr};
+        rocksdb::MergeOperator::MergeOperationOutput merge_out{new_value, existing_operand};
+        benchmark::DoNotOptimize(merge_operator.FullMergeV2(merge_in, &merge_out));
+        benchmark::DoNotOptimize(new_value);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_merge_size_updates)->RangeMultiplier(8)->Range(1, 4096);
+
+// creation of a file followed by the inline writes of a small file
+static void BM_merge_create_inline_writes(benchmark::State& state) {
+    MetadataMergeOperator merge_operator;
+    Metadata md(S_IFREG | 0644);
+    md.stored_inline(true);
+    std::vector<std::string> serialized{CreateOperand(md.serialize()).serialize()};
+    for (int64_t i = 0; i < state.range(0); i++) {
+        serialized.push_back(WriteInlineOperand(i * 64, std::string(64, 'y')).serialize());
+    }
+    std::vector<rdb::Slice> operands(serialized.begin(), serialized.end());
+    rdb::Slice key("/bench/small_file");
+    for (auto _ : state) {
+        std::string new_value;
+        rdb::Slice existing_operand;
+        rocksdb::MergeOperator::MergeOperationInput merge_in{key, nullptr, operands, nullptr};
+        rocksdb::MergeOperator::MergeOperationOutput merge_out{new_value, existing_operand};
+        benchmark::DoNotOptimize(merge_operator.FullMergeV2(merge_in, &merge_out));
+        benchmark::DoNotOptimize(new_value);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_merge_create_inline_writes)->RangeMultiplier(8)->Range(1, 64);
@@ -0,0 +1,78 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <benchmark/benchmark.h>
+#include <client/open_file_map.hpp>
+
+#include <fcntl.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace gkfs::filemap;
+
+namespace {
+
+constexpr int open_files = 1024;
+
+// shared by all threads of a run. Set up and torn down by thread 0, Google Benchmark synchronizes the threads
+// before and after the timed loop
+OpenFileMap* file_map = nullptr;
+std::vector<int> fds;
+
+void setup(const benchmark::State& state) {
+    if (state.thread_index() != 0) {
+        return;
+    }
+    file_map = new OpenFileMap();
+    fds.clear();
+    for (int i = 0; i < open_files; ++i) {
+        fds.push_back(file_map->add(std::make_shared<OpenFile>("/file" + std::to_string(i), O_RDWR)));
+    }
+}
+
+void teardown(const benchmark::State& state) {
+    if (state.thread_index() != 0) {
+        return;
+    }
+    delete file_map;
+    file_map = nullptr;
+}
+
+} // namespace
+
+// lookup done by every read and write
+static void BM_open_file_map_get(benchmark::State& state) {
+    setup(state);
+    size_t i = state.thread_index();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(file_map->get(fds[i++ % fds.size()]));
+    }
+    teardown(state);
+}
+
+BENCHMARK(BM_open_file_map_get)->ThreadRange(1, 16)->UseRealTime();
+
+// open and close
+static void BM_open_file_map_add_remove(benchmark::State& state) {
+    setup(state);
+    auto path = "/thread" + std::to_string(state.thread_index());
+    for (auto _ : state) {
+        auto fd = file_map->add(std::make_shared<OpenFile>(path, O_RDWR));
+        benchmark::DoNotOptimize(file_map->remove(fd));
+    }
+    teardown(state);
+}
+
+BENCHMARK(BM_open_file_map_add_remove)->ThreadRange(1, 16)->UseRealTime();
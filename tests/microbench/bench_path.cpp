@@ -0,0 +1,70 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <benchmark/benchmark.h>
+#include <global/path_util.hpp>
+
+#include <string>
+
+using namespace gkfs::path;
+
+namespace {
+
+// path with the given number of components, e.g., /dir0/dir1/file
+std::string deep_path(int depth) {
+    std::string path;
+    for (int i = 0; i < depth - 1; ++i) {
+        path += "/dir" + std::to_string(i);
+    }
+    return path + "/file";
+}
+
+} // namespace
+
+static void BM_split_path(benchmark::State& state) {
+    auto path = deep_path(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(split_path(path));
+    }
+}
+
+BENCHMARK(BM_split_path)->RangeMultiplier(4)->Range(1, 64);
+
+static void BM_dirname(benchmark::State& state) {
+    auto path = deep_path(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dirname(path));
+    }
+}
+
+BENCHMARK(BM_dirname)->RangeMultiplier(4)->Range(1, 64);
+
+// resolving a relative path against the working directory
+static void BM_prepend_path(benchmark::State& state) {
+    auto cwd = deep_path(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(prepend_path(cwd, "../sub/file"));
+    }
+}
+
+BENCHMARK(BM_prepend_path)->RangeMultiplier(4)->Range(1, 64);
+
+static void BM_path_checks(benchmark::State& state) {
+    auto path = deep_path(8);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(is_absolute(path));
+        benchmark::DoNotOptimize(has_trailing_slash(path));
+    }
+}
+
+BENCHMARK(BM_path_checks);
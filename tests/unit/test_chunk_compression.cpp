@@ -0,0 +1,140 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <daemon/backend/data/chunk_compression.hpp>
+#include <config.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+extern "C" {
+#include <fcntl.h>
+#include <unistd.h>
+}
+
+using namespace gkfs::data;
+
+namespace {
+
+constexpr size_t chunksize = gkfs::config::rpc::chunksize;
+
+// noisy simulation field stored as floats, compresses about 2-3x like our checkpoints
+std::vector<char> compressible_chunk() {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> noise(0, 7);
+    std::vector<float> field(chunksize / sizeof(float));
+    for (size_t i = 0; i < field.size(); ++i) {
+        field[i] = std::round(std::sin(i / 512.0) * 256.0 + noise(gen)) / 8.0f;
+    }
+    std::vector<char> chunk(chunksize);
+    std::memcpy(chunk.data(), field.data(), chunksize);
+    return chunk;
+}
+
+std::vector<char> random_chunk() {
+    std::mt19937_64 gen(42);
+    std::vector<char> chunk(chunksize);
+    for (size_t i = 0; i < chunksize; i += sizeof(uint64_t)) {
+        auto val = gen();
+        std::memcpy(chunk.data() + i, &val, sizeof(val));
+    }
+    return chunk;
+}
+
+const std::vector<CompressionType> algorithms{CompressionType::lz4, CompressionType::zstd, CompressionType::snappy};
+
+} // namespace
+
+TEST_CASE( "Compression types are parsed from their names", "[compression]" ) {
+    for (auto type : algorithms) {
+        REQUIRE( compression_type_from_string(to_string(type)) == type );
+    }
+    REQUIRE( compression_type_from_string("none") == CompressionType::none );
+    REQUIRE_THROWS_AS( compression_type_from_string("gzip"), std::invalid_argument );
+}
+
+TEST_CASE( "Chunks survive a compression round trip", "[compression]" ) {
+    auto chunk = compressible_chunk();
+    for (auto type : algorithms) {
+        ChunkCompressor compressor(type, 0);
+        std::vector<char> compressed;
+        REQUIRE( compressor.compress(chunk.data(), chunk.size(), compressed) );
+        REQUIRE( compressed.size() < chunk.size() / 2 );
+
+        std::vector<char> out(chunk.size());
+        ChunkCompressor::decompress(type, compressed.data(), compressed.size(), out.data(), out.size());
+        REQUIRE( out == chunk );
+
+        // a payload that decompresses to another size is rejected
+        REQUIRE_THROWS( ChunkCompressor::decompress(type, compressed.data(), compressed.size(), out.data(),
+                                                    out.size() - 1) );
+    }
+}
+
+TEST_CASE( "Incompressible chunks are stored raw", "[compression]" ) {
+    auto chunk = random_chunk();
+    std::vector<char> compressed;
+    for (auto type : algorithms) {
+        ChunkCompressor compressor(type, 0);
+        REQUIRE_FALSE( compressor.compress(chunk.data(), chunk.size(), compressed) );
+    }
+    ChunkCompressor none(CompressionType::none, 0);
+    REQUIRE_FALSE( none.compress(compressible_chunk().data(), chunksize, compressed) );
+}
+
+/*
+ * Not run by default. Measures the effective write bandwidth, i.e., chunk bytes per second including compression,
+ * of writing chunk files to the directory in GKFS_BENCH_DIR (default /tmp). Run with `tests "[.benchmark]"`
+ */
+TEST_CASE( "Effective chunk write bandwidth", "[.benchmark]" ) {
+    constexpr int chunk_count = 512;
+    auto dir = getenv("GKFS_BENCH_DIR") ? std::string(getenv("GKFS_BENCH_DIR")) : std::string("/tmp");
+    auto path = dir + "/gkfs_compression_bench";
+
+    for (auto& input : {std::make_pair("compressible", compressible_chunk()),
+                        std::make_pair("random", random_chunk())}) {
+        for (auto type : {CompressionType::none, CompressionType::lz4, CompressionType::zstd,
+                          CompressionType::snappy}) {
+            ChunkCompressor compressor(type, 0);
+            int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0640);
+            REQUIRE( fd >= 0 );
+            std::vector<char> compressed;
+            size_t stored = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < chunk_count; ++i) {
+                const auto& chunk = input.second;
+                auto is_compressed = compressor.compress(chunk.data(), chunk.size(), compressed);
+                const auto& payload = is_compressed ? compressed : chunk;
+                ChunkHeader header{ChunkHeader::MAGIC,
+                                   static_cast<uint8_t>(is_compressed ? type : CompressionType::none), {},
+                                   static_cast<uint32_t>(chunk.size()), static_cast<uint32_t>(payload.size())};
+                REQUIRE( pwrite(fd, &header, sizeof(header), i * (chunksize + sizeof(header))) > 0 );
+                REQUIRE( pwrite(fd, payload.data(), payload.size(), i * (chunksize + sizeof(header)) +
+                                                                    sizeof(header)) > 0 );
+                stored += sizeof(header) + payload.size();
+            }
+            fsync(fd);
+            auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            close(fd);
+            fmt::print("{:>12} {:>6}: {:8.1f} MiB/s effective, stored {:5.1f}% of the data\n", input.first,
+                       to_string(type), chunk_count * chunksize / elapsed / (1024 * 1024),
+                       100.0 * stored / (chunk_count * chunksize));
+        }
+    }
+    std::remove(path.c_str());
+}
@@ -0,0 +1,120 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <catch2/catch.hpp>
+#include <daemon/backend/data/chunk_storage.hpp>
+#include <daemon/backend/data/chunk_reclaimer.hpp>
+#include <config.hpp>
+
+#include <boost/filesystem.hpp>
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/null_sink.h>
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gkfs::data;
+namespace bfs = boost::filesystem;
+
+namespace {
+
+/**
+ * Chunk and reclaim directories side by side as in a daemon's root directory, with the loggers the storage and the
+ * reclaimer expect
+ */
+struct RootDir {
+    bfs::path root;
+    std::shared_ptr<ChunkStorage> storage;
+
+    RootDir() {
+        root = bfs::temp_directory_path() / bfs::unique_path("gkfs_reclaimer_test_%%%%%%%%");
+        bfs::create_directories(root / "chunks");
+        for (auto name : {"ChunkStorage", "ChunkReclaimer"}) {
+            spdlog::drop(name);
+            spdlog::create<spdlog::sinks::null_sink_mt>(name);
+        }
+        storage = std::make_shared<ChunkStorage>((root / "chunks").native(), gkfs::config::rpc::chunksize);
+    }
+
+    ~RootDir() {
+        bfs::remove_all(root);
+    }
+
+    std::string reclaim_path() const {
+        return (root / "reclaim").native();
+    }
+
+    // stores chunks as the storage names them: one directory per file, one file per chunk id
+    void write_chunks(const std::string& chunks_dir, unsigned int count) const {
+        bfs::create_directories(root / "chunks" / chunks_dir);
+        for (unsigned int id = 0; id < count; ++id) {
+            std::ofstream((root / "chunks" / chunks_dir / std::to_string(id)).native()) << "chunk " << id;
+        }
+    }
+};
+
+template<typename Predicate>
+bool eventually(Predicate pred) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE( "Chunks of a removed file are deleted in the background", "[chunk_reclaimer]" ) {
+    RootDir dir;
+    dir.write_chunks("dir:file", 5);
+    dir.write_chunks("other", 1);
+    REQUIRE( dir.storage->chunk_ids("/dir/file") == std::vector<unsigned int>{0, 1, 2, 3, 4} );
+
+    // batches smaller than the file, so that it takes several rounds
+    ChunkReclaimer reclaimer(dir.storage, dir.reclaim_path(), 2, std::chrono::milliseconds(1));
+    reclaimer.reclaim("/dir/file");
+    // detached right away, so that a new file with the same path starts without chunks
+    REQUIRE( dir.storage->chunk_ids("/dir/file").empty() );
+    REQUIRE( !bfs::exists(dir.root / "chunks" / "dir:file") );
+
+    REQUIRE( eventually([&]() { return bfs::is_empty(dir.reclaim_path()); }) );
+    REQUIRE( reclaimer.pending() == 0 );
+    // chunks of other files stay
+    REQUIRE( dir.storage->chunk_ids("/other") == std::vector<unsigned int>{0} );
+}
+
+TEST_CASE( "A file without chunks on this daemon has nothing to reclaim", "[chunk_reclaimer]" ) {
+    RootDir dir;
+    ChunkReclaimer reclaimer(dir.storage, dir.reclaim_path(), 2, std::chrono::milliseconds(1));
+    REQUIRE_NOTHROW( reclaimer.reclaim("/missing") );
+    REQUIRE( reclaimer.pending() == 0 );
+    REQUIRE( bfs::is_empty(dir.reclaim_path()) );
+}
+
+TEST_CASE( "Directories detached before a restart are reclaimed", "[chunk_reclaimer]" ) {
+    RootDir dir;
+    dir.write_chunks("file", 3);
+    bfs::create_directories(dir.reclaim_path());
+    // as left by a daemon that was stopped before it deleted them
+    REQUIRE( dir.storage->detach_chunk_space("/file", dir.reclaim_path() + "/leftover") );
+
+    ChunkReclaimer reclaimer(dir.storage, dir.reclaim_path(), 2, std::chrono::milliseconds(1));
+    REQUIRE( eventually([&]() { return bfs::is_empty(dir.reclaim_path()); }) );
+}
@@ -0,0 +1,93 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <catch2/catch.hpp>
+#include <daemon/backend/data/chunk_storage.hpp>
+#include <config.hpp>
+
+#include <boost/filesystem.hpp>
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/null_sink.h>
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace gkfs::data;
+namespace bfs = boost::filesystem;
+
+namespace {
+
+struct ChunkDir {
+    bfs::path root;
+    std::shared_ptr<ChunkStorage> storage;
+
+    ChunkDir() {
+        root = bfs::temp_directory_path() / bfs::unique_path("gkfs_chunk_storage_test_%%%%%%%%");
+        bfs::create_directories(root);
+        spdlog::drop("ChunkStorage");
+        spdlog::create<spdlog::sinks::null_sink_mt>("ChunkStorage");
+        storage = std::make_shared<ChunkStorage>(root.native(), gkfs::config::rpc::chunksize);
+    }
+
+    ~ChunkDir() {
+        bfs::remove_all(root);
+    }
+
+    void write_chunk(const std::string& chunks_dir, unsigned int id) const {
+        bfs::create_directories(root / chunks_dir);
+        std::ofstream((root / chunks_dir / std::to_string(id)).native()) << "chunk " << id;
+    }
+};
+
+} // namespace
+
+TEST_CASE( "Chunk directory names map back to their file paths", "[chunk_storage]" ) {
+    for (std::string path : {"/file", "/dir/file", "/a:b", "/a/:b", "/a:/b", "/50%off", "/%3A", "/x%25:y/z"}) {
+        auto chunks_dir = ChunkStorage::encode_chunks_dir(path);
+        REQUIRE( chunks_dir.find('/') == std::string::npos );
+        REQUIRE( ChunkStorage::get_file_path(chunks_dir) == path );
+    }
+    // names of files without ':' and '%' are the same as before escaping
+    REQUIRE( ChunkStorage::encode_chunks_dir("/dir/file") == "dir:file" );
+    REQUIRE( ChunkStorage::encode_chunks_dir("/a:b") != ChunkStorage::encode_chunks_dir("/a/b") );
+    // a '%' that starts no escape, as written before escaping
+    REQUIRE( ChunkStorage::get_file_path("50%off") == "/50%off" );
+}
+
+TEST_CASE( "Chunks are listed with the paths of their files", "[chunk_storage]" ) {
+    ChunkDir dir;
+    dir.write_chunk(ChunkStorage::encode_chunks_dir("/a:b"), 0);
+    dir.write_chunk(ChunkStorage::encode_chunks_dir("/a/b"), 1);
+    auto chunks = dir.storage->chunk_list();
+    std::sort(chunks.begin(), chunks.end());
+    REQUIRE( chunks == std::vector<std::pair<std::string, unsigned int>>{{"/a/b", 1}, {"/a:b", 0}} );
+    REQUIRE( dir.storage->chunk_ids("/a:b") == std::vector<unsigned int>{0} );
+}
+
+TEST_CASE( "Chunks written before names were escaped are still found", "[chunk_storage]" ) {
+    ChunkDir dir;
+    // as stored for "/a:b" and "/50%off" before
+    dir.write_chunk("a:b", 3);
+    dir.write_chunk("50%off", 2);
+    REQUIRE( dir.storage->chunk_ids("/a:b") == std::vector<unsigned int>{3} );
+    REQUIRE( dir.storage->chunk_ids("/50%off") == std::vector<unsigned int>{2} );
+
+    SECTION( "the escaped directory is used once it exists" ) {
+        dir.write_chunk(ChunkStorage::encode_chunks_dir("/a:b"), 4);
+        REQUIRE( dir.storage->chunk_ids("/a:b") == std::vector<unsigned int>{4} );
+    }
+}
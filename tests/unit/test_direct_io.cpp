@@ -0,0 +1,196 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <daemon/backend/data/direct_io.hpp>
+#include <config.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <fcntl.h>
+#include <unistd.h>
+}
+
+using namespace gkfs::data;
+
+namespace {
+
+constexpr size_t chunksize = gkfs::config::rpc::chunksize;
+constexpr size_t alignment = gkfs::config::io::direct_io_alignment;
+
+std::string temp_file() {
+    auto dir = getenv("GKFS_BENCH_DIR") ? std::string(getenv("GKFS_BENCH_DIR")) : std::string("/tmp");
+    return dir + "/gkfs_direct_io_test";
+}
+
+std::vector<char> read_file(int fd) {
+    std::vector<char> content(lseek(fd, 0, SEEK_END));
+    REQUIRE( pread(fd, content.data(), content.size(), 0) == static_cast<ssize_t>(content.size()) );
+    return content;
+}
+
+/*
+ * File descriptors of the test file without and, if the file system supports it, with O_DIRECT. The helpers must
+ * give the same result with both
+ */
+std::vector<int> open_fds(const std::string& path) {
+    std::vector<int> fds{open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0640)};
+    REQUIRE( fds[0] >= 0 );
+    int direct_fd = open(path.c_str(), O_RDWR | O_DIRECT);
+    if (direct_fd >= 0) {
+        fds.push_back(direct_fd);
+    } else {
+        WARN( "O_DIRECT is not supported in " << path << ", the helpers are only tested without it" );
+    }
+    return fds;
+}
+
+} // namespace
+
+TEST_CASE( "Direct writes leave the same content as pwrite", "[direct_io]" ) {
+    auto path = temp_file();
+    auto fds = open_fds(path);
+    auto buf = make_aligned_buffer(4 * alignment + 1, alignment);
+    for (size_t i = 0; i < 4 * alignment + 1; ++i) {
+        buf.get()[i] = static_cast<char>('a' + i % 26);
+    }
+
+    // aligned, unaligned head, unaligned tail, within a single block, misaligned buffer, smaller bounce buffer
+    struct Write {
+        size_t buf_off;
+        size_t size;
+        off64_t offset;
+        size_t bounce_size;
+    };
+    std::vector<Write> writes{
+            {0, 2 * alignment,     0,               alignment},
+            {0, 2 * alignment,     2 * alignment,   4 * alignment},
+            {100, 2 * alignment,   100,             4 * alignment},
+            {0, alignment + 10,    alignment,       4 * alignment},
+            {10, 20,               3 * alignment + 10, 4 * alignment},
+            {1, 3 * alignment,     alignment,       alignment},
+            {1, 3 * alignment + 5, 7,               alignment}
+    };
+    for (auto fd : fds) {
+        for (bool existing_data : {false, true}) {
+            for (const auto& w : writes) {
+                REQUIRE( ftruncate(fds[0], 0) == 0 );
+                std::vector<char> expected;
+                if (existing_data) {
+                    expected.assign(5 * alignment + 3, 'x');
+                    REQUIRE( pwrite(fds[0], expected.data(), expected.size(), 0) ==
+                             static_cast<ssize_t>(expected.size()) );
+                }
+                REQUIRE( pwrite_direct(fd, buf.get() + w.buf_off, w.size, w.offset, alignment, w.bounce_size) ==
+                         static_cast<ssize_t>(w.size) );
+                if (expected.size() < w.offset + w.size) {
+                    expected.resize(w.offset + w.size, 0);
+                }
+                std::memcpy(expected.data() + w.offset, buf.get() + w.buf_off, w.size);
+                REQUIRE( read_file(fds[0]) == expected );
+            }
+        }
+    }
+    for (auto fd : fds) {
+        close(fd);
+    }
+    std::remove(path.c_str());
+}
+
+TEST_CASE( "Direct reads return the same data as pread", "[direct_io]" ) {
+    auto path = temp_file();
+    auto fds = open_fds(path);
+    std::vector<char> content(5 * alignment + 3);
+    for (size_t i = 0; i < content.size(); ++i) {
+        content[i] = static_cast<char>('a' + i % 26);
+    }
+    REQUIRE( pwrite(fds[0], content.data(), content.size(), 0) == static_cast<ssize_t>(content.size()) );
+    auto buf = make_aligned_buffer(8 * alignment, alignment);
+
+    for (auto fd : fds) {
+        for (size_t buf_off : {size_t{0}, size_t{1}, size_t{100}}) {
+            for (off64_t offset : {off64_t{0}, off64_t{100}, static_cast<off64_t>(alignment)}) {
+                for (size_t size : {size_t{10}, alignment, 3 * alignment + 7, 6 * alignment}) {
+                    for (size_t bounce_size : {alignment, 4 * alignment}) {
+                        std::memset(buf.get(), 0, 8 * alignment);
+                        auto expected = std::min<size_t>(size, content.size() - offset);
+                        REQUIRE( pread_direct(fd, buf.get() + buf_off, size, offset, alignment, bounce_size) ==
+                                 static_cast<ssize_t>(expected) );
+                        REQUIRE( std::memcmp(buf.get() + buf_off, content.data() + offset, expected) == 0 );
+                    }
+                }
+            }
+        }
+        // behind the end of the file
+        REQUIRE( pread_direct(fd, buf.get(), alignment, 8 * alignment, alignment, alignment) == 0 );
+    }
+    for (auto fd : fds) {
+        close(fd);
+    }
+    std::remove(path.c_str());
+}
+
+/*
+ * Not run by default. Compares buffered and direct chunk writes and reads. Point GKFS_BENCH_DIR to the device to
+ * compare, e.g., an NVMe mount. Buffered writes are synced at the end, and the page cache is dropped before the
+ * buffered reads if possible (needs root). Run with `tests "[.benchmark]"`
+ */
+TEST_CASE( "Buffered and direct chunk I/O throughput", "[.benchmark]" ) {
+    constexpr int chunks = 1024;
+    auto path = temp_file();
+    auto chunk = make_aligned_buffer(chunksize, alignment);
+    std::memset(chunk.get(), 'x', chunksize);
+
+    auto throughput = [&](const char* name, int flags, bool write) {
+        int fd = open(path.c_str(), flags, 0640);
+        if (fd < 0) {
+            WARN( name << ": cannot open " << path << ": " << std::strerror(errno) );
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < chunks; ++i) {
+            auto ret = (flags & O_DIRECT) ?
+                       (write ? pwrite_direct(fd, chunk.get(), chunksize, i * chunksize, alignment, chunksize)
+                              : pread_direct(fd, chunk.get(), chunksize, i * chunksize, alignment, chunksize)) :
+                       (write ? pwrite(fd, chunk.get(), chunksize, i * chunksize)
+                              : pread(fd, chunk.get(), chunksize, i * chunksize));
+            REQUIRE( ret == static_cast<ssize_t>(chunksize) );
+        }
+        if (write) {
+            fsync(fd);
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        close(fd);
+        fmt::print("{:>16}: {:8.1f} MiB/s\n", name, chunks * chunksize / elapsed / (1024 * 1024));
+    };
+    auto drop_caches = [] {
+        sync();
+        int fd = open("/proc/sys/vm/drop_caches", O_WRONLY);
+        if (fd >= 0) {
+            REQUIRE( ::write(fd, "1", 1) == 1 );
+            close(fd);
+        }
+    };
+    throughput("buffered write", O_WRONLY | O_CREAT | O_TRUNC, true);
+    drop_caches();
+    throughput("buffered read", O_RDONLY, false);
+    throughput("direct write", O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, true);
+    throughput("direct read", O_RDONLY | O_DIRECT, false);
+    std::remove(path.c_str());
+}
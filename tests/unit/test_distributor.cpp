@@ -0,0 +1,161 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <catch2/catch.hpp>
+#include <global/rpc/distributor.hpp>
+
+using namespace gkfs::rpc;
+
+TEST_CASE( "Jump hash stays within the host range", "[distributor]" ) {
+    JumpHashDistributor dist(0, 7);
+    for (chunkid_t id = 0; id < 1000; id++) {
+        REQUIRE( dist.locate_data("/file", id) < 7 );
+    }
+    REQUIRE( dist.locate_file_metadata("/file") < 7 );
+    REQUIRE( JumpHashDistributor::jump_hash(42, 1) == 0 );
+}
+
+TEST_CASE( "Jump hash only moves chunks to a new host", "[distributor]" ) {
+    JumpHashDistributor old_dist(0, 8);
+    JumpHashDistributor new_dist(0, 9);
+    unsigned int moved = 0;
+    const chunkid_t chunks = 9000;
+    for (chunkid_t id = 0; id < chunks; id++) {
+        auto before = old_dist.locate_data("/file", id);
+        auto after = new_dist.locate_data("/file", id);
+        if (before != after) {
+            REQUIRE( after == 8 );
+            moved++;
+        }
+    }
+    // about 1/9 of all chunks are expected to move
+    REQUIRE( moved > chunks / 18 );
+    REQUIRE( moved < chunks / 6 );
+}
+
+TEST_CASE( "Distributor types round-trip through their names", "[distributor]" ) {
+    REQUIRE( distributor_type_from_string("simple") == DistributorType::simple_hash );
+    REQUIRE( distributor_type_from_string(to_string(DistributorType::jump_hash)) == DistributorType::jump_hash );
+    REQUIRE( distributor_type_from_string(to_string(DistributorType::locality)) == DistributorType::locality );
+    REQUIRE_THROWS( distributor_type_from_string("ring") );
+}
+
+TEST_CASE( "Striped forwarders find their chunks by re-hashing", "[distributor]" ) {
+    StripedForwarderDistributor dist({4, 2, 7}, 8);
+    unsigned int per_forwarder[8] = {};
+    for (chunkid_t id = 0; id < 300; id++) {
+        auto target = dist.locate_data("/file", id);
+        per_forwarder[target]++;
+        // the daemon's view of the request sent to target
+        auto request_host = dist.data_request_host(target, 8);
+        REQUIRE( request_host.second == 3 );
+        SimpleHashDistributor daemon_dist(request_host.first, request_host.second);
+        REQUIRE( daemon_dist.locate_data("/file", id) == request_host.first );
+    }
+    REQUIRE( per_forwarder[4] + per_forwarder[2] + per_forwarder[7] == 300 );
+    REQUIRE( per_forwarder[4] > 0 );
+    REQUIRE( per_forwarder[2] > 0 );
+    REQUIRE( per_forwarder[7] > 0 );
+    // metadata is hashed across all daemons
+    REQUIRE( dist.locate_file_metadata("/file") < 8 );
+}
+
+TEST_CASE( "Striped layouts spread chunks round-robin over their hosts", "[distributor]" ) {
+    REQUIRE_FALSE( is_striped(0, 8) );
+    REQUIRE_FALSE( is_striped(8, 8) );
+    REQUIRE( is_striped(3, 8) );
+    unsigned int per_host[8] = {};
+    for (chunkid_t id = 0; id < 300; id++) {
+        per_host[locate_striped_data("/file", id, 3, 8)]++;
+    }
+    unsigned int used = 0;
+    for (auto count : per_host) {
+        if (count > 0) {
+            REQUIRE( count == 100 );
+            used++;
+        }
+    }
+    REQUIRE( used == 3 );
+    // consecutive chunks go to different hosts
+    REQUIRE( locate_striped_data("/file", 0, 3, 8) != locate_striped_data("/file", 1, 3, 8) );
+}
+
+TEST_CASE( "Dynamic forwarders are kept for pinned files", "[distributor]" ) {
+    unsigned int selections = 0;
+    DynamicForwarderDistributor dist({1, 3}, 4, [&](const std::vector<host_t>& candidates) {
+        return candidates[selections++ % candidates.size()];
+    });
+    auto flood = [&]() {
+        for (std::size_t i = 0; i < 2 * DynamicForwarderDistributor::max_sticky_files; i++) {
+            dist.locate_data("/file" + std::to_string(i), 0);
+        }
+    };
+
+    host_t host;
+    REQUIRE( dist.pin_file("/open", host) );
+    REQUIRE( (host == 1 || host == 3) );
+    REQUIRE( dist.locate_data("/open", 7) == host );
+    flood();
+    REQUIRE( dist.sticky_files() <= DynamicForwarderDistributor::max_sticky_files );
+    // no new choice for the pinned file
+    auto before = selections;
+    REQUIRE( dist.locate_data("/open", 0) == host );
+    REQUIRE( selections == before );
+
+    SECTION( "unpinned files are forgotten when they have not been used for long" ) {
+        dist.unpin_file("/open");
+        flood();
+        before = selections;
+        dist.locate_data("/open", 0);
+        REQUIRE( selections == before + 1 );
+    }
+    SECTION( "a file stays pinned until its last pin is released" ) {
+        host_t again;
+        REQUIRE( dist.pin_file("/open", again) );
+        REQUIRE( again == host );
+        dist.unpin_file("/open");
+        flood();
+        before = selections;
+        REQUIRE( dist.locate_data("/open", 0) == host );
+        REQUIRE( selections == before );
+        dist.unpin_file("/open");
+    }
+}
+
+TEST_CASE( "Hash distributors do not pin files", "[distributor]" ) {
+    SimpleHashDistributor dist(0, 4);
+    host_t host;
+    REQUIRE_FALSE( dist.pin_file("/file", host) );
+    REQUIRE_NOTHROW( dist.unpin_file("/file") );
+}
+
+TEST_CASE( "Data requests fall back to another forwarder", "[distributor]" ) {
+    StripedForwarderDistributor striped({4, 2, 7}, 8);
+    REQUIRE( striped.alternative_data_host(4) == 2 );
+    REQUIRE( striped.alternative_data_host(7) == 4 );
+    // not one of the forwarders
+    REQUIRE( striped.alternative_data_host(5) == 5 );
+
+    DynamicForwarderDistributor dynamic({1, 3}, 4, [](const std::vector<host_t>& candidates) {
+        return candidates.front();
+    });
+    REQUIRE( dynamic.alternative_data_host(1) == 3 );
+    REQUIRE( dynamic.alternative_data_host(3) == 1 );
+
+    // a single forwarder or hashed placement has no other host holding the data
+    DynamicForwarderDistributor single({2}, 4, [](const std::vector<host_t>& candidates) {
+        return candidates.front();
+    });
+    REQUIRE( single.alternative_data_host(2) == 2 );
+    REQUIRE( SimpleHashDistributor(0, 4).alternative_data_host(1) == 1 );
+}
@@ -0,0 +1,107 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <catch2/catch.hpp>
+#include <client/distributor_switch.hpp>
+#include <global/rpc/distributor.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using gkfs::preload::DistributorGuard;
+using gkfs::preload::DistributorSwitch;
+using gkfs::rpc::Distributor;
+using gkfs::rpc::SimpleHashDistributor;
+
+namespace {
+
+// long enough for a thread that is not blocked to get through a switch or a guard
+void let_threads_run() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+}
+
+} // namespace
+
+TEST_CASE("Guards pin the distributor they acquired", "[distributor_switch]") {
+    DistributorSwitch distributors;
+    std::shared_ptr<Distributor> old_dist = std::make_shared<SimpleHashDistributor>(0, 1);
+    std::shared_ptr<Distributor> new_dist = std::make_shared<SimpleHashDistributor>(0, 2);
+    distributors.distributor(old_dist);
+
+    {
+        DistributorGuard outer(distributors);
+        DistributorGuard inner(distributors);
+        REQUIRE(&*outer == old_dist.get());
+        REQUIRE(inner.operator->() == old_dist.get());
+    }
+
+    // no guard is left, the switch does not wait
+    distributors.switch_distributor(new_dist);
+    REQUIRE(distributors.distributor() == new_dist);
+
+    DistributorGuard guard(distributors);
+    REQUIRE(&*guard == new_dist.get());
+}
+
+TEST_CASE("A distributor switch waits for the operations using the old distributor", "[distributor_switch]") {
+    DistributorSwitch distributors;
+    std::shared_ptr<Distributor> old_dist = std::make_shared<SimpleHashDistributor>(0, 1);
+    std::shared_ptr<Distributor> new_dist = std::make_shared<SimpleHashDistributor>(0, 2);
+    distributors.distributor(old_dist);
+
+    std::unique_ptr<DistributorGuard> running(new DistributorGuard(distributors));
+
+    std::atomic<bool> switched(false);
+    std::thread switcher([&] {
+        distributors.switch_distributor(new_dist);
+        switched = true;
+    });
+    let_threads_run();
+
+    // not REQUIRE: the threads must be joined even if a check fails
+    CHECK_FALSE(switched);
+    CHECK(distributors.distributor() == old_dist);
+    CHECK(&**running == old_dist.get());
+
+    SECTION("the switch completes once the guard is released") {
+        running.reset();
+        switcher.join();
+
+        REQUIRE(switched);
+        REQUIRE(distributors.distributor() == new_dist);
+    }
+
+    SECTION("operations starting meanwhile wait for the switch and use the new distributor") {
+        std::atomic<bool> started(false);
+        const Distributor* used = nullptr;
+        std::thread operation([&] {
+            DistributorGuard guard(distributors);
+            used = guard.operator->();
+            started = true;
+        });
+        let_threads_run();
+
+        CHECK_FALSE(started);
+        CHECK_FALSE(switched);
+
+        running.reset();
+        switcher.join();
+        operation.join();
+
+        REQUIRE(switched);
+        REQUIRE(started);
+        REQUIRE(used == new_dist.get());
+    }
+}
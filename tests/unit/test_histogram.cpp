@@ -0,0 +1,62 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <catch2/catch.hpp>
+#include <global/histogram.hpp>
+
+using namespace gkfs::util;
+
+TEST_CASE( "Latencies fall into power-of-two buckets", "[histogram]" ) {
+    REQUIRE( LatencyHistogram::bucket_of(0) == 0 );
+    REQUIRE( LatencyHistogram::bucket_of(1) == 1 );
+    REQUIRE( LatencyHistogram::bucket_of(3) == 2 );
+    REQUIRE( LatencyHistogram::bucket_of(4) == 3 );
+    REQUIRE( LatencyHistogram::bucket_of(UINT64_MAX) == LatencyHistogram::bucket_count - 1 );
+}
+
+TEST_CASE( "Quantiles are bucket upper bounds", "[histogram]" ) {
+    LatencyHistogram histogram;
+    REQUIRE( histogram.quantile(0.99) == 0 );
+
+    // 99 fast requests and one slow one
+    for (int i = 0; i < 99; i++) {
+        histogram.record(100);
+    }
+    histogram.record(10000);
+    REQUIRE( histogram.count() == 100 );
+    REQUIRE( histogram.quantile(0.5) == 128 );
+    REQUIRE( histogram.quantile(0.99) == 128 );
+    REQUIRE( histogram.quantile(1.0) == 16384 );
+
+    histogram.reset();
+    REQUIRE( histogram.count() == 0 );
+}
+
+TEST_CASE( "Quantiles of summed up snapshots", "[histogram]" ) {
+    LatencyHistogram a;
+    LatencyHistogram b;
+    for (int i = 0; i < 90; i++) {
+        a.record(10);
+    }
+    for (int i = 0; i < 10; i++) {
+        b.record(1000);
+    }
+    auto counts = a.snapshot();
+    auto other = b.snapshot();
+    for (unsigned int i = 0; i < LatencyHistogram::bucket_count; i++) {
+        counts[i] += other[i];
+    }
+    REQUIRE( LatencyHistogram::quantile(counts, 0.9) == 16 );
+    REQUIRE( LatencyHistogram::quantile(counts, 0.95) == 1024 );
+    REQUIRE( LatencyHistogram::quantile(counts, 0.5) == a.quantile(0.5) );
+}
@@ -0,0 +1,113 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <catch2/catch.hpp>
+#include <global/metadata.hpp>
+
+using namespace gkfs::metadata;
+
+TEST_CASE( "Metadata without inline data round-trips", "[metadata]" ) {
+    Metadata md(S_IFREG | 0644);
+    md.size(42);
+    md.data_host(3);
+
+    Metadata copy(md.serialize());
+    REQUIRE( copy.mode() == md.mode() );
+    REQUIRE( copy.size() == 42 );
+    REQUIRE( copy.data_host() == 3 );
+    REQUIRE( !copy.stored_inline() );
+    REQUIRE( copy.inline_data().empty() );
+}
+
+TEST_CASE( "Inline data is binary and follows the text part", "[metadata]" ) {
+    Metadata md(S_IFREG | 0644);
+    md.stored_inline(true);
+    std::string data("a|b\0c", 5);
+    md.inline_data(data);
+    md.size(data.size());
+
+    auto value = md.serialize();
+    // C string receivers only see the text part
+    REQUIRE( std::string(value.c_str()).size() < value.size() );
+
+    Metadata copy(value);
+    REQUIRE( copy.stored_inline() );
+    REQUIRE( copy.inline_data() == data );
+    REQUIRE( copy.size() == 5 );
+
+    Metadata text_only(std::string(value.c_str()));
+    REQUIRE( text_only.stored_inline() );
+    REQUIRE( text_only.inline_data().empty() );
+
+    SECTION( "promotion drops the data" ) {
+        copy.stored_inline(false);
+        REQUIRE( copy.inline_data().empty() );
+        REQUIRE( Metadata(copy.serialize()).size() == 5 );
+    }
+}
+
+TEST_CASE( "Entries written before later fields were added are read", "[metadata]" ) {
+    Metadata md(S_IFREG | 0644);
+    md.size(42);
+    auto value = md.serialize();
+    // the data host, inline flag and layout of an entry that has none of them
+    const std::string added = "|-1|0|0|0";
+    auto pos = value.find(added);
+    REQUIRE( pos != std::string::npos );
+
+    SECTION( "without data host, inline flag and layout" ) {
+        Metadata copy(std::string(value).erase(pos, added.size()));
+        REQUIRE( copy.size() == 42 );
+        REQUIRE( copy.data_host() == NO_DATA_HOST );
+        REQUIRE( !copy.stored_inline() );
+        REQUIRE( copy.layout().chunk_size == 0 );
+        REQUIRE( copy.layout().stripe_width == 0 );
+    }
+    SECTION( "without layout" ) {
+        Metadata copy(std::string(value).erase(pos + 5, 4));
+        REQUIRE( copy.size() == 42 );
+        REQUIRE( copy.data_host() == NO_DATA_HOST );
+        REQUIRE( chunk_size(copy.layout()) == gkfs::config::rpc::chunksize );
+    }
+#ifdef HAS_SYMLINKS
+    SECTION( "a symlink without data host, inline flag and layout" ) {
+        Metadata link(S_IFLNK | 0777, "/target");
+        value = link.serialize();
+        pos = value.find(added);
+        REQUIRE( pos != std::string::npos );
+        Metadata copy(value.erase(pos, added.size()));
+        REQUIRE( copy.target_path() == "/target" );
+        REQUIRE( copy.data_host() == NO_DATA_HOST );
+        REQUIRE( copy.layout().chunk_size == 0 );
+    }
+#endif
+}
+
+TEST_CASE( "Layouts round-trip and are parsed from their names", "[metadata]" ) {
+    Metadata md(S_IFDIR | 0755);
+    REQUIRE( chunk_size(md.layout()) == gkfs::config::rpc::chunksize );
+    md.layout(layout_from_string("chunk_size=4M,stripe_width=8"));
+    REQUIRE( md.layout().chunk_size == 4 * 1024 * 1024 );
+    REQUIRE( md.layout().stripe_width == 8 );
+
+    Metadata copy(md.serialize());
+    REQUIRE( copy.layout().chunk_size == md.layout().chunk_size );
+    REQUIRE( copy.layout().stripe_width == 8 );
+    REQUIRE( layout_from_string(to_string(copy.layout())).chunk_size == copy.layout().chunk_size );
+
+    REQUIRE( layout_from_string("stripe_width=2").chunk_size == 0 );
+    REQUIRE_THROWS_AS( layout_from_string("chunk_size=3000"), std::invalid_argument );
+    REQUIRE_THROWS_AS( layout_from_string("chunk_size=1G"), std::invalid_argument );
+    REQUIRE_THROWS_AS( layout_from_string("chunk_size=1X"), std::invalid_argument );
+    REQUIRE_THROWS_AS( layout_from_string("stripes=2"), std::invalid_argument );
+}
@@ -0,0 +1,160 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <catch2/catch.hpp>
+#include <client/rpc/registration_cache.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using gkfs::rpc::RegistrationCache;
+
+namespace {
+
+/**
+ * Cache whose registrations are only counted, so that no RPC engine is needed. The cache never touches the memory
+ * of a buffer, so regions of one array stand in for user buffers
+ */
+struct CountingCache {
+    std::vector<char> memory = std::vector<char>(8192);
+    std::size_t exposed = 0;
+    RegistrationCache cache;
+
+    explicit CountingCache(std::size_t budget) :
+            cache(budget, [this](void*, std::size_t, hermes::access_mode) {
+                ++exposed;
+                return std::shared_ptr<hermes::exposed_memory>();
+            }) {}
+
+    char* at(std::size_t offset) {
+        return memory.data() + offset;
+    }
+
+    void expose(std::size_t offset, std::size_t size,
+                hermes::access_mode mode = hermes::access_mode::read_only) {
+        cache.expose(at(offset), size, mode);
+    }
+};
+
+} // namespace
+
+TEST_CASE("Registrations are reused for the same address, size and mode", "[registration_cache]") {
+    CountingCache c(4096);
+
+    c.expose(0, 100);
+    c.expose(0, 100);
+    REQUIRE(c.exposed == 1);
+    REQUIRE(c.cache.pinned() == 100);
+
+    SECTION("another size replaces the registration") {
+        c.expose(0, 50);
+        REQUIRE(c.exposed == 2);
+        REQUIRE(c.cache.pinned() == 50);
+        c.expose(0, 100);
+        REQUIRE(c.exposed == 3);
+        REQUIRE(c.cache.pinned() == 100);
+    }
+
+    SECTION("another mode gets a registration of its own") {
+        c.expose(0, 100, hermes::access_mode::write_only);
+        REQUIRE(c.exposed == 2);
+        REQUIRE(c.cache.pinned() == 200);
+        c.expose(0, 100, hermes::access_mode::read_only);
+        c.expose(0, 100, hermes::access_mode::write_only);
+        REQUIRE(c.exposed == 2);
+    }
+
+    SECTION("cleared registrations are not reused") {
+        c.cache.clear();
+        REQUIRE(c.cache.pinned() == 0);
+        c.expose(0, 100);
+        REQUIRE(c.exposed == 2);
+    }
+}
+
+TEST_CASE("Registrations are evicted in LRU order to stay within the budget", "[registration_cache]") {
+    CountingCache c(300);
+
+    c.expose(0, 100);
+    c.expose(1000, 100);
+    c.expose(2000, 100);
+    REQUIRE(c.cache.pinned() == 300);
+
+    // the region at 1000 is the least recently used one now
+    c.expose(0, 100);
+    c.expose(3000, 100);
+    REQUIRE(c.exposed == 4);
+    REQUIRE(c.cache.pinned() == 300);
+
+    c.expose(0, 100);
+    c.expose(2000, 100);
+    c.expose(3000, 100);
+    REQUIRE(c.exposed == 4);
+    c.expose(1000, 100);
+    REQUIRE(c.exposed == 5);
+    REQUIRE(c.cache.pinned() == 300);
+
+    SECTION("buffers larger than the budget are not cached") {
+        c.expose(4000, 400);
+        c.expose(4000, 400);
+        REQUIRE(c.exposed == 7);
+        REQUIRE(c.cache.pinned() == 300);
+        // nothing was evicted for them
+        c.expose(1000, 100);
+        REQUIRE(c.exposed == 7);
+    }
+}
+
+TEST_CASE("Invalidating a range drops the registrations overlapping it", "[registration_cache]") {
+    CountingCache c(4096);
+
+    // the largest region bounds the search for regions starting before an invalidated range
+    c.expose(1000, 500);
+    c.expose(2000, 100);
+    REQUIRE(c.cache.pinned() == 600);
+
+    SECTION("ranges touching a region without overlapping it") {
+        c.cache.invalidate(c.at(1500), 500);
+        c.cache.invalidate(c.at(2100), 100);
+        c.cache.invalidate(c.at(999), 1);
+        REQUIRE(c.cache.pinned() == 600);
+    }
+
+    SECTION("the last byte of the largest region") {
+        c.cache.invalidate(c.at(1499), 1);
+        REQUIRE(c.cache.pinned() == 100);
+        c.expose(1000, 500);
+        REQUIRE(c.exposed == 3);
+    }
+
+    SECTION("a range within a region") {
+        c.cache.invalidate(c.at(2050), 10);
+        REQUIRE(c.cache.pinned() == 500);
+    }
+
+    SECTION("a range covering several regions") {
+        c.cache.invalidate(c.at(1200), 1000);
+        REQUIRE(c.cache.pinned() == 0);
+    }
+
+    SECTION("an empty range") {
+        c.cache.invalidate(c.at(1200), 0);
+        REQUIRE(c.cache.pinned() == 600);
+    }
+
+    SECTION("a range starting before the address space") {
+        c.cache.invalidate(nullptr, 1);
+        REQUIRE(c.cache.pinned() == 600);
+    }
+}
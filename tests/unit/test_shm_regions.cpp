@@ -0,0 +1,201 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <catch2/catch.hpp>
+#include <daemon/classes/shm_regions.hpp>
+#include <global/rpc/shm_region.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <system_error>
+
+extern "C" {
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+}
+
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+
+using namespace gkfs::daemon;
+namespace shm = gkfs::rpc::shm;
+
+namespace {
+
+constexpr size_t region_size = 4 * shm::data_offset;
+
+/**
+ * A region as a client creates it, mapped by the test like by the client
+ */
+struct ClientRegion {
+    int fd;
+    char* base;
+
+    ClientRegion(uint64_t id, const char* name = shm::memfd_name, bool sealed = true) {
+        fd = static_cast<int>(syscall(SYS_memfd_create, name, MFD_ALLOW_SEALING));
+        REQUIRE( fd >= 0 );
+        REQUIRE( ftruncate(fd, region_size) == 0 );
+        if (sealed) {
+            REQUIRE( fcntl(fd, F_ADD_SEALS, shm::required_seals) == 0 );
+        }
+        base = static_cast<char*>(mmap(nullptr, region_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+        REQUIRE( base != MAP_FAILED );
+        shm::Header header{id};
+        std::memcpy(base, &header, sizeof(header));
+    }
+
+    ~ClientRegion() {
+        munmap(base, region_size);
+        close(fd);
+    }
+};
+
+} // namespace
+
+TEST_CASE( "A client region is shared with the daemon", "[shm_regions]" ) {
+    ShmRegions regions(8 * region_size);
+    ClientRegion client(42);
+
+    auto region = regions.get(42, getpid(), client.fd);
+    REQUIRE( region->size() == region_size );
+    REQUIRE( regions.get(42, getpid(), client.fd) == region );
+    REQUIRE( regions.size() == 1 );
+
+    // what the daemon writes is seen by the client and the other way around
+    auto data = region->span(shm::data_offset + 10, 5);
+    REQUIRE( data != nullptr );
+    std::memcpy(data, "hello", 5);
+    REQUIRE( std::memcmp(client.base + shm::data_offset + 10, "hello", 5) == 0 );
+    std::memcpy(client.base + region_size - 3, "end", 3);
+    REQUIRE( std::memcmp(region->span(region_size - 3, 3), "end", 3) == 0 );
+}
+
+TEST_CASE( "Requests cannot reach outside of the region's data", "[shm_regions]" ) {
+    ShmRegions regions(8 * region_size);
+    ClientRegion client(7);
+    auto region = regions.get(7, getpid(), client.fd);
+
+    REQUIRE( region->span(shm::data_offset, region_size - shm::data_offset) != nullptr );
+    REQUIRE( region->span(region_size, 0) != nullptr );
+    // the header
+    REQUIRE( region->span(0, 8) == nullptr );
+    REQUIRE( region->span(shm::data_offset - 1, 1) == nullptr );
+    REQUIRE( region->span(-static_cast<int64_t>(shm::data_offset), 8) == nullptr );
+    // behind the end
+    REQUIRE( region->span(shm::data_offset, region_size) == nullptr );
+    REQUIRE( region->span(region_size - 3, 4) == nullptr );
+    REQUIRE( region->span(region_size + 1, 0) == nullptr );
+    REQUIRE( region->span(shm::data_offset, static_cast<size_t>(-1)) == nullptr );
+}
+
+TEST_CASE( "Only client regions with the right id are mapped", "[shm_regions]" ) {
+    ShmRegions regions(8 * region_size);
+
+    SECTION( "another id" ) {
+        ClientRegion client(1);
+        REQUIRE_THROWS_AS( regions.get(2, getpid(), client.fd), std::system_error );
+    }
+    SECTION( "a memfd of another program" ) {
+        ClientRegion client(3, "other");
+        REQUIRE_THROWS_AS( regions.get(3, getpid(), client.fd), std::system_error );
+    }
+    SECTION( "a region that can be resized" ) {
+        ClientRegion client(5, shm::memfd_name, false);
+        REQUIRE_THROWS_AS( regions.get(5, getpid(), client.fd), std::system_error );
+    }
+    SECTION( "a regular file" ) {
+        auto path = std::string("/tmp/gkfs_shm_regions_test");
+        int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        REQUIRE( fd >= 0 );
+        REQUIRE( ftruncate(fd, region_size) == 0 );
+        REQUIRE_THROWS_AS( regions.get(0, getpid(), fd), std::system_error );
+        close(fd);
+        std::remove(path.c_str());
+    }
+    SECTION( "a closed descriptor" ) {
+        int fd;
+        {
+            ClientRegion client(4);
+            fd = client.fd;
+        }
+        REQUIRE_THROWS_AS( regions.get(4, getpid(), fd), std::system_error );
+    }
+    REQUIRE( regions.size() == 0 );
+}
+
+TEST_CASE( "Regions beyond the limit are dropped", "[shm_regions]" ) {
+    ShmRegions regions(2 * region_size);
+    ClientRegion a(1), b(2), c(3);
+    auto region_a = regions.get(1, getpid(), a.fd);
+    regions.get(2, getpid(), b.fd);
+    regions.get(3, getpid(), c.fd);
+    REQUIRE( regions.size() == 2 );
+    REQUIRE( regions.mapped_size() == 2 * region_size );
+    // still mapped for the request using it
+    std::memcpy(region_a->span(shm::data_offset, 2), "ok", 2);
+    REQUIRE( std::memcmp(a.base + shm::data_offset, "ok", 2) == 0 );
+    // mapped again when it is used next
+    REQUIRE( regions.get(1, getpid(), a.fd) != nullptr );
+
+    SECTION( "a region larger than the limit is not kept" ) {
+        ShmRegions small(region_size / 2);
+        REQUIRE( small.get(1, getpid(), a.fd) != nullptr );
+        REQUIRE( small.size() == 0 );
+        REQUIRE( small.mapped_size() == 0 );
+    }
+}
+
+TEST_CASE( "Regions of exited processes are dropped when a region is mapped", "[shm_regions]" ) {
+    ShmRegions regions(8 * region_size);
+    int fds[2], done[2];
+    REQUIRE( pipe(fds) == 0 );
+    REQUIRE( pipe(done) == 0 );
+    auto child = fork();
+    REQUIRE( child >= 0 );
+    if (child == 0) {
+        // no Catch2 assertions in the child, it only reports its region's descriptor
+        int fd = static_cast<int>(syscall(SYS_memfd_create, shm::memfd_name, MFD_ALLOW_SEALING));
+        if (fd < 0 || ftruncate(fd, region_size) != 0 || fcntl(fd, F_ADD_SEALS, shm::required_seals) != 0) {
+            _exit(1);
+        }
+        shm::Header header{9};
+        if (pwrite(fd, &header, sizeof(header), 0) != sizeof(header) || write(fds[1], &fd, sizeof(fd)) != sizeof(fd)) {
+            _exit(1);
+        }
+        char c;
+        _exit(read(done[0], &c, 1) == 1 ? 0 : 1);
+    }
+    int child_fd = -1;
+    REQUIRE( read(fds[0], &child_fd, sizeof(child_fd)) == sizeof(child_fd) );
+    regions.get(9, child, child_fd);
+    REQUIRE( regions.size() == 1 );
+
+    REQUIRE( write(done[1], "x", 1) == 1 );
+    int status = 0;
+    REQUIRE( waitpid(child, &status, 0) == child );
+    REQUIRE( WIFEXITED(status) );
+    REQUIRE( WEXITSTATUS(status) == 0 );
+    for (auto fd : {fds[0], fds[1], done[0], done[1]}) {
+        close(fd);
+    }
+
+    ClientRegion client(10);
+    regions.get(10, getpid(), client.fd);
+    REQUIRE( regions.size() == 1 );
+    REQUIRE( regions.mapped_size() == region_size );
+}
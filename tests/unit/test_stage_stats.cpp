@@ -0,0 +1,81 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <catch2/catch.hpp>
+#include <global/stage_stats.hpp>
+
+#include <thread>
+
+using namespace gkfs::util;
+
+TEST_CASE( "Stage histograms are laid out by RPC and stage", "[stage_stats]" ) {
+    StageStats stats;
+    stats.record(RpcOp::write, RpcStage::transfer, 100);
+    stats.record(RpcOp::write, RpcStage::transfer, 100);
+    stats.record(RpcOp::get_dirents, RpcStage::total, 0);
+
+    auto counts = stats.snapshot();
+    REQUIRE( counts.size() == StageStats::counts_size );
+    auto transfer = StageStats::offset(RpcOp::write, RpcStage::transfer);
+    REQUIRE( counts[transfer + LatencyHistogram::bucket_of(100)] == 2 );
+    REQUIRE( counts[StageStats::offset(RpcOp::get_dirents, RpcStage::total)] == 1 );
+    // the last histogram ends the snapshot
+    REQUIRE( StageStats::offset(RpcOp::get_dirents, RpcStage::total) + LatencyHistogram::bucket_count ==
+             StageStats::counts_size );
+    uint64_t total = 0;
+    for (auto c : counts) {
+        total += c;
+    }
+    REQUIRE( total == 3 );
+
+    stats.reset();
+    total = 0;
+    for (auto c : stats.snapshot()) {
+        total += c;
+    }
+    REQUIRE( total == 0 );
+}
+
+TEST_CASE( "Stage timers record each stage and the total", "[stage_stats]" ) {
+    StageStats stats;
+    {
+        StageTimer timer(stats, RpcOp::stat);
+        timer.stage(RpcStage::decode);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        timer.stage(RpcStage::storage);
+        timer.record(RpcStage::transfer, std::chrono::microseconds(300));
+        timer.mark();
+        timer.stage(RpcStage::respond);
+    }
+    auto counts = stats.snapshot();
+    auto count_of = [&](RpcStage stage) {
+        uint64_t total = 0;
+        for (unsigned int i = 0; i < LatencyHistogram::bucket_count; i++) {
+            total += counts[StageStats::offset(RpcOp::stat, stage) + i];
+        }
+        return total;
+    };
+    for (auto stage : {RpcStage::decode, RpcStage::storage, RpcStage::transfer, RpcStage::respond,
+                       RpcStage::total}) {
+        REQUIRE( count_of(stage) == 1 );
+    }
+    REQUIRE( count_of(RpcStage::queue) == 0 );
+    REQUIRE( counts[StageStats::offset(RpcOp::stat, RpcStage::transfer) + LatencyHistogram::bucket_of(300)] == 1 );
+    // the sleep falls into storage and the total
+    auto storage = StageStats::offset(RpcOp::stat, RpcStage::storage);
+    uint64_t slow = 0;
+    for (auto i = LatencyHistogram::bucket_of(2000); i < LatencyHistogram::bucket_count; i++) {
+        slow += counts[storage + i] + counts[StageStats::offset(RpcOp::stat, RpcStage::total) + i];
+    }
+    REQUIRE( slow == 2 );
+}
@@ -0,0 +1,153 @@
+/*
+  Copyright 2018-2020, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2020, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  SPDX-License-Identifier: MIT
+*/
+
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+#include <daemon/backend/data/zero_blocks.hpp>
+#include <config.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <fcntl.h>
+#include <unistd.h>
+}
+
+using namespace gkfs::data;
+
+namespace {
+
+constexpr size_t chunksize = gkfs::config::rpc::chunksize;
+constexpr size_t block_size = gkfs::config::io::zero_block_size;
+
+std::string temp_file() {
+    auto dir = getenv("GKFS_BENCH_DIR") ? std::string(getenv("GKFS_BENCH_DIR")) : std::string("/tmp");
+    return dir + "/gkfs_zero_blocks_test";
+}
+
+std::vector<char> read_file(int fd) {
+    std::vector<char> content(lseek(fd, 0, SEEK_END));
+    REQUIRE( pread(fd, content.data(), content.size(), 0) == static_cast<ssize_t>(content.size()) );
+    return content;
+}
+
+} // namespace
+
+TEST_CASE( "Zero buffers are detected", "[zero_blocks]" ) {
+    std::vector<char> buf(chunksize + 13, 0);
+    REQUIRE( is_zero(buf.data(), buf.size()) );
+    REQUIRE( is_zero(buf.data(), 0) );
+
+    // every position, including the unaligned tail, is checked
+    for (size_t pos : {size_t{0}, size_t{63}, size_t{64}, size_t{4097}, chunksize - 1, chunksize + 12}) {
+        buf[pos] = 1;
+        REQUIRE_FALSE( is_zero(buf.data(), buf.size()) );
+        REQUIRE( is_zero(buf.data(), pos) );
+        buf[pos] = 0;
+    }
+}
+
+TEST_CASE( "Sparse writes leave the same content as pwrite", "[zero_blocks]" ) {
+    auto path = temp_file();
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0640);
+    REQUIRE( fd >= 0 );
+
+    // data, zeros, data, trailing zeros
+    std::vector<char> buf(8 * block_size, 0);
+    std::memset(buf.data(), 'a', block_size + 10);
+    std::memset(buf.data() + 5 * block_size, 'b', block_size);
+    size_t written = 0;
+
+    SECTION( "into an empty file" ) {
+        REQUIRE( pwrite_sparse(fd, buf.data(), buf.size(), 0, block_size, written) ==
+                 static_cast<ssize_t>(buf.size()) );
+        REQUIRE( written < 4 * block_size );
+        REQUIRE( read_file(fd) == buf );
+    }
+
+    SECTION( "over existing data" ) {
+        std::vector<char> old(10 * block_size, 'x');
+        REQUIRE( pwrite(fd, old.data(), old.size(), 0) == static_cast<ssize_t>(old.size()) );
+        REQUIRE( pwrite_sparse(fd, buf.data(), buf.size(), 100, block_size, written) ==
+                 static_cast<ssize_t>(buf.size()) );
+        std::memcpy(old.data() + 100, buf.data(), buf.size());
+        REQUIRE( read_file(fd) == old );
+    }
+
+    SECTION( "only zeros extend the file" ) {
+        std::vector<char> zeros(3 * block_size, 0);
+        REQUIRE( pwrite_sparse(fd, zeros.data(), zeros.size(), block_size, block_size, written) ==
+                 static_cast<ssize_t>(zeros.size()) );
+        REQUIRE( written == 1 );
+        REQUIRE( read_file(fd) == std::vector<char>(4 * block_size, 0) );
+    }
+
+    close(fd);
+    std::remove(path.c_str());
+}
+
+/*
+ * Not run by default. Compares the zero scan with a memory copy of a chunk and reports the bytes written to disk for
+ * chunks with a growing share of zero blocks. Run with `tests "[.benchmark]"`
+ */
+TEST_CASE( "Zero block detection bandwidth and bytes written", "[.benchmark]" ) {
+    constexpr int rounds = 2048;
+    std::vector<char> chunk(chunksize, 0);
+    std::vector<char> copy(chunksize);
+
+    auto bandwidth = [&](const char* name, std::function<void()> fn) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; ++i) {
+            fn();
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        fmt::print("{:>24}: {:8.1f} MiB/s\n", name, rounds * chunksize / elapsed / (1024 * 1024));
+    };
+    volatile bool zero = false;
+    bandwidth("scan of a zero chunk", [&]() { zero = is_zero(chunk.data(), chunk.size()); });
+    bandwidth("memcpy of a chunk", [&]() {
+        std::memcpy(copy.data(), chunk.data(), chunk.size());
+        asm volatile("" : : "r"(copy.data()) : "memory");
+    });
+    REQUIRE( zero );
+
+    auto path = temp_file();
+    for (int percent : {0, 25, 50, 75, 100}) {
+        auto zero_blocks = chunksize / block_size * percent / 100;
+        for (size_t i = 0; i < chunksize / block_size; ++i) {
+            std::memset(chunk.data() + i * block_size, i < zero_blocks ? 0 : 'x', block_size);
+        }
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0640);
+        REQUIRE( fd >= 0 );
+        size_t requested = 0, written = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 64; ++i) {
+            size_t on_disk = 0;
+            REQUIRE( pwrite_sparse(fd, chunk.data(), chunksize, i * chunksize, block_size, on_disk) > 0 );
+            requested += chunksize;
+            written += on_disk;
+        }
+        fsync(fd);
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        close(fd);
+        fmt::print("{:>3}% zero blocks: requested {:>9} bytes, written {:>9} bytes ({:5.1f}%), {:8.1f} MiB/s\n",
+                   percent, requested, written, 100.0 * written / requested,
+                   requested / elapsed / (1024 * 1024));
+    }
+    std::remove(path.c_str());
+}